@@ -33,6 +33,7 @@
 #include "gnc-pricedb.h"
 #include "gnc-lot.h"
 #include "gnc-session.h"
+#include "gnc-split-table.h"
 #include "engine-helpers.h"
 #include "gnc-engine-guile.h"
 #include "policy.h"
@@ -207,6 +208,8 @@ SplitList * qof_query_run_subquery (QofQuery *q, const QofQuery *q);
 
 %include <gnc-session.h>
 %include <Query.h>
+%newobject gnc_split_table_get_splits;
+%include <gnc-split-table.h>
 %ignore qof_query_run;
 %ignore qof_query_last_run;
 %ignore qof_query_run_subquery;
@@ -363,6 +366,14 @@ void qof_book_set_string_option(QofBook* book, const char* opt_name, const char*
     SET_ENUM("CLEARED-VOIDED");
     SET_ENUM("CLEARED-ALL");
 
+    SET_ENUM("GNC-BALANCE-INCLUDE-CHILDREN");
+    SET_ENUM("GNC-BALANCE-CLEARED-ONLY");
+    SET_ENUM("GNC-BALANCE-EXCLUDE-CLOSING");
+
+    SET_ENUM("GNC-SPLIT-TABLE-NO-END");
+    SET_ENUM("GNC-SPLIT-TABLE-SECONDARY-END");
+    SET_ENUM("GNC-SPLIT-TABLE-PRIMARY-END");
+
     SET_ENUM("HOOK-REPORT");
     SET_ENUM("HOOK-SAVE-OPTIONS");
 
@@ -618,6 +618,24 @@ class Account(GnuCashCoreClass):
     """
     _new_instance = 'xaccMallocAccount'
 
+class GncBalanceMatrix(GnuCashCoreClass):
+    """Balances of several accounts at several dates, computed in one pass
+    over each account's splits.
+
+    Construct it with a combination of the GNC_BALANCE_ flags, add the
+    accounts (rows) and dates (columns), then read the balances. Call
+    free() when done.
+    """
+    _new_instance = 'gnc_balance_matrix_new'
+
+    def balances(self, row):
+        """Return a list of (GncCommodity, [GncNumeric per date]) pairs for
+        the account in row."""
+        n_dates = self.get_n_dates()
+        return [(self.get_commodity(row, n),
+                 [self.get_balance(row, n, col) for col in range(n_dates)])
+                for n in range(self.get_n_commodities(row))]
+
 class GUID(GnuCashCoreClass):
     _new_instance = 'guid_new_return'
 
@@ -674,6 +692,11 @@ from gnucash.gnucash_core_c import \
     ACCT_TYPE_LIABILITY, ACCT_TYPE_MUTUAL, ACCT_TYPE_PAYABLE, \
     ACCT_TYPE_RECEIVABLE, ACCT_TYPE_STOCK, ACCT_TYPE_ROOT, ACCT_TYPE_TRADING
 
+# GncBalanceMatrix flags
+from gnucash.gnucash_core_c import \
+    GNC_BALANCE_INCLUDE_CHILDREN, GNC_BALANCE_CLEARED_ONLY, \
+    GNC_BALANCE_EXCLUDE_CLOSING
+
 #Book
 Book.add_constructor_and_methods_with_prefix('qof_book_', 'new')
 Book.add_method('gnc_book_get_root_account', 'get_root_account')
@@ -858,6 +881,12 @@ methods_return_instance_lists(
                        })
 Account.name = property( Account.GetName, Account.SetName )
 
+# GncBalanceMatrix
+GncBalanceMatrix.add_methods_with_prefix('gnc_balance_matrix_')
+methods_return_instance(GncBalanceMatrix,
+                        { 'get_commodity' : GncCommodity,
+                          'get_balance' : GncNumeric })
+
 #GUID
 GUID.add_methods_with_prefix('guid_')
 GUID.add_method('xaccAccountLookup', 'AccountLookup')
@@ -1,7 +1,7 @@
 from unittest import main
 from datetime import datetime
 from gnucash import Book, Account, Split, GncCommodity, GncNumeric, \
-    Transaction
+    Transaction, GncBalanceMatrix, GNC_BALANCE_INCLUDE_CHILDREN
 
 from test_book import BookSession
 
@@ -66,5 +66,40 @@ class TestAccount(AccountSession):
         self.account.ScrubLots()
         self.assertEqual(len(self.account.GetLotList()),1)
 
+    def test_balance_matrix(self):
+        self.account.SetCommodity(self.currency)
+        child = Account(self.book)
+        child.SetCommodity(self.currency)
+        self.account.append_child(child)
+        other = Account(self.book)
+        other.SetCommodity(self.currency)
+
+        tx = Transaction(self.book)
+        tx.BeginEdit()
+        tx.SetCurrency(self.currency)
+        tx.SetDateEnteredSecs(datetime(2020, 1, 1, 12))
+        tx.SetDatePostedSecs(datetime(2020, 1, 1, 12))
+        s1 = Split(self.book)
+        s1.SetParent(tx)
+        s1.SetAccount(child)
+        s1.SetAmount(GncNumeric(25))
+        s1.SetValue(GncNumeric(25))
+        s2 = Split(self.book)
+        s2.SetParent(tx)
+        s2.SetAccount(other)
+        s2.SetAmount(GncNumeric(-25))
+        s2.SetValue(GncNumeric(-25))
+        tx.CommitEdit()
+
+        matrix = GncBalanceMatrix(GNC_BALANCE_INCLUDE_CHILDREN)
+        row = matrix.add_account(self.account)
+        matrix.add_date(datetime(2020, 2, 1))
+        matrix.add_date(datetime(2019, 12, 1))
+        ((commodity, balances),) = matrix.balances(row)
+        self.assertTrue(commodity.equal(self.currency))
+        self.assertTrue(balances[0].equal(GncNumeric(25)))
+        self.assertTrue(balances[1].zero_p())
+        matrix.free()
+
 if __name__ == '__main__':
     main()
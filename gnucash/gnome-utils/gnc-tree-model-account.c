@@ -36,6 +36,7 @@
 #include "gnc-accounting-period.h"
 #include "gnc-commodity.h"
 #include "gnc-prefs.h"
+#include "gnc-pricedb.h"
 #include "gnc-engine.h"
 #include "gnc-event.h"
 #include "gnc-gobject-utils.h"
@@ -101,6 +102,13 @@ typedef struct GncTreeModelAccountPrivate
 
     GHashTable *account_values_hash;
 
+    /* Account -> AccountBalances, dropped along the ancestor chain of
+     * a changed account. Converted balances are also invalidated by
+     * any change to the prices. */
+    GHashTable *account_balances_hash;
+    guint price_generation;
+    guint suppressed_events;
+
 } GncTreeModelAccountPrivate;
 
 #define GNC_TREE_MODEL_ACCOUNT_GET_PRIVATE(o)  \
@@ -200,6 +208,9 @@ gnc_tree_model_account_init (GncTreeModelAccount *model)
     // create the account values cache hash
     priv->account_values_hash = g_hash_table_new_full (g_str_hash, g_str_equal,
                                                        g_free, g_free);
+    priv->account_balances_hash = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+                                                         NULL, g_free);
+    priv->suppressed_events = qof_event_get_suppressed_count ();
 
     gnc_prefs_register_cb (GNC_PREFS_GROUP_GENERAL, GNC_PREF_NEGATIVE_IN_RED,
                            gnc_tree_model_account_update_color,
@@ -254,6 +265,7 @@ gnc_tree_model_account_dispose (GObject *object)
 
     // destroy the cached account values
     g_hash_table_destroy (priv->account_values_hash);
+    g_hash_table_destroy (priv->account_balances_hash);
 
     gnc_prefs_remove_cb_by_func (GNC_PREFS_GROUP_GENERAL, GNC_PREF_NEGATIVE_IN_RED,
                                  gnc_tree_model_account_update_color,
@@ -553,6 +565,150 @@ gnc_tree_model_account_set_color (GncTreeModelAccount *model,
         g_value_set_static_string (value, NULL);
 }
 
+/** The balances shown by the model's columns. */
+typedef enum
+{
+    ACCOUNT_BALANCE_PRESENT,
+    ACCOUNT_BALANCE_BALANCE,
+    ACCOUNT_BALANCE_TOTAL,
+    ACCOUNT_BALANCE_CLEARED,
+    ACCOUNT_BALANCE_RECONCILED,
+    ACCOUNT_BALANCE_FUTURE_MIN,
+    ACCOUNT_BALANCE_PERIOD,
+    ACCOUNT_BALANCE_TOTAL_PERIOD,
+    ACCOUNT_BALANCE_NUM_KINDS
+} AccountBalanceKind;
+
+/** A balance as returned by the engine, before any sign reversal. The
+ *  balance holds while the account and its descendants don't change
+ *  and, if it depends on them, while the prices, the report currency,
+ *  today's date and the accounting period stay the same. */
+typedef struct
+{
+    gboolean valid;
+    gnc_numeric value;
+    const gnc_commodity *commodity;
+    guint price_generation;
+    time64 start;
+    time64 end;
+} CachedBalance;
+
+typedef struct
+{
+    /* Indexed by kind, then by whether in the report currency. */
+    CachedBalance balances[ACCOUNT_BALANCE_NUM_KINDS][2];
+} AccountBalances;
+
+static gnc_numeric
+gnc_tree_model_account_get_balance (GncTreeModelAccount *model,
+                                    Account *account,
+                                    AccountBalanceKind kind,
+                                    gboolean report)
+{
+    GncTreeModelAccountPrivate *priv = GNC_TREE_MODEL_ACCOUNT_GET_PRIVATE(model);
+    const gnc_commodity *commodity = report ? gnc_default_report_currency () : NULL;
+    AccountBalances *balances;
+    CachedBalance *cached;
+    time64 start = 0, end = 0;
+
+    switch (kind)
+    {
+    case ACCOUNT_BALANCE_PRESENT:
+    case ACCOUNT_BALANCE_FUTURE_MIN:
+        end = gnc_time64_get_today_end ();
+        break;
+    case ACCOUNT_BALANCE_PERIOD:
+    case ACCOUNT_BALANCE_TOTAL_PERIOD:
+        start = gnc_accounting_period_fiscal_start ();
+        end = gnc_accounting_period_fiscal_end ();
+        break;
+    default:
+        break;
+    }
+
+    /* Changes made while events were suspended went unseen. */
+    if (priv->suppressed_events != qof_event_get_suppressed_count ())
+    {
+        g_hash_table_remove_all (priv->account_balances_hash);
+        priv->suppressed_events = qof_event_get_suppressed_count ();
+    }
+
+    balances = g_hash_table_lookup (priv->account_balances_hash, account);
+    if (!balances)
+    {
+        balances = g_new0 (AccountBalances, 1);
+        g_hash_table_insert (priv->account_balances_hash, account, balances);
+    }
+
+    cached = &balances->balances[kind][report ? 1 : 0];
+    if (cached->valid && cached->commodity == commodity &&
+        cached->price_generation == priv->price_generation &&
+        cached->start == start && cached->end == end)
+        return cached->value;
+
+    switch (kind)
+    {
+    case ACCOUNT_BALANCE_PRESENT:
+        cached->value = xaccAccountGetPresentBalanceInCurrency (account, commodity, TRUE);
+        break;
+    case ACCOUNT_BALANCE_BALANCE:
+        cached->value = xaccAccountGetBalanceInCurrency (account, commodity, FALSE);
+        break;
+    case ACCOUNT_BALANCE_TOTAL:
+        cached->value = xaccAccountGetBalanceInCurrency (account, commodity, TRUE);
+        break;
+    case ACCOUNT_BALANCE_CLEARED:
+        cached->value = xaccAccountGetClearedBalanceInCurrency (account, commodity, TRUE);
+        break;
+    case ACCOUNT_BALANCE_RECONCILED:
+        cached->value = xaccAccountGetReconciledBalanceInCurrency (account, commodity, TRUE);
+        break;
+    case ACCOUNT_BALANCE_FUTURE_MIN:
+        cached->value = xaccAccountGetProjectedMinimumBalanceInCurrency (account, commodity, TRUE);
+        break;
+    case ACCOUNT_BALANCE_PERIOD:
+    case ACCOUNT_BALANCE_TOTAL_PERIOD:
+        cached->value = xaccAccountGetBalanceChangeForPeriod (account, start, end,
+                                                              kind == ACCOUNT_BALANCE_TOTAL_PERIOD);
+        break;
+    default:
+        g_assert_not_reached ();
+        break;
+    }
+    cached->valid = TRUE;
+    cached->commodity = commodity;
+    cached->price_generation = priv->price_generation;
+    cached->start = start;
+    cached->end = end;
+    return cached->value;
+}
+
+/* Like gnc_ui_account_get_print_balance() and, if report is set,
+ * gnc_ui_account_get_print_report_balance(), from the cached balance. */
+static gchar *
+gnc_tree_model_account_print_balance (GncTreeModelAccount *model,
+                                      Account *account,
+                                      AccountBalanceKind kind,
+                                      gboolean report,
+                                      gboolean *negative)
+{
+    gnc_numeric balance;
+    GNCPrintAmountInfo print_info;
+
+    balance = gnc_tree_model_account_get_balance (model, account, kind, report);
+    if (gnc_reverse_balance (account))
+        balance = gnc_numeric_neg (balance);
+
+    if (negative)
+        *negative = gnc_numeric_negative_p (balance);
+
+    if (report)
+        print_info = gnc_commodity_print_info (gnc_default_report_currency (), TRUE);
+    else
+        print_info = gnc_account_print_info (account, TRUE);
+    return g_strdup (xaccPrintAmount (balance, print_info));
+}
+
 static gchar *
 gnc_tree_model_account_compute_period_balance (GncTreeModelAccount *model,
                                                Account *acct,
@@ -576,7 +732,10 @@ gnc_tree_model_account_compute_period_balance (GncTreeModelAccount *model,
     if (t1 > t2)
         return g_strdup ("");
 
-    b3 = xaccAccountGetBalanceChangeForPeriod (acct, t1, t2, recurse);
+    b3 = gnc_tree_model_account_get_balance (model, acct,
+                                             recurse ? ACCOUNT_BALANCE_TOTAL_PERIOD
+                                                     : ACCOUNT_BALANCE_PERIOD,
+                                             FALSE);
     if (gnc_reverse_balance (acct))
         b3 = gnc_numeric_neg (b3);
 
@@ -613,12 +772,15 @@ gnc_tree_model_account_clear_cache (GncTreeModelAccount *model)
 static void
 clear_account_cached_values (GncTreeModelAccount *model, GHashTable *hash, Account *account)
 {
+    GncTreeModelAccountPrivate *priv = GNC_TREE_MODEL_ACCOUNT_GET_PRIVATE(model);
     GtkTreeIter iter;
     gchar acct_guid_str[GUID_ENCODING_LENGTH + 1];
 
     if (!account)
         return;
 
+    g_hash_table_remove (priv->account_balances_hash, account);
+
     // make sure tree view sees the change
     if (gnc_tree_model_account_get_iter_from_account (model, account, &iter))
     {
@@ -776,40 +938,40 @@ gnc_tree_model_account_get_value (GtkTreeModel *tree_model,
 
     case GNC_TREE_MODEL_ACCOUNT_COL_PRESENT:
         g_value_init (value, G_TYPE_STRING);
-        string = gnc_ui_account_get_print_balance (xaccAccountGetPresentBalanceInCurrency,
-                 account, TRUE, &negative);
+        string = gnc_tree_model_account_print_balance (model, account, ACCOUNT_BALANCE_PRESENT,
+                 FALSE, &negative);
         g_value_take_string (value, string);
         break;
     case GNC_TREE_MODEL_ACCOUNT_COL_PRESENT_REPORT:
         g_value_init (value, G_TYPE_STRING);
-        string = gnc_ui_account_get_print_report_balance (xaccAccountGetPresentBalanceInCurrency,
-                 account, TRUE, &negative);
+        string = gnc_tree_model_account_print_balance (model, account, ACCOUNT_BALANCE_PRESENT,
+                 TRUE, &negative);
         g_value_take_string (value, string);
         break;
     case GNC_TREE_MODEL_ACCOUNT_COL_COLOR_PRESENT:
         g_value_init (value, G_TYPE_STRING);
-        string = gnc_ui_account_get_print_balance (xaccAccountGetPresentBalanceInCurrency,
-                 account, TRUE, &negative);
+        string = gnc_tree_model_account_print_balance (model, account, ACCOUNT_BALANCE_PRESENT,
+                 FALSE, &negative);
         gnc_tree_model_account_set_color (model, negative, value);
         g_free (string);
         break;
 
     case GNC_TREE_MODEL_ACCOUNT_COL_BALANCE:
         g_value_init (value, G_TYPE_STRING);
-        string = gnc_ui_account_get_print_balance (xaccAccountGetBalanceInCurrency,
-                 account, FALSE, &negative);
+        string = gnc_tree_model_account_print_balance (model, account, ACCOUNT_BALANCE_BALANCE,
+                 FALSE, &negative);
         g_value_take_string (value, string);
         break;
     case GNC_TREE_MODEL_ACCOUNT_COL_BALANCE_REPORT:
         g_value_init (value, G_TYPE_STRING);
-        string = gnc_ui_account_get_print_report_balance (xaccAccountGetBalanceInCurrency,
-                 account, FALSE, &negative);
+        string = gnc_tree_model_account_print_balance (model, account, ACCOUNT_BALANCE_BALANCE,
+                 TRUE, &negative);
         g_value_take_string (value, string);
         break;
     case GNC_TREE_MODEL_ACCOUNT_COL_COLOR_BALANCE:
         g_value_init (value, G_TYPE_STRING);
-        string = gnc_ui_account_get_print_balance (xaccAccountGetBalanceInCurrency,
-                 account, FALSE, &negative);
+        string = gnc_tree_model_account_print_balance (model, account, ACCOUNT_BALANCE_BALANCE,
+                 FALSE, &negative);
         gnc_tree_model_account_set_color (model, negative, value);
         g_free (string);
         break;
@@ -827,34 +989,34 @@ gnc_tree_model_account_get_value (GtkTreeModel *tree_model,
 
     case GNC_TREE_MODEL_ACCOUNT_COL_CLEARED:
         g_value_init (value, G_TYPE_STRING);
-        string = gnc_ui_account_get_print_balance (xaccAccountGetClearedBalanceInCurrency,
-                 account, TRUE, &negative);
+        string = gnc_tree_model_account_print_balance (model, account, ACCOUNT_BALANCE_CLEARED,
+                 FALSE, &negative);
         g_value_take_string (value, string);
         break;
     case GNC_TREE_MODEL_ACCOUNT_COL_CLEARED_REPORT:
         g_value_init (value, G_TYPE_STRING);
-        string = gnc_ui_account_get_print_report_balance (xaccAccountGetClearedBalanceInCurrency,
-                 account, TRUE, &negative);
+        string = gnc_tree_model_account_print_balance (model, account, ACCOUNT_BALANCE_CLEARED,
+                 TRUE, &negative);
         g_value_take_string (value, string);
         break;
     case GNC_TREE_MODEL_ACCOUNT_COL_COLOR_CLEARED:
         g_value_init (value, G_TYPE_STRING);
-        string = gnc_ui_account_get_print_balance (xaccAccountGetClearedBalanceInCurrency,
-                 account, TRUE, &negative);
+        string = gnc_tree_model_account_print_balance (model, account, ACCOUNT_BALANCE_CLEARED,
+                 FALSE, &negative);
         gnc_tree_model_account_set_color (model, negative, value);
         g_free (string);
         break;
 
     case GNC_TREE_MODEL_ACCOUNT_COL_RECONCILED:
         g_value_init (value, G_TYPE_STRING);
-        string = gnc_ui_account_get_print_balance (xaccAccountGetReconciledBalanceInCurrency,
-                 account, TRUE, &negative);
+        string = gnc_tree_model_account_print_balance (model, account, ACCOUNT_BALANCE_RECONCILED,
+                 FALSE, &negative);
         g_value_take_string (value, string);
         break;
     case GNC_TREE_MODEL_ACCOUNT_COL_RECONCILED_REPORT:
         g_value_init (value, G_TYPE_STRING);
-        string = gnc_ui_account_get_print_report_balance (xaccAccountGetReconciledBalanceInCurrency,
-                 account, TRUE, &negative);
+        string = gnc_tree_model_account_print_balance (model, account, ACCOUNT_BALANCE_RECONCILED,
+                 TRUE, &negative);
         g_value_take_string (value, string);
         break;
     case GNC_TREE_MODEL_ACCOUNT_COL_RECONCILED_DATE:
@@ -865,48 +1027,48 @@ gnc_tree_model_account_get_value (GtkTreeModel *tree_model,
 
     case GNC_TREE_MODEL_ACCOUNT_COL_COLOR_RECONCILED:
         g_value_init (value, G_TYPE_STRING);
-        string = gnc_ui_account_get_print_balance (xaccAccountGetReconciledBalanceInCurrency,
-                 account, TRUE, &negative);
+        string = gnc_tree_model_account_print_balance (model, account, ACCOUNT_BALANCE_RECONCILED,
+                 FALSE, &negative);
         gnc_tree_model_account_set_color (model, negative, value);
         g_free (string);
         break;
 
     case GNC_TREE_MODEL_ACCOUNT_COL_FUTURE_MIN:
         g_value_init (value, G_TYPE_STRING);
-        string = gnc_ui_account_get_print_balance (xaccAccountGetProjectedMinimumBalanceInCurrency,
-                 account, TRUE, &negative);
+        string = gnc_tree_model_account_print_balance (model, account, ACCOUNT_BALANCE_FUTURE_MIN,
+                 FALSE, &negative);
         g_value_take_string (value, string);
         break;
     case GNC_TREE_MODEL_ACCOUNT_COL_FUTURE_MIN_REPORT:
         g_value_init (value, G_TYPE_STRING);
-        string = gnc_ui_account_get_print_report_balance (xaccAccountGetProjectedMinimumBalanceInCurrency,
-                 account, TRUE, &negative);
+        string = gnc_tree_model_account_print_balance (model, account, ACCOUNT_BALANCE_FUTURE_MIN,
+                 TRUE, &negative);
         g_value_take_string (value, string);
         break;
     case GNC_TREE_MODEL_ACCOUNT_COL_COLOR_FUTURE_MIN:
         g_value_init (value, G_TYPE_STRING);
-        string = gnc_ui_account_get_print_balance (xaccAccountGetProjectedMinimumBalanceInCurrency,
-                 account, TRUE, &negative);
+        string = gnc_tree_model_account_print_balance (model, account, ACCOUNT_BALANCE_FUTURE_MIN,
+                 FALSE, &negative);
         gnc_tree_model_account_set_color (model, negative, value);
         g_free (string);
         break;
 
     case GNC_TREE_MODEL_ACCOUNT_COL_TOTAL:
         g_value_init (value, G_TYPE_STRING);
-        string = gnc_ui_account_get_print_balance (xaccAccountGetBalanceInCurrency,
-                 account, TRUE, &negative);
+        string = gnc_tree_model_account_print_balance (model, account, ACCOUNT_BALANCE_TOTAL,
+                 FALSE, &negative);
         g_value_take_string (value, string);
         break;
     case GNC_TREE_MODEL_ACCOUNT_COL_TOTAL_REPORT:
         g_value_init (value, G_TYPE_STRING);
-        string = gnc_ui_account_get_print_report_balance (xaccAccountGetBalanceInCurrency,
-                 account, TRUE, &negative);
+        string = gnc_tree_model_account_print_balance (model, account, ACCOUNT_BALANCE_TOTAL,
+                 TRUE, &negative);
         g_value_take_string (value, string);
         break;
     case GNC_TREE_MODEL_ACCOUNT_COL_COLOR_TOTAL:
         g_value_init (value, G_TYPE_STRING);
-        string = gnc_ui_account_get_print_balance (xaccAccountGetBalanceInCurrency,
-                 account, TRUE, &negative);
+        string = gnc_tree_model_account_print_balance (model, account, ACCOUNT_BALANCE_TOTAL,
+                 FALSE, &negative);
         gnc_tree_model_account_set_color (model, negative, value);
         g_free (string);
         break;
@@ -1438,6 +1600,14 @@ gnc_tree_model_account_event_handler (QofInstance *entity,
 
     g_return_if_fail (model);    /* Required */
 
+    if (GNC_IS_PRICE(entity))
+    {
+        /* Balances converted with the old prices are stale. */
+        priv = GNC_TREE_MODEL_ACCOUNT_GET_PRIVATE(model);
+        priv->price_generation++;
+        return;
+    }
+
     if (!GNC_IS_ACCOUNT(entity))
         return;
 
@@ -1458,9 +1628,14 @@ gnc_tree_model_account_event_handler (QofInstance *entity,
         return;
     }
 
-    /* clear the cached model values for account */
+    /* clear the cached model values for account; an added account has
+     * none yet, but the totals of its new ancestors change */
     if (event_type != QOF_EVENT_ADD)
         gnc_tree_model_account_clear_cached_values (model, account);
+    else
+        gnc_tree_model_account_clear_cached_values (model, gnc_account_get_parent (account));
+    if (event_type == QOF_EVENT_REMOVE && ed && ed->node)
+        gnc_tree_model_account_clear_cached_values (model, GNC_ACCOUNT(ed->node));
 
     /* What to do, that to do. */
     switch (event_type)
@@ -124,7 +124,9 @@ typedef struct
  */
 GType gnc_tree_model_account_get_type (void);
 
-/** Clear the tree model account cached values.
+/** Clear the tree model account cached values. The strings are
+ *  rebuilt from the cached balances, which stay valid until their
+ *  account or one of its descendants changes.
  *
  *  @param model A pointer to the account tree model.
  */
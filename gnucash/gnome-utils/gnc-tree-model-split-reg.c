@@ -90,6 +90,7 @@ static void gtm_sr_increment_stamp (GncTreeModelSplitReg *model);
 
 
 static void gtm_sr_insert_trans (GncTreeModelSplitReg *model, Transaction *trans, gboolean before);
+static void gtm_sr_insert_trans_at (GncTreeModelSplitReg *model, Transaction *trans, gint position);
 static void gtm_sr_delete_trans (GncTreeModelSplitReg *model, Transaction *trans);
 
 /** Component Manager Callback ******************************************/
@@ -126,6 +127,7 @@ struct GncTreeModelSplitRegPrivate
     GtkListStore *account_list;      // Account combo list
 
     gint event_handler_id;
+    guint edit_generation;           // Changed with anything the rows show
 };
 
 
@@ -348,6 +350,8 @@ gnc_tree_model_split_reg_prefs_changed (gpointer prefs, gchar *pref, gpointer us
     if (model == NULL)
         return;
 
+    model->priv->edit_generation++;
+
     if (g_str_has_suffix (pref, GNC_PREF_ACCOUNTING_LABELS))
     {
         model->use_accounting_labels = gnc_prefs_get_bool (GNC_PREFS_GROUP_GENERAL, GNC_PREF_ACCOUNTING_LABELS);
@@ -547,11 +551,11 @@ gtm_sr_remove_all_rows (GncTreeModelSplitReg *model)
     g_list_free (rr_list);
 }
 
-static void
+static GList *
 gtm_sr_reg_load (GncTreeModelSplitReg *model, GncTreeModelSplitRegUpdate model_update, gint num_of_rows)
 {
     GncTreeModelSplitRegPrivate *priv;
-    GList *node;
+    GList *node, *tlist = NULL;
     gint rows = 0;
 
     priv = model->priv;
@@ -564,7 +568,7 @@ gtm_sr_reg_load (GncTreeModelSplitReg *model, GncTreeModelSplitRegUpdate model_u
         {
             Transaction *trans = node->data;
 
-            priv->tlist = g_list_append (priv->tlist, trans);
+            tlist = g_list_prepend (tlist, trans);
             rows++;
 
             if (rows == num_of_rows)
@@ -580,7 +584,7 @@ gtm_sr_reg_load (GncTreeModelSplitReg *model, GncTreeModelSplitRegUpdate model_u
         {
             Transaction *trans = node->data;
 
-            priv->tlist = g_list_append (priv->tlist, trans);
+            tlist = g_list_prepend (tlist, trans);
             rows++;
 
             if (rows == num_of_rows)
@@ -596,31 +600,27 @@ gtm_sr_reg_load (GncTreeModelSplitReg *model, GncTreeModelSplitRegUpdate model_u
         {
             Transaction *trans = node->data;
 
-            priv->tlist = g_list_append (priv->tlist, trans);
+            tlist = g_list_prepend (tlist, trans);
             rows++;
 
             if (rows == (NUM_OF_TRANS*3))
                 break;
         } 
     }
+    return g_list_reverse (tlist);
 }
 
 
-/* Load the model with unique transactions based on a GList of splits */
-void
-gnc_tree_model_split_reg_load (GncTreeModelSplitReg *model, GList *slist, Account *default_account)
+/* Set the full_tlist to the unique transactions of slist and the blank
+   transaction, in the order of the model, and return the part of it to
+   show in the tlist. */
+static GList *
+gtm_sr_set_full_tlist (GncTreeModelSplitReg *model, GList *slist)
 {
     GncTreeModelSplitRegPrivate *priv;
 
-    ENTER("#### Load ModelSplitReg = %p and slist length is %d ####", model, g_list_length (slist));
-
     priv = model->priv;
 
-    /* Clear the treeview */
-    gtm_sr_remove_all_rows (model);
-    priv->full_tlist = NULL;
-    priv->tlist = NULL;
-
     if (model->current_trans == NULL)
         model->current_trans = priv->btrans;
 
@@ -652,17 +652,36 @@ gnc_tree_model_split_reg_load (GncTreeModelSplitReg *model, GList *slist, Accoun
     if (g_list_length (priv->full_tlist) < NUM_OF_TRANS*3)
     {
         // Copy the full_tlist to tlist
-        priv->tlist = g_list_copy (priv->full_tlist);
+        return g_list_copy (priv->full_tlist);
     }
     else
     {
         if (model->position_of_trans_in_full_tlist < (NUM_OF_TRANS*3))
-            gtm_sr_reg_load (model, VIEW_HOME, NUM_OF_TRANS*3);
+            return gtm_sr_reg_load (model, VIEW_HOME, NUM_OF_TRANS*3);
         else if (model->position_of_trans_in_full_tlist > g_list_length (priv->full_tlist) - (NUM_OF_TRANS*3))
-            gtm_sr_reg_load (model, VIEW_END, NUM_OF_TRANS*3);
+            return gtm_sr_reg_load (model, VIEW_END, NUM_OF_TRANS*3);
         else
-            gtm_sr_reg_load (model, VIEW_GOTO, model->position_of_trans_in_full_tlist);
+            return gtm_sr_reg_load (model, VIEW_GOTO, model->position_of_trans_in_full_tlist);
     }
+}
+
+
+/* Load the model with unique transactions based on a GList of splits */
+void
+gnc_tree_model_split_reg_load (GncTreeModelSplitReg *model, GList *slist, Account *default_account)
+{
+    GncTreeModelSplitRegPrivate *priv;
+
+    ENTER("#### Load ModelSplitReg = %p and slist length is %d ####", model, g_list_length (slist));
+
+    priv = model->priv;
+
+    /* Clear the treeview */
+    gtm_sr_remove_all_rows (model);
+    priv->full_tlist = NULL;
+    priv->tlist = NULL;
+
+    priv->tlist = gtm_sr_set_full_tlist (model, slist);
 
     PINFO("#### Register for Account '%s' has %d transactions and %d splits and tlist is %d ####",
           default_account ? xaccAccountGetName (default_account) : "NULL", g_list_length (priv->full_tlist), g_list_length (slist), g_list_length (priv->tlist));
@@ -672,11 +691,164 @@ gnc_tree_model_split_reg_load (GncTreeModelSplitReg *model, GList *slist, Accoun
 
     priv->anchor = default_account;
     priv->bsplit_parent_node = NULL;
+    priv->edit_generation++;
 
     LEAVE("#### Leave Model Load ####");
 }
 
 
+static gint
+gtm_sr_compare_tnode_position (gconstpointer a, gconstpointer b, gpointer user_data)
+{
+    GHashTable *positions = user_data;
+    Transaction *trans_a = (*(GList *const *)a)->data;
+    Transaction *trans_b = (*(GList *const *)b)->data;
+    gint pos_a = GPOINTER_TO_INT (g_hash_table_lookup (positions, xaccTransGetGUID (trans_a)));
+    gint pos_b = GPOINTER_TO_INT (g_hash_table_lookup (positions, xaccTransGetGUID (trans_b)));
+
+    return pos_a - pos_b;
+}
+
+
+/* Change the rows of the transactions in tlist to those of new_tlist.
+   Transactions are matched by GUID: the rows of those not in new_tlist
+   are deleted, those of the ones in both reordered as one change and
+   the others inserted where they go. The tlist nodes of the transactions
+   kept are relinked rather than replaced, as iters point at them. */
+static gboolean
+gtm_sr_apply_tlist (GncTreeModelSplitReg *model, GList *new_tlist)
+{
+    GncTreeModelSplitRegPrivate *priv = model->priv;
+    GHashTable *new_positions, *old_guids;
+    GList *node, *next;
+    GList **nodes;
+    gint *new_order;
+    gint n_nodes, i, position;
+    gboolean changed = FALSE, reordered = FALSE;
+
+    new_positions = g_hash_table_new (guid_hash_to_guint, guid_g_hash_table_equal);
+    for (node = new_tlist, position = 0; node; node = node->next, position++)
+        g_hash_table_insert (new_positions, (gpointer) xaccTransGetGUID (node->data),
+                             GINT_TO_POINTER (position));
+
+    /* Remove the transactions that are gone */
+    for (node = priv->tlist; node; node = next)
+    {
+        Transaction *trans = node->data;
+
+        next = node->next;
+        if (!g_hash_table_contains (new_positions, xaccTransGetGUID (trans)))
+        {
+            DEBUG("remove trans %p", trans);
+            gtm_sr_delete_trans (model, trans);
+            changed = TRUE;
+        }
+    }
+
+    /* Put the ones left in their new order */
+    n_nodes = g_list_length (priv->tlist);
+    nodes = g_new (GList *, n_nodes);
+    old_guids = g_hash_table_new (guid_hash_to_guint, guid_g_hash_table_equal);
+    for (node = priv->tlist, i = 0; node; node = node->next, i++)
+    {
+        nodes[i] = node;
+        g_hash_table_insert (old_guids, (gpointer) xaccTransGetGUID (node->data),
+                             GINT_TO_POINTER (i));
+    }
+    g_qsort_with_data (nodes, n_nodes, sizeof (GList *),
+                       gtm_sr_compare_tnode_position, new_positions);
+
+    new_order = g_new (gint, n_nodes);
+    for (i = 0; i < n_nodes; i++)
+    {
+        new_order[i] = GPOINTER_TO_INT (g_hash_table_lookup (old_guids,
+                           xaccTransGetGUID (nodes[i]->data)));
+        if (new_order[i] != i)
+            reordered = TRUE;
+    }
+    if (reordered)
+    {
+        GtkTreePath *path = gtk_tree_path_new ();
+
+        for (i = 0; i < n_nodes; i++)
+        {
+            nodes[i]->prev = i > 0 ? nodes[i - 1] : NULL;
+            nodes[i]->next = i < n_nodes - 1 ? nodes[i + 1] : NULL;
+        }
+        priv->tlist = nodes[0];
+
+        DEBUG("reorder %d transactions", n_nodes);
+        gtm_sr_increment_stamp (model);
+        gtk_tree_model_rows_reordered (GTK_TREE_MODEL (model), path, NULL, new_order);
+        gtk_tree_path_free (path);
+        changed = TRUE;
+    }
+    g_free (new_order);
+    g_free (nodes);
+
+    /* Add the new ones, each after those before it in new_tlist */
+    for (node = new_tlist, position = 0; node; node = node->next, position++)
+    {
+        if (!g_hash_table_contains (old_guids, xaccTransGetGUID (node->data)))
+        {
+            DEBUG("insert trans %p at %d", node->data, position);
+            gtm_sr_insert_trans_at (model, node->data, position);
+            changed = TRUE;
+        }
+    }
+    g_hash_table_destroy (old_guids);
+    g_hash_table_destroy (new_positions);
+    return changed;
+}
+
+
+/* Reload the model from a GList of splits, changing only the rows that need it */
+void
+gnc_tree_model_split_reg_update (GncTreeModelSplitReg *model, GList *slist, Account *default_account)
+{
+    GncTreeModelSplitRegPrivate *priv;
+    GList *new_tlist;
+
+    ENTER("#### Update ModelSplitReg = %p and slist length is %d ####", model, g_list_length (slist));
+
+    priv = model->priv;
+
+    /* Nothing to keep, or rows of another account */
+    if (priv->tlist == NULL || priv->anchor != default_account)
+    {
+        gnc_tree_model_split_reg_load (model, slist, default_account);
+        LEAVE("#### Loaded ####");
+        return;
+    }
+
+    g_list_free (priv->full_tlist);
+    new_tlist = gtm_sr_set_full_tlist (model, slist);
+
+    if (gtm_sr_apply_tlist (model, new_tlist))
+        g_signal_emit_by_name (model, "refresh_view");
+    g_list_free (new_tlist);
+
+    PINFO("#### Register for Account '%s' has %d transactions and %d splits and tlist is %d ####",
+          default_account ? xaccAccountGetName (default_account) : "NULL", g_list_length (priv->full_tlist), g_list_length (slist), g_list_length (priv->tlist));
+
+    /* Update the completion model liststores */
+    g_idle_add ((GSourceFunc) gnc_tree_model_split_reg_update_completion, model);
+
+    priv->edit_generation++;
+
+    LEAVE("#### Leave Model Update ####");
+}
+
+
+guint
+gnc_tree_model_split_reg_get_edit_generation (GncTreeModelSplitReg *model)
+{
+    g_return_val_if_fail (GNC_IS_TREE_MODEL_SPLIT_REG (model), 0);
+
+    return model->priv->edit_generation;
+}
+
+
 void
 gnc_tree_model_split_reg_move (GncTreeModelSplitReg *model, GncTreeModelSplitRegUpdate model_update)
 {
@@ -2405,16 +2577,21 @@ gtm_sr_changed_row_at (GncTreeModelSplitReg *model, GtkTreeIter *iter)
 /* Insert transaction into model */
 static void
 gtm_sr_insert_trans (GncTreeModelSplitReg *model, Transaction *trans, gboolean before)
+{
+    gtm_sr_insert_trans_at (model, trans, before ? 0 : -1);
+}
+
+
+/* Insert transaction into model at position in tlist, at the end if negative */
+static void
+gtm_sr_insert_trans_at (GncTreeModelSplitReg *model, Transaction *trans, gint position)
 {
     GtkTreeIter iter;
     GtkTreePath *path;
     GList *tnode = NULL, *snode = NULL;
 
-    ENTER("insert transaction %p into model %p", trans, model);
-    if (before == TRUE)
-        model->priv->tlist = g_list_prepend (model->priv->tlist, trans);
-    else
-        model->priv->tlist = g_list_append (model->priv->tlist, trans);
+    ENTER("insert transaction %p into model %p at %d", trans, model, position);
+    model->priv->tlist = g_list_insert (model->priv->tlist, trans, position);
     tnode = g_list_find (model->priv->tlist, trans);
 
     iter = gtm_sr_make_iter (model, TROW1, tnode, NULL);
@@ -3127,6 +3304,10 @@ gnc_tree_model_split_reg_event_handler (QofInstance *entity,
         return;
     type = entity->e_type;
 
+    /* Whatever changed may show in some row, account names and balances
+       included. */
+    priv->edit_generation++;
+
     if (g_strcmp0 (type, GNC_ID_SPLIT) == 0)
     {
         /* Get the split.*/
@@ -207,6 +207,16 @@ gnc_tree_model_split_reg_new (SplitRegisterType2 reg_type, SplitRegisterStyle2 s
 /** Load the model from a slist and set default account for register. */
 void gnc_tree_model_split_reg_load (GncTreeModelSplitReg *model, GList * slist, Account *default_account);
 
+/** Reload the model from a slist like gnc_tree_model_split_reg_load, but
+ *  only delete, insert or reorder the rows of the transactions that
+ *  left, joined or moved in the list, matching them by GUID, so that the
+ *  view keeps the state of the other rows. */
+void gnc_tree_model_split_reg_update (GncTreeModelSplitReg *model, GList * slist, Account *default_account);
+
+/** Return a number that changes whenever the text shown in any row of
+ *  the model may have changed. */
+guint gnc_tree_model_split_reg_get_edit_generation (GncTreeModelSplitReg *model);
+
 /** Sets the template account. */
 void gnc_tree_model_split_reg_set_template_account (GncTreeModelSplitReg *model, Account *template_account);
 
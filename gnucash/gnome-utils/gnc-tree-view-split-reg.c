@@ -78,6 +78,8 @@ static guint gnc_tree_view_split_reg_signals[LAST_SIGNAL] = {0};
 
 static void gnc_tree_view_split_reg_pref_changed (gpointer prefs, gchar *pref, gpointer user_data);
 
+static void gtv_sr_row_text_free (gpointer data);
+
 static void gtv_sr_cdf0 (GtkTreeViewColumn *col, GtkCellRenderer *renderer, GtkTreeModel *s_model,
 				GtkTreeIter *s_iter, gpointer user_data);
 
@@ -280,8 +282,23 @@ struct GncTreeViewSplitRegPrivate
     gchar               *transfer_string;              // The transfer account string.
     gboolean             stop_cell_move;               // Stops the cursor moving to a different cell.
 
+    GHashTable          *row_text;                     // Cached GtvSrRowText by split or transaction
+    guint                row_text_generation;          // The model edit generation of row_text
+
 };
 
+/* The text of the cells of a row that only depend on the row's split or
+   transaction, so need not be worked out again on every draw. */
+typedef struct
+{
+    gchar    *transfer;           // Transfer account or accounts
+    gboolean  transfer_is_multi;  // The transfer is to several accounts
+    gchar    *debcred;            // The amount without its sign
+    gint      debcred_sign;       // The sign of the amount, 0 if none is shown
+    gchar    *balance;            // The balance of a transaction row
+    gboolean  balance_negative;
+} GtvSrRowText;
+
 /* Define some cell colors */
 #define PINKCELL "#F8BEC6"
 #define REDCELL "#F34943"
@@ -445,6 +462,10 @@ gnc_tree_view_split_reg_init (GncTreeViewSplitReg *view)
     view->priv->transfer_string = g_strdup ("Dummy");
     view->priv->stop_cell_move = FALSE;
 
+    view->priv->row_text = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+                                                  NULL, gtv_sr_row_text_free);
+    view->priv->row_text_generation = 0;
+
     view->priv->show_calendar_buttons = gnc_prefs_get_bool (GNC_PREFS_GROUP_GENERAL_REGISTER, GNC_PREF_SHOW_CAL_BUTTONS);
     view->show_extra_dates = gnc_prefs_get_bool (GNC_PREFS_GROUP_GENERAL_REGISTER, GNC_PREF_SHOW_EXTRA_DATES);
     view->priv->show_extra_dates_on_selection = gnc_prefs_get_bool (GNC_PREFS_GROUP_GENERAL_REGISTER, GNC_PREF_SHOW_EXTRA_DATES_ON_SEL);
@@ -501,6 +522,12 @@ gnc_tree_view_split_reg_dispose (GObject *object)
     if (view->priv->transfer_string)
         g_free (view->priv->transfer_string);
 
+    if (view->priv->row_text)
+    {
+        g_hash_table_destroy (view->priv->row_text);
+        view->priv->row_text = NULL;
+    }
+
     gnc_prefs_remove_cb_by_func (GNC_PREFS_GROUP_GENERAL_REGISTER,
                                  GNC_PREF_DRAW_HOR_LINES,
                                  gnc_tree_view_split_reg_pref_changed,
@@ -550,6 +577,9 @@ gnc_tree_view_split_reg_refresh_from_prefs (GncTreeViewSplitReg *view)
 
     view->priv->negative_in_red = gnc_prefs_get_bool (GNC_PREFS_GROUP_GENERAL,
                                                       GNC_PREF_NEGATIVE_IN_RED);
+
+    /* The amounts may print differently now */
+    g_hash_table_remove_all (view->priv->row_text);
 }
 
 
@@ -1343,6 +1373,54 @@ gtv_sr_control_cdf0 (GtkTreeViewColumn *col, GtkCellRenderer *cell, GtkTreeModel
 }
 
 
+/* Free a GtvSrRowText */
+static void
+gtv_sr_row_text_free (gpointer data)
+{
+    GtvSrRowText *row_text = data;
+
+    g_free (row_text->transfer);
+    g_free (row_text->debcred);
+    g_free (row_text->balance);
+    g_free (row_text);
+}
+
+
+/* Return the cached text of the row of row_item, a split or the
+   transaction of a transaction row. All of it is dropped whenever the
+   model's edit generation moves on. Returns NULL for rows that must be
+   worked out each time: those of the blank transaction and of
+   transactions being edited. */
+static GtvSrRowText *
+gtv_sr_get_row_text (GncTreeViewSplitReg *view, GncTreeModelSplitReg *model,
+                     Transaction *trans, gpointer row_item)
+{
+    GncTreeViewSplitRegPrivate *priv = view->priv;
+    GtvSrRowText *row_text;
+    guint generation;
+
+    if (xaccTransIsOpen (trans) || (trans == priv->dirty_trans) ||
+        (trans == gnc_tree_model_split_get_blank_trans (model)) ||
+        (xaccTransCountSplits (trans) == 0))
+        return NULL;
+
+    generation = gnc_tree_model_split_reg_get_edit_generation (model);
+    if (priv->row_text_generation != generation)
+    {
+        g_hash_table_remove_all (priv->row_text);
+        priv->row_text_generation = generation;
+    }
+
+    row_text = g_hash_table_lookup (priv->row_text, row_item);
+    if (!row_text)
+    {
+        row_text = g_new0 (GtvSrRowText, 1);
+        g_hash_table_insert (priv->row_text, row_item, row_text);
+    }
+    return row_text;
+}
+
+
 /* Instead of setting a different cellDataFunc for each column, we just
    collect everything here for the first cell renderer. */
 static void
@@ -1603,7 +1681,22 @@ gtv_sr_cdf0 (GtkTreeViewColumn *col, GtkCellRenderer *cell, GtkTreeModel *s_mode
                 else
                 {
                     gboolean is_multi;
-                    string = g_strdup (gnc_tree_util_split_reg_get_transfer_entry (gtv_sr_get_this_split (view, trans), &is_multi));
+                    GtvSrRowText *row_text = is_blank ? NULL : gtv_sr_get_row_text (view, model, trans, trans);
+
+                    if (row_text && row_text->transfer)
+                    {
+                        string = g_strdup (row_text->transfer);
+                        is_multi = row_text->transfer_is_multi;
+                    }
+                    else
+                    {
+                        string = g_strdup (gnc_tree_util_split_reg_get_transfer_entry (gtv_sr_get_this_split (view, trans), &is_multi));
+                        if (row_text)
+                        {
+                            row_text->transfer = g_strdup (string);
+                            row_text->transfer_is_multi = is_multi;
+                        }
+                    }
 
                     editable = anchor && !expanded && !is_multi;
                 }
@@ -1625,11 +1718,20 @@ gtv_sr_cdf0 (GtkTreeViewColumn *col, GtkCellRenderer *cell, GtkTreeModel *s_mode
 
                     if (acct != NULL)
                     {
-                        if (view->priv->acct_short_names)
-                            string = g_strdup (xaccAccountGetName (acct));
+                        GtvSrRowText *row_text = is_blank ? NULL : gtv_sr_get_row_text (view, model, trans, split);
+
+                        if (row_text && row_text->transfer)
+                            string = g_strdup (row_text->transfer);
                         else
-                            string = gnc_account_get_full_name (acct);
+                        {
+                            if (view->priv->acct_short_names)
+                                string = g_strdup (xaccAccountGetName (acct));
+                            else
+                                string = gnc_account_get_full_name (acct);
 
+                            if (row_text)
+                                row_text->transfer = g_strdup (string);
+                        }
                     }
                     else
                         string = g_strdup (" ");
@@ -1978,37 +2080,72 @@ gtv_sr_cdf0 (GtkTreeViewColumn *col, GtkCellRenderer *cell, GtkTreeModel *s_mode
         {
             if (!is_template) // Is this a template
             {
-                GNCPrintAmountInfo print_info;
-                print_info = gnc_account_print_info (anchor, SHOW_SYMBOL);
-
-                if (is_split)
+                GtvSrRowText *row_text = NULL;
+                const gchar *amount;
+                gint sign;
+
+                /* With trading accounts a split's amount and symbol depend
+                   on whether the cursor is on it, so don't cache those. */
+                if (!is_blank && !is_trow2 &&
+                    !(is_split && xaccTransUseTradingAccounts (trans)))
+                    row_text = gtv_sr_get_row_text (view, model, trans,
+                                                    is_split ? (gpointer) split : (gpointer) trans);
+
+                if (row_text && row_text->debcred)
                 {
-                    if (!gnc_tree_util_split_reg_get_debcred_entry (view, trans, split, is_blank, &num, &print_info))
-                        num = gnc_numeric_zero();
-
-                    if (gtv_sr_get_imbalance (trans))
-                        g_object_set (cell, "cell-background", PINKCELL, (gchar*)NULL);
+                    amount = row_text->debcred;
+                    sign = row_text->debcred_sign;
                 }
-                else if (is_trow1)
+                else
                 {
-                    if (anchor)
+                    GNCPrintAmountInfo print_info;
+                    print_info = gnc_account_print_info (anchor, SHOW_SYMBOL);
+
+                    if (is_split)
                     {
-                         num = xaccTransGetAccountAmount (trans, anchor);
+                        if (!gnc_tree_util_split_reg_get_debcred_entry (view, trans, split, is_blank, &num, &print_info))
+                            num = gnc_numeric_zero();
                     }
-                    else
+                    else if (is_trow1)
+                    {
+                        if (anchor)
+                        {
+                             num = xaccTransGetAccountAmount (trans, anchor);
+                        }
+                        else
+                        {
+                            num = gnc_numeric_zero();
+                        }
+                    }
+                    else if (is_trow2)
                     {
                         num = gnc_numeric_zero();
                     }
+
+                    if ((gnc_numeric_check(num) != GNC_ERROR_OK) || gnc_numeric_zero_p(num))
+                    {
+                        sign = 0;
+                        amount = "";
+                    }
+                    else
+                    {
+                        sign = gnc_numeric_negative_p(num) ? -1 : 1;
+                        amount = xaccPrintAmount (gnc_numeric_abs (num), print_info);
+                    }
+
+                    if (row_text)
+                    {
+                        row_text->debcred = g_strdup (amount);
+                        row_text->debcred_sign = sign;
+                    }
                 }
-                else if (is_trow2)
-                {
-                    num = gnc_numeric_zero();
-                }
 
-                if ((gnc_numeric_check(num) != GNC_ERROR_OK) ||
-                     gnc_numeric_zero_p(num) ||
-                    (gnc_numeric_negative_p(num) && viewcol == COL_DEBIT) ||
-                    (gnc_numeric_positive_p(num) && viewcol == COL_CREDIT))
+                if (is_split && gtv_sr_get_imbalance (trans))
+                    g_object_set (cell, "cell-background", PINKCELL, (gchar*)NULL);
+
+                if ((sign == 0) ||
+                    (sign < 0 && viewcol == COL_DEBIT) ||
+                    (sign > 0 && viewcol == COL_CREDIT))
                 {
                     s = "";
                 }
@@ -2017,7 +2154,7 @@ gtv_sr_cdf0 (GtkTreeViewColumn *col, GtkCellRenderer *cell, GtkTreeModel *s_mode
                     if ((is_trow1 || is_trow2) && expanded)
                         s = "";
                     else
-                        s = xaccPrintAmount (gnc_numeric_abs (num), print_info);
+                        s = amount;
                 }
             }
             else
@@ -2048,13 +2185,31 @@ gtv_sr_cdf0 (GtkTreeViewColumn *col, GtkCellRenderer *cell, GtkTreeModel *s_mode
             g_object_set(cell, "cell-background", "white", (gchar*)NULL);
 
         if (is_trow1 && anchor) {
-            num = xaccTransGetAccountBalance (trans, anchor);
-            if (gnc_reverse_balance (anchor))
-                num = gnc_numeric_neg (num);
-            s = xaccPrintAmount (num, gnc_account_print_info(anchor, FALSE));
+            GtvSrRowText *row_text = is_blank ? NULL : gtv_sr_get_row_text (view, model, trans, trans);
+            gboolean negative;
+
+            if (row_text && row_text->balance)
+            {
+                s = row_text->balance;
+                negative = row_text->balance_negative;
+            }
+            else
+            {
+                num = xaccTransGetAccountBalance (trans, anchor);
+                if (gnc_reverse_balance (anchor))
+                    num = gnc_numeric_neg (num);
+                s = xaccPrintAmount (num, gnc_account_print_info(anchor, FALSE));
+                negative = gnc_numeric_negative_p (num);
+
+                if (row_text)
+                {
+                    row_text->balance = g_strdup (s);
+                    row_text->balance_negative = negative;
+                }
+            }
 
             // Display negative numbers in red if requested in preferences
-            if (gnc_numeric_negative_p (num) && negative_in_red)
+            if (negative && negative_in_red)
                 g_object_set (cell, "foreground", "red", (gchar*)NULL);
             else
                 g_object_set (cell, "foreground", NULL, (gchar*)NULL);
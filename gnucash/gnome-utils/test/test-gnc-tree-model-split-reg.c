@@ -0,0 +1,248 @@
+/********************************************************************
+ * test-gnc-tree-model-split-reg.c: Test the split register model   *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+\********************************************************************/
+
+#include <config.h>
+#include <glib.h>
+#include <gtk/gtk.h>
+#include <qof.h>
+#include <cashobjects.h>
+#include <TransLog.h>
+#include <Account.h>
+#include <Transaction.h>
+#include <gnc-commodity.h>
+#include <gnc-session.h>
+#include <gnc-ui-util.h>
+#include "gnc-tree-model-split-reg.h"
+
+typedef struct
+{
+    QofBook *book;
+    Account *acct;
+    Account *other;
+    Split *splits[3];
+    GncTreeModelSplitReg *model;
+    gint inserted;
+    gint deleted;
+    gint reordered;
+} Fixture;
+
+static Split *
+make_trans (Fixture *fixture, gint day, gint64 amount)
+{
+    Transaction *trans = xaccMallocTransaction (fixture->book);
+    gnc_commodity *currency = xaccAccountGetCommodity (fixture->acct);
+    Split *split = xaccMallocSplit (fixture->book);
+    Split *other = xaccMallocSplit (fixture->book);
+    gnc_numeric value = gnc_numeric_create (amount, 100);
+
+    xaccTransBeginEdit (trans);
+    xaccTransSetCurrency (trans, currency);
+    xaccTransSetDatePostedSecsNormalized (trans, gnc_dmy2time64 (day, 1, 2020));
+    xaccSplitSetParent (split, trans);
+    xaccSplitSetAccount (split, fixture->acct);
+    xaccSplitSetValue (split, value);
+    xaccSplitSetAmount (split, value);
+    xaccSplitSetParent (other, trans);
+    xaccSplitSetAccount (other, fixture->other);
+    xaccSplitSetValue (other, gnc_numeric_neg (value));
+    xaccSplitSetAmount (other, gnc_numeric_neg (value));
+    xaccTransCommitEdit (trans);
+    return split;
+}
+
+/* Only count the transaction rows, not their split rows */
+static void
+row_inserted_cb (GtkTreeModel *model, GtkTreePath *path, GtkTreeIter *iter,
+                 Fixture *fixture)
+{
+    if (gtk_tree_path_get_depth (path) == 1)
+        fixture->inserted++;
+}
+
+static void
+row_deleted_cb (GtkTreeModel *model, GtkTreePath *path, Fixture *fixture)
+{
+    if (gtk_tree_path_get_depth (path) == 1)
+        fixture->deleted++;
+}
+
+static void
+rows_reordered_cb (GtkTreeModel *model, GtkTreePath *path, GtkTreeIter *iter,
+                   gint *new_order, Fixture *fixture)
+{
+    fixture->reordered++;
+}
+
+static void
+setup (Fixture *fixture, gconstpointer pData)
+{
+    gnc_commodity_table *table;
+    gnc_commodity *currency;
+    Account *root;
+    gint i;
+
+    fixture->book = gnc_get_current_book ();
+    table = gnc_commodity_table_get_table (fixture->book);
+    currency = gnc_commodity_table_lookup (table, GNC_COMMODITY_NS_CURRENCY, "USD");
+    root = gnc_book_get_root_account (fixture->book);
+
+    fixture->acct = xaccMallocAccount (fixture->book);
+    fixture->other = xaccMallocAccount (fixture->book);
+    xaccAccountBeginEdit (fixture->acct);
+    xaccAccountSetName (fixture->acct, "Checking");
+    xaccAccountSetType (fixture->acct, ACCT_TYPE_BANK);
+    xaccAccountSetCommodity (fixture->acct, currency);
+    gnc_account_append_child (root, fixture->acct);
+    xaccAccountCommitEdit (fixture->acct);
+    xaccAccountBeginEdit (fixture->other);
+    xaccAccountSetName (fixture->other, "Expenses");
+    xaccAccountSetType (fixture->other, ACCT_TYPE_EXPENSE);
+    xaccAccountSetCommodity (fixture->other, currency);
+    gnc_account_append_child (root, fixture->other);
+    xaccAccountCommitEdit (fixture->other);
+
+    for (i = 0; i < 3; i++)
+        fixture->splits[i] = make_trans (fixture, i + 1, (i + 1) * 1000);
+
+    fixture->model = gnc_tree_model_split_reg_new (BANK_REGISTER2, REG2_STYLE_LEDGER,
+                                                   FALSE, FALSE, FALSE);
+    g_signal_connect (fixture->model, "row-inserted",
+                      G_CALLBACK (row_inserted_cb), fixture);
+    g_signal_connect (fixture->model, "row-deleted",
+                      G_CALLBACK (row_deleted_cb), fixture);
+    g_signal_connect (fixture->model, "rows-reordered",
+                      G_CALLBACK (rows_reordered_cb), fixture);
+}
+
+static void
+teardown (Fixture *fixture, gconstpointer pData)
+{
+    gnc_tree_model_split_reg_destroy (fixture->model);
+    g_object_unref (fixture->model);
+    gnc_clear_current_session ();
+}
+
+static GList *
+make_slist (Fixture *fixture, const gint *order, gint n)
+{
+    GList *slist = NULL;
+    gint i;
+
+    for (i = n - 1; i >= 0; i--)
+        slist = g_list_prepend (slist, fixture->splits[order[i]]);
+    return slist;
+}
+
+/* Check that the transaction rows are those of the splits in order,
+   followed by the blank transaction. */
+static void
+check_rows (Fixture *fixture, const gint *order, gint n)
+{
+    GtkTreeModel *model = GTK_TREE_MODEL (fixture->model);
+    GtkTreeIter iter;
+    gint i;
+
+    g_assert_cmpint (gtk_tree_model_iter_n_children (model, NULL), ==, n + 1);
+    for (i = 0; i <= n; i++)
+    {
+        gboolean is_trow1, is_trow2, is_split, is_blank;
+        Split *split;
+        Transaction *trans;
+
+        g_assert_true (gtk_tree_model_iter_nth_child (model, &iter, NULL, i));
+        gnc_tree_model_split_reg_get_split_and_trans (fixture->model, &iter,
+                                                      &is_trow1, &is_trow2,
+                                                      &is_split, &is_blank,
+                                                      &split, &trans);
+        g_assert_true (is_trow1);
+        if (i < n)
+            g_assert_true (trans == xaccSplitGetParent (fixture->splits[order[i]]));
+        else
+            g_assert_true (trans == gnc_tree_model_split_get_blank_trans (fixture->model));
+    }
+}
+
+static void
+test_update (Fixture *fixture, const gint *order, gint n)
+{
+    GList *slist = make_slist (fixture, order, n);
+
+    gnc_tree_model_split_reg_update (fixture->model, slist, fixture->acct);
+    g_list_free (slist);
+    check_rows (fixture, order, n);
+}
+
+static void
+test_update_rows (Fixture *fixture, gconstpointer pData)
+{
+    const gint two[] = {0, 1};
+    const gint three[] = {0, 1, 2};
+    const gint dropped[] = {0, 2};
+    const gint swapped[] = {2, 0};
+    GList *slist = make_slist (fixture, two, 2);
+    guint generation;
+
+    gnc_tree_model_split_reg_load (fixture->model, slist, fixture->acct);
+    g_list_free (slist);
+    check_rows (fixture, two, 2);
+    generation = gnc_tree_model_split_reg_get_edit_generation (fixture->model);
+
+    /* Insert: only the new transaction gets a row, before the blank one */
+    test_update (fixture, three, 3);
+    g_assert_cmpint (fixture->inserted, ==, 1);
+    g_assert_cmpint (fixture->deleted, ==, 0);
+    g_assert_cmpint (fixture->reordered, ==, 0);
+    g_assert_cmpuint (gnc_tree_model_split_reg_get_edit_generation (fixture->model),
+                      !=, generation);
+
+    /* Delete */
+    test_update (fixture, dropped, 2);
+    g_assert_cmpint (fixture->inserted, ==, 1);
+    g_assert_cmpint (fixture->deleted, ==, 1);
+    g_assert_cmpint (fixture->reordered, ==, 0);
+
+    /* Reorder: one change for the rows kept, the blank one stays last */
+    test_update (fixture, swapped, 2);
+    g_assert_cmpint (fixture->inserted, ==, 1);
+    g_assert_cmpint (fixture->deleted, ==, 1);
+    g_assert_cmpint (fixture->reordered, ==, 1);
+
+    /* Nothing changed */
+    test_update (fixture, swapped, 2);
+    g_assert_cmpint (fixture->inserted, ==, 1);
+    g_assert_cmpint (fixture->deleted, ==, 1);
+    g_assert_cmpint (fixture->reordered, ==, 1);
+}
+
+int
+main (int argc, char *argv[])
+{
+    qof_init ();
+    qof_log_init_filename_special ("stderr");
+    g_test_init (&argc, &argv, NULL);
+    xaccLogDisable ();
+    cashobjects_register ();
+
+    g_test_add ("/gnome-utils/tree-model-split-reg/update", Fixture, NULL,
+                setup, test_update_rows, teardown);
+
+    return g_test_run ();
+}
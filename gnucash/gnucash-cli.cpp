@@ -63,6 +63,7 @@ namespace Gnucash {
         boost::optional <std::string> m_report_name;
         boost::optional <std::string> m_export_type;
         boost::optional <std::string> m_output_file;
+        boost::optional <std::string> m_batch_file;
     };
 
 }
@@ -105,13 +106,18 @@ Gnucash::GnucashCli::configure_program_options (void)
      "  list: \tLists available reports.\n"
      "  show: \tDescribe the options modified in the named report. A datafile \
 may be specified to describe some saved options.\n"
-     "  run: \tRun the named report in the given GnuCash datafile.\n"))
+     "  run: \tRun the named report in the given GnuCash datafile.\n"
+     "  run-batch: \tLoad the given GnuCash datafile once and run each report \
+listed in the batch file.\n"))
     ("name", bpo::value (&m_report_name),
      _("Name of the report to run\n"))
     ("export-type", bpo::value (&m_export_type),
      _("Specify export type\n"))
     ("output-file", bpo::value (&m_output_file),
-     _("Output file for report\n"));
+     _("Output file for report\n"))
+    ("batch-file", bpo::value (&m_batch_file),
+     _("File listing the reports to run with run-batch, one per line: \
+the report name or guid, a tab and the output file\n"));
     m_opt_desc_display->add (report_options);
     m_opt_desc_all.add (report_options);
 
@@ -156,6 +162,25 @@ Gnucash::GnucashCli::start ([[maybe_unused]] int argc, [[maybe_unused]] char **a
                                            m_export_type, m_output_file);
         }
 
+        else if (*m_report_cmd == "run-batch")
+        {
+            if (!m_file_to_load || m_file_to_load->empty())
+            {
+                std::cerr << bl::translate("Missing data file parameter") << "\n\n"
+                          << *m_opt_desc_display.get();
+                return 1;
+            }
+            else if (!m_batch_file || m_batch_file->empty())
+            {
+                std::cerr << bl::translate("Missing --batch-file parameter") << "\n\n"
+                          << *m_opt_desc_display.get();
+                return 1;
+            }
+            else
+                return Gnucash::run_report_batch(m_file_to_load, m_batch_file,
+                                                 m_export_type);
+        }
+
         // The command "list" does *not* test&pass the m_file_to_load
         // argument because the reports are global rather than
         // per-file objects. In the future, saved reports may be saved
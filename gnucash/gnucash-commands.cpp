@@ -42,8 +42,13 @@ extern "C" {
 }
 
 #include <boost/locale.hpp>
+#include <chrono>
 #include <fstream>
+#include <future>
+#include <iomanip>
 #include <iostream>
+#include <utility>
+#include <vector>
 
 namespace bl = boost::locale;
 
@@ -162,11 +167,8 @@ write_report_file (const char *html, const char* file)
 }
 
 static void
-scm_run_report (void *data,
-                [[maybe_unused]] int argc, [[maybe_unused]] char **argv)
+scm_init_report_modules (void)
 {
-    auto args = static_cast<run_report_args*>(data);
-
     scm_c_eval_string("(debug-set! stack 200000)");
     scm_c_use_module ("gnucash utilities");
     scm_c_use_module ("gnucash app-utils");
@@ -177,25 +179,12 @@ scm_run_report (void *data,
     // load_user_config();
     gnc_prefs_init ();
     qof_event_suspend ();
+}
 
-    auto datafile = args->file_to_load.c_str();
-    auto check_report_cmd = scm_c_eval_string ("gnc:cmdline-check-report");
-    auto get_report_cmd = scm_c_eval_string ("gnc:cmdline-get-report-id");
-    auto run_export_cmd = scm_c_eval_string ("gnc:cmdline-template-export");
-    /* We generally insist on using scm_from_utf8_string() throughout GnuCash
-     * because all GUI-sourced strings and all file-sourced strings are encoded
-     * that way. In this case, though, the input is coming from a shell window
-     * and Microsoft Windows shells are generally not capable of entering UTF8
-     * so it's necessary here to allow guile to read the locale and interpret
-     * the input in that encoding.
-     */
-    auto report = scm_from_locale_string (args->run_report.c_str());
-    auto type = !args->export_type.empty() ?
-                scm_from_locale_string (args->export_type.c_str()) : SCM_BOOL_F;
-
-    if (scm_is_false (scm_call_2 (check_report_cmd, report, type)))
-        scm_cleanup_and_exit_with_failure (nullptr);
-
+static QofSession*
+scm_load_report_session (const std::string& file_to_load)
+{
+    auto datafile = file_to_load.c_str();
     PINFO ("Loading datafile %s...\n", datafile);
 
     auto session = gnc_get_current_session ();
@@ -210,9 +199,18 @@ scm_run_report (void *data,
     if (qof_session_get_error (session) != ERR_BACKEND_NO_ERR)
         scm_cleanup_and_exit_with_failure (session);
 
-    char *output;
+    return session;
+}
+
+/* Render one report, or export it if type isn't #f, into output. Returns
+ * false after reporting the problem on stderr. */
+static bool
+scm_render_report (SCM report, SCM type, std::string& output)
+{
+    auto get_report_cmd = scm_c_eval_string ("gnc:cmdline-get-report-id");
+    auto run_export_cmd = scm_c_eval_string ("gnc:cmdline-template-export");
 
-    if (!args->export_type.empty())
+    if (scm_is_true (type))
     {
         SCM retval = scm_call_2 (run_export_cmd, report, type);
         SCM query_result = scm_c_eval_string ("gnc:html-document?");
@@ -223,7 +221,7 @@ scm_run_report (void *data,
         {
             std::cerr << _("This report must be upgraded to \
 return a document object with export-string or export-error.") << std::endl;
-            scm_cleanup_and_exit_with_failure (nullptr);
+            return false;
         }
 
         SCM export_string = scm_call_1 (get_export_string, retval);
@@ -231,27 +229,22 @@ return a document object with export-string or export-error.") << std::endl;
 
         if (scm_is_string (export_string))
         {
-            output = scm_to_utf8_string (export_string);
-            if (!args->output_file.empty())
-            {
-                write_report_file(output, args->output_file.c_str());
-            }
-            else
-            {
-                std::cout << output << std::endl;
-            }
+            auto str = scm_to_utf8_string (export_string);
+            output = str;
+            free (str);
         }
         else if (scm_is_string (export_error))
         {
             auto err = scm_to_utf8_string (export_error);
             std::cerr << err << std::endl;
-            scm_cleanup_and_exit_with_failure (nullptr);
+            free (err);
+            return false;
         }
         else
         {
             std::cerr << _("This report must be upgraded to \
 return a document object with export-string or export-error.") << std::endl;
-            scm_cleanup_and_exit_with_failure (nullptr);
+            return false;
         }
     }
     else
@@ -259,21 +252,55 @@ return a document object with export-string or export-error.") << std::endl;
         SCM id = scm_call_1(get_report_cmd, report);
 
         if (scm_is_false (id))
-            scm_cleanup_and_exit_with_failure (nullptr);
+            return false;
         char* html;
         gnc_run_report (scm_to_int(id), &html);
-        if (html && *html)
+        gnc_report_remove_by_id (scm_to_int(id));
+        if (html)
         {
-            if (!args->output_file.empty())
-            {
-                write_report_file(html, args->output_file.c_str());
-            }
-            else
-            {
-                std::cout << html << std::endl;
-            }
+            output = html;
+            g_free (html);
         }
     }
+    return true;
+}
+
+static void
+scm_run_report (void *data,
+                [[maybe_unused]] int argc, [[maybe_unused]] char **argv)
+{
+    auto args = static_cast<run_report_args*>(data);
+
+    scm_init_report_modules ();
+
+    auto check_report_cmd = scm_c_eval_string ("gnc:cmdline-check-report");
+    /* We generally insist on using scm_from_utf8_string() throughout GnuCash
+     * because all GUI-sourced strings and all file-sourced strings are encoded
+     * that way. In this case, though, the input is coming from a shell window
+     * and Microsoft Windows shells are generally not capable of entering UTF8
+     * so it's necessary here to allow guile to read the locale and interpret
+     * the input in that encoding.
+     */
+    auto report = scm_from_locale_string (args->run_report.c_str());
+    auto type = !args->export_type.empty() ?
+                scm_from_locale_string (args->export_type.c_str()) : SCM_BOOL_F;
+
+    if (scm_is_false (scm_call_2 (check_report_cmd, report, type)))
+        scm_cleanup_and_exit_with_failure (nullptr);
+
+    auto session = scm_load_report_session (args->file_to_load);
+
+    std::string output;
+    if (!scm_render_report (report, type, output))
+        scm_cleanup_and_exit_with_failure (nullptr);
+
+    if (!output.empty())
+    {
+        if (!args->output_file.empty())
+            write_report_file(output.c_str(), args->output_file.c_str());
+        else
+            std::cout << output << std::endl;
+    }
 
     qof_session_destroy (session);
 
@@ -282,6 +309,92 @@ return a document object with export-string or export-error.") << std::endl;
     return;
 }
 
+/* Each job is a report name or guid and the file to write it to. */
+using report_job = std::pair<std::string, std::string>;
+
+struct run_report_batch_args {
+    const std::string& file_to_load;
+    const std::vector<report_job>& jobs;
+    const std::string& export_type;
+};
+
+static void
+scm_run_report_batch (void *data,
+                      [[maybe_unused]] int argc, [[maybe_unused]] char **argv)
+{
+    auto args = static_cast<run_report_batch_args*>(data);
+    using clock = std::chrono::steady_clock;
+
+    scm_init_report_modules ();
+
+    auto check_report_cmd = scm_c_eval_string ("gnc:cmdline-check-report");
+    auto type = !args->export_type.empty() ?
+                scm_from_locale_string (args->export_type.c_str()) : SCM_BOOL_F;
+
+    /* Check every report before paying for the load. */
+    auto failures = 0;
+    for (const auto& job : args->jobs)
+    {
+        auto report = scm_from_locale_string (job.first.c_str());
+        if (scm_is_false (scm_call_2 (check_report_cmd, report, type)))
+            ++failures;
+    }
+    if (failures)
+        scm_cleanup_and_exit_with_failure (nullptr);
+
+    auto start = clock::now();
+    auto session = scm_load_report_session (args->file_to_load);
+    std::chrono::duration<double> elapsed = clock::now() - start;
+    std::cerr << bl::format (bl::translate ("Loaded {1} in {2} seconds"))
+        % args->file_to_load % elapsed.count() << "\n";
+
+    /* Reports run one at a time: Guile and the engine are not safe to
+     * share between threads. Writing a report out overlaps with rendering
+     * the next one. */
+    std::future<bool> writer;
+    for (const auto& job : args->jobs)
+    {
+        auto report = scm_from_locale_string (job.first.c_str());
+        std::string output;
+
+        start = clock::now();
+        auto ok = scm_render_report (report, type, output);
+        elapsed = clock::now() - start;
+
+        if (!ok)
+        {
+            ++failures;
+            std::cerr << bl::format (bl::translate ("Report {1} failed after {2} seconds"))
+                % job.first % elapsed.count() << "\n";
+            continue;
+        }
+        std::cerr << bl::format (bl::translate ("Report {1} ran in {2} seconds"))
+            % job.first % elapsed.count() << "\n";
+
+        if (writer.valid() && !writer.get())
+            ++failures;
+        writer = std::async (std::launch::async,
+                             [output = std::move (output), file = job.second]
+                             {
+                                 std::ofstream ofs{file};
+                                 if (ofs)
+                                     ofs << output << std::endl;
+                                 if (!ofs)
+                                     std::cerr << "Failed to write file "
+                                               << file << "\n";
+                                 return static_cast<bool>(ofs);
+                             });
+    }
+    if (writer.valid() && !writer.get())
+        ++failures;
+
+    qof_session_destroy (session);
+
+    qof_event_resume ();
+    gnc_shutdown (failures ? 1 : 0);
+    return;
+}
+
 
 struct show_report_args {
     const std::string& file_to_load;
@@ -362,6 +475,49 @@ Gnucash::run_report (const bo_str& file_to_load,
     return 0;
 }
 
+int
+Gnucash::run_report_batch (const bo_str& file_to_load,
+                           const bo_str& batch_file,
+                           const bo_str& export_type)
+{
+    std::vector<report_job> jobs;
+    std::ifstream jobs_file{*batch_file};
+    if (!jobs_file)
+    {
+        std::cerr << bl::format (bl::translate ("Failed to open batch file {1}"))
+            % *batch_file << "\n";
+        return 1;
+    }
+
+    /* One job per line: the report name or guid, a tab and the output
+     * file. Blank lines and lines starting with '#' are skipped. */
+    std::string line;
+    for (auto lineno = 1; std::getline (jobs_file, line); ++lineno)
+    {
+        if (!line.empty() && line.back() == '\r')
+            line.pop_back();
+        if (line.empty() || line[0] == '#')
+            continue;
+        auto tab = line.find ('\t');
+        if (tab == std::string::npos || tab == 0 || tab + 1 == line.size())
+        {
+            std::cerr << bl::format (bl::translate ("{1}:{2}: expected a report name, a tab and an output file"))
+                % *batch_file % lineno << "\n";
+            return 1;
+        }
+        jobs.emplace_back (line.substr (0, tab), line.substr (tab + 1));
+    }
+    if (jobs.empty())
+        return 0;
+
+    auto args = run_report_batch_args { file_to_load ? *file_to_load : empty_string,
+                                        jobs,
+                                        export_type ? *export_type : empty_string };
+    scm_boot_guile (0, nullptr, scm_run_report_batch, &args);
+
+    return 0;
+}
+
 int
 Gnucash::report_show (const bo_str& file_to_load,
                       const bo_str& show_report)
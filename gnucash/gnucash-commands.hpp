@@ -37,6 +37,9 @@ namespace Gnucash {
                     const bo_str& run_report,
                     const bo_str& export_type,
                     const bo_str& output_file);
+    int run_report_batch (const bo_str& file_to_load,
+                          const bo_str& batch_file,
+                          const bo_str& export_type);
     int report_list (void);
     int report_show (const bo_str& file_to_load,
                      const bo_str& run_report);
@@ -31,6 +31,7 @@
 #include "assistant-qif-import.h"
 #include "gnc-plugin-manager.h"
 #include "gnc-plugin-qif-import.h"
+#include "qif-import-native.h"
 
 static void gnc_plugin_qif_import_class_init (GncPluginQifImportClass *klass);
 static void gnc_plugin_qif_import_init (GncPluginQifImport *plugin);
@@ -132,6 +133,7 @@ gnc_plugin_qif_import_create_plugin (void)
     gnc_new_user_dialog_register_qif_assistant
         ((void (*)())gnc_file_qif_import);
 
+    gnc_qif_import_native_init ();
     scm_c_use_module("gnucash qif-import");
 
     /* Add to preferences under Online Banking */
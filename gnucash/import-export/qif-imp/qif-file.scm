@@ -77,7 +77,12 @@
           (delimiters (string #\cr #\nl))
           (file-stats #f)
           (file-size 0)
-          (bytes-read 0))
+          (bytes-read 0)
+          (native-open (qif-import:native-procedure 'qif-import:reader-open))
+          (native-next (qif-import:native-procedure 'qif-import:reader-next))
+          (native-fraction (qif-import:native-procedure 'qif-import:reader-fraction))
+          (native-close (qif-import:native-procedure 'qif-import:reader-close))
+          (native-reader #f))
 
       ;; This procedure simplifies handling of warnings.
       (define (mywarn . args)
@@ -116,6 +121,74 @@
 	      (unread-char c1)
 	      #f))))
 
+      ;; Read the next non-empty line into line, tag and value, returning
+      ;; #f at the end of the file.
+      (define (next-line!)
+        (if native-reader
+            (let ((record (native-next native-reader)))
+              (and record
+                   (begin
+                     (set! line-num (car record))
+                     (set! tag (cadr record))
+                     (set! value (caddr record))
+                     (set! line (string-append (string tag) value))
+                     (case (cadddr record)
+                       ((stripped)
+                        (mywarn
+                         (G_ "Some characters have been discarded.")
+                         " " (G_"Converted to: ") value))
+                       ((converted)
+                        (mywarn
+                         (G_ "Some characters have been converted according to your locale.")
+                         " " (G_"Converted to: ") value)))
+                     #t)))
+            (let loop ()
+              (set! line (read-delimited delimiters))
+              (set! line-num (+ 1 line-num))
+              (cond
+               ((eof-object? line) #f)
+               ((string=? line "") (loop))
+               (else
+                ;; Add to the bytes-read tally.
+                (set! bytes-read
+                      (+ bytes-read 1 (string-length line)))
+
+                ;; Pick the 1-char tag off from the remainder of the line.
+                (set! tag (string-ref line 0))
+                (set! value (substring line 1))
+
+                ;; If the line doesn't conform to UTF-8, try a default
+                ;; character set conversion based on the locale. If that
+                ;; fails, remove any invalid characters.
+                (if (not (gnc-utf8? value))
+                    (let ((converted-value (gnc-locale-to-utf8 value)))
+                      (if (or (string=? converted-value "")
+                              (not (gnc-utf8? converted-value)))
+                          (begin
+                            (set! value (gnc-utf8-strip-invalid-strdup value))
+                            (mywarn
+                             (G_ "Some characters have been discarded.")
+                             " " (G_"Converted to: ") value))
+                          (begin
+                            (mywarn
+                             (G_ "Some characters have been converted according to your locale.")
+                             " " (G_"Converted to: ") converted-value)
+                            (set! value converted-value)))))
+                #t)))))
+
+      ;; Call thunk with the file open for next-line!.
+      (define (call-with-lines thunk)
+        (if native-reader
+            (dynamic-wind
+              (lambda () #f)
+              thunk
+              (lambda () (native-close native-reader)))
+            (with-input-from-file path
+              (lambda ()
+                (strip-bom)
+                (thunk))
+              #:encoding "UTF-8")))
+
       (qif-file:set-path! self path)
       (if (not (access? path R_OK))
           ;; A UTF-8 encoded path won't succeed on some systems, such as
@@ -123,48 +196,19 @@
           (set! path (gnc-locale-from-utf8 path)))
       (set! file-stats (stat path))
       (set! file-size (stat:size file-stats))
+      (set! native-reader (and native-open (native-open path)))
 
 
       (if progress-dialog
           (gnc-progress-dialog-set-sub progress-dialog
                                        (string-append (G_ "Reading") " " path)))
 
-      (with-input-from-file path
+      (call-with-lines
         (lambda ()
-	  (strip-bom)
           ;; loop over lines
           (let line-loop ()
-            (set! line (read-delimited delimiters))
-            (set! line-num (+ 1 line-num))
-            (if (and (not (eof-object? line))
-                     (not (string=? line "")))
+            (if (next-line!)
                 (begin
-                  ;; Add to the bytes-read tally.
-                  (set! bytes-read
-                        (+ bytes-read 1 (string-length line)))
-
-                  ;; Pick the 1-char tag off from the remainder of the line.
-                  (set! tag (string-ref line 0))
-                  (set! value (substring line 1))
-
-                  ;; If the line doesn't conform to UTF-8, try a default
-                  ;; character set conversion based on the locale. If that
-                  ;; fails, remove any invalid characters.
-                  (if (not (gnc-utf8? value))
-                      (let ((converted-value (gnc-locale-to-utf8 value)))
-                        (if (or (string=? converted-value "")
-                                (not (gnc-utf8? converted-value)))
-                            (begin
-                              (set! value (gnc-utf8-strip-invalid-strdup value))
-                              (mywarn
-                               (G_ "Some characters have been discarded.")
-                               " " (G_"Converted to: ") value))
-                            (begin
-                              (mywarn
-                               (G_ "Some characters have been converted according to your locale.")
-                               " " (G_"Converted to: ") converted-value)
-                              (set! value converted-value)))))
-
                   (if (eq? tag #\!)
                       ;; The "!" tag has the highest precedence and is used
                       ;; to switch between different sections of the file.
@@ -502,21 +546,17 @@
                            (zero? (remainder line-num 32)))
                       (begin
                         (gnc-progress-dialog-set-value progress-dialog
-                                                       (/ bytes-read file-size))
+                                                       (if native-reader
+                                                           (native-fraction native-reader)
+                                                           (/ bytes-read file-size)))
                         (qif-import:check-pause progress-dialog)
                         (if qif-import:canceled
                             (begin
                               (set! private-retval #t)
                               (set! abort-read #t)))))
 
-                  ;; This is if we read a normal (non-null, non-eof) line...
                   (if (not abort-read)
-                      (line-loop)))
-
-                ;; ...and this is if we read a null or eof line.
-                (if (and (not abort-read)
-                         (not (eof-object? line)))
-                    (line-loop))))) #:encoding "UTF-8")
+                      (line-loop)))))))
 
       ;; Reverse the transaction list so xtns are in the same order that
       ;; they appeared in the file.  This is important in a few cases.
@@ -0,0 +1,1769 @@
+/********************************************************************\
+ * qif-import-native.c -- native helpers for the QIF importer       *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+\********************************************************************/
+
+#include <config.h>
+
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <libguile.h>
+#include <stdio.h>
+#include <string.h>
+
+/* For regex */
+#include <sys/types.h>
+#include <regex.h>
+
+#include "Account.h"
+#include "Transaction.h"
+#include "engine-helpers.h"
+#include "gnc-engine.h"
+#include "gnc-engine-guile.h"
+#include "gnc-glib-utils.h"
+#include "qif-import-native.h"
+#include "swig-runtime.h"
+
+static QofLogModule log_module = GNC_MOD_IMPORT;
+
+#define QIF_READ_CHUNK 65536
+#define QIF_WEEK_SECS (60 * 60 * 24 * 7)
+
+struct GncQifReader
+{
+    FILE *file;
+    gint64 file_size;
+    /* The file offset of the start of buffer. */
+    gint64 offset;
+    gchar buffer[QIF_READ_CHUNK];
+    gsize length;
+    gsize pos;
+    gboolean started;
+    GString *line;
+    guint line_num;
+};
+
+GncQifReader *
+gnc_qif_reader_new (const gchar *path)
+{
+    GncQifReader *reader;
+    GStatBuf stats;
+    FILE *file;
+
+    g_return_val_if_fail (path, NULL);
+
+    file = g_fopen (path, "rb");
+    if (!file)
+        return NULL;
+
+    reader = g_new0 (GncQifReader, 1);
+    reader->file = file;
+    if (g_stat (path, &stats) == 0)
+        reader->file_size = stats.st_size;
+    reader->line = g_string_sized_new (256);
+    return reader;
+}
+
+static gboolean
+reader_fill (GncQifReader *reader)
+{
+    if (!reader->file)
+        return FALSE;
+
+    reader->offset += reader->length;
+    reader->length = fread (reader->buffer, 1, QIF_READ_CHUNK, reader->file);
+    reader->pos = 0;
+    if (!reader->started)
+    {
+        reader->started = TRUE;
+        if (reader->length >= 3 && memcmp (reader->buffer, "\xEF\xBB\xBF", 3) == 0)
+            reader->pos = 3;
+    }
+    return reader->pos < reader->length;
+}
+
+/* Read up to the next carriage return or newline into reader->line,
+ * returning FALSE at the end of the file if nothing was left. */
+static gboolean
+reader_read_line (GncQifReader *reader)
+{
+    g_string_truncate (reader->line, 0);
+    while (TRUE)
+    {
+        const gchar *start, *end, *p;
+
+        if (reader->pos >= reader->length && !reader_fill (reader))
+            return reader->line->len > 0;
+
+        start = reader->buffer + reader->pos;
+        end = reader->buffer + reader->length;
+        for (p = start; p < end && *p != '\r' && *p != '\n'; p++)
+            ;
+        g_string_append_len (reader->line, start, p - start);
+        if (p < end)
+        {
+            reader->pos = p - reader->buffer + 1;
+            return TRUE;
+        }
+        reader->pos = reader->length;
+    }
+}
+
+/* If str isn't valid UTF-8, try converting it from the locale's
+ * character set and, failing that, drop the invalid characters. */
+static gchar *
+qif_to_utf8 (const gchar *str, gsize len, GncQifLineStatus *status)
+{
+    gchar *copy = g_strndup (str, len);
+    gchar *converted;
+
+    *status = GNC_QIF_LINE_OK;
+    if (gnc_utf8_validate (copy, -1, NULL))
+        return copy;
+
+    converted = g_locale_to_utf8 (copy, -1, NULL, NULL, NULL);
+    if (converted && *converted && gnc_utf8_validate (converted, -1, NULL))
+    {
+        *status = GNC_QIF_LINE_CONVERTED;
+        g_free (copy);
+        return converted;
+    }
+    g_free (converted);
+
+    *status = GNC_QIF_LINE_STRIPPED;
+    converted = gnc_utf8_strip_invalid_strdup (copy);
+    g_free (copy);
+    return converted;
+}
+
+gboolean
+gnc_qif_reader_next (GncQifReader *reader, gunichar *tag, gchar **value,
+                     GncQifLineStatus *status)
+{
+    const gchar *line;
+
+    g_return_val_if_fail (reader && tag && value && status, FALSE);
+
+    do
+    {
+        if (!reader_read_line (reader))
+            return FALSE;
+        reader->line_num++;
+    }
+    while (reader->line->len == 0);
+
+    line = reader->line->str;
+    if ((guchar)line[0] < 0x80)
+    {
+        *tag = line[0];
+        *value = qif_to_utf8 (line + 1, reader->line->len - 1, status);
+    }
+    else
+    {
+        /* The tag itself needs converting; QIF tags are ASCII, so this
+         * is a line the parser will ignore anyway. */
+        gchar *utf8 = qif_to_utf8 (line, reader->line->len, status);
+        if (*utf8)
+        {
+            *tag = g_utf8_get_char (utf8);
+            *value = g_strdup (g_utf8_next_char (utf8));
+        }
+        else
+        {
+            *tag = 0;
+            *value = g_strdup ("");
+        }
+        g_free (utf8);
+    }
+    return TRUE;
+}
+
+guint
+gnc_qif_reader_get_line_num (const GncQifReader *reader)
+{
+    g_return_val_if_fail (reader, 0);
+    return reader->line_num;
+}
+
+gdouble
+gnc_qif_reader_get_fraction (const GncQifReader *reader)
+{
+    g_return_val_if_fail (reader, 0);
+    if (reader->file_size <= 0)
+        return 0;
+    return (gdouble)(reader->offset + reader->pos) / reader->file_size;
+}
+
+void
+gnc_qif_reader_close (GncQifReader *reader)
+{
+    g_return_if_fail (reader);
+    if (reader->file)
+        fclose (reader->file);
+    reader->file = NULL;
+    reader->length = reader->pos = 0;
+}
+
+void
+gnc_qif_reader_free (GncQifReader *reader)
+{
+    if (!reader)
+        return;
+    gnc_qif_reader_close (reader);
+    g_string_free (reader->line, TRUE);
+    g_free (reader);
+}
+
+/********************************************************************\
+ * Field parsing
+\********************************************************************/
+
+/* The expressions of qif-parse.scm. Guile's regexp-exec uses the same
+ * POSIX matcher, so fields are split here as they are there. */
+static regex_t category_regex;
+static regex_t date_regex;
+static regex_t date_mdy_regex;
+static regex_t date_ymd_regex;
+static regex_t decimal_radix_regex;
+static regex_t comma_radix_regex;
+static regex_t integer_regex;
+
+static gboolean regex_compiled = FALSE;
+
+static void
+compile_regex (void)
+{
+    int flags = REG_EXTENDED;
+
+    regcomp (&category_regex,
+             "^ *(\\[)?([^]/|]*)(]?)(/?)([^|]*)(\\|(\\[)?([^]/]*)(]?)(/?)(.*))? *$", flags);
+
+    regcomp (&date_regex,
+             "^ *([0-9]+) *[-/.'] *([0-9]+) *[-/.'] *([0-9]+).*$|^ *([0-9][0-9][0-9][0-9][0-9][0-9][0-9][0-9]).*$", flags);
+    regcomp (&date_mdy_regex, "([0-9][0-9])([0-9][0-9])([0-9][0-9][0-9][0-9])", flags);
+    regcomp (&date_ymd_regex, "([0-9][0-9][0-9][0-9])([0-9][0-9])([0-9][0-9])", flags);
+
+    regcomp (&decimal_radix_regex,
+             "^ *[$]?[+-]?[$]?[0-9]+[+-]?$|^ *[$]?[+-]?[$]?[0-9]?[0-9]?[0-9]?([,'][0-9][0-9][0-9])*(\\.[0-9]*)?[+-]? *$|^ *[$]?[+-]?[$]?[0-9]+\\.[0-9]*[+-]? *$", flags);
+    regcomp (&comma_radix_regex,
+             "^ *[$]?[+-]?[$]?[0-9]+[+-]?$|^ *[$]?[+-]?[$]?[0-9]?[0-9]?[0-9]?([\\.'][0-9][0-9][0-9])*(,[0-9]*)?[+-]? *$|^ *[$]?[+-]?[$]?[0-9]+,[0-9]*[+-]? *$", flags);
+    regcomp (&integer_regex, "^[$]?[+-]?[$]?[0-9]+[+-]? *$", flags);
+
+    regex_compiled = TRUE;
+}
+
+/* The value of len digits, saturating at G_MAXINT. */
+static gint
+digits_value (const gchar *str, gint len)
+{
+    gint64 value = 0;
+
+    while (len-- > 0 && value < G_MAXINT)
+        value = value * 10 + (*str++ - '0');
+    return MIN (value, G_MAXINT);
+}
+
+static gint
+fix_year_value (gint value, gint threshold)
+{
+    /* Two digit years before the threshold are after 2000. */
+    if (value < threshold)
+        return 2000 + value;
+    /* A common bug prints 2000 as 19100. */
+    if (value > 19000)
+        return 1900 + (value - 19000);
+    /* Years since 1900, as struct tm has them. */
+    if (value < 1902)
+        return 1900 + value;
+    return value;
+}
+
+gboolean
+gnc_qif_fix_year (const gchar *str, gint threshold, gint *year)
+{
+    const gchar *digits;
+    gint64 value = 0;
+    gboolean negative = FALSE;
+
+    g_return_val_if_fail (str && year, FALSE);
+
+    if (*str == '\'')
+    {
+        PWARN ("weird QIF year [%s]", str);
+        if (!str[1])
+            return FALSE;
+        str += 2;
+    }
+
+    /* Read an integer the way Scheme's read would. */
+    while (g_ascii_isspace (*str))
+        str++;
+    if (*str == '-' || *str == '+')
+        negative = (*str++ == '-');
+    for (digits = str; g_ascii_isdigit (*str); str++)
+        if (value < G_MAXINT)
+            value = value * 10 + (*str - '0');
+    if (str == digits ||
+        (*str && !g_ascii_isspace (*str) && !strchr ("()\";", *str)))
+    {
+        PWARN ("what is this QIF year? [%s]", digits);
+        return FALSE;
+    }
+
+    value = MIN (value, G_MAXINT);
+    *year = fix_year_value (negative ? -value : value, threshold);
+    return TRUE;
+}
+
+/* The three parts of a date and the number of digits in each. */
+typedef struct
+{
+    gint value[3];
+    gint len[3];
+} DateParts;
+
+/* The parts holding the day, month and year, for each GncQifDateFormat. */
+static const gint date_part_order[][3] =
+{
+    { 0, 1, 2 },                /* GNC_QIF_DATE_D_M_Y */
+    { 1, 0, 2 },                /* GNC_QIF_DATE_M_D_Y */
+    { 2, 1, 0 },                /* GNC_QIF_DATE_Y_M_D */
+    { 1, 2, 0 },                /* GNC_QIF_DATE_Y_D_M */
+};
+
+static void
+date_parts_init (DateParts *parts, const gchar *str, const regmatch_t *match)
+{
+    gint i;
+
+    for (i = 0; i < 3; i++)
+    {
+        parts->len[i] = match[i + 1].rm_eo - match[i + 1].rm_so;
+        parts->value[i] = digits_value (str + match[i + 1].rm_so, parts->len[i]);
+    }
+}
+
+/* Split the string of eight digits at match into parts, as YYYYxxxx if
+ * year_first is set and as xxxxYYYY otherwise. */
+static void
+date_parts_init_digits (DateParts *parts, const gchar *str,
+                        const regmatch_t *match, gboolean year_first)
+{
+    gchar digits[9];
+    regmatch_t split[4];
+
+    memcpy (digits, str + match->rm_so, 8);
+    digits[8] = '\0';
+    regexec (year_first ? &date_ymd_regex : &date_mdy_regex, digits, 4, split, 0);
+    date_parts_init (parts, digits, split);
+}
+
+static gboolean
+date_parts_valid (const DateParts *parts, GncQifDateFormat format)
+{
+    const gint *order = date_part_order[format];
+    gint day = parts->value[order[0]];
+    gint month = parts->value[order[1]];
+
+    if (day < 1 || day > 31 || month < 1 || month > 12)
+        return FALSE;
+    /* A four digit year must be a recent one. */
+    return parts->len[order[2]] != 4 || parts->value[order[2]] > 1930;
+}
+
+static guint
+date_parts_check (const DateParts *parts, const GncQifDateFormat *formats,
+                  guint n_formats, GncQifDateFormat *result)
+{
+    guint i, n = 0;
+
+    for (i = 0; i < n_formats; i++)
+        if (date_parts_valid (parts, formats[i]))
+            result[n++] = formats[i];
+    return n;
+}
+
+static gboolean
+has_date_format (const GncQifDateFormat *formats, guint n_formats,
+                 GncQifDateFormat a, GncQifDateFormat b)
+{
+    guint i;
+
+    for (i = 0; i < n_formats; i++)
+        if (formats[i] == a || formats[i] == b)
+            return TRUE;
+    return FALSE;
+}
+
+gint
+gnc_qif_check_date_format (const gchar *str, const GncQifDateFormat *formats,
+                           guint n_formats, GncQifDateFormat *result)
+{
+    regmatch_t match[5];
+    DateParts parts;
+    guint n = 0;
+
+    g_return_val_if_fail (formats || !n_formats, -1);
+    g_return_val_if_fail (result || !n_formats, -1);
+
+    if (!str || !*str)
+        return -1;
+    if (!regex_compiled)
+        compile_regex ();
+    if (regexec (&date_regex, str, 5, match, 0) != 0)
+        return -1;
+
+    if (match[1].rm_so != -1)
+    {
+        date_parts_init (&parts, str, match);
+        return date_parts_check (&parts, formats, n_formats, result);
+    }
+
+    /* Eight digits: we don't know which way round they are, so try
+     * both and let the year check sort them out. */
+    if (has_date_format (formats, n_formats,
+                         GNC_QIF_DATE_Y_D_M, GNC_QIF_DATE_Y_M_D))
+    {
+        date_parts_init_digits (&parts, str, &match[4], TRUE);
+        n += date_parts_check (&parts, formats, n_formats, result);
+    }
+    if (has_date_format (formats, n_formats,
+                         GNC_QIF_DATE_D_M_Y, GNC_QIF_DATE_M_D_Y))
+    {
+        date_parts_init_digits (&parts, str, &match[4], FALSE);
+        n += date_parts_check (&parts, formats, n_formats, result + n);
+    }
+    return n;
+}
+
+gboolean
+gnc_qif_parse_date (const gchar *str, GncQifDateFormat format,
+                    gint *day, gint *month, gint *year)
+{
+    regmatch_t match[5];
+    DateParts parts;
+    const gint *order = date_part_order[format];
+    gint d, m;
+
+    g_return_val_if_fail (str && day && month && year, FALSE);
+    g_return_val_if_fail (format <= GNC_QIF_DATE_Y_D_M, FALSE);
+
+    if (!regex_compiled)
+        compile_regex ();
+    if (regexec (&date_regex, str, 5, match, 0) != 0)
+    {
+        PWARN ("can't interpret date [%s]", str);
+        return FALSE;
+    }
+
+    if (match[1].rm_so != -1)
+        date_parts_init (&parts, str, match);
+    else
+        date_parts_init_digits (&parts, str, &match[4],
+                                format == GNC_QIF_DATE_Y_M_D ||
+                                format == GNC_QIF_DATE_Y_D_M);
+
+    d = parts.value[order[0]];
+    m = parts.value[order[1]];
+    if (d < 1 || d > 31 || m < 1 || m > 12)
+    {
+        PWARN ("format is %d but date is [%s]", format, str);
+        return FALSE;
+    }
+    *day = d;
+    *month = m;
+    *year = fix_year_value (parts.value[order[2]], 50);
+    return TRUE;
+}
+
+static regex_t *
+number_regex (GncQifNumberFormat format)
+{
+    switch (format)
+    {
+    case GNC_QIF_NUMBER_DECIMAL:
+        return &decimal_radix_regex;
+    case GNC_QIF_NUMBER_COMMA:
+        return &comma_radix_regex;
+    case GNC_QIF_NUMBER_INTEGER:
+        return &integer_regex;
+    }
+    return NULL;
+}
+
+guint
+gnc_qif_check_number_format (const gchar *str, GncQifNumberFormat *formats,
+                             guint n_formats)
+{
+    guint i, n = 0;
+
+    g_return_val_if_fail (str, 0);
+    g_return_val_if_fail (formats || !n_formats, 0);
+
+    if (!regex_compiled)
+        compile_regex ();
+    for (i = 0; i < n_formats; i++)
+    {
+        regex_t *regex = number_regex (formats[i]);
+        if (regex && regexec (regex, str, 0, NULL, 0) == 0)
+            formats[n++] = formats[i];
+    }
+    return n;
+}
+
+gboolean
+gnc_qif_parse_number (const gchar *str, GncQifNumberFormat format,
+                      gnc_numeric *number)
+{
+    gchar radix = format == GNC_QIF_NUMBER_COMMA ? ',' : '.';
+    gboolean negative = FALSE, seen_radix = FALSE;
+    gint64 value = 0, denom = 1;
+    guint digits = 0;
+
+    g_return_val_if_fail (str && number, FALSE);
+
+    for (; *str; str++)
+    {
+        if (*str == '-')
+            negative = TRUE;
+        else if (strchr ("$'+", *str) ||
+                 (format == GNC_QIF_NUMBER_DECIMAL && *str == ',') ||
+                 (format == GNC_QIF_NUMBER_COMMA && *str == '.'))
+            continue;
+        else if (*str == radix && !seen_radix)
+            seen_radix = TRUE;
+        /* Eighteen digits always fit a gint64. */
+        else if (g_ascii_isdigit (*str) && digits < 18)
+        {
+            value = value * 10 + (*str - '0');
+            if (seen_radix)
+                denom *= 10;
+            digits++;
+        }
+        else
+            return FALSE;
+    }
+    if (!digits)
+        return FALSE;
+
+    *number = gnc_numeric_create (negative ? -value : value, denom);
+    return TRUE;
+}
+
+static gchar *
+match_strdup (const gchar *str, const regmatch_t *match)
+{
+    if (match->rm_so == -1)
+        return NULL;
+    return g_strndup (str + match->rm_so, match->rm_eo - match->rm_so);
+}
+
+gboolean
+gnc_qif_parse_category (const gchar *str, GncQifCategory *category)
+{
+    regmatch_t match[12];
+
+    g_return_val_if_fail (str && category, FALSE);
+
+    if (!regex_compiled)
+        compile_regex ();
+    if (regexec (&category_regex, str, 12, match, 0) != 0)
+    {
+        PWARN ("can't parse [%s]", str);
+        return FALSE;
+    }
+
+    /* 1 and 3 are the brackets around the category, 4 the slash before
+     * the class, 6 the whole miscx part and 7, 9 and 10 its brackets
+     * and slash. */
+    category->name = match_strdup (str, &match[2]);
+    category->is_account = match[1].rm_so != -1 && match[3].rm_so != -1;
+    category->class_name = match[4].rm_so != -1 ?
+                           match_strdup (str, &match[5]) : NULL;
+    category->miscx_name = match[6].rm_so != -1 ?
+                           match_strdup (str, &match[8]) : NULL;
+    category->miscx_is_account = match[7].rm_so != -1 &&
+                                 match[9].rm_so != -1;
+    category->miscx_class = match[10].rm_so != -1 ?
+                            match_strdup (str, &match[11]) : NULL;
+    return TRUE;
+}
+
+void
+gnc_qif_category_clear (GncQifCategory *category)
+{
+    g_return_if_fail (category);
+    g_free (category->name);
+    g_free (category->class_name);
+    g_free (category->miscx_name);
+    g_free (category->miscx_class);
+    memset (category, 0, sizeof (GncQifCategory));
+}
+
+/********************************************************************\
+ * Conversion
+\********************************************************************/
+
+static const gchar *
+map_lookup (const GncQifConverter *converter, GncQifMap map,
+            const gchar *qif_name)
+{
+    if (!qif_name)
+        return NULL;
+    return converter->map_lookup (map, qif_name, converter->user_data);
+}
+
+/* Investment transactions name accounts and categories alike. */
+static const gchar *
+map_lookup_account (const GncQifConverter *converter, const gchar *qif_name)
+{
+    const gchar *gnc_name = map_lookup (converter, GNC_QIF_MAP_ACCOUNT,
+                                        qif_name);
+    if (!gnc_name)
+        gnc_name = map_lookup (converter, GNC_QIF_MAP_CATEGORY, qif_name);
+    return gnc_name;
+}
+
+static Account *
+account_lookup (const GncQifConverter *converter, const gchar *gnc_name)
+{
+    return converter->account_lookup (gnc_name, converter->user_data);
+}
+
+static const gchar *
+non_empty (const gchar *str)
+{
+    return str && *str ? str : NULL;
+}
+
+/* The account a bank transaction split goes to. Failing a category,
+ * the payee or memo of a simple transaction, or the memo of a split
+ * one, may be mapped. */
+static const gchar *
+far_account_name (const GncQifConverter *converter, const GncQifXtnInfo *xtn,
+                  const GncQifSplitInfo *split, const gchar *memo,
+                  const gchar *split_memo)
+{
+    const gchar *gnc_name = NULL;
+
+    if (*split->category)
+        gnc_name = map_lookup (converter,
+                               split->category_is_account ?
+                               GNC_QIF_MAP_ACCOUNT : GNC_QIF_MAP_CATEGORY,
+                               split->category);
+    else if (xtn->n_splits == 1)
+    {
+        gnc_name = map_lookup (converter, GNC_QIF_MAP_MEMO,
+                               non_empty (xtn->payee));
+        if (!gnc_name)
+            gnc_name = map_lookup (converter, GNC_QIF_MAP_MEMO,
+                                   non_empty (memo));
+    }
+    else
+        gnc_name = map_lookup (converter, GNC_QIF_MAP_MEMO,
+                               non_empty (split_memo));
+
+    return gnc_name ? gnc_name : converter->unspec_name;
+}
+
+static char
+cleared_flag (GncQifCleared cleared, char otherwise)
+{
+    switch (cleared)
+    {
+    case GNC_QIF_CLEARED:
+        return CREC;
+    case GNC_QIF_RECONCILED:
+        return YREC;
+    default:
+        return otherwise;
+    }
+}
+
+/* The accounts a transaction's splits go to, found before it is
+ * changed at all. */
+typedef struct
+{
+    /* NULL only for an investment transaction that names no accounts,
+     * which gets no splits. */
+    const gchar *near_name;
+    Account *near_account;
+    /* One for each split of a bank transaction, or for the first split
+     * of an investment one. */
+    Account **far_accounts;
+    Account *commission_account;
+} XtnAccounts;
+
+/* The other end of each unmarked split is its category's account, and
+ * the near split is in the account the transaction was read from. */
+static gboolean
+bank_xtn_accounts (const GncQifXtnInfo *xtn, const GncQifConverter *converter,
+                   const gchar *memo, XtnAccounts *accounts)
+{
+    guint i;
+
+    accounts->near_name = map_lookup (converter, GNC_QIF_MAP_ACCOUNT,
+                                      xtn->from_acct);
+    if (!accounts->near_name)
+    {
+        PWARN ("no account is mapped for [%s]",
+               xtn->from_acct ? xtn->from_acct : "");
+        return FALSE;
+    }
+    accounts->near_account = account_lookup (converter, accounts->near_name);
+
+    accounts->far_accounts = g_new0 (Account *, xtn->n_splits);
+    for (i = 0; i < xtn->n_splits; i++)
+    {
+        const GncQifSplitInfo *split = &xtn->splits[i];
+        const gchar *split_memo = xtn->has_default_split ? split->memo : NULL;
+
+        if (!split->marked)
+            accounts->far_accounts[i] =
+                account_lookup (converter,
+                                far_account_name (converter, xtn, split, memo,
+                                                  split_memo));
+    }
+    return TRUE;
+}
+
+/* The near split takes the total of the far ones. */
+static void
+bank_xtn_splits (const GncQifXtnInfo *xtn, const XtnAccounts *accounts,
+                 Transaction *trans, Split *near_split)
+{
+    QofBook *book = xaccTransGetBook (trans);
+    gnc_numeric total = gnc_numeric_zero ();
+    guint i;
+
+    for (i = 0; i < xtn->n_splits; i++)
+    {
+        const GncQifSplitInfo *split = &xtn->splits[i];
+        gnc_numeric amount = split->has_amount ? split->amount :
+                             gnc_numeric_zero ();
+        Split *far_split;
+
+        if (split->marked)
+            continue;
+
+        far_split = xaccMallocSplit (book);
+        total = gnc_numeric_add (total, amount, GNC_DENOM_AUTO,
+                                 GNC_HOW_DENOM_LCD);
+        xaccSplitSetValue (far_split, gnc_numeric_neg (amount));
+        xaccSplitSetAmount (far_split, gnc_numeric_neg (amount));
+        if (xtn->has_default_split && split->memo)
+            xaccSplitSetMemo (far_split, split->memo);
+        if (split->matching_cleared != GNC_QIF_UNCLEARED)
+            xaccSplitSetReconcile (far_split,
+                                   cleared_flag (split->matching_cleared, NREC));
+        xaccSplitSetAccount (far_split, accounts->far_accounts[i]);
+        xaccSplitSetParent (far_split, trans);
+    }
+
+    /* The Scheme converter's sum comes back from Guile reduced, and the
+     * amount keeps its fraction until the account is set. */
+    total = gnc_numeric_reduce (total);
+    xaccSplitSetValue (near_split, total);
+    xaccSplitSetAmount (near_split, total);
+    xaccSplitSetParent (near_split, trans);
+    xaccSplitSetAccount (near_split, accounts->near_account);
+}
+
+/* Whether the amount of shares goes up, down or neither, and whether
+ * the near split takes the amount of the transaction or its negation. */
+typedef enum
+{
+    STOCK_SHARES_IN,
+    STOCK_SHARES_OUT,
+    STOCK_CASH_IN,
+    STOCK_CASH_OUT,
+    STOCK_SPLIT,
+    STOCK_NOTHING,
+} StockEffect;
+
+static StockEffect
+stock_effect (GncQifAction action)
+{
+    switch (action)
+    {
+    case GNC_QIF_ACTION_BUY:
+    case GNC_QIF_ACTION_BUYX:
+    case GNC_QIF_ACTION_REINVINT:
+    case GNC_QIF_ACTION_REINVDIV:
+    case GNC_QIF_ACTION_REINVSG:
+    case GNC_QIF_ACTION_REINVSH:
+    case GNC_QIF_ACTION_REINVMD:
+    case GNC_QIF_ACTION_REINVLG:
+    case GNC_QIF_ACTION_SHRSIN:
+        return STOCK_SHARES_IN;
+    case GNC_QIF_ACTION_SELL:
+    case GNC_QIF_ACTION_SELLX:
+    case GNC_QIF_ACTION_SHRSOUT:
+        return STOCK_SHARES_OUT;
+    case GNC_QIF_ACTION_CGSHORT:
+    case GNC_QIF_ACTION_CGSHORTX:
+    case GNC_QIF_ACTION_CGMID:
+    case GNC_QIF_ACTION_CGMIDX:
+    case GNC_QIF_ACTION_CGLONG:
+    case GNC_QIF_ACTION_CGLONGX:
+    case GNC_QIF_ACTION_INTINC:
+    case GNC_QIF_ACTION_INTINCX:
+    case GNC_QIF_ACTION_DIV:
+    case GNC_QIF_ACTION_DIVX:
+    case GNC_QIF_ACTION_MISCINC:
+    case GNC_QIF_ACTION_MISCINCX:
+    case GNC_QIF_ACTION_XIN:
+    case GNC_QIF_ACTION_RTRNCAP:
+    case GNC_QIF_ACTION_RTRNCAPX:
+        return STOCK_CASH_IN;
+    case GNC_QIF_ACTION_XOUT:
+    case GNC_QIF_ACTION_MISCEXP:
+    case GNC_QIF_ACTION_MISCEXPX:
+    case GNC_QIF_ACTION_MARGINT:
+    case GNC_QIF_ACTION_MARGINTX:
+        return STOCK_CASH_OUT;
+    case GNC_QIF_ACTION_STKSPLIT:
+        return STOCK_SPLIT;
+    default:
+        return STOCK_NOTHING;
+    }
+}
+
+/* The near account of an investment transaction depends on its action:
+ * it is generally the security's account, but can also be an income
+ * account. */
+static gboolean
+stock_xtn_accounts (const GncQifXtnInfo *xtn, const GncQifConverter *converter,
+                    XtnAccounts *accounts)
+{
+    const GncQifSplitInfo *split = &xtn->splits[0];
+    StockEffect effect = stock_effect (xtn->action);
+
+    if (effect != STOCK_SPLIT && effect != STOCK_NOTHING && !split->has_amount)
+    {
+        PWARN ("action %d needs an amount", xtn->action);
+        return FALSE;
+    }
+
+    if (xtn->near_acct && xtn->far_acct)
+    {
+        const gchar *far_name = NULL;
+
+        /* With no far account named, try a payee or memo mapping. */
+        if (!*xtn->far_acct)
+        {
+            far_name = map_lookup (converter, GNC_QIF_MAP_MEMO, xtn->payee);
+            if (!far_name)
+                far_name = map_lookup (converter, GNC_QIF_MAP_MEMO, split->memo);
+        }
+        if (!far_name)
+            far_name = map_lookup_account (converter, xtn->far_acct);
+
+        accounts->near_name = map_lookup_account (converter, xtn->near_acct);
+        if (!accounts->near_name || !far_name)
+        {
+            PWARN ("no account is mapped for [%s] or [%s]",
+                   xtn->near_acct, xtn->far_acct);
+            return FALSE;
+        }
+        accounts->near_account = account_lookup (converter,
+                                                 accounts->near_name);
+        accounts->far_accounts = g_new (Account *, 1);
+        accounts->far_accounts[0] = account_lookup (converter, far_name);
+    }
+
+    if (xtn->commission_acct)
+    {
+        const gchar *commission_name =
+            map_lookup_account (converter, xtn->commission_acct);
+        if (commission_name)
+            accounts->commission_account = account_lookup (converter,
+                                                           commission_name);
+    }
+    return TRUE;
+}
+
+/* Are shares going in or out, and are the amounts currency or shares? */
+static void
+stock_xtn_splits (const GncQifXtnInfo *xtn, const XtnAccounts *accounts,
+                  Transaction *trans, Split *near_split)
+{
+    QofBook *book = xaccTransGetBook (trans);
+    const GncQifSplitInfo *split = &xtn->splits[0];
+    StockEffect effect = stock_effect (xtn->action);
+    gnc_numeric num_shares = xtn->has_num_shares ? xtn->num_shares :
+                             gnc_numeric_zero ();
+    gnc_numeric xtn_amount = split->amount;
+    gnc_numeric split_amount;
+    Split *far_split = xaccMallocSplit (book);
+
+    if (xtn->n_splits > 1)
+        PWARN ("splits in stock transaction!");
+
+    /* The value of the shares, without the commission. */
+    if (split->has_amount && xtn->has_commission)
+        split_amount = effect == STOCK_SHARES_OUT ?
+                       gnc_numeric_add (xtn_amount, xtn->commission,
+                                        GNC_DENOM_AUTO, GNC_HOW_DENOM_LCD) :
+                       gnc_numeric_sub (xtn_amount, xtn->commission,
+                                        GNC_DENOM_AUTO, GNC_HOW_DENOM_LCD);
+    else if (split->has_amount)
+        split_amount = xtn_amount;
+    else if (xtn->has_share_price)
+        /* Use the given share price, despite possible rounding. */
+        split_amount = gnc_numeric_mul (num_shares, xtn->share_price,
+                                        GNC_DENOM_AUTO, GNC_HOW_DENOM_REDUCE);
+    else
+        split_amount = gnc_numeric_zero ();
+
+    switch (effect)
+    {
+    case STOCK_SHARES_IN:
+        xaccSplitSetAmount (near_split, num_shares);
+        xaccSplitSetValue (near_split, split_amount);
+        xaccSplitSetValue (far_split, gnc_numeric_neg (xtn_amount));
+        xaccSplitSetAmount (far_split, gnc_numeric_neg (xtn_amount));
+        break;
+    case STOCK_SHARES_OUT:
+        xaccSplitSetAmount (near_split, gnc_numeric_neg (num_shares));
+        xaccSplitSetValue (near_split, gnc_numeric_neg (split_amount));
+        xaccSplitSetValue (far_split, xtn_amount);
+        xaccSplitSetAmount (far_split, xtn_amount);
+        break;
+    case STOCK_CASH_IN:
+        xaccSplitSetValue (near_split, xtn_amount);
+        xaccSplitSetAmount (near_split, xtn_amount);
+        xaccSplitSetValue (far_split, gnc_numeric_neg (xtn_amount));
+        xaccSplitSetAmount (far_split, gnc_numeric_neg (xtn_amount));
+        break;
+    case STOCK_CASH_OUT:
+        xaccSplitSetValue (near_split, gnc_numeric_neg (xtn_amount));
+        xaccSplitSetAmount (near_split, gnc_numeric_neg (xtn_amount));
+        xaccSplitSetValue (far_split, xtn_amount);
+        xaccSplitSetAmount (far_split, xtn_amount);
+        break;
+    case STOCK_SPLIT:
+    {
+        /* QIF gives only the split ratio, so the number of shares comes
+         * from the security account, reduced as Guile would give it. */
+        gnc_numeric ratio = gnc_numeric_div (num_shares,
+                                             gnc_numeric_create (10, 1),
+                                             GNC_DENOM_AUTO,
+                                             GNC_HOW_DENOM_REDUCE);
+        gnc_numeric in_shares =
+            gnc_numeric_reduce (xaccAccountGetBalance (accounts->near_account));
+        gnc_numeric out_shares = gnc_numeric_mul (in_shares, ratio,
+                                                  GNC_DENOM_AUTO,
+                                                  GNC_HOW_DENOM_REDUCE);
+        xaccSplitSetAmount (near_split, out_shares);
+        xaccSplitSetAmount (far_split, gnc_numeric_neg (in_shares));
+        xaccSplitSetValue (near_split, gnc_numeric_neg (split_amount));
+        xaccSplitSetValue (far_split, split_amount);
+        break;
+    }
+    case STOCK_NOTHING:
+        break;
+    }
+
+    if (split->matching_cleared != GNC_QIF_UNCLEARED)
+        xaccSplitSetReconcile (far_split,
+                               cleared_flag (split->matching_cleared, NREC));
+
+    xaccSplitSetParent (near_split, trans);
+    xaccSplitSetAccount (near_split, accounts->near_account);
+    xaccSplitSetParent (far_split, trans);
+    xaccSplitSetAccount (far_split, accounts->far_accounts[0]);
+
+    if (xtn->has_commission && accounts->commission_account)
+    {
+        Split *commission_split = xaccMallocSplit (book);
+        xaccSplitSetValue (commission_split, xtn->commission);
+        xaccSplitSetAmount (commission_split, xtn->commission);
+        xaccSplitSetParent (commission_split, trans);
+        xaccSplitSetAccount (commission_split, accounts->commission_account);
+    }
+}
+
+gboolean
+gnc_qif_xtn_to_gnc_xtn (const GncQifXtnInfo *xtn,
+                        const GncQifConverter *converter, Transaction *trans)
+{
+    XtnAccounts accounts = { NULL, NULL, NULL, NULL };
+    Split *near_split = NULL;
+    const gchar *memo;
+
+    g_return_val_if_fail (xtn && converter && trans, FALSE);
+    g_return_val_if_fail (xtn->n_splits > 0, FALSE);
+
+    if (!xtn->day)
+    {
+        PWARN ("missing transaction date");
+        return FALSE;
+    }
+
+    /* The transaction memo is in the default split if there is one, and
+     * in the first split otherwise. */
+    memo = xtn->has_default_split ? xtn->default_memo : xtn->splits[0].memo;
+
+    if (!(xtn->security ?
+          stock_xtn_accounts (xtn, converter, &accounts) :
+          bank_xtn_accounts (xtn, converter, memo, &accounts)))
+    {
+        g_free (accounts.far_accounts);
+        return FALSE;
+    }
+
+    if (accounts.near_name)
+        near_split = xaccMallocSplit (xaccTransGetBook (trans));
+
+    xaccTransSetDate (trans, xtn->day, xtn->month, xtn->year);
+    if (xtn->payee)
+        xaccTransSetDescription (trans, xtn->payee);
+    if (xtn->number)
+        gnc_set_num_action (trans, near_split, xtn->number, NULL);
+
+    if (memo)
+    {
+        if (!xtn->payee || !*xtn->payee)
+            xaccTransSetDescription (trans, memo);
+        else
+            /* The memo goes to the transaction notes rather than the
+             * splits; see bug 495219. */
+            xaccTransSetNotes (trans, memo);
+    }
+
+    if (near_split)
+    {
+        xaccSplitSetReconcile (near_split,
+                               cleared_flag (xtn->cleared,
+                                             converter->status_pref));
+        if (xtn->security)
+            stock_xtn_splits (xtn, &accounts, trans, near_split);
+        else
+            bank_xtn_splits (xtn, &accounts, trans, near_split);
+    }
+    g_free (accounts.far_accounts);
+
+    /* QIF marks a void transaction by starting the payee with "**VOID**". */
+    if (xtn->payee && g_str_has_prefix (xtn->payee, "**VOID**"))
+        xaccTransVoid (trans, "QIF");
+    return TRUE;
+}
+
+/********************************************************************\
+ * Duplicate detection
+\********************************************************************/
+
+/* The old splits are bucketed by account name and value, so each new
+ * split only has its dates compared with the splits that could match
+ * it. */
+typedef struct
+{
+    const gchar *account_name;
+    gnc_numeric value;
+} DuplicateKey;
+
+static guint
+duplicate_key_hash (gconstpointer key)
+{
+    const DuplicateKey *dkey = key;
+    return g_str_hash (dkey->account_name) ^
+           g_int64_hash (&dkey->value.num) ^
+           (g_int64_hash (&dkey->value.denom) * 31);
+}
+
+static gboolean
+duplicate_key_equal (gconstpointer a, gconstpointer b)
+{
+    const DuplicateKey *ka = a, *kb = b;
+    return ka->value.num == kb->value.num &&
+           ka->value.denom == kb->value.denom &&
+           g_strcmp0 (ka->account_name, kb->account_name) == 0;
+}
+
+/* Fill key for split. Values are reduced so that equal amounts with
+ * different denominators share a bucket. */
+static void
+duplicate_key_init (DuplicateKey *key, Split *split, GHashTable *names)
+{
+    Account *account = xaccSplitGetAccount (split);
+    gchar *name = g_hash_table_lookup (names, account);
+
+    if (!name)
+    {
+        name = gnc_account_get_full_name (account);
+        g_hash_table_insert (names, account, name);
+    }
+    key->account_name = name;
+    key->value = gnc_numeric_reduce (xaccSplitGetValue (split));
+}
+
+gboolean
+gnc_qif_find_duplicates (GList *new_splits, GList *old_splits,
+                         GncQifProgressFunc progress, gpointer user_data,
+                         GList **duplicates)
+{
+    GHashTable *names = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+                                               NULL, g_free);
+    GHashTable *buckets = g_hash_table_new_full (duplicate_key_hash,
+                                                 duplicate_key_equal,
+                                                 g_free, NULL);
+    GHashTable *matched = g_hash_table_new (g_direct_hash, g_direct_equal);
+    GHashTableIter iter;
+    gpointer bucket;
+    GList *found = NULL;
+    GList *node;
+    guint work_to_do = g_list_length (new_splits);
+    guint work_done = 0;
+    gboolean canceled = FALSE;
+
+    g_return_val_if_fail (duplicates, FALSE);
+
+    for (node = old_splits; node; node = node->next)
+    {
+        DuplicateKey *key = g_new (DuplicateKey, 1);
+
+        /* An existing key is kept and the new one freed. */
+        duplicate_key_init (key, node->data, names);
+        g_hash_table_insert (buckets, key,
+                             g_list_prepend (g_hash_table_lookup (buckets, key),
+                                             node->data));
+    }
+    g_hash_table_iter_init (&iter, buckets);
+    while (g_hash_table_iter_next (&iter, NULL, &bucket))
+        g_hash_table_iter_replace (&iter, g_list_reverse (bucket));
+
+    for (node = new_splits; node; node = node->next, work_done++)
+    {
+        Split *split = node->data;
+        Transaction *trans = xaccSplitGetParent (split);
+        DuplicateKey key;
+        GList *candidates = NULL;
+        GList *old;
+        time64 date;
+
+        /* The transaction has already been matched through another of
+         * its splits. */
+        if (g_hash_table_contains (matched, trans))
+            continue;
+
+        if (progress && work_done % 8 == 0 &&
+            !progress ((gdouble)work_done / work_to_do, user_data))
+        {
+            canceled = TRUE;
+            break;
+        }
+
+        duplicate_key_init (&key, split, names);
+        date = xaccTransGetDate (trans);
+        for (old = g_hash_table_lookup (buckets, &key); old; old = old->next)
+        {
+            Transaction *old_trans = xaccSplitGetParent (old->data);
+            time64 old_date = xaccTransGetDate (old_trans);
+            if (ABS (old_date - date) <= QIF_WEEK_SECS)
+                candidates = g_list_prepend (candidates, old_trans);
+        }
+
+        if (candidates)
+        {
+            GncQifDuplicate *duplicate = g_new (GncQifDuplicate, 1);
+            duplicate->new_trans = trans;
+            duplicate->old_trans = g_list_reverse (candidates);
+            found = g_list_prepend (found, duplicate);
+            g_hash_table_add (matched, trans);
+        }
+    }
+
+    g_hash_table_iter_init (&iter, buckets);
+    while (g_hash_table_iter_next (&iter, NULL, &bucket))
+        g_list_free (bucket);
+    g_hash_table_destroy (buckets);
+    g_hash_table_destroy (names);
+    g_hash_table_destroy (matched);
+
+    if (canceled)
+    {
+        gnc_qif_duplicates_free (found);
+        *duplicates = NULL;
+        return FALSE;
+    }
+    *duplicates = g_list_reverse (found);
+    return TRUE;
+}
+
+static void
+duplicate_free (gpointer data)
+{
+    GncQifDuplicate *duplicate = data;
+    g_list_free (duplicate->old_trans);
+    g_free (duplicate);
+}
+
+void
+gnc_qif_duplicates_free (GList *duplicates)
+{
+    g_list_free_full (duplicates, duplicate_free);
+}
+
+/********************************************************************\
+ * Scheme interface
+\********************************************************************/
+
+static void
+reader_finalize (void *reader)
+{
+    gnc_qif_reader_free (reader);
+}
+
+/* (qif-import:reader-open path) => reader or #f */
+static SCM
+scm_qif_reader_open (SCM path)
+{
+    char *str = scm_to_locale_string (path);
+    GncQifReader *reader = gnc_qif_reader_new (str);
+
+    free (str);
+    if (!reader)
+        return SCM_BOOL_F;
+    return scm_from_pointer (reader, reader_finalize);
+}
+
+/* (qif-import:reader-next reader) => (line-num tag value status) or #f
+ * at the end of the file, with status #f, 'converted or 'stripped. */
+static SCM
+scm_qif_reader_next (SCM scm_reader)
+{
+    GncQifReader *reader = scm_to_pointer (scm_reader);
+    GncQifLineStatus status;
+    gunichar tag;
+    gchar *value;
+    SCM scm_value, scm_status = SCM_BOOL_F;
+
+    if (!gnc_qif_reader_next (reader, &tag, &value, &status))
+        return SCM_BOOL_F;
+
+    scm_value = scm_from_utf8_string (value);
+    g_free (value);
+    if (status == GNC_QIF_LINE_CONVERTED)
+        scm_status = scm_from_utf8_symbol ("converted");
+    else if (status == GNC_QIF_LINE_STRIPPED)
+        scm_status = scm_from_utf8_symbol ("stripped");
+
+    return scm_list_4 (scm_from_uint (gnc_qif_reader_get_line_num (reader)),
+                       SCM_MAKE_CHAR (tag), scm_value, scm_status);
+}
+
+/* (qif-import:reader-fraction reader) => the fraction of the file read */
+static SCM
+scm_qif_reader_fraction (SCM scm_reader)
+{
+    return scm_from_double (gnc_qif_reader_get_fraction (scm_to_pointer (scm_reader)));
+}
+
+/* (qif-import:reader-close reader) */
+static SCM
+scm_qif_reader_close (SCM scm_reader)
+{
+    gnc_qif_reader_close (scm_to_pointer (scm_reader));
+    return SCM_UNSPECIFIED;
+}
+
+/* The Scheme names of the formats, actions and maps, made when the
+ * module is defined. */
+static const gchar *date_format_names[] = { "d-m-y", "m-d-y", "y-m-d", "y-d-m" };
+static const gchar *number_format_names[] = { "decimal", "comma", "integer" };
+static const gchar *action_names[] =
+{
+    "", "buy", "buyx", "cglong", "cglongx", "cgmid", "cgmidx", "cgshort",
+    "cgshortx", "div", "divx", "intinc", "intincx", "margint", "margintx",
+    "miscexp", "miscexpx", "miscinc", "miscincx", "reinvdiv", "reinvint",
+    "reinvlg", "reinvmd", "reinvsg", "reinvsh", "reminder", "rtrncap",
+    "rtrncapx", "sell", "sellx", "shrsin", "shrsout", "stksplit", "xin",
+    "xout"
+};
+static const gchar *cleared_names[] = { "", "cleared", "reconciled" };
+static const gchar *map_names[] = { "account", "category", "memo" };
+
+static SCM date_format_symbols[G_N_ELEMENTS (date_format_names)];
+static SCM number_format_symbols[G_N_ELEMENTS (number_format_names)];
+static SCM action_symbols[G_N_ELEMENTS (action_names)];
+static SCM cleared_symbols[G_N_ELEMENTS (cleared_names)];
+static SCM map_symbols[G_N_ELEMENTS (map_names)];
+
+static void
+symbols_init (SCM *symbols, const gchar **names, guint n_names)
+{
+    guint i;
+
+    for (i = 0; i < n_names; i++)
+        symbols[i] = scm_gc_protect_object (scm_from_utf8_symbol (names[i]));
+}
+
+/* The index of symbol in symbols, or -1. */
+static gint
+symbol_index (SCM symbol, const SCM *symbols, guint n_symbols)
+{
+    guint i;
+
+    for (i = 0; i < n_symbols; i++)
+        if (scm_is_eq (symbol, symbols[i]))
+            return i;
+    return -1;
+}
+
+static SCM
+string_to_scm (const gchar *str)
+{
+    return str ? scm_from_utf8_string (str) : SCM_BOOL_F;
+}
+
+/* (qif-import:check-date-format str formats) => the formats str could
+ * be in, or #f if it isn't a date */
+static SCM
+scm_qif_check_date_format (SCM scm_str, SCM scm_formats)
+{
+    guint length = MAX (scm_ilength (scm_formats), 0);
+    GncQifDateFormat *formats = g_new (GncQifDateFormat, length);
+    GncQifDateFormat *result = g_new (GncQifDateFormat, 2 * length);
+    SCM list = SCM_EOL;
+    gchar *str;
+    gint i, n = 0;
+
+    for (; scm_is_pair (scm_formats); scm_formats = SCM_CDR (scm_formats))
+    {
+        gint format = symbol_index (SCM_CAR (scm_formats), date_format_symbols,
+                                    G_N_ELEMENTS (date_format_symbols));
+        if (format >= 0)
+            formats[n++] = format;
+    }
+
+    str = scm_is_string (scm_str) ? scm_to_utf8_string (scm_str) : NULL;
+    n = gnc_qif_check_date_format (str, formats, n, result);
+    free (str);
+
+    for (i = n - 1; i >= 0; i--)
+        list = scm_cons (date_format_symbols[result[i]], list);
+    g_free (formats);
+    g_free (result);
+    return n < 0 ? SCM_BOOL_F : list;
+}
+
+/* (qif-import:parse-date/format str format) => (day month year) or #f */
+static SCM
+scm_qif_parse_date (SCM scm_str, SCM scm_format)
+{
+    gint format = symbol_index (scm_format, date_format_symbols,
+                                G_N_ELEMENTS (date_format_symbols));
+    gint day, month, year;
+    gboolean ok;
+    gchar *str;
+
+    if (format < 0)
+        return SCM_BOOL_F;
+
+    str = scm_to_utf8_string (scm_str);
+    ok = gnc_qif_parse_date (str, format, &day, &month, &year);
+    free (str);
+    if (!ok)
+        return SCM_BOOL_F;
+    return scm_list_3 (scm_from_int (day), scm_from_int (month),
+                       scm_from_int (year));
+}
+
+/* (qif-import:check-number-format str formats) => the formats str
+ * could be in */
+static SCM
+scm_qif_check_number_format (SCM scm_str, SCM scm_formats)
+{
+    guint length = MAX (scm_ilength (scm_formats), 0);
+    GncQifNumberFormat *formats = g_new (GncQifNumberFormat, length);
+    SCM list = SCM_EOL;
+    gchar *str;
+    gint i, n = 0;
+
+    for (; scm_is_pair (scm_formats); scm_formats = SCM_CDR (scm_formats))
+    {
+        gint format = symbol_index (SCM_CAR (scm_formats),
+                                    number_format_symbols,
+                                    G_N_ELEMENTS (number_format_symbols));
+        if (format >= 0)
+            formats[n++] = format;
+    }
+
+    str = scm_to_utf8_string (scm_str);
+    n = gnc_qif_check_number_format (str, formats, n);
+    free (str);
+
+    for (i = n - 1; i >= 0; i--)
+        list = scm_cons (number_format_symbols[formats[i]], list);
+    g_free (formats);
+    return list;
+}
+
+/* (qif-import:parse-number/format str format) => the number, or #f if
+ * it isn't a plain number the Scheme parser has to read */
+static SCM
+scm_qif_parse_number (SCM scm_str, SCM scm_format)
+{
+    gint format = symbol_index (scm_format, number_format_symbols,
+                                G_N_ELEMENTS (number_format_symbols));
+    gnc_numeric number;
+    gboolean ok;
+    gchar *str;
+
+    if (format < 0)
+        return SCM_BOOL_F;
+
+    str = scm_to_utf8_string (scm_str);
+    ok = gnc_qif_parse_number (str, format, &number);
+    free (str);
+    return ok ? gnc_numeric_to_scm (number) : SCM_BOOL_F;
+}
+
+/* (qif-import:parse-category str) => the list qif-split:parse-category
+ * returns, or #f if str can't be parsed */
+static SCM
+scm_qif_parse_category (SCM scm_str)
+{
+    GncQifCategory category;
+    gchar *str = scm_to_utf8_string (scm_str);
+    gboolean ok = gnc_qif_parse_category (str, &category);
+    SCM result;
+
+    free (str);
+    if (!ok)
+        return SCM_BOOL_F;
+
+    result = scm_list_n (string_to_scm (category.name),
+                         scm_from_bool (category.is_account),
+                         string_to_scm (category.class_name),
+                         string_to_scm (category.miscx_name),
+                         scm_from_bool (category.miscx_is_account),
+                         string_to_scm (category.miscx_class),
+                         SCM_UNDEFINED);
+    gnc_qif_category_clear (&category);
+    return result;
+}
+
+/* The fields of the vectors qif-import:xtn-to-gnc-xtn is passed for a
+ * transaction and each of its splits. */
+enum
+{
+    XTN_FIELD_DATE,
+    XTN_FIELD_PAYEE,
+    XTN_FIELD_NUMBER,
+    XTN_FIELD_ACTION,
+    XTN_FIELD_CLEARED,
+    XTN_FIELD_SECURITY,
+    XTN_FIELD_FROM_ACCT,
+    XTN_FIELD_SHARE_PRICE,
+    XTN_FIELD_NUM_SHARES,
+    XTN_FIELD_COMMISSION,
+    XTN_FIELD_HAS_DEFAULT_SPLIT,
+    XTN_FIELD_DEFAULT_MEMO,
+    XTN_FIELD_ACCOUNTS_AFFECTED,
+};
+
+enum
+{
+    SPLIT_FIELD_CATEGORY,
+    SPLIT_FIELD_CATEGORY_IS_ACCOUNT,
+    SPLIT_FIELD_MEMO,
+    SPLIT_FIELD_AMOUNT,
+    SPLIT_FIELD_MATCHING_CLEARED,
+    SPLIT_FIELD_MARK,
+};
+
+/* A copy of str, freed when the current dynwind context ends, or NULL
+ * if str isn't a string. */
+static const gchar *
+scm_to_dynwind_string (SCM str)
+{
+    gchar *copy;
+
+    if (!scm_is_string (str))
+        return NULL;
+    copy = scm_to_utf8_string (str);
+    scm_dynwind_free (copy);
+    return copy;
+}
+
+static gboolean
+scm_to_numeric_if_set (SCM number, gnc_numeric *result)
+{
+    if (!scm_is_number (number))
+        return FALSE;
+    *result = gnc_scm_to_numeric (number);
+    return TRUE;
+}
+
+static GncQifCleared
+scm_to_cleared (SCM cleared)
+{
+    gint index = symbol_index (cleared, cleared_symbols,
+                               G_N_ELEMENTS (cleared_symbols));
+    return index > 0 ? index : GNC_QIF_UNCLEARED;
+}
+
+typedef struct
+{
+    SCM map_lookup;
+    SCM accounts;
+} ScmConverterData;
+
+static const gchar *
+scm_converter_map_lookup (GncQifMap map, const gchar *qif_name,
+                          gpointer user_data)
+{
+    ScmConverterData *data = user_data;
+    return scm_to_dynwind_string (scm_call_2 (data->map_lookup, map_symbols[map],
+                                              scm_from_utf8_string (qif_name)));
+}
+
+static Account *
+scm_converter_account_lookup (const gchar *gnc_name, gpointer user_data)
+{
+    ScmConverterData *data = user_data;
+    SCM account = scm_hash_ref (data->accounts, scm_from_utf8_string (gnc_name),
+                                SCM_BOOL_F);
+
+    if (scm_is_false (account))
+        return NULL;
+    return SWIG_MustGetPtr (account, SWIG_TypeQuery ("_p_Account"), 1, 0);
+}
+
+static void
+scm_to_split_info (SCM fields, GncQifSplitInfo *split)
+{
+    split->category =
+        scm_to_dynwind_string (scm_c_vector_ref (fields, SPLIT_FIELD_CATEGORY));
+    if (!split->category)
+        split->category = "";
+    split->category_is_account =
+        scm_is_true (scm_c_vector_ref (fields, SPLIT_FIELD_CATEGORY_IS_ACCOUNT));
+    split->memo = scm_to_dynwind_string (scm_c_vector_ref (fields, SPLIT_FIELD_MEMO));
+    split->has_amount =
+        scm_to_numeric_if_set (scm_c_vector_ref (fields, SPLIT_FIELD_AMOUNT),
+                               &split->amount);
+    split->matching_cleared =
+        scm_to_cleared (scm_c_vector_ref (fields, SPLIT_FIELD_MATCHING_CLEARED));
+    split->marked = scm_is_true (scm_c_vector_ref (fields, SPLIT_FIELD_MARK));
+}
+
+/* (qif-import:xtn-to-gnc-xtn gnc-xtn xtn-fields split-fields map-lookup
+ *                            gnc-acct-hash unspec-acct status-pref)
+ *
+ * Convert the transaction whose fields are given as vectors, looking
+ * up GnuCash account names with (map-lookup map qif-name), where map
+ * is 'account, 'category or 'memo, and the accounts in gnc-acct-hash. */
+static SCM
+scm_qif_xtn_to_gnc_xtn (SCM scm_trans, SCM fields, SCM split_fields,
+                        SCM map_lookup, SCM accounts, SCM unspec_name,
+                        SCM status_pref)
+{
+    Transaction *trans = SWIG_MustGetPtr (scm_trans,
+                                          SWIG_TypeQuery ("_p_Transaction"),
+                                          1, 0);
+    ScmConverterData data = { map_lookup, accounts };
+    GncQifConverter converter;
+    GncQifXtnInfo xtn;
+    GncQifSplitInfo *splits;
+    SCM date, affected;
+    gint action;
+    guint i;
+    gboolean ok;
+
+    scm_dynwind_begin (0);
+
+    memset (&xtn, 0, sizeof (xtn));
+    date = scm_c_vector_ref (fields, XTN_FIELD_DATE);
+    if (scm_ilength (date) == 3)
+    {
+        xtn.day = scm_to_int (scm_car (date));
+        xtn.month = scm_to_int (scm_cadr (date));
+        xtn.year = scm_to_int (scm_caddr (date));
+    }
+    xtn.payee = scm_to_dynwind_string (scm_c_vector_ref (fields, XTN_FIELD_PAYEE));
+    xtn.number = scm_to_dynwind_string (scm_c_vector_ref (fields, XTN_FIELD_NUMBER));
+    action = symbol_index (scm_c_vector_ref (fields, XTN_FIELD_ACTION),
+                           action_symbols, G_N_ELEMENTS (action_symbols));
+    xtn.action = action > 0 ? action : GNC_QIF_ACTION_NONE;
+    xtn.cleared = scm_to_cleared (scm_c_vector_ref (fields, XTN_FIELD_CLEARED));
+    xtn.security =
+        scm_to_dynwind_string (scm_c_vector_ref (fields, XTN_FIELD_SECURITY));
+    xtn.from_acct =
+        scm_to_dynwind_string (scm_c_vector_ref (fields, XTN_FIELD_FROM_ACCT));
+    xtn.has_share_price =
+        scm_to_numeric_if_set (scm_c_vector_ref (fields, XTN_FIELD_SHARE_PRICE),
+                               &xtn.share_price);
+    xtn.has_num_shares =
+        scm_to_numeric_if_set (scm_c_vector_ref (fields, XTN_FIELD_NUM_SHARES),
+                               &xtn.num_shares);
+    xtn.has_commission =
+        scm_to_numeric_if_set (scm_c_vector_ref (fields, XTN_FIELD_COMMISSION),
+                               &xtn.commission);
+    xtn.has_default_split =
+        scm_is_true (scm_c_vector_ref (fields, XTN_FIELD_HAS_DEFAULT_SPLIT));
+    xtn.default_memo =
+        scm_to_dynwind_string (scm_c_vector_ref (fields, XTN_FIELD_DEFAULT_MEMO));
+
+    affected = scm_c_vector_ref (fields, XTN_FIELD_ACCOUNTS_AFFECTED);
+    if (scm_ilength (affected) == 3)
+    {
+        xtn.near_acct = scm_to_dynwind_string (scm_car (affected));
+        xtn.far_acct = scm_to_dynwind_string (scm_cadr (affected));
+        xtn.commission_acct = scm_to_dynwind_string (scm_caddr (affected));
+    }
+
+    xtn.n_splits = MAX (scm_ilength (split_fields), 0);
+    splits = g_new0 (GncQifSplitInfo, xtn.n_splits);
+    scm_dynwind_unwind_handler (g_free, splits, SCM_F_WIND_EXPLICITLY);
+    for (i = 0; i < xtn.n_splits; i++, split_fields = SCM_CDR (split_fields))
+        scm_to_split_info (SCM_CAR (split_fields), &splits[i]);
+    xtn.splits = splits;
+
+    converter.map_lookup = scm_converter_map_lookup;
+    converter.account_lookup = scm_converter_account_lookup;
+    converter.user_data = &data;
+    converter.unspec_name = scm_to_dynwind_string (unspec_name);
+    converter.status_pref = SCM_CHAR (status_pref);
+
+    ok = xtn.n_splits > 0 && gnc_qif_xtn_to_gnc_xtn (&xtn, &converter, trans);
+    if (!ok)
+        scm_misc_error ("qif-import:xtn-to-gnc-xtn",
+                        "Can't convert the QIF transaction.", SCM_EOL);
+
+    scm_dynwind_end ();
+    return scm_trans;
+}
+
+static GList *
+scm_to_split_list (SCM list)
+{
+    swig_type_info *split_type = SWIG_TypeQuery ("_p_Split");
+    GList *splits = NULL;
+
+    for (; scm_is_pair (list); list = SCM_CDR(list))
+        splits = g_list_prepend (splits,
+                                 SWIG_MustGetPtr (SCM_CAR(list), split_type, 1, 0));
+    return g_list_reverse (splits);
+}
+
+/* Call the Scheme procedure at user_data, which returns #f to cancel. */
+static gboolean
+scm_qif_progress (gdouble fraction, gpointer user_data)
+{
+    SCM *progress = user_data;
+    return scm_is_true (scm_call_1 (*progress, scm_from_double (fraction)));
+}
+
+/* (qif-import:find-duplicates new-splits old-splits progress)
+ *
+ * Returns the same association list as gnc:account-tree-find-duplicates:
+ * ((new-xtn . ((old-xtn . #f) ...)) ...), most recently found first,
+ * or #f if (progress fraction), called unless progress is #f, returned
+ * #f to cancel. */
+static SCM
+scm_qif_find_duplicates (SCM scm_new_splits, SCM scm_old_splits,
+                         SCM progress)
+{
+    swig_type_info *trans_type = SWIG_TypeQuery ("_p_Transaction");
+    GList *new_splits = scm_to_split_list (scm_new_splits);
+    GList *old_splits = scm_to_split_list (scm_old_splits);
+    GList *duplicates;
+    SCM matches = SCM_EOL;
+    GList *node, *old;
+    gboolean done;
+
+    done = gnc_qif_find_duplicates (new_splits, old_splits,
+                                    scm_is_true (progress) ? scm_qif_progress : NULL,
+                                    &progress, &duplicates);
+    g_list_free (new_splits);
+    g_list_free (old_splits);
+    if (!done)
+        return SCM_BOOL_F;
+
+    for (node = duplicates; node; node = node->next)
+    {
+        GncQifDuplicate *duplicate = node->data;
+        SCM candidates = SCM_EOL;
+
+        for (old = g_list_last (duplicate->old_trans); old; old = old->prev)
+            candidates = scm_cons (scm_cons (SWIG_NewPointerObj (old->data,
+                                                                 trans_type, 0),
+                                             SCM_BOOL_F),
+                                   candidates);
+        matches = scm_cons (scm_cons (SWIG_NewPointerObj (duplicate->new_trans,
+                                                          trans_type, 0),
+                                      candidates),
+                            matches);
+    }
+
+    gnc_qif_duplicates_free (duplicates);
+    return matches;
+}
+
+static void
+qif_import_native_define (void *data)
+{
+    symbols_init (date_format_symbols, date_format_names,
+                  G_N_ELEMENTS (date_format_names));
+    symbols_init (number_format_symbols, number_format_names,
+                  G_N_ELEMENTS (number_format_names));
+    symbols_init (action_symbols, action_names, G_N_ELEMENTS (action_names));
+    symbols_init (cleared_symbols, cleared_names, G_N_ELEMENTS (cleared_names));
+    symbols_init (map_symbols, map_names, G_N_ELEMENTS (map_names));
+
+    scm_c_define_gsubr ("qif-import:reader-open", 1, 0, 0,
+                        scm_qif_reader_open);
+    scm_c_define_gsubr ("qif-import:reader-next", 1, 0, 0,
+                        scm_qif_reader_next);
+    scm_c_define_gsubr ("qif-import:reader-fraction", 1, 0, 0,
+                        scm_qif_reader_fraction);
+    scm_c_define_gsubr ("qif-import:reader-close", 1, 0, 0,
+                        scm_qif_reader_close);
+    scm_c_define_gsubr ("qif-import:check-date-format", 2, 0, 0,
+                        scm_qif_check_date_format);
+    scm_c_define_gsubr ("qif-import:parse-date/format", 2, 0, 0,
+                        scm_qif_parse_date);
+    scm_c_define_gsubr ("qif-import:check-number-format", 2, 0, 0,
+                        scm_qif_check_number_format);
+    scm_c_define_gsubr ("qif-import:parse-number/format", 2, 0, 0,
+                        scm_qif_parse_number);
+    scm_c_define_gsubr ("qif-import:parse-category", 1, 0, 0,
+                        scm_qif_parse_category);
+    scm_c_define_gsubr ("qif-import:xtn-to-gnc-xtn", 7, 0, 0,
+                        scm_qif_xtn_to_gnc_xtn);
+    scm_c_define_gsubr ("qif-import:find-duplicates", 3, 0, 0,
+                        scm_qif_find_duplicates);
+    scm_c_export ("qif-import:reader-open", "qif-import:reader-next",
+                  "qif-import:reader-fraction", "qif-import:reader-close",
+                  "qif-import:check-date-format", "qif-import:parse-date/format",
+                  "qif-import:check-number-format",
+                  "qif-import:parse-number/format", "qif-import:parse-category",
+                  "qif-import:xtn-to-gnc-xtn", "qif-import:find-duplicates",
+                  NULL);
+}
+
+void
+gnc_qif_import_native_init (void)
+{
+    scm_c_define_module ("gnucash qif-import native",
+                         qif_import_native_define, NULL);
+}
@@ -0,0 +1,349 @@
+/********************************************************************\
+ * qif-import-native.h -- native helpers for the QIF importer       *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+\********************************************************************/
+
+/** @file qif-import-native.h
+    @brief Native QIF reader, field parser, converter and duplicate finder.
+
+    These do the parts of the QIF import whose cost grows with the size
+    of the file: splitting it into tagged lines, parsing the fields,
+    building the GnuCash transactions and matching them against those
+    already in the book. The Scheme importer uses them through the
+    (gnucash qif-import native) module when it has been defined, and
+    does the same work itself otherwise.
+*/
+
+#ifndef QIF_IMPORT_NATIVE_H
+#define QIF_IMPORT_NATIVE_H
+
+#include <glib.h>
+#include "Account.h"
+#include "Transaction.h"
+
+/** @name Reading
+ *  @{
+ */
+
+/** How the value of a line was made valid UTF-8. */
+typedef enum
+{
+    GNC_QIF_LINE_OK,
+    /** Converted from the locale's character set. */
+    GNC_QIF_LINE_CONVERTED,
+    /** Invalid characters were discarded. */
+    GNC_QIF_LINE_STRIPPED,
+} GncQifLineStatus;
+
+typedef struct GncQifReader GncQifReader;
+
+/** Open path for reading.
+ *
+ *  @return NULL if the file can't be opened.
+ */
+GncQifReader *gnc_qif_reader_new (const gchar *path);
+
+/** Read the next non-empty line, skipping a leading byte order mark.
+ *  Carriage returns and newlines each end a line.
+ *
+ *  @param tag The first character of the line.
+ *  @param value A newly allocated, valid UTF-8 copy of the rest of it.
+ *  @return FALSE at the end of the file.
+ */
+gboolean gnc_qif_reader_next (GncQifReader *reader, gunichar *tag,
+                              gchar **value, GncQifLineStatus *status);
+
+/** The number of the line last returned, counting empty lines. */
+guint gnc_qif_reader_get_line_num (const GncQifReader *reader);
+
+/** The fraction of the file read so far. */
+gdouble gnc_qif_reader_get_fraction (const GncQifReader *reader);
+
+/** Close the file. The reader then reports the end of the file. */
+void gnc_qif_reader_close (GncQifReader *reader);
+void gnc_qif_reader_free (GncQifReader *reader);
+/** @} */
+
+/** @name Field parsing
+ *
+ *  These read field values the way qif-parse.scm does, using the same
+ *  regular expressions.
+ *  @{
+ */
+
+/** The orders a QIF date may be written in. */
+typedef enum
+{
+    GNC_QIF_DATE_D_M_Y,
+    GNC_QIF_DATE_M_D_Y,
+    GNC_QIF_DATE_Y_M_D,
+    GNC_QIF_DATE_Y_D_M,
+} GncQifDateFormat;
+
+/** Find which of formats str could be written in.
+ *
+ *  A string of eight digits is tried both as YYYYxxxx, if formats has
+ *  one starting with the year, and as xxxxYYYY, if it has one starting
+ *  with the day or month, so a format may be listed twice.
+ *
+ *  @param result Room for twice n_formats formats, filled in the order
+ *  of formats.
+ *  @return The number of formats put in result, or -1 if str isn't a
+ *  date at all.
+ */
+gint gnc_qif_check_date_format (const gchar *str,
+                                const GncQifDateFormat *formats,
+                                guint n_formats, GncQifDateFormat *result);
+
+/** Read str as a date written in format. Two digit years before 50
+ *  are taken to be after 2000.
+ *
+ *  @return FALSE if str isn't a valid date in that format.
+ */
+gboolean gnc_qif_parse_date (const gchar *str, GncQifDateFormat format,
+                             gint *day, gint *month, gint *year);
+
+/** Read a QIF year: "00", "2000" and "19100" all mean 2000, and years
+ *  before threshold are taken to be after 2000.
+ *
+ *  @return FALSE if str doesn't hold a number.
+ */
+gboolean gnc_qif_fix_year (const gchar *str, gint threshold, gint *year);
+
+/** The ways a QIF number may be written. */
+typedef enum
+{
+    /** 1,500.00 or 2'000.00 */
+    GNC_QIF_NUMBER_DECIMAL,
+    /** 5.000,00 or 4'500,00 */
+    GNC_QIF_NUMBER_COMMA,
+    /** 456 */
+    GNC_QIF_NUMBER_INTEGER,
+} GncQifNumberFormat;
+
+/** Remove from formats those str can't be written in, keeping the
+ *  order of the others.
+ *
+ *  @return The number of formats left.
+ */
+guint gnc_qif_check_number_format (const gchar *str,
+                                   GncQifNumberFormat *formats,
+                                   guint n_formats);
+
+/** Read str as a number written in format. Any minus sign makes it
+ *  negative.
+ *
+ *  @return FALSE if, without its sign, currency and grouping
+ *  characters, str isn't a run of digits with at most one radix point
+ *  that fits a gnc_numeric.
+ */
+gboolean gnc_qif_parse_number (const gchar *str, GncQifNumberFormat format,
+                               gnc_numeric *number);
+
+/** The parts of a QIF category field,
+ *  "category/class|miscx-category/miscx-class", where either category
+ *  may be an account name in brackets. */
+typedef struct
+{
+    gchar *name;
+    gboolean is_account;
+    gchar *class_name;
+    /** NULL if there is no miscx part. */
+    gchar *miscx_name;
+    gboolean miscx_is_account;
+    gchar *miscx_class;
+} GncQifCategory;
+
+/** Split str into category.
+ *
+ *  @return FALSE if str can't be parsed, leaving category unset.
+ */
+gboolean gnc_qif_parse_category (const gchar *str, GncQifCategory *category);
+void gnc_qif_category_clear (GncQifCategory *category);
+/** @} */
+
+/** @name Conversion
+ *  @{
+ */
+
+/** The reconcile status of a QIF transaction or split. */
+typedef enum
+{
+    GNC_QIF_UNCLEARED,
+    GNC_QIF_CLEARED,
+    GNC_QIF_RECONCILED,
+} GncQifCleared;
+
+/** The investment actions, as qif-parse.scm names them. */
+typedef enum
+{
+    GNC_QIF_ACTION_NONE,
+    GNC_QIF_ACTION_BUY,
+    GNC_QIF_ACTION_BUYX,
+    GNC_QIF_ACTION_CGLONG,
+    GNC_QIF_ACTION_CGLONGX,
+    GNC_QIF_ACTION_CGMID,
+    GNC_QIF_ACTION_CGMIDX,
+    GNC_QIF_ACTION_CGSHORT,
+    GNC_QIF_ACTION_CGSHORTX,
+    GNC_QIF_ACTION_DIV,
+    GNC_QIF_ACTION_DIVX,
+    GNC_QIF_ACTION_INTINC,
+    GNC_QIF_ACTION_INTINCX,
+    GNC_QIF_ACTION_MARGINT,
+    GNC_QIF_ACTION_MARGINTX,
+    GNC_QIF_ACTION_MISCEXP,
+    GNC_QIF_ACTION_MISCEXPX,
+    GNC_QIF_ACTION_MISCINC,
+    GNC_QIF_ACTION_MISCINCX,
+    GNC_QIF_ACTION_REINVDIV,
+    GNC_QIF_ACTION_REINVINT,
+    GNC_QIF_ACTION_REINVLG,
+    GNC_QIF_ACTION_REINVMD,
+    GNC_QIF_ACTION_REINVSG,
+    GNC_QIF_ACTION_REINVSH,
+    GNC_QIF_ACTION_REMINDER,
+    GNC_QIF_ACTION_RTRNCAP,
+    GNC_QIF_ACTION_RTRNCAPX,
+    GNC_QIF_ACTION_SELL,
+    GNC_QIF_ACTION_SELLX,
+    GNC_QIF_ACTION_SHRSIN,
+    GNC_QIF_ACTION_SHRSOUT,
+    GNC_QIF_ACTION_STKSPLIT,
+    GNC_QIF_ACTION_XIN,
+    GNC_QIF_ACTION_XOUT,
+} GncQifAction;
+
+/** A parsed QIF split. */
+typedef struct
+{
+    /** The category or account name, "" if there is none. */
+    const gchar *category;
+    gboolean category_is_account;
+    const gchar *memo;
+    gboolean has_amount;
+    gnc_numeric amount;
+    GncQifCleared matching_cleared;
+    /** Set if the split is the other half of a transfer already
+     *  imported, and so is skipped. */
+    gboolean marked;
+} GncQifSplitInfo;
+
+/** A parsed QIF transaction. The strings may be NULL if the file
+ *  didn't give them. */
+typedef struct
+{
+    /** All zero if the file gave no date. */
+    gint day, month, year;
+    const gchar *payee;
+    const gchar *number;
+    GncQifAction action;
+    GncQifCleared cleared;
+    /** Set for investment transactions. */
+    const gchar *security;
+    const gchar *from_acct;
+    gboolean has_default_split;
+    const gchar *default_memo;
+    gboolean has_share_price, has_num_shares, has_commission;
+    gnc_numeric share_price, num_shares, commission;
+    /** For investment transactions, the QIF accounts the first split
+     *  affects, as qif-split:accounts-affected finds them. */
+    const gchar *near_acct, *far_acct, *commission_acct;
+    const GncQifSplitInfo *splits;
+    guint n_splits;
+} GncQifXtnInfo;
+
+/** The QIF to GnuCash name mappings. */
+typedef enum
+{
+    GNC_QIF_MAP_ACCOUNT,
+    GNC_QIF_MAP_CATEGORY,
+    GNC_QIF_MAP_MEMO,
+} GncQifMap;
+
+/** How QIF names become GnuCash accounts. */
+typedef struct
+{
+    /** The GnuCash account name map gives qif_name, or NULL. The name
+     *  must stay valid until the conversion returns. */
+    const gchar *(*map_lookup) (GncQifMap map, const gchar *qif_name,
+                                gpointer user_data);
+    /** The account made for a GnuCash account name, or NULL. */
+    Account *(*account_lookup) (const gchar *gnc_name, gpointer user_data);
+    gpointer user_data;
+    /** The account for splits whose category isn't mapped. */
+    const gchar *unspec_name;
+    /** The reconcile flag of transactions the file didn't give one. */
+    char status_pref;
+} GncQifConverter;
+
+/** Add the splits of xtn to trans, which must be open for editing,
+ *  as qif-import:qif-xtn-to-gnc-xtn does.
+ *
+ *  @return FALSE, without changing trans, if xtn has no date, its
+ *  accounts aren't mapped or its investment action lacks the amount it
+ *  needs.
+ */
+gboolean gnc_qif_xtn_to_gnc_xtn (const GncQifXtnInfo *xtn,
+                                 const GncQifConverter *converter,
+                                 Transaction *trans);
+/** @} */
+
+/** @name Duplicate detection
+ *  @{
+ */
+
+/** A transaction being imported and the ones already in the book that
+ *  it may duplicate. */
+typedef struct
+{
+    Transaction *new_trans;
+    GList *old_trans;
+} GncQifDuplicate;
+
+/** Report the fraction of the work done.
+ *
+ *  @return FALSE to cancel.
+ */
+typedef gboolean (*GncQifProgressFunc) (gdouble fraction, gpointer user_data);
+
+/** Find, for each transaction of new_splits, the transactions of
+ *  old_splits that have a split in an account with the same full name,
+ *  with the same value and posted at most a week apart.
+ *
+ *  A transaction is only reported for the first of its splits with
+ *  any such match. Candidates are listed in the order of old_splits,
+ *  as often as they have a matching split.
+ *
+ *  @param progress Called, if not NULL, for every eighth new split.
+ *  @param duplicates Set to a list of GncQifDuplicate in the order of
+ *  new_splits, to be freed with gnc_qif_duplicates_free().
+ *  @return FALSE, with duplicates set to NULL, if progress canceled the
+ *  search.
+ */
+gboolean gnc_qif_find_duplicates (GList *new_splits, GList *old_splits,
+                                  GncQifProgressFunc progress,
+                                  gpointer user_data, GList **duplicates);
+void gnc_qif_duplicates_free (GList *duplicates);
+/** @} */
+
+/** Define the (gnucash qif-import native) Scheme module. */
+void gnc_qif_import_native_init (void);
+
+#endif /* QIF_IMPORT_NATIVE_H */
@@ -43,8 +43,8 @@
 (debug-enable 'backtrace)
 
 (load-from-path "gnucash/qif-import/qif-objects")      ;; class definitions
-(load-from-path "gnucash/qif-import/qif-parse")        ;; string-to-value
 (load-from-path "gnucash/qif-import/qif-utils")
+(load-from-path "gnucash/qif-import/qif-parse")        ;; string-to-value
 (load-from-path "gnucash/qif-import/qif-file")         ;; actual file reading
 (load-from-path "gnucash/qif-import/qif-dialog-utils") ;; build displays
 (load-from-path "gnucash/qif-import/qif-guess-map")    ;; build acct mappings
@@ -85,51 +85,67 @@
             (qif-import:check-pause progress-dialog)
             (if qif-import:canceled (throw 'cancel))))
 
+        (define native-find-duplicates
+          (qif-import:native-procedure 'qif-import:find-duplicates))
+
         (when progress-dialog
           (gnc-progress-dialog-set-sub progress-dialog
                                        (G_ "Finding duplicate transactions")))
 
-        (let loop ((new-splits new-splits)
-                   (work-done 0)
-                   (matches '()))
-          (cond
-           ((null? new-splits)
-            (progress 1)
-            matches)
-
-           ((assoc (xaccSplitGetParent (car new-splits)) matches)
-            ;; txn has already been matched, by another split within same txn
-            (loop (cdr new-splits)
-                  (1+ work-done)
-                  matches))
-
-           (else
-            (let* ((new-split (car new-splits))
-                   (candidate-old-splits
-                    (filter
-                     (lambda (old-split)
-                       (and
-                        ;; split value matches
-                        (= (xaccSplitGetValue old-split)
-                           (xaccSplitGetValue new-split))
-                        ;; account name matches
-                        (string=?
-                         (gnc-account-get-full-name (xaccSplitGetAccount old-split))
-                         (gnc-account-get-full-name (xaccSplitGetAccount new-split)))
-                        ;; maximum 1 week date difference
-                        (<= (abs (- (xaccTransGetDate (xaccSplitGetParent old-split))
-                                    (xaccTransGetDate (xaccSplitGetParent new-split))))
-                            WeekSecs)))
-                     old-splits)))
-              (update-progress work-done)
-              (loop (cdr new-splits)
-                    (1+ work-done)
-                    (if (null? candidate-old-splits)
-                        matches
-                        (cons (cons (xaccSplitGetParent new-split)
-                                    (map (lambda (s) (cons (xaccSplitGetParent s) #f))
-                                         candidate-old-splits))
-                              matches)))))))))
+        (if native-find-duplicates
+            ;; Buckets the old splits by account name and value instead
+            ;; of comparing every pair, and returns #f when canceled.
+            (let ((matches (native-find-duplicates
+                            new-splits old-splits
+                            (and progress-dialog
+                                 (lambda (fraction)
+                                   (progress fraction)
+                                   (qif-import:check-pause progress-dialog)
+                                   (not qif-import:canceled))))))
+              (unless matches (throw 'cancel))
+              (progress 1)
+              matches)
+            (let loop ((new-splits new-splits)
+                       (work-done 0)
+                       (matches '()))
+              (cond
+               ((null? new-splits)
+                (progress 1)
+                matches)
+
+               ((assoc (xaccSplitGetParent (car new-splits)) matches)
+                ;; txn has already been matched, by another split within same txn
+                (loop (cdr new-splits)
+                      (1+ work-done)
+                      matches))
+
+               (else
+                (let* ((new-split (car new-splits))
+                       (candidate-old-splits
+                        (filter
+                         (lambda (old-split)
+                           (and
+                            ;; split value matches
+                            (= (xaccSplitGetValue old-split)
+                               (xaccSplitGetValue new-split))
+                            ;; account name matches
+                            (string=?
+                             (gnc-account-get-full-name (xaccSplitGetAccount old-split))
+                             (gnc-account-get-full-name (xaccSplitGetAccount new-split)))
+                            ;; maximum 1 week date difference
+                            (<= (abs (- (xaccTransGetDate (xaccSplitGetParent old-split))
+                                        (xaccTransGetDate (xaccSplitGetParent new-split))))
+                                WeekSecs)))
+                         old-splits)))
+                  (update-progress work-done)
+                  (loop (cdr new-splits)
+                        (1+ work-done)
+                        (if (null? candidate-old-splits)
+                            matches
+                            (cons (cons (xaccSplitGetParent new-split)
+                                        (map (lambda (s) (cons (xaccSplitGetParent s) #f))
+                                             candidate-old-splits))
+                                  matches))))))))))
 
      ;; Since there are either no accounts or no transactions in the old
      ;; tree, duplicate checking is unnecessary.
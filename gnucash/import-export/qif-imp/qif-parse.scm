@@ -28,6 +28,19 @@
 
 (define regexp-enabled?
   (defined? 'make-regexp))
+
+;; The parsers of qif-import-native.c, used when the plugin defined
+;; them; see qif-import:native-procedure.
+(define native-parse-category
+  (qif-import:native-procedure 'qif-import:parse-category))
+(define native-check-date-format
+  (qif-import:native-procedure 'qif-import:check-date-format))
+(define native-parse-date/format
+  (qif-import:native-procedure 'qif-import:parse-date/format))
+(define native-check-number-format
+  (qif-import:native-procedure 'qif-import:check-number-format))
+(define native-parse-number/format
+  (qif-import:native-procedure 'qif-import:parse-number/format))
 ;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
 ;;  qif-split:parse-category
 ;;  this one just gets nastier and nastier.
@@ -57,6 +70,7 @@
   ;;   and field3 is a miscx-category or [miscx-account]
   ;;   and field4 is a miscx-class
   (cond
+   ((and native-parse-category (native-parse-category value)))
    ((regexp-exec qif-category-compiled-rexp value) =>
     (lambda (rmatch)
       (list (match:substring rmatch 2)
@@ -283,6 +297,11 @@
        (make-regexp "([0-9][0-9][0-9][0-9])([0-9][0-9])([0-9][0-9])")))
 
 (define (qif-parse:check-date-format date-string possible-formats)
+  (if native-check-date-format
+      (native-check-date-format date-string possible-formats)
+      (scheme-check-date-format date-string possible-formats)))
+
+(define (scheme-check-date-format date-string possible-formats)
   (and (string? date-string)
        (not (string-null? date-string))
        (let ((rmatch (regexp-exec qif-date-compiled-rexp date-string)))
@@ -298,10 +317,13 @@
                    (append
                     (if (or (memq 'y-d-m possible-formats)
                             (memq 'y-m-d possible-formats))
-                        (parse-check-date-format date-ymd possible-formats))
+                        (parse-check-date-format date-ymd possible-formats)
+                        '())
                     (if (or (memq 'd-m-y possible-formats)
                             (memq 'm-d-y possible-formats))
-                        (parse-check-date-format date-mdy possible-formats)))))))))
+                        (parse-check-date-format date-mdy possible-formats)
+                        '()))))
+             #f))))
 
 ;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
 ;;  qif-parse:parse-date/format
@@ -310,6 +332,11 @@
 ;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
 
 (define (qif-parse:parse-date/format date-string dateformat)
+  (if native-parse-date/format
+      (native-parse-date/format date-string dateformat)
+      (scheme-parse-date/format date-string dateformat)))
+
+(define (scheme-parse-date/format date-string dateformat)
   (define (date? d m y)
     (and (number? d) (<= 1 d 31)
          (number? m) (<= 1 m 12)))
@@ -356,7 +383,7 @@
      ((eq? dateformat 'd-m-y) (refs->list 0 1 2))
      ((eq? dateformat 'm-d-y) (refs->list 1 0 2))
      ((eq? dateformat 'y-m-d) (refs->list 2 1 0))
-     ((eq? dateformat 'y-d-m) (refs->list 2 0 1)))))
+     ((eq? dateformat 'y-d-m) (refs->list 1 2 0)))))
 
 ;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
 ;;  number format predicates
@@ -385,6 +412,11 @@
 ;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
 
 (define (qif-parse:check-number-format value-string possible-formats)
+  (if native-check-number-format
+      (native-check-number-format value-string possible-formats)
+      (scheme-check-number-format value-string possible-formats)))
+
+(define (scheme-check-number-format value-string possible-formats)
   (define numtypes-alist
     (list (cons 'decimal decimal-radix-regexp)
           (cons 'comma comma-radix-regexp)
@@ -399,8 +431,14 @@
 ;;  represent the number
 ;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
 
-;; the following is a working refactored function
+;; the following is a working refactored function. The native parser
+;; only reads plain numbers, and returns #f for anything else.
 (define (qif-parse:parse-number/format value-string format)
+  (or (and native-parse-number/format
+           (native-parse-number/format value-string format))
+      (scheme-parse-number/format value-string format)))
+
+(define (scheme-parse-number/format value-string format)
   (let* ((has-minus? (string-index value-string #\-))
          (filtered-string (gnc:string-delete-chars value-string "$'+-"))
          (read-string (case format
@@ -35,6 +35,9 @@
 (define (n* a b) (gnc-numeric-mul a b 0 GNC-DENOM-REDUCE))
 (define (n/ a b) (gnc-numeric-div a b 0 GNC-DENOM-REDUCE))
 
+(define native-xtn-to-gnc-xtn
+  (qif-import:native-procedure 'qif-import:xtn-to-gnc-xtn))
+
 ;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
 ;;  qif-import:find-or-make-acct
 ;;
@@ -417,14 +420,22 @@
                   ;; user-specified currency. Use it for the txn too.
                   (xaccTransSetCurrency gnc-xtn default-currency)
 
-                  ;; Build the transaction.
-                  (qif-import:qif-xtn-to-gnc-xtn xtn qif-file gnc-xtn
-                                                 gnc-acct-hash
-                                                 qif-acct-map
-                                                 qif-cat-map
-                                                 qif-memo-map
-                                                 transaction-status-pref
-                                                 progress-dialog)
+                  ;; Build the transaction. The Scheme converter
+                  ;; logs a missing date, so it gets those.
+                  (if (and native-xtn-to-gnc-xtn (qif-xtn:date xtn))
+                      (qif-import:native-xtn-to-gnc-xtn xtn gnc-xtn
+                                                        gnc-acct-hash
+                                                        qif-acct-map
+                                                        qif-cat-map
+                                                        qif-memo-map
+                                                        transaction-status-pref)
+                      (qif-import:qif-xtn-to-gnc-xtn xtn qif-file gnc-xtn
+                                                     gnc-acct-hash
+                                                     qif-acct-map
+                                                     qif-cat-map
+                                                     qif-memo-map
+                                                     transaction-status-pref
+                                                     progress-dialog))
 
                   ;; rebalance and commit everything
                   (xaccTransCommitEdit gnc-xtn))))
@@ -803,6 +814,58 @@
     gnc-xtn))
 
 
+;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+;; qif-import:native-xtn-to-gnc-xtn
+;; the same as qif-import:qif-xtn-to-gnc-xtn, done by
+;; qif-import-native.c. The transaction's fields are passed as
+;; vectors, and the maps are looked up through a procedure.
+;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+
+(define (qif-import:native-xtn-to-gnc-xtn qif-xtn gnc-xtn
+                                          gnc-acct-hash
+                                          qif-acct-map qif-cat-map qif-memo-map
+                                          transaction-status-pref)
+  (define (split-fields qif-split)
+    (vector (qif-split:category qif-split)
+            (qif-split:category-is-account? qif-split)
+            (qif-split:memo qif-split)
+            (qif-split:amount qif-split)
+            (qif-split:matching-cleared qif-split)
+            (qif-split:mark qif-split)))
+
+  (define (map-lookup map qif-name)
+    (let ((info (hash-ref (case map
+                            ((account) qif-acct-map)
+                            ((category) qif-cat-map)
+                            (else qif-memo-map))
+                          qif-name)))
+      (and info (qif-map-entry:gnc-name info))))
+
+  (let ((splits (qif-xtn:splits qif-xtn))
+        (default-split (qif-xtn:default-split qif-xtn)))
+    (native-xtn-to-gnc-xtn
+     gnc-xtn
+     (vector (qif-xtn:date qif-xtn)
+             (qif-xtn:payee qif-xtn)
+             (qif-xtn:number qif-xtn)
+             (qif-xtn:action qif-xtn)
+             (qif-xtn:cleared qif-xtn)
+             (qif-xtn:security-name qif-xtn)
+             (qif-xtn:from-acct qif-xtn)
+             (qif-xtn:share-price qif-xtn)
+             (qif-xtn:num-shares qif-xtn)
+             (qif-xtn:commission qif-xtn)
+             (and default-split #t)
+             (and default-split (qif-split:memo default-split))
+             (and (qif-xtn:security-name qif-xtn)
+                  (qif-split:accounts-affected (car splits) qif-xtn)))
+     (map split-fields splits)
+     map-lookup
+     gnc-acct-hash
+     (default-unspec-acct)
+     transaction-status-pref)))
+
+
 ;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
 ;;  qif-import:mark-matching-xtns
 ;;  find transactions that are the "opposite half" of xtn and
@@ -54,3 +54,12 @@
   (while (and qif-import:paused (not qif-import:canceled))
     (gnc-progress-dialog-update progress-dialog)))
 
+
+;; The procedures of the (gnucash qif-import native) module are defined
+;; when the QIF import plugin is loaded. Without them, callers do the
+;; same work in Scheme.
+(define (qif-import:native-procedure name)
+  (let ((module (resolve-module '(gnucash qif-import native) #f #:ensure #f)))
+    (and module
+         (module-defined? module name)
+         (module-ref module name))))
@@ -0,0 +1,848 @@
+/********************************************************************\
+ * test-qif-import-native.c -- tests for the native QIF helpers     *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+\********************************************************************/
+
+#include <config.h>
+
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <locale.h>
+#include <unistd.h>
+
+#include <qof.h>
+#include "Account.h"
+#include "Transaction.h"
+#include "TransLog.h"
+#include "cashobjects.h"
+#include "gnc-commodity.h"
+#include "gnc-session.h"
+#include "qif-import-native.h"
+
+#define DAY_SECS (60 * 60 * 24)
+
+static QofBook *
+test_book (void)
+{
+    return qof_session_get_book (gnc_get_current_session ());
+}
+
+/* Write contents, len bytes of it, to a new file and return its name. */
+static gchar *
+write_qif (const gchar *contents, gssize len)
+{
+    gchar *path;
+    gint fd = g_file_open_tmp ("test-qif-XXXXXX.qif", &path, NULL);
+
+    g_assert_cmpint (fd, !=, -1);
+    close (fd);
+    g_assert_true (g_file_set_contents (path, contents, len, NULL));
+    return path;
+}
+
+/********************************************************************\
+ * Reading
+\********************************************************************/
+
+static void
+test_reader_line_ends (void)
+{
+    gchar *path = write_qif ("!Type:Bank\rD01/02/2003\r\nT-1.00\n\n^", -1);
+    GncQifReader *reader = gnc_qif_reader_new (path);
+    GncQifLineStatus status;
+    gunichar tag;
+    gchar *value;
+
+    g_assert_nonnull (reader);
+
+    g_assert_true (gnc_qif_reader_next (reader, &tag, &value, &status));
+    g_assert_cmpint (tag, ==, '!');
+    g_assert_cmpstr (value, ==, "Type:Bank");
+    g_assert_cmpint (status, ==, GNC_QIF_LINE_OK);
+    g_assert_cmpuint (gnc_qif_reader_get_line_num (reader), ==, 1);
+    g_free (value);
+
+    g_assert_true (gnc_qif_reader_next (reader, &tag, &value, &status));
+    g_assert_cmpint (tag, ==, 'D');
+    g_assert_cmpstr (value, ==, "01/02/2003");
+    g_assert_cmpuint (gnc_qif_reader_get_line_num (reader), ==, 2);
+    g_free (value);
+
+    /* The CR LF pair ends one line and starts an empty one, which is
+     * counted but not returned. */
+    g_assert_true (gnc_qif_reader_next (reader, &tag, &value, &status));
+    g_assert_cmpint (tag, ==, 'T');
+    g_assert_cmpstr (value, ==, "-1.00");
+    g_assert_cmpuint (gnc_qif_reader_get_line_num (reader), ==, 4);
+    g_free (value);
+
+    g_assert_true (gnc_qif_reader_next (reader, &tag, &value, &status));
+    g_assert_cmpint (tag, ==, '^');
+    g_assert_cmpstr (value, ==, "");
+    g_assert_cmpuint (gnc_qif_reader_get_line_num (reader), ==, 6);
+    g_free (value);
+
+    g_assert_false (gnc_qif_reader_next (reader, &tag, &value, &status));
+    g_assert_cmpfloat (gnc_qif_reader_get_fraction (reader), ==, 1.0);
+
+    gnc_qif_reader_free (reader);
+    g_unlink (path);
+    g_free (path);
+}
+
+static void
+test_reader_bom (void)
+{
+    gchar *path = write_qif ("\xEF\xBB\xBF!Type:Cash\nPCaf\xC3\xA9\n", -1);
+    GncQifReader *reader = gnc_qif_reader_new (path);
+    GncQifLineStatus status;
+    gunichar tag;
+    gchar *value;
+
+    g_assert_true (gnc_qif_reader_next (reader, &tag, &value, &status));
+    g_assert_cmpint (tag, ==, '!');
+    g_assert_cmpstr (value, ==, "Type:Cash");
+    g_free (value);
+
+    /* Only a leading byte order mark is skipped. */
+    g_assert_true (gnc_qif_reader_next (reader, &tag, &value, &status));
+    g_assert_cmpint (tag, ==, 'P');
+    g_assert_cmpstr (value, ==, "Caf\xC3\xA9");
+    g_assert_cmpint (status, ==, GNC_QIF_LINE_OK);
+    g_free (value);
+
+    gnc_qif_reader_free (reader);
+    g_unlink (path);
+    g_free (path);
+}
+
+static void
+test_reader_invalid_utf8 (void)
+{
+    gchar *path = write_qif ("PCaf\xE9\nM\xFF\xFEok\n", -1);
+    GncQifReader *reader;
+    GncQifLineStatus status;
+    gunichar tag;
+    gchar *value;
+
+    /* In the C locale, nothing converts the stray bytes. */
+    g_unsetenv ("CHARSET");
+    setlocale (LC_ALL, "C");
+    reader = gnc_qif_reader_new (path);
+
+    g_assert_true (gnc_qif_reader_next (reader, &tag, &value, &status));
+    g_assert_cmpint (tag, ==, 'P');
+    g_assert_cmpstr (value, ==, "Caf");
+    g_assert_cmpint (status, ==, GNC_QIF_LINE_STRIPPED);
+    g_free (value);
+
+    g_assert_true (gnc_qif_reader_next (reader, &tag, &value, &status));
+    g_assert_cmpint (tag, ==, 'M');
+    g_assert_cmpstr (value, ==, "ok");
+    g_assert_cmpint (status, ==, GNC_QIF_LINE_STRIPPED);
+    g_free (value);
+
+    gnc_qif_reader_free (reader);
+    g_unlink (path);
+    g_free (path);
+}
+
+static void
+test_reader_missing_file (void)
+{
+    g_assert_null (gnc_qif_reader_new ("/nonexistent/test.qif"));
+}
+
+/********************************************************************\
+ * Field parsing, as test-qif-parse.scm checks qif-parse.scm
+\********************************************************************/
+
+static void
+test_fix_year (void)
+{
+    gint year;
+
+    g_assert_true (gnc_qif_fix_year ("1998", 50, &year));
+    g_assert_cmpint (year, ==, 1998);
+    g_assert_true (gnc_qif_fix_year ("' 0", 50, &year));
+    g_assert_cmpint (year, ==, 2000);
+    g_assert_true (gnc_qif_fix_year ("98", 50, &year));
+    g_assert_cmpint (year, ==, 1998);
+    g_assert_true (gnc_qif_fix_year ("48", 50, &year));
+    g_assert_cmpint (year, ==, 2048);
+    g_assert_true (gnc_qif_fix_year ("19134", 50, &year));
+    g_assert_cmpint (year, ==, 2034);
+    g_assert_true (gnc_qif_fix_year ("102", 50, &year));
+    g_assert_cmpint (year, ==, 2002);
+    g_assert_false (gnc_qif_fix_year ("abc", 50, &year));
+}
+
+static void
+check_date_formats (const gchar *str, const GncQifDateFormat *formats,
+                    gint n_expected, const GncQifDateFormat *expected)
+{
+    GncQifDateFormat result[8];
+    gint i, n = gnc_qif_check_date_format (str, formats, 4, result);
+
+    g_assert_cmpint (n, ==, n_expected);
+    for (i = 0; i < n; i++)
+        g_assert_cmpint (result[i], ==, expected[i]);
+}
+
+static void
+test_check_date_format (void)
+{
+    const GncQifDateFormat dymy[] =
+    {
+        GNC_QIF_DATE_D_M_Y, GNC_QIF_DATE_Y_M_D,
+        GNC_QIF_DATE_Y_D_M, GNC_QIF_DATE_M_D_Y
+    };
+    const GncQifDateFormat dmyy[] =
+    {
+        GNC_QIF_DATE_D_M_Y, GNC_QIF_DATE_Y_M_D,
+        GNC_QIF_DATE_M_D_Y, GNC_QIF_DATE_Y_D_M
+    };
+    const GncQifDateFormat dmy[] = { GNC_QIF_DATE_D_M_Y };
+    const GncQifDateFormat dmy_mdy[] = { GNC_QIF_DATE_D_M_Y, GNC_QIF_DATE_M_D_Y };
+    const GncQifDateFormat ymd_ydm[] = { GNC_QIF_DATE_Y_M_D, GNC_QIF_DATE_Y_D_M };
+
+    check_date_formats ("20/02/1981", dymy, 1, dmy);
+    check_date_formats ("12/02/1981", dymy, 2, dmy_mdy);
+    check_date_formats ("1979/03/03", dmyy, 2, ymd_ydm);
+    check_date_formats ("03/03/79", dmyy, 2, dmy_mdy);
+    check_date_formats ("03121984", dmyy, 2, dmy_mdy);
+    check_date_formats ("19790303", dmyy, 2, ymd_ydm);
+    check_date_formats ("not a date", dmyy, -1, NULL);
+    check_date_formats ("", dmyy, -1, NULL);
+}
+
+static void
+test_parse_date (void)
+{
+    gint day, month, year;
+
+    g_assert_true (gnc_qif_parse_date ("31/01/81", GNC_QIF_DATE_D_M_Y,
+                                       &day, &month, &year));
+    g_assert_cmpint (day, ==, 31);
+    g_assert_cmpint (month, ==, 1);
+    g_assert_cmpint (year, ==, 1981);
+
+    g_assert_false (gnc_qif_parse_date ("31/01/81", GNC_QIF_DATE_M_D_Y,
+                                        &day, &month, &year));
+
+    g_assert_true (gnc_qif_parse_date ("1999/31/12", GNC_QIF_DATE_Y_D_M,
+                                       &day, &month, &year));
+    g_assert_cmpint (day, ==, 31);
+    g_assert_cmpint (month, ==, 12);
+    g_assert_cmpint (year, ==, 1999);
+
+    g_assert_true (gnc_qif_parse_date ("20012311", GNC_QIF_DATE_Y_D_M,
+                                       &day, &month, &year));
+    g_assert_cmpint (day, ==, 23);
+    g_assert_cmpint (month, ==, 11);
+    g_assert_cmpint (year, ==, 2001);
+
+    g_assert_true (gnc_qif_parse_date ("01171983", GNC_QIF_DATE_M_D_Y,
+                                       &day, &month, &year));
+    g_assert_cmpint (day, ==, 17);
+    g_assert_cmpint (month, ==, 1);
+    g_assert_cmpint (year, ==, 1983);
+}
+
+static void
+check_number_formats (const gchar *str, guint n_expected,
+                      const GncQifNumberFormat *expected)
+{
+    GncQifNumberFormat formats[] =
+    {
+        GNC_QIF_NUMBER_COMMA, GNC_QIF_NUMBER_INTEGER, GNC_QIF_NUMBER_DECIMAL
+    };
+    guint i, n = gnc_qif_check_number_format (str, formats, 3);
+
+    g_assert_cmpuint (n, ==, n_expected);
+    for (i = 0; i < n; i++)
+        g_assert_cmpint (formats[i], ==, expected[i]);
+}
+
+static void
+test_check_number_format (void)
+{
+    const GncQifNumberFormat all[] =
+    {
+        GNC_QIF_NUMBER_COMMA, GNC_QIF_NUMBER_INTEGER, GNC_QIF_NUMBER_DECIMAL
+    };
+    const GncQifNumberFormat comma[] = { GNC_QIF_NUMBER_COMMA };
+    const GncQifNumberFormat decimal[] = { GNC_QIF_NUMBER_DECIMAL };
+
+    check_number_formats ("1,00", 1, comma);
+    check_number_formats ("999", 3, all);
+    check_number_formats ("999.20", 1, decimal);
+    check_number_formats ("9.200,99", 1, comma);
+    check_number_formats ("$1000", 3, all);
+    check_number_formats ("*", 0, NULL);
+}
+
+static void
+check_number (const gchar *str, GncQifNumberFormat format,
+              gint64 num, gint64 denom)
+{
+    gnc_numeric number;
+
+    g_assert_true (gnc_qif_parse_number (str, format, &number));
+    g_assert_true (gnc_numeric_equal (number, gnc_numeric_create (num, denom)));
+}
+
+static void
+test_parse_number (void)
+{
+    gnc_numeric number;
+
+    check_number ("1,23", GNC_QIF_NUMBER_COMMA, 123, 100);
+    check_number ("1,234.00", GNC_QIF_NUMBER_DECIMAL, 1234, 1);
+    check_number ("-1234", GNC_QIF_NUMBER_INTEGER, -1234, 1);
+    check_number ("1234-", GNC_QIF_NUMBER_INTEGER, -1234, 1);
+    check_number ("1234", GNC_QIF_NUMBER_INTEGER, 1234, 1);
+    check_number ("$2'000,50", GNC_QIF_NUMBER_COMMA, 200050, 100);
+
+    /* Left to the Scheme parser. */
+    g_assert_false (gnc_qif_parse_number ("1e5", GNC_QIF_NUMBER_DECIMAL,
+                                          &number));
+    g_assert_false (gnc_qif_parse_number ("", GNC_QIF_NUMBER_DECIMAL,
+                                          &number));
+}
+
+static void
+check_category (const gchar *str, const gchar *name, gboolean is_account,
+                const gchar *class_name, const gchar *miscx_name,
+                gboolean miscx_is_account, const gchar *miscx_class)
+{
+    GncQifCategory category;
+
+    g_assert_true (gnc_qif_parse_category (str, &category));
+    g_assert_cmpstr (category.name, ==, name);
+    g_assert_cmpint (category.is_account, ==, is_account);
+    g_assert_cmpstr (category.class_name, ==, class_name);
+    g_assert_cmpstr (category.miscx_name, ==, miscx_name);
+    g_assert_cmpint (category.miscx_is_account, ==, miscx_is_account);
+    g_assert_cmpstr (category.miscx_class, ==, miscx_class);
+    gnc_qif_category_clear (&category);
+}
+
+static void
+test_parse_category (void)
+{
+    check_category ("[Transfer]/Class", "Transfer", TRUE, "Class",
+                    NULL, FALSE, NULL);
+    check_category ("Category/Class", "Category", FALSE, "Class",
+                    NULL, FALSE, NULL);
+    check_category ("Category", "Category", FALSE, "", NULL, FALSE, NULL);
+    check_category ("[Transfer]", "Transfer", TRUE, "", NULL, FALSE, NULL);
+    check_category ("Category/|miscx-category", "Category", FALSE, "",
+                    "miscx-category", FALSE, "");
+    check_category ("[Transfer]/Class|miscx-category/miscx-class",
+                    "Transfer", TRUE, "Class",
+                    "miscx-category", FALSE, "miscx-class");
+    check_category ("Category/|[miscx-account]/miscx-class",
+                    "Category", FALSE, "", "miscx-account", TRUE,
+                    "miscx-class");
+}
+
+/********************************************************************\
+ * Conversion and duplicate detection
+\********************************************************************/
+
+typedef struct
+{
+    gnc_commodity *currency;
+    gnc_commodity *security;
+    Account *root;
+    GHashTable *accounts;
+    GHashTable *maps[3];
+} Fixture;
+
+static Account *
+fixture_account (Fixture *fixture, Account *parent, const gchar *name,
+                 gnc_commodity *commodity)
+{
+    Account *account = xaccMallocAccount (test_book ());
+
+    xaccAccountBeginEdit (account);
+    xaccAccountSetName (account, name);
+    xaccAccountSetCommodity (account, commodity);
+    xaccAccountCommitEdit (account);
+    gnc_account_append_child (parent, account);
+    g_hash_table_insert (fixture->accounts, gnc_account_get_full_name (account),
+                         account);
+    return account;
+}
+
+static void
+setup (Fixture *fixture, gconstpointer data)
+{
+    QofBook *book = test_book ();
+    guint i;
+
+    fixture->currency = gnc_commodity_new (book, "US Dollar", "CURRENCY",
+                                           "USD", "840", 100);
+    fixture->security = gnc_commodity_new (book, "Acme", "NYSE", "ACME",
+                                           NULL, 1000);
+    fixture->root = xaccMallocAccount (book);
+    fixture->accounts = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                               g_free, NULL);
+    for (i = 0; i < G_N_ELEMENTS (fixture->maps); i++)
+        fixture->maps[i] = g_hash_table_new (g_str_hash, g_str_equal);
+}
+
+static void
+teardown (Fixture *fixture, gconstpointer data)
+{
+    guint i;
+
+    g_hash_table_destroy (fixture->accounts);
+    for (i = 0; i < G_N_ELEMENTS (fixture->maps); i++)
+        g_hash_table_destroy (fixture->maps[i]);
+}
+
+static const gchar *
+fixture_map_lookup (GncQifMap map, const gchar *qif_name, gpointer user_data)
+{
+    Fixture *fixture = user_data;
+    return g_hash_table_lookup (fixture->maps[map], qif_name);
+}
+
+static Account *
+fixture_account_lookup (const gchar *gnc_name, gpointer user_data)
+{
+    Fixture *fixture = user_data;
+    return g_hash_table_lookup (fixture->accounts, gnc_name);
+}
+
+static Transaction *
+fixture_trans_begin (Fixture *fixture)
+{
+    Transaction *trans = xaccMallocTransaction (test_book ());
+
+    xaccTransBeginEdit (trans);
+    xaccTransSetCurrency (trans, fixture->currency);
+    return trans;
+}
+
+static void
+fixture_converter (Fixture *fixture, GncQifConverter *converter)
+{
+    converter->map_lookup = fixture_map_lookup;
+    converter->account_lookup = fixture_account_lookup;
+    converter->user_data = fixture;
+    converter->unspec_name = "Unspecified";
+    converter->status_pref = NREC;
+}
+
+static void
+test_convert_bank (Fixture *fixture, gconstpointer data)
+{
+    Account *assets = fixture_account (fixture, fixture->root, "Assets",
+                                       fixture->currency);
+    Account *checking = fixture_account (fixture, assets, "Checking",
+                                         fixture->currency);
+    Account *food = fixture_account (fixture, fixture->root, "Food",
+                                     fixture->currency);
+    Account *unspec = fixture_account (fixture, fixture->root, "Unspecified",
+                                       fixture->currency);
+    GncQifSplitInfo splits[] =
+    {
+        { "Groceries", FALSE, "bread", TRUE, { -1250, 100 },
+          GNC_QIF_RECONCILED, FALSE },
+        { "", FALSE, "tip", TRUE, { -250, 100 }, GNC_QIF_UNCLEARED, FALSE },
+    };
+    GncQifXtnInfo xtn = { 0 };
+    GncQifConverter converter;
+    Transaction *trans = fixture_trans_begin (fixture);
+    Split *split;
+    GDate date;
+
+    g_hash_table_insert (fixture->maps[GNC_QIF_MAP_ACCOUNT], "Bank",
+                         "Assets:Checking");
+    g_hash_table_insert (fixture->maps[GNC_QIF_MAP_CATEGORY], "Groceries",
+                         "Food");
+    fixture_converter (fixture, &converter);
+
+    xtn.day = 3;
+    xtn.month = 4;
+    xtn.year = 2021;
+    xtn.payee = "Market";
+    xtn.cleared = GNC_QIF_CLEARED;
+    xtn.from_acct = "Bank";
+    xtn.has_default_split = TRUE;
+    xtn.default_memo = "weekly shop";
+    xtn.splits = splits;
+    xtn.n_splits = G_N_ELEMENTS (splits);
+
+    g_assert_true (gnc_qif_xtn_to_gnc_xtn (&xtn, &converter, trans));
+
+    date = xaccTransGetDatePostedGDate (trans);
+    g_assert_cmpint (g_date_get_day (&date), ==, 3);
+    g_assert_cmpint (g_date_get_month (&date), ==, 4);
+    g_assert_cmpint (g_date_get_year (&date), ==, 2021);
+    g_assert_cmpstr (xaccTransGetDescription (trans), ==, "Market");
+    g_assert_cmpstr (xaccTransGetNotes (trans), ==, "weekly shop");
+    g_assert_cmpint (xaccTransCountSplits (trans), ==, 3);
+
+    split = xaccTransFindSplitByAccount (trans, checking);
+    g_assert_nonnull (split);
+    g_assert_true (gnc_numeric_equal (xaccSplitGetValue (split),
+                                      gnc_numeric_create (-1500, 100)));
+    g_assert_cmpint (xaccSplitGetReconcile (split), ==, CREC);
+
+    split = xaccTransFindSplitByAccount (trans, food);
+    g_assert_nonnull (split);
+    g_assert_true (gnc_numeric_equal (xaccSplitGetValue (split),
+                                      gnc_numeric_create (1250, 100)));
+    g_assert_cmpstr (xaccSplitGetMemo (split), ==, "bread");
+    g_assert_cmpint (xaccSplitGetReconcile (split), ==, YREC);
+
+    /* An unmapped split goes to the default account. */
+    split = xaccTransFindSplitByAccount (trans, unspec);
+    g_assert_nonnull (split);
+    g_assert_true (gnc_numeric_equal (xaccSplitGetValue (split),
+                                      gnc_numeric_create (250, 100)));
+    g_assert_cmpint (xaccSplitGetReconcile (split), ==, NREC);
+
+    xaccTransCommitEdit (trans);
+}
+
+static void
+test_convert_unmapped (Fixture *fixture, gconstpointer data)
+{
+    GncQifSplitInfo split = { "", FALSE, NULL, TRUE, { 100, 1 },
+                              GNC_QIF_UNCLEARED, FALSE };
+    GncQifXtnInfo xtn = { 0 };
+    GncQifConverter converter;
+    Transaction *trans = fixture_trans_begin (fixture);
+
+    fixture_converter (fixture, &converter);
+    xtn.from_acct = "Bank";
+    xtn.payee = "Nobody";
+    xtn.splits = &split;
+    xtn.n_splits = 1;
+
+    /* Neither a date nor a mapped account: the transaction is left
+     * alone. */
+    g_assert_false (gnc_qif_xtn_to_gnc_xtn (&xtn, &converter, trans));
+    xtn.day = xtn.month = 1;
+    xtn.year = 2020;
+    g_assert_false (gnc_qif_xtn_to_gnc_xtn (&xtn, &converter, trans));
+    g_assert_cmpint (xaccTransCountSplits (trans), ==, 0);
+    g_assert_cmpstr (xaccTransGetDescription (trans), ==, "");
+
+    xaccTransDestroy (trans);
+    xaccTransCommitEdit (trans);
+}
+
+static void
+test_convert_stock (Fixture *fixture, gconstpointer data)
+{
+    Account *broker = fixture_account (fixture, fixture->root, "Broker",
+                                       fixture->currency);
+    Account *acme = fixture_account (fixture, broker, "ACME",
+                                     fixture->security);
+    Account *fees = fixture_account (fixture, fixture->root, "Fees",
+                                     fixture->currency);
+    GncQifSplitInfo split = { "", FALSE, NULL, TRUE, { 5200, 100 },
+                              GNC_QIF_UNCLEARED, FALSE };
+    GncQifXtnInfo xtn = { 0 };
+    GncQifConverter converter;
+    Transaction *trans = fixture_trans_begin (fixture);
+    Split *gnc_split;
+
+    g_hash_table_insert (fixture->maps[GNC_QIF_MAP_ACCOUNT], "Broker",
+                         "Broker");
+    g_hash_table_insert (fixture->maps[GNC_QIF_MAP_ACCOUNT], "Broker:ACME",
+                         "Broker:ACME");
+    g_hash_table_insert (fixture->maps[GNC_QIF_MAP_CATEGORY], "Commission",
+                         "Fees");
+    fixture_converter (fixture, &converter);
+
+    xtn.day = 15;
+    xtn.month = 6;
+    xtn.year = 2020;
+    xtn.action = GNC_QIF_ACTION_BUY;
+    xtn.security = "ACME";
+    xtn.from_acct = "Broker";
+    xtn.has_share_price = xtn.has_num_shares = xtn.has_commission = TRUE;
+    xtn.share_price = gnc_numeric_create (5, 1);
+    xtn.num_shares = gnc_numeric_create (10, 1);
+    xtn.commission = gnc_numeric_create (200, 100);
+    xtn.near_acct = "Broker:ACME";
+    xtn.far_acct = "Broker";
+    xtn.commission_acct = "Commission";
+    xtn.splits = &split;
+    xtn.n_splits = 1;
+
+    g_assert_true (gnc_qif_xtn_to_gnc_xtn (&xtn, &converter, trans));
+    g_assert_cmpint (xaccTransCountSplits (trans), ==, 3);
+
+    /* The shares are worth the total less the commission. */
+    gnc_split = xaccTransFindSplitByAccount (trans, acme);
+    g_assert_true (gnc_numeric_equal (xaccSplitGetAmount (gnc_split),
+                                      gnc_numeric_create (10, 1)));
+    g_assert_true (gnc_numeric_equal (xaccSplitGetValue (gnc_split),
+                                      gnc_numeric_create (5000, 100)));
+
+    gnc_split = xaccTransFindSplitByAccount (trans, broker);
+    g_assert_true (gnc_numeric_equal (xaccSplitGetValue (gnc_split),
+                                      gnc_numeric_create (-5200, 100)));
+
+    gnc_split = xaccTransFindSplitByAccount (trans, fees);
+    g_assert_true (gnc_numeric_equal (xaccSplitGetValue (gnc_split),
+                                      gnc_numeric_create (200, 100)));
+
+    xaccTransCommitEdit (trans);
+}
+
+/* Make a transaction posted days after 2020-01-01 moving value from
+ * other into account, and return its split in account. */
+static Split *
+fixture_trans (Fixture *fixture, Account *account, Account *other,
+               gint days, gint64 value)
+{
+    Transaction *trans = fixture_trans_begin (fixture);
+    Split *split = xaccMallocSplit (test_book ());
+    Split *other_split = xaccMallocSplit (test_book ());
+
+    xaccTransSetDatePostedSecsNormalized (trans, gnc_dmy2time64_neutral (1, 1, 2020)
+                                          + (time64)days * DAY_SECS);
+    xaccSplitSetParent (split, trans);
+    xaccSplitSetAccount (split, account);
+    xaccSplitSetValue (split, gnc_numeric_create (value, 100));
+    xaccSplitSetAmount (split, gnc_numeric_create (value, 100));
+    xaccSplitSetParent (other_split, trans);
+    xaccSplitSetAccount (other_split, other);
+    xaccSplitSetValue (other_split, gnc_numeric_create (-value, 100));
+    xaccSplitSetAmount (other_split, gnc_numeric_create (-value, 100));
+    xaccTransCommitEdit (trans);
+    return split;
+}
+
+typedef struct
+{
+    Account *new_bank, *new_other, *old_bank, *old_other;
+} DuplicateTrees;
+
+/* Two trees whose accounts have the same full names. */
+static void
+duplicate_trees_init (DuplicateTrees *trees, Fixture *fixture)
+{
+    Account *new_root = xaccMallocAccount (test_book ());
+
+    trees->old_bank = fixture_account (fixture, fixture->root, "Bank",
+                                       fixture->currency);
+    trees->old_other = fixture_account (fixture, fixture->root, "Other",
+                                        fixture->currency);
+    trees->new_bank = xaccMallocAccount (test_book ());
+    xaccAccountSetName (trees->new_bank, "Bank");
+    xaccAccountSetCommodity (trees->new_bank, fixture->currency);
+    gnc_account_append_child (new_root, trees->new_bank);
+    trees->new_other = xaccMallocAccount (test_book ());
+    xaccAccountSetName (trees->new_other, "Other");
+    xaccAccountSetCommodity (trees->new_other, fixture->currency);
+    gnc_account_append_child (new_root, trees->new_other);
+}
+
+static void
+test_find_duplicates (Fixture *fixture, gconstpointer data)
+{
+    DuplicateTrees trees;
+    Split *old1, *old2, *old_far, *old_other;
+    Split *new1, *new2, *new3, *new3_other;
+    GList *old_splits = NULL, *new_splits = NULL, *duplicates = NULL;
+    GncQifDuplicate *duplicate;
+
+    duplicate_trees_init (&trees, fixture);
+
+    old1 = fixture_trans (fixture, trees.old_bank, trees.old_other, 10, 500);
+    old2 = fixture_trans (fixture, trees.old_bank, trees.old_other, 12, 500);
+    /* More than a week from new1. */
+    old_far = fixture_trans (fixture, trees.old_bank, trees.old_other, 25, 500);
+    old_other = fixture_trans (fixture, trees.old_bank, trees.old_other, 30, 700);
+    old_splits = g_list_append (old_splits, old2);
+    old_splits = g_list_append (old_splits, old_far);
+    old_splits = g_list_append (old_splits, old1);
+    old_splits = g_list_append (old_splits, old_other);
+    /* The other half of old_other's transaction. */
+    old_splits = g_list_append (old_splits,
+                                xaccSplitGetOtherSplit (old_other));
+
+    /* Exactly a week from old1 and five days from old2. */
+    new1 = fixture_trans (fixture, trees.new_bank, trees.new_other, 17, 500);
+    new2 = fixture_trans (fixture, trees.new_bank, trees.new_other, 17, 900);
+    new3 = fixture_trans (fixture, trees.new_bank, trees.new_other, 31, 700);
+    new3_other = xaccSplitGetOtherSplit (new3);
+    new_splits = g_list_append (new_splits, new1);
+    new_splits = g_list_append (new_splits, new2);
+    new_splits = g_list_append (new_splits, new3);
+    new_splits = g_list_append (new_splits, new3_other);
+
+    g_assert_true (gnc_qif_find_duplicates (new_splits, old_splits, NULL, NULL,
+                                            &duplicates));
+    g_assert_cmpuint (g_list_length (duplicates), ==, 2);
+
+    /* Candidates come in the order of the old splits. */
+    duplicate = duplicates->data;
+    g_assert_true (duplicate->new_trans == xaccSplitGetParent (new1));
+    g_assert_cmpuint (g_list_length (duplicate->old_trans), ==, 2);
+    g_assert_true (g_list_nth_data (duplicate->old_trans, 0) ==
+                   xaccSplitGetParent (old2));
+    g_assert_true (g_list_nth_data (duplicate->old_trans, 1) ==
+                   xaccSplitGetParent (old1));
+
+    /* new3 is reported once, for its first split. */
+    duplicate = duplicates->next->data;
+    g_assert_true (duplicate->new_trans == xaccSplitGetParent (new3));
+    g_assert_cmpuint (g_list_length (duplicate->old_trans), ==, 1);
+    g_assert_true (duplicate->old_trans->data == xaccSplitGetParent (old_other));
+
+    gnc_qif_duplicates_free (duplicates);
+    g_list_free (old_splits);
+    g_list_free (new_splits);
+}
+
+static void
+test_find_duplicates_window (Fixture *fixture, gconstpointer data)
+{
+    DuplicateTrees trees;
+    GList *old_splits = NULL, *new_splits = NULL, *duplicates = NULL;
+
+    duplicate_trees_init (&trees, fixture);
+    old_splits = g_list_append (old_splits,
+                                fixture_trans (fixture, trees.old_bank,
+                                               trees.old_other, 0, 500));
+    new_splits = g_list_append (new_splits,
+                                fixture_trans (fixture, trees.new_bank,
+                                               trees.new_other, 8, 500));
+    /* The same value in the other direction isn't a match either. */
+    new_splits = g_list_append (new_splits,
+                                fixture_trans (fixture, trees.new_bank,
+                                               trees.new_other, 1, -500));
+
+    g_assert_true (gnc_qif_find_duplicates (new_splits, old_splits, NULL, NULL,
+                                            &duplicates));
+    g_assert_null (duplicates);
+
+    g_list_free (old_splits);
+    g_list_free (new_splits);
+}
+
+typedef struct
+{
+    guint calls;
+    gdouble last;
+    guint cancel_after;
+} ProgressData;
+
+static gboolean
+progress_cb (gdouble fraction, gpointer user_data)
+{
+    ProgressData *progress = user_data;
+
+    g_assert_cmpfloat (fraction, >=, progress->last);
+    g_assert_cmpfloat (fraction, <, 1.0);
+    progress->last = fraction;
+    return ++progress->calls < progress->cancel_after;
+}
+
+static void
+test_find_duplicates_progress (Fixture *fixture, gconstpointer data)
+{
+    DuplicateTrees trees;
+    GList *old_splits = NULL, *new_splits = NULL, *duplicates = NULL;
+    ProgressData progress = { 0, 0.0, G_MAXUINT };
+    gint i;
+
+    duplicate_trees_init (&trees, fixture);
+    old_splits = g_list_append (old_splits,
+                                fixture_trans (fixture, trees.old_bank,
+                                               trees.old_other, 0, 500));
+    for (i = 0; i < 20; i++)
+        new_splits = g_list_append (new_splits,
+                                    fixture_trans (fixture, trees.new_bank,
+                                                   trees.new_other, 0, 500));
+
+    /* Every eighth split: the 1st, 9th and 17th. */
+    g_assert_true (gnc_qif_find_duplicates (new_splits, old_splits,
+                                            progress_cb, &progress,
+                                            &duplicates));
+    g_assert_cmpuint (progress.calls, ==, 3);
+    g_assert_cmpuint (g_list_length (duplicates), ==, 20);
+    gnc_qif_duplicates_free (duplicates);
+
+    /* Returning FALSE cancels the search. */
+    progress.calls = 0;
+    progress.last = 0.0;
+    progress.cancel_after = 2;
+    duplicates = GINT_TO_POINTER (1);
+    g_assert_false (gnc_qif_find_duplicates (new_splits, old_splits,
+                                             progress_cb, &progress,
+                                             &duplicates));
+    g_assert_cmpuint (progress.calls, ==, 2);
+    g_assert_null (duplicates);
+
+    g_list_free (old_splits);
+    g_list_free (new_splits);
+}
+
+int
+main (int argc, char *argv[])
+{
+    qof_init ();
+    qof_log_init_filename_special ("stderr");
+    g_test_init (&argc, &argv, NULL);
+    xaccLogDisable ();
+    cashobjects_register ();
+
+    g_test_add_func ("/qif-import/native/reader/line-ends",
+                     test_reader_line_ends);
+    g_test_add_func ("/qif-import/native/reader/bom", test_reader_bom);
+    g_test_add_func ("/qif-import/native/reader/invalid-utf8",
+                     test_reader_invalid_utf8);
+    g_test_add_func ("/qif-import/native/reader/missing-file",
+                     test_reader_missing_file);
+    g_test_add_func ("/qif-import/native/parse/fix-year", test_fix_year);
+    g_test_add_func ("/qif-import/native/parse/check-date-format",
+                     test_check_date_format);
+    g_test_add_func ("/qif-import/native/parse/date", test_parse_date);
+    g_test_add_func ("/qif-import/native/parse/check-number-format",
+                     test_check_number_format);
+    g_test_add_func ("/qif-import/native/parse/number", test_parse_number);
+    g_test_add_func ("/qif-import/native/parse/category",
+                     test_parse_category);
+    g_test_add ("/qif-import/native/convert/bank", Fixture, NULL,
+                setup, test_convert_bank, teardown);
+    g_test_add ("/qif-import/native/convert/unmapped", Fixture, NULL,
+                setup, test_convert_unmapped, teardown);
+    g_test_add ("/qif-import/native/convert/stock", Fixture, NULL,
+                setup, test_convert_stock, teardown);
+    g_test_add ("/qif-import/native/duplicates/order", Fixture, NULL,
+                setup, test_find_duplicates, teardown);
+    g_test_add ("/qif-import/native/duplicates/window", Fixture, NULL,
+                setup, test_find_duplicates_window, teardown);
+    g_test_add ("/qif-import/native/duplicates/progress", Fixture, NULL,
+                setup, test_find_duplicates_progress, teardown);
+
+    return g_test_run ();
+}
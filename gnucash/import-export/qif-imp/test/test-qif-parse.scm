@@ -172,7 +172,20 @@
     '(y-m-d y-d-m)
     (qif-parse:check-date-format
      "19790303"
-     '(d-m-y y-m-d m-d-y y-d-m))))
+     '(d-m-y y-m-d m-d-y y-d-m)))
+
+  ;; eight digits with only one of the two families of formats asked for
+  (test-equal "qif-parse:check-date-format 19791231 y-m-d only"
+    '(y-m-d)
+    (qif-parse:check-date-format "19791231" '(y-m-d)))
+
+  (test-equal "qif-parse:check-date-format 12311979 m-d-y only"
+    '(m-d-y)
+    (qif-parse:check-date-format "12311979" '(m-d-y)))
+
+  (test-equal "qif-parse:check-date-format not a date"
+    #f
+    (qif-parse:check-date-format "today" '(d-m-y y-m-d m-d-y y-d-m))))
 
 
 
@@ -185,7 +198,19 @@
 
   (test-equal "qif-parse:parse-date/format error"
     #f
-    (qif-parse:parse-date/format "31/01/81" 'm-d-y)))
+    (qif-parse:parse-date/format "31/01/81" 'm-d-y))
+
+  (test-equal "qif-parse:parse-date/format y-d-m"
+    (list 31 12 1999)
+    (qif-parse:parse-date/format "1999/31/12" 'y-d-m))
+
+  (test-equal "qif-parse:parse-date/format y-d-m eight digits"
+    (list 31 12 1999)
+    (qif-parse:parse-date/format "19993112" 'y-d-m))
+
+  (test-equal "qif-parse:parse-date/format y-m-d"
+    (list 31 12 1999)
+    (qif-parse:parse-date/format "1999/12/31" 'y-m-d)))
 
 
 
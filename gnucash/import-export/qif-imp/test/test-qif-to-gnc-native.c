@@ -0,0 +1,380 @@
+/********************************************************************\
+ * test-qif-to-gnc-native.c -- compare the native and Scheme QIF    *
+ *                             transaction converters               *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+\********************************************************************/
+
+#include <config.h>
+
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <libguile.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <qof.h>
+#include "Account.h"
+#include "Transaction.h"
+#include "TransLog.h"
+#include "gnc-commodity.h"
+#include "gnc-session.h"
+#include "qif-import-native.h"
+#include "swig-runtime.h"
+
+/* The split amounts of the market transaction add up to a fraction
+ * that reduces, and the rent is too big for a comma radix. */
+static const gchar *bank_qif =
+    "!Account\n"
+    "NChecking\n"
+    "TBank\n"
+    "^\n"
+    "!Type:Bank\n"
+    "D1/15/2020\n"
+    "N1001\n"
+    "PLandlord\n"
+    "T-1,250.00\n"
+    "LRent\n"
+    "CX\n"
+    "^\n"
+    "D1/16/2020\n"
+    "PTransfer\n"
+    "T-200.00\n"
+    "L[Savings]\n"
+    "^\n"
+    "D1/17/2020\n"
+    "PMarket\n"
+    "Mweekly shop\n"
+    "T-15.00\n"
+    "C*\n"
+    "SGroceries\n"
+    "Ebread\n"
+    "$-10.25\n"
+    "SHousehold\n"
+    "Esoap\n"
+    "$-4.75\n"
+    "^\n"
+    "D1/18/2020\n"
+    "PKiosk\n"
+    "T-3.50\n"
+    "^\n";
+
+/* Share prices and quantities with more decimals than the currency,
+ * commissions on both sides, and a stock split of the shares bought
+ * and sold before it. */
+static const gchar *invst_qif =
+    "!Account\n"
+    "NBrokerage\n"
+    "TInvst\n"
+    "^\n"
+    "!Type:Invst\n"
+    "D1/21/2020\n"
+    "NBuy\n"
+    "YACME\n"
+    "I12.345\n"
+    "Q10.5\n"
+    "O9.95\n"
+    "T139.57\n"
+    "^\n"
+    "D1/22/2020\n"
+    "NSell\n"
+    "YACME\n"
+    "I13.1\n"
+    "Q3.25\n"
+    "O7.5\n"
+    "T35.08\n"
+    "CX\n"
+    "^\n"
+    "D1/23/2020\n"
+    "NDiv\n"
+    "YACME\n"
+    "T4.21\n"
+    "^\n"
+    "D1/24/2020\n"
+    "NStkSplit\n"
+    "YACME\n"
+    "Q20\n"
+    "^\n";
+
+static SCM
+qif_import_ref (const gchar *name)
+{
+    gchar *expr = g_strdup_printf ("(@@ (gnucash qif-import) %s)", name);
+    SCM value = scm_c_eval_string (expr);
+
+    g_free (expr);
+    return value;
+}
+
+/* Read and parse contents with the import's own <qif-file>. */
+static SCM
+read_qif (const gchar *contents)
+{
+    gchar *path;
+    gint fd = g_file_open_tmp ("test-qif-XXXXXX.qif", &path, NULL);
+    SCM qif_file = scm_call_0 (qif_import_ref ("make-qif-file"));
+    SCM result;
+
+    g_assert_cmpint (fd, !=, -1);
+    close (fd);
+    g_assert_true (g_file_set_contents (path, contents, -1, NULL));
+
+    result = scm_call_4 (qif_import_ref ("qif-file:read-file"), qif_file,
+                         scm_from_utf8_string (path),
+                         scm_call_0 (qif_import_ref ("make-ticker-map")),
+                         SCM_BOOL_F);
+    g_assert_true (scm_is_null (result));
+    result = scm_call_2 (qif_import_ref ("qif-file:parse-fields"), qif_file,
+                         SCM_BOOL_F);
+    g_assert_true (scm_is_null (result));
+
+    g_unlink (path);
+    g_free (path);
+    return qif_file;
+}
+
+static void
+add_name (GHashTable *names, SCM name)
+{
+    if (scm_is_string (name) && scm_c_string_length (name) > 0)
+        g_hash_table_add (names, scm_to_utf8_string (name));
+}
+
+/* Add the names of every account the transactions refer to, and those
+ * of the security accounts to stocks. */
+static void
+collect_names (SCM xtns, GHashTable *names, GHashTable *stocks)
+{
+    SCM security_name = qif_import_ref ("qif-xtn:security-name");
+    SCM from_acct = qif_import_ref ("qif-xtn:from-acct");
+    SCM xtn_splits = qif_import_ref ("qif-xtn:splits");
+    SCM category = qif_import_ref ("qif-split:category");
+    SCM accounts_affected = qif_import_ref ("qif-split:accounts-affected");
+    SCM stock_acct = qif_import_ref ("default-stock-acct");
+
+    for (; scm_is_pair (xtns); xtns = scm_cdr (xtns))
+    {
+        SCM xtn = scm_car (xtns);
+        SCM security = scm_call_1 (security_name, xtn);
+        SCM splits = scm_call_1 (xtn_splits, xtn);
+        SCM affected = SCM_EOL;
+
+        add_name (names, scm_call_1 (from_acct, xtn));
+        if (scm_is_true (security))
+        {
+            affected = scm_call_2 (accounts_affected, scm_car (splits), xtn);
+            add_name (stocks, scm_call_2 (stock_acct,
+                                          scm_call_1 (from_acct, xtn),
+                                          security));
+        }
+        else
+            for (; scm_is_pair (splits); splits = scm_cdr (splits))
+                affected = scm_cons (scm_call_1 (category, scm_car (splits)),
+                                     affected);
+
+        for (; scm_is_pair (affected); affected = scm_cdr (affected))
+            add_name (names, scm_car (affected));
+    }
+    add_name (names, scm_call_0 (qif_import_ref ("default-unspec-acct")));
+}
+
+/* Map every name to an account of the same name in both the account and
+ * the category maps, and fill accounts, the hash of GnuCash accounts. */
+static void
+make_accounts (GHashTable *names, GHashTable *stocks, SCM accounts,
+               SCM acct_map, SCM cat_map)
+{
+    QofBook *book = gnc_get_current_book ();
+    gnc_commodity *currency =
+        gnc_commodity_table_lookup (gnc_commodity_table_get_table (book),
+                                    GNC_COMMODITY_NS_CURRENCY, "USD");
+    gnc_commodity *security = gnc_commodity_new (book, "Acme", "NYSE",
+                                                 "ACME", NULL, 10000);
+    swig_type_info *account_type = SWIG_TypeQuery ("_p_Account");
+    SCM make_entry = qif_import_ref ("make-qif-map-entry");
+    SCM set_qif_name = qif_import_ref ("qif-map-entry:set-qif-name!");
+    SCM set_gnc_name = qif_import_ref ("qif-map-entry:set-gnc-name!");
+    GHashTableIter iter;
+    gpointer name;
+
+    g_hash_table_iter_init (&iter, names);
+    while (g_hash_table_iter_next (&iter, &name, NULL))
+    {
+        Account *account = xaccMallocAccount (book);
+        SCM scm_name = scm_from_utf8_string (name);
+        SCM entry = scm_call_0 (make_entry);
+
+        xaccAccountBeginEdit (account);
+        xaccAccountSetName (account, name);
+        xaccAccountSetCommodity (account,
+                                 g_hash_table_contains (stocks, name) ?
+                                 security : currency);
+        xaccAccountCommitEdit (account);
+        scm_hash_set_x (accounts, scm_name,
+                        SWIG_NewPointerObj (account, account_type, 0));
+
+        scm_call_2 (set_qif_name, entry, scm_name);
+        scm_call_2 (set_gnc_name, entry, scm_name);
+        scm_hash_set_x (acct_map, scm_name, entry);
+        scm_hash_set_x (cat_map, scm_name, entry);
+    }
+}
+
+static Transaction *
+trans_begin (void)
+{
+    QofBook *book = gnc_get_current_book ();
+    Transaction *trans = xaccMallocTransaction (book);
+
+    xaccTransBeginEdit (trans);
+    xaccTransSetCurrency (trans,
+                          gnc_commodity_table_lookup (gnc_commodity_table_get_table (book),
+                                                      GNC_COMMODITY_NS_CURRENCY,
+                                                      "USD"));
+    return trans;
+}
+
+/* The same fraction, not just the same value. */
+static void
+assert_same_numeric (gnc_numeric actual, gnc_numeric expected)
+{
+    g_assert_cmpint (actual.num, ==, expected.num);
+    g_assert_cmpint (actual.denom, ==, expected.denom);
+}
+
+static void
+assert_same_trans (Transaction *actual, Transaction *expected)
+{
+    gint i, n_splits = xaccTransCountSplits (expected);
+
+    g_assert_cmpint (xaccTransGetDate (actual), ==,
+                     xaccTransGetDate (expected));
+    g_assert_cmpstr (xaccTransGetDescription (actual), ==,
+                     xaccTransGetDescription (expected));
+    g_assert_cmpstr (xaccTransGetNotes (actual), ==,
+                     xaccTransGetNotes (expected));
+    g_assert_cmpstr (xaccTransGetNum (actual), ==, xaccTransGetNum (expected));
+    g_assert_cmpint (xaccTransCountSplits (actual), ==, n_splits);
+
+    for (i = 0; i < n_splits; i++)
+    {
+        Split *actual_split = xaccTransGetSplit (actual, i);
+        Split *expected_split = xaccTransGetSplit (expected, i);
+
+        g_assert_true (xaccSplitGetAccount (actual_split) ==
+                       xaccSplitGetAccount (expected_split));
+        g_assert_cmpstr (xaccSplitGetMemo (actual_split), ==,
+                         xaccSplitGetMemo (expected_split));
+        g_assert_cmpstr (xaccSplitGetAction (actual_split), ==,
+                         xaccSplitGetAction (expected_split));
+        g_assert_cmpint (xaccSplitGetReconcile (actual_split), ==,
+                         xaccSplitGetReconcile (expected_split));
+        assert_same_numeric (xaccSplitGetValue (actual_split),
+                             xaccSplitGetValue (expected_split));
+        assert_same_numeric (xaccSplitGetAmount (actual_split),
+                             xaccSplitGetAmount (expected_split));
+    }
+}
+
+/* Convert every transaction of contents with both converters and check
+ * that they build the same GnuCash transaction. Both are built before
+ * either is committed, so that a stock split sees the same balance. */
+static void
+check_converters (const gchar *contents)
+{
+    SCM qif_file = read_qif (contents);
+    SCM xtns = scm_call_1 (qif_import_ref ("qif-file:xtns"), qif_file);
+    SCM scheme_convert = qif_import_ref ("qif-import:qif-xtn-to-gnc-xtn");
+    SCM native_convert = qif_import_ref ("qif-import:native-xtn-to-gnc-xtn");
+    SCM accounts = scm_c_make_hash_table (16);
+    SCM acct_map = scm_c_make_hash_table (16);
+    SCM cat_map = scm_c_make_hash_table (16);
+    SCM memo_map = scm_c_make_hash_table (16);
+    SCM status_pref = SCM_MAKE_CHAR (NREC);
+    swig_type_info *trans_type = SWIG_TypeQuery ("_p_Transaction");
+    GHashTable *names = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                               free, NULL);
+    GHashTable *stocks = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                                free, NULL);
+
+    g_assert_true (scm_is_true (qif_import_ref ("native-xtn-to-gnc-xtn")));
+    g_assert_cmpint (scm_ilength (xtns), >, 0);
+
+    collect_names (xtns, names, stocks);
+    make_accounts (names, stocks, accounts, acct_map, cat_map);
+
+    for (; scm_is_pair (xtns); xtns = scm_cdr (xtns))
+    {
+        Transaction *expected = trans_begin ();
+        Transaction *actual = trans_begin ();
+
+        scm_call_9 (scheme_convert, scm_car (xtns), qif_file,
+                    SWIG_NewPointerObj (expected, trans_type, 0),
+                    accounts, acct_map, cat_map, memo_map, status_pref,
+                    SCM_BOOL_F);
+        scm_call_7 (native_convert, scm_car (xtns),
+                    SWIG_NewPointerObj (actual, trans_type, 0),
+                    accounts, acct_map, cat_map, memo_map, status_pref);
+        xaccTransCommitEdit (expected);
+        xaccTransCommitEdit (actual);
+
+        g_assert_cmpint (xaccTransCountSplits (expected), >, 1);
+        assert_same_trans (actual, expected);
+    }
+
+    g_hash_table_destroy (names);
+    g_hash_table_destroy (stocks);
+}
+
+static void
+test_convert_bank (void)
+{
+    check_converters (bank_qif);
+}
+
+static void
+test_convert_invst (void)
+{
+    check_converters (invst_qif);
+}
+
+static void
+guile_main (void *closure, int argc, char **argv)
+{
+    /* Define the native procedures before the Scheme converter looks
+     * them up. */
+    gnc_qif_import_native_init ();
+    scm_c_use_module ("gnucash qif-import");
+    xaccLogDisable ();
+
+    g_test_add_func ("/qif-import/native/scheme/bank", test_convert_bank);
+    g_test_add_func ("/qif-import/native/scheme/invst", test_convert_invst);
+
+    exit (g_test_run ());
+}
+
+int
+main (int argc, char *argv[])
+{
+    qof_init ();
+    qof_log_init_filename_special ("stderr");
+    g_test_init (&argc, &argv, NULL);
+    g_setenv ("GNC_UNINSTALLED", "1", TRUE);
+    scm_boot_guile (argc, argv, guile_main, NULL);
+    return 0;
+}
@@ -94,6 +94,10 @@ gnc_ledger_display_internal (Account* lead_account, Query* q,
 static void gnc_ledger_display_refresh_internal (GNCLedgerDisplay* ld,
                                                  GList* splits);
 
+static void gnc_ledger_display_refresh_changed (GNCLedgerDisplay* ld,
+                                                GList* splits,
+                                                GList* changed);
+
 static void gnc_ledger_display_make_query (GNCLedgerDisplay* ld,
                                            gint limit,
                                            SplitRegisterType type);
@@ -543,6 +547,108 @@ gnc_ledger_display_set_watches (GNCLedgerDisplay* ld, GList* splits)
     }
 }
 
+typedef struct
+{
+    QofBook* book;
+    GList* splits;
+    gboolean need_requery;
+} LedgerChanges;
+
+static void
+collect_changed_splits (gpointer key, gpointer value, gpointer user_data)
+{
+    const GncGUID* guid = key;
+    const EventInfo* info = value;
+    LedgerChanges* lc = user_data;
+    Transaction* trans;
+    Split* split;
+
+    if (lc->need_requery)
+        return;
+
+    /* Destroyed objects may still be referenced by the last query
+     * results, so those can't be patched. */
+    if (info->event_mask & QOF_EVENT_DESTROY)
+    {
+        lc->need_requery = TRUE;
+        return;
+    }
+
+    trans = xaccTransLookup (guid, lc->book);
+    if (trans)
+    {
+        GList* node;
+
+        for (node = xaccTransGetSplitList (trans); node; node = node->next)
+            lc->splits = g_list_prepend (lc->splits, node->data);
+        return;
+    }
+
+    split = xaccSplitLookup (guid, lc->book);
+    if (split)
+        lc->splits = g_list_prepend (lc->splits, split);
+}
+
+/* Whether the lists a and b hold the same splits in the same order. */
+static gboolean
+same_split_list (GList* a, GList* b)
+{
+    for (; a && b; a = a->next, b = b->next)
+        if (a->data != b->data)
+            return FALSE;
+    return !a && !b;
+}
+
+/* Update the ledger's split list from the splits touched by the
+ * engine events in changes, re-testing only those against the query
+ * instead of scanning the whole book. If the list came out the same,
+ * *changed is set to the touched splits, to be freed by the caller,
+ * and the register rows can be kept. */
+static GList*
+gnc_ledger_display_run_query (GNCLedgerDisplay* ld, GHashTable* changes,
+                              GList** changed)
+{
+    LedgerChanges lc;
+    GList* last_run;
+    GList* splits;
+
+    *changed = NULL;
+
+    if (!changes || !qof_query_last_run (ld->query))
+        return qof_query_run (ld->query);
+
+    lc.book = gnc_get_current_book();
+    lc.splits = NULL;
+    lc.need_requery = FALSE;
+
+    g_hash_table_foreach (changes, collect_changed_splits, &lc);
+
+    if (lc.need_requery)
+    {
+        splits = qof_query_run (ld->query);
+        g_list_free (lc.splits);
+        lc.splits = NULL;
+    }
+    else
+    {
+        /* The last results are replaced, copy them for the comparison. */
+        last_run = g_list_copy (qof_query_last_run (ld->query));
+        splits = qof_query_run_incremental (ld->query, lc.splits, NULL);
+        if (same_split_list (last_run, splits))
+            *changed = lc.splits;
+        else
+        {
+            g_list_free (lc.splits);
+            lc.splits = NULL;
+        }
+        g_list_free (last_run);
+    }
+
+    DEBUG ("%s refresh, %d changed splits kept in place",
+           lc.need_requery ? "full" : "incremental", g_list_length (*changed));
+    return splits;
+}
+
 static void
 refresh_handler (GHashTable* changes, gpointer user_data)
 {
@@ -550,6 +656,7 @@ refresh_handler (GHashTable* changes, gpointer user_data)
     const EventInfo* info;
     gboolean has_leader;
     GList* splits;
+    GList* changed;
 
     ENTER ("changes=%p, user_data=%p", changes, user_data);
 
@@ -598,16 +705,23 @@ refresh_handler (GHashTable* changes, gpointer user_data)
         g_list_free (accounts);
     }
 
-    /* Its not clear if we should re-run the query, or if we should
-     * just use qof_query_last_run().  Its possible that the dates
-     * changed, requiring a full new query.  Similar considerations
-     * needed for multi-user mode.
+    /* Only the splits touched by the engine events are re-tested
+     * against the query, unless something was destroyed or the query
+     * itself changed, in which case it is run over the whole book. A
+     * forced refresh (no changes) always re-runs the query, so that
+     * e.g. relative date filters are re-evaluated.
      */
-    splits = qof_query_run (ld->query);
+    splits = gnc_ledger_display_run_query (ld, changes, &changed);
 
     gnc_ledger_display_set_watches (ld, splits);
 
-    gnc_ledger_display_refresh_internal (ld, splits);
+    /* If the split list is unchanged, only the rows of the changed
+     * transactions need redrawing. */
+    if (changed)
+        gnc_ledger_display_refresh_changed (ld, splits, changed);
+    else
+        gnc_ledger_display_refresh_internal (ld, splits);
+    g_list_free (changed);
     LEAVE (" ");
 }
 
@@ -872,6 +986,27 @@ gnc_ledger_display_refresh_internal (GNCLedgerDisplay* ld, GList* splits)
     ld->loading = FALSE;
 }
 
+/* Like gnc_ledger_display_refresh_internal, but try redrawing the
+ * rows of the changed splits before loading the register. */
+static void
+gnc_ledger_display_refresh_changed (GNCLedgerDisplay* ld, GList* splits,
+                                    GList* changed)
+{
+    if (!ld || ld->loading)
+        return;
+
+    if (!gnc_split_register_full_refresh_ok (ld->reg))
+        return;
+
+    ld->loading = TRUE;
+
+    if (!gnc_split_register_refresh_rows (ld->reg, splits, changed))
+        gnc_split_register_load (ld->reg, splits,
+                                 gnc_ledger_display_leader (ld));
+
+    ld->loading = FALSE;
+}
+
 void
 gnc_ledger_display_refresh (GNCLedgerDisplay* ld)
 {
@@ -886,8 +886,6 @@ gnc_ledger_display2_find_by_query (Query *q)
 static void
 gnc_ledger_display2_refresh_internal (GNCLedgerDisplay2 *ld, GList *splits)
 {
-    GtkTreeModel *s_model, *model;
-
     if (!ld || ld->loading)
         return;
 
@@ -902,21 +900,12 @@ gnc_ledger_display2_refresh_internal (GNCLedgerDisplay2 *ld, GList *splits)
 	/* This is used for the reloading of registers to refresh them and to update the search_ledger */
         ld->loading = TRUE;
 
-	s_model = gtk_tree_view_get_model (GTK_TREE_VIEW (ld->view)); // this is the sort model
-        model = gtk_tree_model_sort_get_model (GTK_TREE_MODEL_SORT (s_model)); // this is the model
-
-        g_object_ref (s_model);
-        g_object_ref (model);
-
+        /* Only the rows of transactions that came, went or moved change,
+           so the view is left attached and keeps its state for the rest. */
         gnc_tree_view_split_reg_block_selection (ld->view, TRUE); // This blocks the tree selection
-        gtk_tree_view_set_model (GTK_TREE_VIEW (ld->view), NULL); // Detach sort model from view
-        gnc_tree_model_split_reg_load (ld->model, splits, gnc_ledger_display2_leader (ld)); //reload splits
-        gtk_tree_view_set_model (GTK_TREE_VIEW (ld->view), GTK_TREE_MODEL (s_model)); // Re-attach sort model to view
+        gnc_tree_model_split_reg_update (ld->model, splits, gnc_ledger_display2_leader (ld)); //reload splits
         gnc_tree_view_split_reg_block_selection (ld->view, FALSE); // This unblocks the tree selection
 
-        g_object_unref (model);
-        g_object_unref (s_model);
-
         /* Set the default selection start position */
         gnc_tree_view_split_reg_default_selection (ld->view);
 
@@ -235,8 +235,11 @@ _find_split_with_parent_txn (gconstpointer a, gconstpointer b)
     return xaccSplitGetParent (split) == txn ? 0 : 1;
 }
 
-static void add_quickfill_completions (TableLayout* layout, Transaction* trans,
-                                       Split* split, gboolean has_last_num)
+/* Number of transactions added to the quickfill cells per idle call.
+ * Registers with fewer transactions are filled in synchronously. */
+#define QUICKFILL_CHUNK_SIZE 500
+
+static void add_quickfill_completions (TableLayout* layout, Transaction* trans)
 {
     Split* s;
     int i = 0;
@@ -249,11 +252,6 @@ static void add_quickfill_completions (TableLayout* layout, Transaction* trans,
         (QuickFillCell*) gnc_table_layout_get_cell (layout, NOTES_CELL),
         xaccTransGetNotes (trans));
 
-    if (!has_last_num)
-        gnc_num_cell_set_last_num (
-            (NumCell*) gnc_table_layout_get_cell (layout, NUM_CELL),
-            gnc_get_num_action (trans, split));
-
     while ((s = xaccTransGetSplit (trans, i)) != NULL)
     {
         gnc_quickfill_cell_add_completion (
@@ -263,6 +261,81 @@ static void add_quickfill_completions (TableLayout* layout, Transaction* trans,
     }
 }
 
+/* Feed the next chunk of queued transactions to the quickfill cells.
+ * Transactions are queued by GUID so that ones deleted in the meantime
+ * are simply skipped. */
+static gboolean
+gnc_split_register_quickfill_idle (gpointer user_data)
+{
+    SplitRegister* reg = user_data;
+    SRInfo* info = gnc_split_register_get_info (reg);
+    guint stop;
+
+    stop = MIN (info->quickfill_next + QUICKFILL_CHUNK_SIZE,
+                info->quickfill_pending->len);
+
+    for (; info->quickfill_next < stop; info->quickfill_next++)
+    {
+        GncGUID* guid = &g_array_index (info->quickfill_pending, GncGUID,
+                                        info->quickfill_next);
+        Transaction* trans = xaccTransLookup (guid, info->quickfill_book);
+
+        if (trans)
+            add_quickfill_completions (reg->table->layout, trans);
+    }
+
+    if (info->quickfill_next < info->quickfill_pending->len)
+        return G_SOURCE_CONTINUE;
+
+    DEBUG ("quickfill load of %u transactions done", info->quickfill_next);
+    info->quickfill_idle_id = 0;
+    g_array_free (info->quickfill_pending, TRUE);
+    info->quickfill_pending = NULL;
+    info->quickfill_book = NULL;
+    info->quickfill_next = 0;
+    return G_SOURCE_REMOVE;
+}
+
+void
+gnc_split_register_cancel_quickfill_load (SplitRegister* reg)
+{
+    SRInfo* info;
+
+    if (!reg || !reg->sr_info)
+        return;
+
+    info = reg->sr_info;
+
+    if (info->quickfill_idle_id)
+    {
+        g_source_remove (info->quickfill_idle_id);
+        info->quickfill_idle_id = 0;
+    }
+
+    if (info->quickfill_pending)
+    {
+        g_array_free (info->quickfill_pending, TRUE);
+        info->quickfill_pending = NULL;
+    }
+    info->quickfill_book = NULL;
+    info->quickfill_next = 0;
+}
+
+/* Fill the first chunk of the quickfill cells now and leave the rest
+ * to an idle handler so that opening a large register doesn't block
+ * on building completions for its whole history. */
+static void
+gnc_split_register_start_quickfill_load (SplitRegister* reg, SRInfo* info)
+{
+    if (!info->quickfill_pending)
+        return;
+
+    if (gnc_split_register_quickfill_idle (reg) == G_SOURCE_CONTINUE)
+        info->quickfill_idle_id =
+            g_idle_add_full (G_PRIORITY_LOW, gnc_split_register_quickfill_idle,
+                             reg, NULL);
+}
+
 static Split*
 create_blank_split (Account* default_account, SRInfo* info)
 {
@@ -517,6 +590,10 @@ gnc_split_register_load (SplitRegister* reg, GList* slist,
             }
         }
 
+        /* queue up the quickfill completions, see below */
+        gnc_split_register_cancel_quickfill_load (reg);
+        info->quickfill_pending = g_array_new (FALSE, FALSE, sizeof (GncGUID));
+
         /* load up account names into the transfer combobox menus */
         gnc_split_register_load_xfer_cells (reg, default_account);
         gnc_split_register_load_doclink_cells (reg);
@@ -648,10 +725,21 @@ gnc_split_register_load (SplitRegister* reg, GList* slist,
             }
         }
 
-        /* If this is the first load of the register,
-         * fill up the quickfill cells. */
+        /* If this is the first load of the register, queue the
+         * transaction for filling up the quickfill cells. */
         if (info->first_pass)
-            add_quickfill_completions (reg->table->layout, trans, split, has_last_num);
+        {
+            if (!info->quickfill_book)
+                info->quickfill_book = xaccTransGetBook (trans);
+            g_array_append_val (info->quickfill_pending,
+                                *xaccTransGetGUID (trans));
+
+            if (!has_last_num)
+                gnc_num_cell_set_last_num (
+                    (NumCell*) gnc_table_layout_get_cell (table->layout,
+                                                          NUM_CELL),
+                    gnc_get_num_action (trans, split));
+        }
 
         if (trans == find_trans)
             new_trans_row = vcell_loc.virt_row;
@@ -728,6 +816,8 @@ gnc_split_register_load (SplitRegister* reg, GList* slist,
     /* go to blank on first pass */
     if (info->first_pass)
     {
+        gnc_split_register_start_quickfill_load (reg, info);
+
         new_split_row = -1;
         new_trans_split_row = -1;
         new_trans_row = -1;
@@ -799,6 +889,284 @@ gnc_split_register_load (SplitRegister* reg, GList* slist,
     LEAVE (" ");
 }
 
+/* Whether the virtual row at row is a split row holding guid. */
+static gboolean
+row_holds_split_row (Table* table, CellBlock* split_cursor, int row,
+                     const GncGUID* guid)
+{
+    VirtualCellLocation vcell_loc = { row, 0 };
+    VirtualCell* vcell;
+
+    if (row >= table->num_virt_rows)
+        return FALSE;
+
+    vcell = gnc_table_get_virtual_cell (table, vcell_loc);
+    return vcell && vcell->cellblock == split_cursor &&
+           guid_equal (vcell->vcell_data, guid);
+}
+
+/* The row after the lead row at row and the split rows following it. */
+static int
+next_lead_row (Table* table, CellBlock* split_cursor, int row)
+{
+    VirtualCellLocation vcell_loc = { row + 1, 0 };
+
+    for (; vcell_loc.virt_row < table->num_virt_rows; vcell_loc.virt_row++)
+    {
+        VirtualCell* vcell = gnc_table_get_virtual_cell (table, vcell_loc);
+
+        if (!vcell || vcell->cellblock != split_cursor)
+            break;
+    }
+    return vcell_loc.virt_row;
+}
+
+/* Skip the rows of the blank transaction if they start at row. */
+static int
+skip_blank_rows (Table* table, CellBlock* split_cursor, Split* blank_split,
+                 int row)
+{
+    VirtualCellLocation vcell_loc = { row, 0 };
+    VirtualCell* vcell;
+
+    if (row >= table->num_virt_rows)
+        return row;
+
+    vcell = gnc_table_get_virtual_cell (table, vcell_loc);
+    if (vcell && vcell->cellblock != split_cursor &&
+        guid_equal (vcell->vcell_data, xaccSplitGetGUID (blank_split)))
+        return next_lead_row (table, split_cursor, row);
+    return row;
+}
+
+/* Whether the rows of trans starting at the lead row at row are still
+ * those gnc_split_register_add_transaction would set up. */
+static gboolean
+trans_rows_match (Table* table, CellBlock* split_cursor, Transaction* trans,
+                  int row)
+{
+    GList* node;
+
+    for (node = xaccTransGetSplitList (trans); node; node = node->next)
+    {
+        Split* split = node->data;
+
+        if (!xaccTransStillHasSplit (trans, split))
+            continue;
+        if (!row_holds_split_row (table, split_cursor, ++row,
+                                  xaccSplitGetGUID (split)))
+            return FALSE;
+    }
+
+    /* the empty split row ends the transaction */
+    return row_holds_split_row (table, split_cursor, ++row, guid_null ()) &&
+           next_lead_row (table, split_cursor, row - 1) == row + 1;
+}
+
+/* Walk slist the way gnc_split_register_load does and check that the
+ * table already has the rows it would set up: the same lead splits in
+ * the same order, the same dividers, and for the transactions in
+ * changed_trans the same split rows. */
+static gboolean
+gnc_split_register_rows_match (SplitRegister* reg, GList* slist,
+                               GHashTable* changed_trans, Split* blank_split)
+{
+    SRInfo* info = gnc_split_register_get_info (reg);
+    Table* table = reg->table;
+    CellBlock* split_cursor = gnc_table_layout_get_cursor (table->layout,
+                                                           CURSOR_SPLIT);
+    Transaction* blank_trans = xaccSplitGetParent (blank_split);
+    GHashTable* trans_table = NULL;
+    gboolean multi_line = (reg->style == REG_STYLE_JOURNAL);
+    gboolean use_autoreadonly = qof_book_uses_autoreadonly (
+                                    gnc_get_current_book());
+    gboolean future_after_blank = gnc_prefs_get_bool (
+                                      GNC_PREFS_GROUP_GENERAL_REGISTER,
+                                      GNC_PREF_FUTURE_AFTER_BLANK);
+    gboolean need_divider_upper = FALSE;
+    gboolean found_divider_upper = FALSE;
+    gboolean found_divider = FALSE;
+    gboolean match = TRUE;
+    int dividing_row_upper = -1;
+    int dividing_row = -1;
+    int dividing_row_lower = -1;
+    int row = 1;
+    time64 present, autoreadonly_time = 0;
+    GList* node;
+
+    present = gnc_time64_get_today_end ();
+    if (use_autoreadonly)
+    {
+        GDate* d = qof_book_get_autoreadonly_gdate (gnc_get_current_book());
+        autoreadonly_time = d ? gdate_to_time64 (*d) : 0;
+        g_date_free (d);
+    }
+
+    if (multi_line)
+        trans_table = g_hash_table_new (g_direct_hash, g_direct_equal);
+
+    for (node = slist; node && match; node = node->next)
+    {
+        Split* split = node->data;
+        Transaction* trans = xaccSplitGetParent (split);
+        VirtualCellLocation vcell_loc;
+        VirtualCell* vcell;
+
+        if (!xaccTransStillHasSplit (trans, split))
+            continue;
+
+        if (xaccTransCountSplits (trans) == 1 &&
+            xaccSplitGetAccount (split) == NULL)
+            continue;
+
+        if (trans == blank_trans)
+            continue;
+
+        if (multi_line)
+        {
+            if (g_hash_table_contains (trans_table, trans))
+                continue;
+            g_hash_table_add (trans_table, trans);
+        }
+
+        if (info->show_present_divider && use_autoreadonly &&
+            !found_divider_upper)
+        {
+            if (xaccTransGetDate (trans) >= autoreadonly_time)
+            {
+                dividing_row_upper = row;
+                found_divider_upper = TRUE;
+            }
+            else
+                need_divider_upper = TRUE;
+        }
+
+        if (info->show_present_divider && !found_divider &&
+            xaccTransGetDate (trans) > present)
+        {
+            dividing_row = row;
+            found_divider = TRUE;
+
+            if (future_after_blank)
+            {
+                row = skip_blank_rows (table, split_cursor, blank_split, row);
+                dividing_row_lower = row;
+            }
+        }
+
+        vcell_loc.virt_row = row;
+        vcell_loc.virt_col = 0;
+        vcell = row < table->num_virt_rows ?
+                gnc_table_get_virtual_cell (table, vcell_loc) : NULL;
+
+        match = vcell && vcell->cellblock != split_cursor &&
+                guid_equal (vcell->vcell_data, xaccSplitGetGUID (split));
+
+        if (match && g_hash_table_contains (changed_trans, trans))
+            match = trans_rows_match (table, split_cursor, trans, row);
+
+        row = next_lead_row (table, split_cursor, row);
+    }
+
+    if (multi_line)
+        g_hash_table_destroy (trans_table);
+
+    if (!match)
+        return FALSE;
+
+    if (info->show_present_divider && use_autoreadonly &&
+        !found_divider_upper && need_divider_upper)
+        dividing_row_upper = row;
+
+    /* the blank transaction ends the register unless it went in above */
+    row = skip_blank_rows (table, split_cursor, blank_split, row);
+    if (future_after_blank && !found_divider)
+        dividing_row_lower = row;
+
+    return row == table->num_virt_rows &&
+           dividing_row_upper == table->model->dividing_row_upper &&
+           dividing_row == table->model->dividing_row &&
+           dividing_row_lower == table->model->dividing_row_lower;
+}
+
+gboolean
+gnc_split_register_refresh_rows (SplitRegister* reg, GList* slist,
+                                 GList* changed)
+{
+    SRInfo* info;
+    Table* table;
+    Split* blank_split;
+    Transaction* blank_trans;
+    GHashTable* changed_trans;
+    gboolean match = TRUE;
+    GList* node;
+
+    g_return_val_if_fail (reg, FALSE);
+    table = reg->table;
+    info = gnc_split_register_get_info (reg);
+    g_return_val_if_fail (table && info, FALSE);
+
+    /* Anything the load would do besides setting up the rows needs the
+     * full load. */
+    if (info->first_pass || info->separator_changed || info->traverse_to_new ||
+        !guid_equal (&info->pending_trans_guid, guid_null ()) ||
+        gnc_table_current_cursor_changed (table, FALSE))
+        return FALSE;
+
+    blank_split = xaccSplitLookup (&info->blank_split_guid,
+                                   gnc_get_current_book());
+    if (!blank_split)
+        return FALSE;
+    blank_trans = xaccSplitGetParent (blank_split);
+
+    changed_trans = g_hash_table_new (g_direct_hash, g_direct_equal);
+    for (node = changed; node && match; node = node->next)
+    {
+        Transaction* trans = xaccSplitGetParent (node->data);
+
+        if (trans == blank_trans)
+            match = FALSE;
+        else if (trans)
+            g_hash_table_add (changed_trans, trans);
+    }
+
+    if (match)
+        match = gnc_split_register_rows_match (reg, slist, changed_trans,
+                                               blank_split);
+
+    DEBUG ("reg=%p, %u changed transactions, rows %s", reg,
+           g_hash_table_size (changed_trans), match ? "match" : "differ");
+
+    if (match)
+    {
+        Transaction* current_trans = gnc_split_register_get_current_trans (reg);
+
+        /* The cursor holds the cell values of its row, reload them if
+         * its transaction changed. */
+        if (current_trans &&
+            g_hash_table_contains (changed_trans, current_trans))
+        {
+            VirtualLocation save_loc = table->current_cursor_loc;
+            VirtualLocation virt_loc;
+
+            gnc_table_control_allow_move (table->control, FALSE);
+            gnc_virtual_location_init (&virt_loc);
+            gnc_table_move_cursor_gui (table, virt_loc);
+            gnc_table_move_cursor_gui (table, save_loc);
+            gnc_split_register_set_cell_fractions (
+                reg, gnc_split_register_get_current_split (reg));
+            gnc_table_control_allow_move (table->control, TRUE);
+        }
+
+        /* The other rows read their entries when drawn, and the
+         * balances of the rows below the changed ones move too. */
+        gnc_table_redraw_gui (table);
+    }
+
+    g_hash_table_destroy (changed_trans);
+    return match;
+}
+
 /* ===================================================================== */
 
 #define QKEY  "split_reg_shared_quickfill"
@@ -133,6 +133,19 @@ struct sr_info
 
     /** true if the account separator has changed */
     gboolean separator_changed;
+
+    /** GUIDs of the transactions whose descriptions, notes and memos
+     * still have to be added to the quickfill cells */
+    GArray *quickfill_pending;
+
+    /** Book of the pending quickfill transactions, that of the ledger */
+    QofBook *quickfill_book;
+
+    /** Position of the next pending quickfill transaction */
+    guint quickfill_next;
+
+    /** Idle source feeding the quickfill cells, 0 if none */
+    guint quickfill_idle_id;
 };
 
 
@@ -206,5 +219,9 @@ gboolean gnc_split_register_split_needs_amount(
 gboolean gnc_split_register_needs_conv_rate(
     SplitRegister *reg, Transaction *txn, Account *acc);
 
+/** Stop feeding the quickfill cells in the background and drop any
+ * transactions still queued for it. */
+void gnc_split_register_cancel_quickfill_load (SplitRegister *reg);
+
 /** @} */
 #endif
@@ -3048,6 +3048,8 @@ gnc_split_register_destroy_info (SplitRegister* reg)
     if (!info)
         return;
 
+    gnc_split_register_cancel_quickfill_load (reg);
+
     g_free (info->tdebit_str);
     g_free (info->tcredit_str);
 
@@ -517,6 +517,16 @@ void gnc_split_register_cancel_cursor_trans_changes (SplitRegister* reg);
  *  various default values for the blank split (such as currency, last check
  *  number, and transfer account) for the blank split.
  *
+ *  Every row gets its virtual cell here, so the time this takes grows
+ *  with the length of @a slist. Only the quickfill completions beyond the
+ *  first few hundred transactions are left to an idle handler. The
+ *  register sheet sizes itself and places the cursor from the full table,
+ *  and jump-to-date and search find rows by their table position, so
+ *  building only the rows near the viewport would need the sheet to page
+ *  rows in as it scrolls. The balance cells show the engine's cached
+ *  split balances when they are drawn, so there are no totals to compute
+ *  here.
+ *
  *  @param reg a ::SplitRegister
  *
  *  @param slist a list of splits
@@ -526,6 +536,22 @@ void gnc_split_register_cancel_cursor_trans_changes (SplitRegister* reg);
 void gnc_split_register_load (SplitRegister* reg, GList* slist,
                               Account* default_account);
 
+/** Redraw the register for the splits in changed without reloading it,
+ *  if its rows are still those gnc_split_register_load() would set up
+ *  for slist: no rows come or go, no transaction of changed gained or
+ *  lost a split, and the dividers stay in place.
+ *
+ *  @param reg a ::SplitRegister
+ *
+ *  @param slist the list of splits the register was loaded with
+ *
+ *  @param changed the splits changed since
+ *
+ *  @return FALSE if nothing was done and the register must be loaded
+ */
+gboolean gnc_split_register_refresh_rows (SplitRegister* reg, GList* slist,
+                                          GList* changed);
+
 /** Copy the contents of the current cursor to a split. The split and
  *    transaction that are updated are the ones associated with the
  *    current cursor (register entry) position. If the do_commit flag
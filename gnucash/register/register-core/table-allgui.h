@@ -342,6 +342,9 @@ void        gnc_table_refresh_current_cursor_gui (Table * table,
 /** Refresh the whole GUI from the table. */
 void        gnc_table_refresh_gui (Table *table, gboolean do_scroll);
 
+/** Redraw the GUI from the table without reloading its rows. */
+void        gnc_table_redraw_gui (Table *table);
+
 /** Try to show the whole range in the register. */
 void        gnc_table_show_range (Table *table,
                                   VirtualCellLocation start_loc,
@@ -36,16 +36,30 @@
 #include <string.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <locale.h>
 
 #include "gnc-filepath-utils.h"
 #include "gnc-guile-utils.h"
 #include "gnc-report.h"
 #include "gnc-engine.h"
+#include "gnc-prefs.h"
+#include "gnc-session.h"
+#include "gnc-ui-util.h"
+#include "gnc-uri-utils.h"
 
 extern SCM scm_init_sw_report_module(void);
 
 static QofLogModule log_module = GNC_MOD_GUI;
 
+#define GNC_PREFS_GROUP_REPORT "general.report"
+#define GNC_PREF_REPORT_CACHE_SIZE "cache-size"
+#define GNC_PREF_REPORT_CACHE_ON_DISK "cache-on-disk"
+#define REPORT_CACHE_DIR "report-cache"
+/* Files in the disk cache older than this are removed at startup. */
+#define REPORT_CACHE_DISK_MAX_AGE (7 * 24 * 3600)
+
+static void gnc_report_cache_init (void);
+
 /* Fow now, this is global, like it was in guile.  It _should_ be per-book. */
 static GHashTable *reports = NULL;
 static gint report_next_serial_id = 0;
@@ -107,6 +121,7 @@ gnc_report_init (void)
     scm_c_eval_string("(report-module-loader (list '(gnucash report stylesheets)))");
 
     load_custom_reports_stylesheets();
+    gnc_report_cache_init ();
 }
 
 
@@ -386,3 +401,294 @@ gnc_saved_reports_write_to_file (const gchar* report_def, gboolean overwrite)
 
     return success;
 }
+
+/* Rendered report cache.
+ *
+ * Entries are keyed by a digest of the caller's key (the report type and
+ * options), the current book, the day, the preferences and locale which
+ * change how reports show names and amounts, and a generation counter that
+ * every QOF event changing the book's contents bumps, so any edit makes all
+ * of the older entries unreachable. The in-memory cache is bounded by the
+ * cache-size preference and evicts the least recently used entries.
+ *
+ * If cache-on-disk is set, output for a file-based book that hasn't been
+ * changed since it was loaded or saved is also written to the user data
+ * directory, keyed by the file's modification time and size instead of
+ * the generation, so that it survives restarting GnuCash.
+ */
+typedef struct
+{
+    gchar *digest;
+    gchar *output;
+    gsize size;
+} ReportCacheEntry;
+
+static GHashTable *report_cache = NULL; /* digest -> GList link in lru */
+static GQueue report_cache_lru = G_QUEUE_INIT; /* most recent first */
+static gsize report_cache_bytes = 0;
+static guint64 report_cache_generation = 0;
+static gint report_cache_handler_id = 0;
+
+static void
+report_cache_entry_free (ReportCacheEntry *entry)
+{
+    g_free (entry->digest);
+    g_free (entry->output);
+    g_free (entry);
+}
+
+static void
+report_cache_clear_memory (void)
+{
+    if (report_cache)
+        g_hash_table_remove_all (report_cache);
+    while (!g_queue_is_empty (&report_cache_lru))
+        report_cache_entry_free (g_queue_pop_head (&report_cache_lru));
+    report_cache_bytes = 0;
+}
+
+static void
+report_cache_event_handler (QofInstance *entity, QofEventId event_type,
+                            gpointer user_data, gpointer event_data)
+{
+    if (!entity || !(event_type & (QOF_EVENT_CREATE | QOF_EVENT_MODIFY |
+                                   QOF_EVENT_DESTROY | QOF_EVENT_ADD |
+                                   QOF_EVENT_REMOVE)))
+        return;
+    ++report_cache_generation;
+    if (report_cache_bytes)
+        report_cache_clear_memory ();
+}
+
+static void
+report_cache_prune_disk (void)
+{
+    gchar *dirname = gnc_build_userdata_path (REPORT_CACHE_DIR);
+    GDir *dir = g_dir_open (dirname, 0, NULL);
+    const gchar *name;
+    time64 now = gnc_time (NULL);
+
+    while (dir && (name = g_dir_read_name (dir)))
+    {
+        gchar *path = g_build_filename (dirname, name, NULL);
+        GStatBuf st;
+        if (g_stat (path, &st) == 0 && now - st.st_mtime > REPORT_CACHE_DISK_MAX_AGE)
+            g_unlink (path);
+        g_free (path);
+    }
+    if (dir)
+        g_dir_close (dir);
+    g_free (dirname);
+}
+
+static void
+gnc_report_cache_init (void)
+{
+    if (report_cache_handler_id)
+        return;
+    report_cache = g_hash_table_new (g_str_hash, g_str_equal);
+    report_cache_handler_id =
+        qof_event_register_handler (report_cache_event_handler, NULL);
+    if (gnc_prefs_get_bool (GNC_PREFS_GROUP_REPORT, GNC_PREF_REPORT_CACHE_ON_DISK))
+        report_cache_prune_disk ();
+}
+
+static gsize
+report_cache_limit (void)
+{
+    gint megabytes = gnc_prefs_get_int (GNC_PREFS_GROUP_REPORT,
+                                        GNC_PREF_REPORT_CACHE_SIZE);
+    return megabytes > 0 ? (gsize) megabytes << 20 : 0;
+}
+
+static time64
+report_cache_day (void)
+{
+    /* Reports with relative dates change at midnight. */
+    return gnc_time64_get_today_start ();
+}
+
+/* The settings besides the report's options which change its output:
+ * the account separator, which balances are reversed, how negative
+ * amounts are shown, the default currencies and the locale. */
+static gchar *
+report_cache_settings (void)
+{
+    gnc_commodity *currency = gnc_default_currency ();
+    gnc_commodity *report_currency = gnc_default_report_currency ();
+
+    return g_strdup_printf ("%s\n%d%d%d\n%s\n%s\n%s",
+                            gnc_get_account_separator_string (),
+                            gnc_prefs_get_bool (GNC_PREFS_GROUP_GENERAL,
+                                                GNC_PREF_REVERSED_ACCTS_CREDIT),
+                            gnc_prefs_get_bool (GNC_PREFS_GROUP_GENERAL,
+                                                GNC_PREF_REVERSED_ACCTS_INC_EXP),
+                            gnc_prefs_get_bool (GNC_PREFS_GROUP_GENERAL,
+                                                GNC_PREF_NEGATIVE_IN_RED),
+                            currency ? gnc_commodity_get_unique_name (currency) : "",
+                            report_currency ?
+                            gnc_commodity_get_unique_name (report_currency) : "",
+                            setlocale (LC_ALL, NULL));
+}
+
+static gchar *
+report_cache_memory_digest (const gchar *key)
+{
+    QofBook *book = gnc_get_current_book ();
+    gchar guidstr[GUID_ENCODING_LENGTH + 1];
+    gchar *settings = report_cache_settings ();
+    gchar *text, *digest;
+
+    guid_to_string_buff (qof_book_get_guid (book), guidstr);
+    text = g_strdup_printf ("%s\n%" G_GUINT64_FORMAT "\n%" G_GINT64_FORMAT
+                            "\n%s\n%s", guidstr, report_cache_generation,
+                            report_cache_day (), settings, key);
+    digest = g_compute_checksum_for_string (G_CHECKSUM_SHA256, text, -1);
+    g_free (settings);
+    g_free (text);
+    return digest;
+}
+
+/* The path of the disk cache file for key, or NULL if the current book
+ * can't use the disk cache. */
+static gchar *
+report_cache_disk_path (const gchar *key)
+{
+    QofSession *session;
+    const gchar *url;
+    gchar *filename, *settings, *text, *digest, *name, *dirname, *path;
+    GStatBuf st;
+
+    if (!gnc_prefs_get_bool (GNC_PREFS_GROUP_REPORT, GNC_PREF_REPORT_CACHE_ON_DISK))
+        return NULL;
+    session = gnc_get_current_session ();
+    url = session ? qof_session_get_url (session) : NULL;
+    if (!url || !gnc_uri_is_file_uri (url) ||
+        qof_book_session_not_saved (qof_session_get_book (session)))
+        return NULL;
+
+    filename = gnc_uri_get_path (url);
+    if (!filename || g_stat (filename, &st) != 0)
+    {
+        g_free (filename);
+        return NULL;
+    }
+    settings = report_cache_settings ();
+    text = g_strdup_printf ("%s\n%" G_GINT64_FORMAT "\n%" G_GINT64_FORMAT
+                            "\n%" G_GINT64_FORMAT "\n%s\n%s", filename,
+                            (gint64) st.st_mtime, (gint64) st.st_size,
+                            report_cache_day (), settings, key);
+    g_free (settings);
+    g_free (filename);
+    digest = g_compute_checksum_for_string (G_CHECKSUM_SHA256, text, -1);
+    g_free (text);
+
+    dirname = gnc_build_userdata_path (REPORT_CACHE_DIR);
+    name = g_strconcat (digest, ".html", NULL);
+    path = g_build_filename (dirname, name, NULL);
+    g_free (dirname);
+    g_free (name);
+    g_free (digest);
+    return path;
+}
+
+static void
+report_cache_store_memory (gchar *digest, const gchar *output, gsize limit)
+{
+    ReportCacheEntry *entry;
+    GList *link = g_hash_table_lookup (report_cache, digest);
+    gsize size = strlen (output) + 1;
+
+    if (link || size > limit)
+    {
+        g_free (digest);
+        return;
+    }
+    while (report_cache_bytes + size > limit && report_cache_lru.tail)
+    {
+        entry = g_queue_pop_tail (&report_cache_lru);
+        g_hash_table_remove (report_cache, entry->digest);
+        report_cache_bytes -= entry->size;
+        report_cache_entry_free (entry);
+    }
+    entry = g_new (ReportCacheEntry, 1);
+    entry->digest = digest;
+    entry->output = g_strdup (output);
+    entry->size = size;
+    g_queue_push_head (&report_cache_lru, entry);
+    g_hash_table_insert (report_cache, entry->digest, report_cache_lru.head);
+    report_cache_bytes += size;
+}
+
+gchar *
+gnc_report_cache_lookup (const gchar *key)
+{
+    gchar *digest, *path, *output = NULL;
+    GList *link;
+    gsize limit = report_cache_limit ();
+
+    g_return_val_if_fail (key, NULL);
+    if (!limit)
+        return NULL;
+    gnc_report_cache_init ();
+
+    digest = report_cache_memory_digest (key);
+    link = g_hash_table_lookup (report_cache, digest);
+    if (link)
+    {
+        ReportCacheEntry *entry = link->data;
+        g_queue_unlink (&report_cache_lru, link);
+        g_queue_push_head_link (&report_cache_lru, link);
+        g_free (digest);
+        DEBUG ("Using cached report output");
+        return g_strdup (entry->output);
+    }
+
+    path = report_cache_disk_path (key);
+    if (path && g_file_get_contents (path, &output, NULL, NULL))
+    {
+        DEBUG ("Using report output cached in %s", path);
+        report_cache_store_memory (digest, output, limit);
+    }
+    else
+        g_free (digest);
+    g_free (path);
+    return output;
+}
+
+void
+gnc_report_cache_store (const gchar *key, const gchar *output)
+{
+    gchar *path;
+    gsize limit = report_cache_limit ();
+
+    g_return_if_fail (key && output);
+    if (!limit)
+        return;
+    gnc_report_cache_init ();
+
+    report_cache_store_memory (report_cache_memory_digest (key), output, limit);
+
+    path = report_cache_disk_path (key);
+    if (path)
+    {
+        gchar *dirname = g_path_get_dirname (path);
+        GError *error = NULL;
+        if (g_mkdir_with_parents (dirname, 0700) != 0 ||
+            !g_file_set_contents (path, output, -1, &error))
+        {
+            PWARN ("Unable to cache report output in %s: %s", path,
+                   error ? error->message : g_strerror (errno));
+            g_clear_error (&error);
+        }
+        g_free (dirname);
+    }
+    g_free (path);
+}
+
+void
+gnc_report_cache_clear (void)
+{
+    report_cache_clear_memory ();
+    ++report_cache_generation;
+}
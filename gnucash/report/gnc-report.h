@@ -58,6 +58,27 @@ GHashTable *gnc_reports_get_global(void);
 
 gchar* gnc_get_default_report_font_family(void);
 
+/** Look up the rendered output of a report in the report cache.
+ *
+ *  The key must describe everything the output depends on besides the
+ *  book and the global display settings, i.e. the report type and
+ *  options. Entries are dropped whenever the book changes and at
+ *  midnight, and aren't found while the account separator, reversed
+ *  balance, negative amount, currency or locale settings differ from
+ *  those they were stored with.
+ *
+ *  @param key The report's cache key.
+ *  @return A newly allocated copy of the output, or NULL.
+ */
+gchar* gnc_report_cache_lookup (const gchar *key);
+
+/** Store the rendered output of a report under key. Does nothing if the
+ *  cache is disabled with a cache-size of 0. */
+void gnc_report_cache_store (const gchar *key, const gchar *output);
+
+/** Drop everything from the in-memory report cache. */
+void gnc_report_cache_clear (void);
+
 gboolean gnc_saved_reports_backup (void);
 gboolean gnc_saved_reports_write_to_file (const gchar* report_def, gboolean overwrite);
 
@@ -660,6 +660,30 @@ not found.")))
           (gnc:custom-report-templates-list))))
 
 
+;; a string describing everything besides the book and the global
+;; display preferences, which gnc-report-cache-lookup adds itself, that
+;; the output of report depends on, used as its key in the rendered
+;; report cache.
+;; the html links back to the report by id, so the id is part of it.
+(define (gnc:report-cache-key report headers?)
+  (let ((stylesheet (gnc:report-stylesheet report))
+        (options (gnc:report-options report)))
+    (string-append
+     (if headers? "headers\n" "body\n")
+     (gnc:report-type report) "\n"
+     (object->string (gnc:report-id report)) "\n"
+     (object->string (qof-date-format-get)) "\n"
+     (gnc:generate-restore-forms options "options")
+     (if stylesheet
+         (gnc:generate-restore-forms
+          (gnc:html-style-sheet-options stylesheet) "options")
+         "")
+     (string-concatenate
+      (map (lambda (id)
+             (let ((subreport (gnc-report-find id)))
+               (if subreport (gnc:report-cache-key subreport #f) "")))
+           (or (gnc:report-embedded-list options) '()))))))
+
 ;; gets the renderer from the report template;
 ;; gets the stylesheet from the report;
 ;; renders the html doc and caches the resulting string;
@@ -672,14 +696,19 @@ not found.")))
       (gnc:report-ctext report)
       (let ((template (hash-ref *gnc:_report-templates_* (gnc:report-type report))))
         (and template
-             (let* ((renderer (gnc:report-template-renderer template))
+             (let* ((key (gnc:report-cache-key report headers?))
+                    (cached (gnc-report-cache-lookup key))
+                    (renderer (gnc:report-template-renderer template))
                     (stylesheet (gnc:report-stylesheet report))
-                    (doc (renderer report))
+                    (doc (and (not cached) (renderer report)))
                     (html (cond
+                           (cached cached)
                            ((string? doc) doc)
                            (else
                             (gnc:html-document-set-style-sheet! doc stylesheet)
                             (gnc:html-document-render doc headers?)))))
+               (if (and (not cached) (string? html))
+                   (gnc-report-cache-store key html))
                (gnc:report-set-ctext! report html) ;; cache the html
                (gnc:report-set-dirty?! report #f)  ;; mark it clean
                html)))))
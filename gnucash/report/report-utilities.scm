@@ -368,12 +368,54 @@
   (define (amount->monetary bal)
     (gnc:make-gnc-monetary (xaccAccountGetCommodity account) (or bal 0)))
   (define balance 0)
-  (map amount->monetary
-       (gnc:account-accumulate-at-dates
-        account dates-list #:split->elt
-        (lambda (s)
-          (if s (set! balance (+ balance (or (split->amount s) 0))))
-          balance))))
+  (if (eq? split->amount xaccSplitGetAmount)
+      (map (lambda (coll)
+             (amount->monetary
+              (cadr (coll 'getpair (xaccAccountGetCommodity account) #f))))
+           (car (gnc:accounts-get-comm-balances-at-dates
+                 (list account) (sort dates-list <))))
+      (map amount->monetary
+           (gnc:account-accumulate-at-dates
+            account dates-list #:split->elt
+            (lambda (s)
+              (if s (set! balance (+ balance (or (split->amount s) 0))))
+              balance)))))
+
+;; computes the balances of several accounts at several dates in the
+;; engine, walking each account's splits once.
+;; in:  accounts - list of accounts
+;;      dates - list of time64, in any order
+;;      include-children? - add in the balances of all descendants
+;;      cleared-only? - skip unreconciled splits
+;;      ignore-closing? - skip closing transactions
+;; out: (list (list coll-acc0-date0 coll-acc0-date1 ...)
+;;            (list coll-acc1-date0 ...) ...)
+;;      one commodity-collector per account and date; a balance at a
+;;      date includes the splits posted on that date.
+(define* (gnc:accounts-get-comm-balances-at-dates
+          accounts dates #:key include-children? cleared-only? ignore-closing?)
+  (define matrix
+    (gnc-balance-matrix-new
+     (logior (if include-children? GNC-BALANCE-INCLUDE-CHILDREN 0)
+             (if cleared-only? GNC-BALANCE-CLEARED-ONLY 0)
+             (if ignore-closing? GNC-BALANCE-EXCLUDE-CLOSING 0))))
+  (define (row->collectors row)
+    (map
+     (lambda (col)
+       (let ((coll (gnc:make-commodity-collector)))
+         (let lp ((n 0))
+           (when (< n (gnc-balance-matrix-get-n-commodities matrix row))
+             (coll 'add
+                   (gnc-balance-matrix-get-commodity matrix row n)
+                   (gnc-balance-matrix-get-balance matrix row n col))
+             (lp (1+ n))))
+         coll))
+     (iota (length dates))))
+  (for-each (lambda (acc) (gnc-balance-matrix-add-account matrix acc)) accounts)
+  (for-each (lambda (date) (gnc-balance-matrix-add-date matrix date)) dates)
+  (let ((result (map row->collectors (iota (length accounts)))))
+    (gnc-balance-matrix-free matrix)
+    result))
 
 
 ;; this function will scan through account splitlist, building a list
@@ -435,6 +477,8 @@
 ;; thus takes care of children accounts with different currencies.
 (define (gnc:account-get-comm-balance-at-date
          account date include-children?)
+  ;; a single date is served by the engine's balance checkpoints; the
+  ;; matrix only pays off across several dates.
   (let ((balance-collector (gnc:make-commodity-collector))
         (accounts (cons account
                         (if include-children?
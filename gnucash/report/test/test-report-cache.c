@@ -0,0 +1,158 @@
+/********************************************************************
+ * test-report-cache.c: Test the rendered report cache              *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+\********************************************************************/
+
+#include <config.h>
+#include <glib.h>
+#include <qof.h>
+#include <Account.h>
+#include <TransLog.h>
+#include <gnc-engine.h>
+#include <gnc-prefs.h>
+#include <gnc-prefs-p.h>
+#include <gnc-session.h>
+#include "gnc-report.h"
+
+#define KEY "body\ntest-report\n1\n"
+#define OUTPUT "<html><body>Cached</body></html>"
+
+/* A preferences backend with the report cache enabled on disk. */
+static gboolean negative_in_red = FALSE;
+
+static gboolean
+test_get_bool (const gchar *group, const gchar *pref_name)
+{
+    if (g_strcmp0 (pref_name, "cache-on-disk") == 0)
+        return TRUE;
+    if (g_strcmp0 (pref_name, GNC_PREF_NEGATIVE_IN_RED) == 0)
+        return negative_in_red;
+    return FALSE;
+}
+
+static gint
+test_get_int (const gchar *group, const gchar *pref_name)
+{
+    return g_strcmp0 (pref_name, "cache-size") == 0 ? 1 : 0;
+}
+
+static PrefsBackend test_prefs =
+{
+    .get_bool = test_get_bool,
+    .get_int = test_get_int,
+};
+
+static void
+assert_hit (void)
+{
+    gchar *output = gnc_report_cache_lookup (KEY);
+    g_assert_cmpstr (output, ==, OUTPUT);
+    g_free (output);
+}
+
+static void
+assert_miss (void)
+{
+    g_assert_null (gnc_report_cache_lookup (KEY));
+}
+
+static void
+test_hit (void)
+{
+    gnc_report_cache_store (KEY, OUTPUT);
+    assert_hit ();
+    g_assert_null (gnc_report_cache_lookup ("body\nother-report\n2\n"));
+}
+
+static void
+test_pref_change (void)
+{
+    negative_in_red = TRUE;
+    assert_miss ();
+    negative_in_red = FALSE;
+    assert_hit ();
+
+    gnc_set_account_separator ("/");
+    assert_miss ();
+    gnc_set_account_separator (":");
+    assert_hit ();
+}
+
+/* The saved book is unchanged, so the output was also written to disk and
+ * must be found there once the memory cache is gone. */
+static void
+test_on_disk (void)
+{
+    gnc_report_cache_clear ();
+    assert_hit ();
+}
+
+/* Changing the book makes both the memory and the disk entries stale. */
+static void
+test_book_change (void)
+{
+    QofBook *book = gnc_get_current_book ();
+    Account *acct = xaccMallocAccount (book);
+
+    xaccAccountBeginEdit (acct);
+    xaccAccountSetName (acct, "Changed");
+    gnc_account_append_child (gnc_book_get_root_account (book), acct);
+    xaccAccountCommitEdit (acct);
+    assert_miss ();
+}
+
+int
+main (int argc, char *argv[])
+{
+    QofSession *session;
+    gchar *dirname, *filename, *uri;
+    int result;
+
+    qof_init ();
+    qof_log_init_filename_special ("stderr");
+    g_test_init (&argc, &argv, NULL);
+    gnc_engine_init (0, NULL);
+    xaccLogDisable ();
+    prefsbackend = &test_prefs;
+
+    dirname = g_dir_make_tmp ("test-report-cache-XXXXXX", NULL);
+    g_assert_nonnull (dirname);
+    filename = g_build_filename (dirname, "book.gnucash", NULL);
+    uri = g_strconcat ("file://", filename, NULL);
+    session = qof_session_new (qof_book_new ());
+    qof_session_begin (session, uri, SESSION_NEW_STORE);
+    g_assert_cmpint (qof_session_get_error (session), ==, ERR_BACKEND_NO_ERR);
+    qof_session_save (session, NULL);
+    g_assert_cmpint (qof_session_get_error (session), ==, ERR_BACKEND_NO_ERR);
+    gnc_set_current_session (session);
+
+    g_test_add_func ("/report/cache/hit", test_hit);
+    g_test_add_func ("/report/cache/pref-change", test_pref_change);
+    g_test_add_func ("/report/cache/on-disk", test_on_disk);
+    g_test_add_func ("/report/cache/book-change", test_book_change);
+    result = g_test_run ();
+
+    qof_session_end (session);
+    gnc_clear_current_session ();
+    prefsbackend = NULL;
+    g_free (uri);
+    g_free (filename);
+    g_free (dirname);
+    return result;
+}
@@ -1050,8 +1050,10 @@ be excluded from periodic reporting.")
 ;; ;;;;;;;;;;;;;;;;;;;;
 ;; Here comes the big function that builds the whole table.
 
-(define (make-split-table splits options custom-calculated-cells
+(define (make-split-table splits group-ends options custom-calculated-cells
                           begindate)
+  ;; group-ends lists the GncSplitTableGroupEnd of each split, i.e.
+  ;; which subtotal groups end after it
 
   (define (opt-val section name)
     (let ((option (gnc:lookup-option options section name)))
@@ -1722,6 +1724,7 @@ be excluded from periodic reporting.")
                       def:secondary-subtotal-style (car splits) 'secondary))
 
     (let loop ((splits splits)
+               (group-ends group-ends)
                (odd-row? #t)
                (work-done 0))
 
@@ -1744,6 +1747,7 @@ be excluded from periodic reporting.")
           (let* ((current (car splits))
                  (rest (cdr splits))
                  (next (and (pair? rest) (car rest)))
+                 (group-end (car group-ends))
                  (split-values (add-split-row
                                 current
                                 calculated-cells
@@ -1775,9 +1779,7 @@ be excluded from periodic reporting.")
 
             (cond
              ((and primary-subtotal-comparator
-                   (or (not next)
-                       (not (equal? (primary-subtotal-comparator current)
-                                    (primary-subtotal-comparator next)))))
+                   (eqv? group-end GNC-SPLIT-TABLE-PRIMARY-END))
               (when secondary-subtotal-comparator
                 (add-subtotal-row (total-string
                                    (render-summary current 'secondary #f))
@@ -1814,9 +1816,7 @@ be excluded from periodic reporting.")
 
              (else
               (when (and secondary-subtotal-comparator
-                         (or (not next)
-                             (not (equal? (secondary-subtotal-comparator current)
-                                          (secondary-subtotal-comparator next)))))
+                         (eqv? group-end GNC-SPLIT-TABLE-SECONDARY-END))
                 (add-subtotal-row (total-string
                                    (render-summary current 'secondary #f))
                                   secondary-subtotal-collectors
@@ -1836,7 +1836,7 @@ be excluded from periodic reporting.")
                   (add-subheading (render-summary next 'secondary #t)
                                   def:secondary-subtotal-style next 'secondary)))))
 
-            (loop rest (not odd-row?) (1+ work-done)))))
+            (loop rest (cdr group-ends) (not odd-row?) (1+ work-done)))))
 
     (let ((csvlist (cond
                     ((any (lambda (cell) (vector-ref cell 4)) calculated-cells)
@@ -1967,15 +1967,6 @@ be excluded from periodic reporting.")
     (gnc:option-value (gnc:lookup-option options section name)))
   (define BOOK-SPLIT-ACTION
     (qof-book-use-split-action-for-num-field (gnc-get-current-book)))
-  (define (is-filter-member split account-list)
-    (define (same-split? s) (equal? s split))
-    (define (from-account? s) (member (xaccSplitGetAccount s) account-list))
-    (let lp ((splits (xaccTransGetSplitList (xaccSplitGetParent split))))
-      (match splits
-        (() #f)
-        (((? same-split?) . rest) (lp rest))
-        (((? from-account?) . _) #t)
-        ((_ . rest) (lp rest)))))
 
   (when filename
     (issue-deprecation-warning "trep-renderer filename is obsolete, and not \
@@ -2044,6 +2035,7 @@ warning will be removed in GnuCash 5.0"))
                          (opt-val pagename-filter optname-closing-transactions)
                          'closing-match))
          (splits '())
+         (group-ends '())
          (custom-sort? (or (and (memq primary-key DATE-SORTING-TYPES)
                                 (not (eq? primary-date-subtotal 'none)))
                            (and (memq secondary-key DATE-SORTING-TYPES)
@@ -2069,43 +2061,16 @@ warning will be removed in GnuCash 5.0"))
        (else
         (string-contains str transaction-matcher))))
 
-    (define (generic-less? split-X split-Y sortkey date-subtotal-key ascend?)
-      ;; compare splits X and Y, whereby
-      ;; sortkey and date-subtotal-key specify the options used
-      ;; ascend? specifies whether ascending or descending
-      (let* ((comparator-function
-              (if (memq sortkey DATE-SORTING-TYPES)
-                  (let ((date (keylist-get-info
-                               (sortkey-list BOOK-SPLIT-ACTION)
-                               sortkey 'split-sortvalue))
-                        (date-comparator
-                         (keylist-get-info date-subtotal-list
-                                           date-subtotal-key 'date-sortvalue)))
-                    (lambda (s)
-                      (and date-comparator (date-comparator (date s)))))
-                  (or (keylist-get-info (sortkey-list BOOK-SPLIT-ACTION)
-                                        sortkey 'split-sortvalue)
-                      (lambda (s) #f))))
-             (value-of-X (comparator-function split-X))
-             (value-of-Y (comparator-function split-Y))
-             (op (if (string? value-of-X)
-                     (if ascend? gnc:string-locale<? gnc:string-locale>?)
-                     (if ascend? < >))))
-        (and value-of-X (op value-of-X value-of-Y))))
-
-    (define (primary-comparator? X Y)
-      (generic-less? X Y primary-key
-                     primary-date-subtotal
-                     (eq? primary-order 'ascend)))
-
-    (define (secondary-comparator? X Y)
-      (generic-less? X Y secondary-key
-                     secondary-date-subtotal
-                     (eq? secondary-order 'ascend)))
-
-    ;; This will, by default, sort the split list by ascending posted-date.
-    (define (date-comparator? X Y)
-      (generic-less? X Y 'date 'none #t))
+    ;; whether make-split-table subtotals sortkey, i.e. whether it has
+    ;; a 'split-sortvalue to compare the groups with
+    (define (subtotal-key? sortkey date-subtotal subtotal?)
+      (and (if (memq sortkey DATE-SORTING-TYPES)
+               (keylist-get-info date-subtotal-list date-subtotal 'split-sortvalue)
+               (and (SUBTOTAL-ENABLED? sortkey BOOK-SPLIT-ACTION)
+                    subtotal?
+                    (keylist-get-info (sortkey-list BOOK-SPLIT-ACTION)
+                                      sortkey 'split-sortvalue)))
+           #t))
 
     (define (transaction-filter-match split)
       (or (match? (xaccTransGetDescription (xaccSplitGetParent split)))
@@ -2167,42 +2132,68 @@ warning will be removed in GnuCash 5.0"))
          query (eq? primary-order 'ascend) (eq? secondary-order 'ascend)
          #t))
 
-      (if (opt-val "__trep" "unique-transactions")
-          (set! splits (xaccQueryGetSplitsUniqueTrans query))
-          (set! splits (qof-query-run query)))
+      ;; The split table filters the splits by account and by the
+      ;; transaction matcher, sorts them when the query couldn't, and
+      ;; finds the subtotal groups, all natively.
+      (let* ((split-table (gnc-split-table-new))
+             (unique-trans? (opt-val "__trep" "unique-transactions"))
+             (native-matcher?
+              (or (string-null? transaction-matcher)
+                  (gnc-split-table-set-matcher
+                   split-table transaction-matcher
+                   (regexp? transaction-matcher-regexp)
+                   transaction-filter-case-insensitive?
+                   transaction-filter-exclude?))))
+        (gnc-split-table-set-split-action split-table BOOK-SPLIT-ACTION)
+        (unless (eq? filter-mode 'none)
+          (gnc-split-table-set-account-filter
+           split-table c_account_2 (eq? filter-mode 'exclude)))
+        (gnc-split-table-set-sort-key
+         split-table 0 (symbol->string primary-key)
+         (symbol->string primary-date-subtotal) (eq? primary-order 'ascend)
+         (subtotal-key? primary-key primary-date-subtotal
+                        (opt-val pagename-sorting optname-prime-subtotal)))
+        (gnc-split-table-set-sort-key
+         split-table 1 (symbol->string secondary-key)
+         (symbol->string secondary-date-subtotal) (eq? secondary-order 'ascend)
+         (subtotal-key? secondary-key secondary-date-subtotal
+                        (opt-val pagename-sorting optname-sec-subtotal)))
 
-      (qof-query-destroy query)
+        (cond
+         ((or split->date custom-split-filter (not native-matcher?))
+          ;; Filters in Scheme:
+          ;; - include/exclude using split->date according to date options
+          ;; - regex matcher the split table can't compile
+          ;; - custom-split-filter, a split->bool function for derived reports
+          (gnc-split-table-build
+           split-table
+           (filter
+            (lambda (split)
+              (and (or (not split->date)
+                       (let ((date (split->date split)))
+                         (if date
+                             (<= begindate date enddate)
+                             split->date-include-false?)))
+                   (or native-matcher?
+                       (if transaction-filter-exclude?
+                           (not (transaction-filter-match split))
+                           (transaction-filter-match split)))
+                   (or (not custom-split-filter)
+                       (custom-split-filter split))))
+            (if unique-trans?
+                (xaccQueryGetSplitsUniqueTrans query)
+                (qof-query-run query)))
+           custom-sort?))
+         (else
+          (gnc-split-table-run split-table query unique-trans? custom-sort?)))
 
-      ;; Combined Filter:
-      ;; - include/exclude using split->date according to date options
-      ;; - include/exclude splits to/from selected accounts
-      ;; - substring/regex matcher for Transaction Description/Notes/Memo
-      ;; - custom-split-filter, a split->bool function for derived reports
-      (set! splits
-        (filter
-         (lambda (split)
-           (let* ((trans (xaccSplitGetParent split)))
-             (and (or (not split->date)
-                      (let ((date (split->date split)))
-                        (if date
-                            (<= begindate date enddate)
-                            split->date-include-false?)))
-                  (case filter-mode
-                    ((none) #t)
-                    ((include) (is-filter-member split c_account_2))
-                    ((exclude) (not (is-filter-member split c_account_2))))
-                  (or (string-null? transaction-matcher)
-                      (if transaction-filter-exclude?
-                          (not (transaction-filter-match split))
-                          (transaction-filter-match split)))
-                  (or (not custom-split-filter)
-                      (custom-split-filter split)))))
-         splits))
-
-      (when custom-sort?
-        (set! splits (stable-sort! splits date-comparator?))
-        (set! splits (stable-sort! splits secondary-comparator?))
-        (set! splits (stable-sort! splits primary-comparator?)))
+        (set! splits (gnc-split-table-get-splits split-table))
+        (set! group-ends
+          (map (lambda (row) (gnc-split-table-get-group-end split-table row))
+               (iota (gnc-split-table-get-n-rows split-table))))
+        (gnc-split-table-free split-table))
+
+      (qof-query-destroy query)
 
       (cond
        ((null? splits)
@@ -2222,8 +2213,8 @@ warning will be removed in GnuCash 5.0"))
 
        (else
         (let-values (((table grid csvlist)
-                      (make-split-table splits options custom-calculated-cells
-                                        begindate)))
+                      (make-split-table splits group-ends options
+                                        custom-calculated-cells begindate)))
 
           (gnc:html-document-set-title! document report-title)
 
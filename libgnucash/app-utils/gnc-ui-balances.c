@@ -29,9 +29,11 @@
 #include "gnc-ui-util.h"
 
 #include <glib.h>
+#include <string.h>
 
 #include "Account.h"
 #include "Split.h"
+#include "Transaction.h"
 #include "gncOwner.h"
 #include "qof.h"
 
@@ -343,63 +345,240 @@ gnc_ui_owner_get_print_report_balance (GncOwner *owner,
 
 /* the following functions are used in window-autoclear: */
 
-#define MAXIMUM_SACK_SIZE 1000000
+/* The solver tracks, for every amount the uncleared splits can add up
+ * to, whether one or more than one combination of them reaches it. The
+ * amounts are counted in the smallest unit of the splits and kept in
+ * bitsets spanning from the sum of the negative amounts to the sum of
+ * the positive ones, so adding a split is a shift and an or.
+ */
+#define MAXIMUM_SACK_BITS (1 << 27)
+
+typedef struct
+{
+    Split *split;
+    gint64 units;
+} AutoclearItem;
+
+typedef struct
+{
+    gint64 lo;        /* the amount of bit 0 */
+    gsize n_words;
+    guint64 *words;
+} AutoclearBits;
+
+typedef struct
+{
+    GncAutoclearCancelFunc cancel;
+    gpointer cancel_data;
+    gboolean cancelled;
+} AutoclearRun;
+
+static gboolean
+autoclear_cancelled (AutoclearRun *run)
+{
+    if (!run->cancelled && run->cancel)
+        run->cancelled = run->cancel (run->cancel_data);
+    return run->cancelled;
+}
+
+static void
+bits_init (AutoclearBits *bits, gint64 lo, gint64 hi)
+{
+    bits->lo = lo;
+    bits->n_words = (hi - lo) / 64 + 1;
+    bits->words = g_new0 (guint64, bits->n_words);
+}
 
 static gboolean
-ght_gnc_numeric_equal(gconstpointer v1, gconstpointer v2)
+bits_test (const AutoclearBits *bits, gint64 value)
 {
-    gnc_numeric n1 = *(gnc_numeric *)v1, n2 = *(gnc_numeric *)v2;
-    return gnc_numeric_equal(n1, n2);
+    guint64 bit = value - bits->lo;
+
+    if (value < bits->lo || bit / 64 >= bits->n_words)
+        return FALSE;
+    return (bits->words[bit / 64] >> (bit % 64)) & 1;
 }
 
-static guint
-ght_gnc_numeric_hash(gconstpointer v1)
+static void
+bits_set (AutoclearBits *bits, gint64 value)
 {
-    gnc_numeric n1 = *(gnc_numeric *)v1;
-    gdouble d1 = gnc_numeric_to_double(n1);
-    return g_double_hash (&d1);
+    guint64 bit = value - bits->lo;
+    bits->words[bit / 64] |= G_GUINT64_CONSTANT (1) << (bit % 64);
 }
 
-typedef struct _sack_foreach_data_t
+/* dst |= src shifted up by shift bits, or down for a negative shift,
+ * for the words from first to before end. dst may be src: the words
+ * are visited so that each source word is read before it is written. */
+static void
+bits_or_shifted (guint64 *dst, const guint64 *src, gsize n_words,
+                 gsize first, gsize end, gint64 shift)
 {
-    gnc_numeric split_value;
-    GList *reachable_list;
-} *sack_foreach_data_t;
+    gsize w = ABS (shift) / 64;
+    guint b = ABS (shift) % 64;
+
+    if (w >= n_words)
+        return;
+
+    if (shift >= 0)
+    {
+        for (gsize i = end; i-- > MAX (first, w); )
+        {
+            guint64 word = src[i - w] << b;
+            if (b && i > w)
+                word |= src[i - w - 1] >> (64 - b);
+            dst[i] |= word;
+        }
+    }
+    else
+    {
+        for (gsize i = first; i < end && i + w < n_words; i++)
+        {
+            guint64 word = src[i + w] >> b;
+            if (b && i + w + 1 < n_words)
+                word |= src[i + w + 1] << (64 - b);
+            dst[i] |= word;
+        }
+    }
+}
 
-static void sack_foreach_func(gpointer key, gpointer value, gpointer user_data)
+static void
+items_range (const AutoclearItem *items, gsize n, gint64 *lo, gint64 *hi)
 {
-    sack_foreach_data_t data = (sack_foreach_data_t) user_data;
-    gnc_numeric thisvalue = *(gnc_numeric *) key;
-    gnc_numeric reachable_value = gnc_numeric_add_fixed (thisvalue, data->split_value);
+    *lo = *hi = 0;
+    for (gsize i = 0; i < n; i++)
+    {
+        if (items[i].units < 0)
+            *lo += items[i].units;
+        else
+            *hi += items[i].units;
+    }
+}
+
+/* Mark the amounts reachable by some combination of the items, the
+ * empty one included. If twice is given, also mark there the amounts
+ * reached by more than one combination. */
+static gboolean
+sack_fill (const AutoclearItem *items, gsize n, AutoclearBits *once,
+           AutoclearBits *twice, AutoclearRun *run)
+{
+    gint64 lo, hi;
+    guint64 *shifted;
+
+    items_range (items, n, &lo, &hi);
+    bits_init (once, lo, hi);
+    if (twice)
+        bits_init (twice, lo, hi);
+    bits_set (once, 0);
+    lo = hi = 0;
+
+    /* Only the words between the lowest and highest sums of the items
+     * added so far can change. */
+    shifted = g_new0 (guint64, once->n_words);
+    for (gsize i = 0; i < n; i++)
+    {
+        gsize first, end;
+
+        if (autoclear_cancelled (run))
+            break;
+
+        if (items[i].units < 0)
+            lo += items[i].units;
+        else
+            hi += items[i].units;
+        first = (lo - once->lo) / 64;
+        end = (hi - once->lo) / 64 + 1;
+
+        bits_or_shifted (shifted, once->words, once->n_words, first, end,
+                         items[i].units);
+        if (twice)
+        {
+            bits_or_shifted (twice->words, twice->words, twice->n_words,
+                             first, end, items[i].units);
+            for (gsize j = first; j < end; j++)
+                twice->words[j] |= once->words[j] & shifted[j];
+        }
+        for (gsize j = first; j < end; j++)
+        {
+            once->words[j] |= shifted[j];
+            shifted[j] = 0;
+        }
+    }
+    g_free (shifted);
+    return !run->cancelled;
+}
+
+/* Append to solution the items of the only combination adding up to
+ * target, halving the items each time so that the bitsets never span
+ * more than the amounts of the half being split. */
+static gboolean
+sack_solve (const AutoclearItem *items, gsize n, gint64 target,
+            GList **solution, AutoclearRun *run)
+{
+    AutoclearBits first = { 0, 0, NULL }, second = { 0, 0, NULL };
+    gsize half = n / 2;
+    gint64 target_first = 0;
+    gboolean found = FALSE;
+
+    if (n == 1)
+    {
+        if (target)
+            *solution = g_list_prepend (*solution, items[0].split);
+        return TRUE;
+    }
+
+    if (!sack_fill (items, half, &first, NULL, run) ||
+        !sack_fill (items + half, n - half, &second, NULL, run))
+    {
+        g_free (first.words);
+        g_free (second.words);
+        return FALSE;
+    }
+
+    for (gint64 value = first.lo; !found && value < first.lo +
+             (gint64)first.n_words * 64; value++)
+    {
+        if (bits_test (&first, value) && bits_test (&second, target - value))
+        {
+            target_first = value;
+            found = TRUE;
+        }
+    }
+    g_free (first.words);
+    g_free (second.words);
 
-    data->reachable_list = g_list_prepend
-        (data->reachable_list, g_memdup (&reachable_value, sizeof (gnc_numeric)));
+    return sack_solve (items, half, target_first, solution, run) &&
+        sack_solve (items + half, n - half, target - target_first, solution, run);
 }
 
 GList *
-gnc_account_get_autoclear_splits (Account *account, gnc_numeric toclear_value,
-                                  gchar **errmsg)
+gnc_account_get_autoclear_splits_full (Account *account,
+                                       gnc_numeric toclear_value,
+                                       time64 end_date,
+                                       GncAutoclearCancelFunc cancel,
+                                       gpointer cancel_data,
+                                       gchar **errmsg)
 {
     GList *nc_list = NULL, *toclear_list = NULL;
-    GHashTable *sack;
-    gchar *msg = NULL;
-    guint sack_size = 0;
+    AutoclearRun run = { cancel, cancel_data, FALSE };
+    AutoclearBits once = { 0, 0, NULL }, twice = { 0, 0, NULL };
+    AutoclearItem *items = NULL;
+    gsize n_items = 0;
+    gint64 denom = 1, target, lo, hi, partial = 0;
+    const gchar *msg = NULL;
 
     g_return_val_if_fail (GNC_IS_ACCOUNT (account), NULL);
 
-    sack = g_hash_table_new_full (ght_gnc_numeric_hash, ght_gnc_numeric_equal,
-                                  g_free, NULL);
-
     /* Extract which splits are not cleared and compute the amount we have to clear */
     for (GList *node = xaccAccountGetSplitList (account); node; node = node->next)
     {
         Split *split = (Split *)node->data;
 
-        if (xaccSplitGetReconcile (split) == NREC)
-            nc_list = g_list_prepend (nc_list, split);
-        else
+        if (xaccSplitGetReconcile (split) != NREC)
             toclear_value = gnc_numeric_sub_fixed
                 (toclear_value, xaccSplitGetAmount (split));
+        else if (end_date == INT64_MAX ||
+                 xaccTransGetDate (xaccSplitGetParent (split)) <= end_date)
+            nc_list = g_list_prepend (nc_list, split);
     }
 
     if (gnc_numeric_zero_p (toclear_value))
@@ -408,81 +587,97 @@ gnc_account_get_autoclear_splits (Account *account, gnc_numeric toclear_value,
         goto skip_knapsack;
     }
 
-    /* Run knapsack */
-    /* Entries in the hash table are:
-     *  - key   = amount to which we know how to clear (freed by GHashTable)
-     *  - value = last split we used to clear this amount (not managed by GHashTable)
-     */
+    /* Count every amount in the smallest unit they share. */
     for (GList *node = nc_list; node; node = node->next)
     {
-        Split *split = (Split *)node->data;
-        gnc_numeric split_value = xaccSplitGetAmount (split);
-
-        struct _sack_foreach_data_t s_data[1];
-        s_data->split_value = split_value;
-        s_data->reachable_list = NULL;
-
-        /* For each value in the sack, compute a new reachable value */
-        g_hash_table_foreach (sack, sack_foreach_func, s_data);
-
-        /* Add the value of the split itself to the reachable_list */
-        s_data->reachable_list = g_list_prepend
-            (s_data->reachable_list, g_memdup (&split_value, sizeof (gnc_numeric)));
+        gint64 split_denom = gnc_numeric_denom (xaccSplitGetAmount (node->data));
+        gint64 gcd = denom, rest = split_denom;
 
-        /* Add everything to the sack, looking out for duplicates */
-        for (GList *s_node = s_data->reachable_list; s_node; s_node = s_node->next)
+        while (rest)
         {
-            gnc_numeric *reachable_value = s_node->data;
-
-            /* Check if it already exists */
-            if (g_hash_table_lookup_extended (sack, reachable_value, NULL, NULL))
-            {
-                /* If yes, we are in trouble, we reached an amount
-                   using two solutions */
-                g_hash_table_insert (sack, reachable_value, NULL);
-            }
-            else
-            {
-                g_hash_table_insert (sack, reachable_value, split);
-                sack_size++;
-
-                if (sack_size > MAXIMUM_SACK_SIZE)
-                {
-                    msg = _("Too many uncleared splits");
-                    goto skip_knapsack;
-                }
-            }
+            gint64 tmp = gcd % rest;
+            gcd = rest;
+            rest = tmp;
+        }
+        if (split_denom <= 0 || denom / gcd > MAXIMUM_SACK_BITS / split_denom)
+        {
+            msg = _("Too many uncleared splits");
+            goto skip_knapsack;
         }
-        g_list_free (s_data->reachable_list);
+        denom = denom / gcd * split_denom;
     }
 
-    /* Check solution */
-    while (!gnc_numeric_zero_p (toclear_value))
+    toclear_value = gnc_numeric_convert (toclear_value, denom, GNC_HOW_RND_NEVER);
+    if (gnc_numeric_check (toclear_value))
     {
-        Split *split = NULL;
+        msg = _("The selected amount cannot be cleared.");
+        goto skip_knapsack;
+    }
+    target = gnc_numeric_num (toclear_value);
 
-        if (!g_hash_table_lookup_extended (sack, &toclear_value,
-                                           NULL, (gpointer) &split))
-        {
-            msg = _("The selected amount cannot be cleared.");
-            goto skip_knapsack;
-        }
+    items = g_new (AutoclearItem, g_list_length (nc_list));
+    lo = hi = 0;
+    for (GList *node = nc_list; node; node = node->next)
+    {
+        gnc_numeric amount = gnc_numeric_convert (xaccSplitGetAmount (node->data),
+                                                  denom, GNC_HOW_RND_NEVER);
+        gint64 units = gnc_numeric_num (amount);
 
-        if (!split)
+        if (ABS (units) > MAXIMUM_SACK_BITS ||
+            (hi - lo) + ABS (units) > MAXIMUM_SACK_BITS)
         {
-            msg = _("Cannot uniquely clear splits. Found multiple possibilities.");
+            msg = _("Too many uncleared splits");
             goto skip_knapsack;
         }
+        if (units < 0)
+            lo += units;
+        else
+            hi += units;
+        items[n_items].split = node->data;
+        items[n_items].units = units;
+        n_items++;
+    }
 
-        toclear_list = g_list_prepend (toclear_list, split);
-        toclear_value = gnc_numeric_sub_fixed (toclear_value,
-                                               xaccSplitGetAmount (split));
+    if (!sack_fill (items, n_items, &once, &twice, &run))
+        goto skip_knapsack;
+
+    if (!bits_test (&once, target))
+    {
+        msg = _("The selected amount cannot be cleared.");
+        goto skip_knapsack;
+    }
+
+    if (bits_test (&twice, target))
+    {
+        msg = _("Cannot uniquely clear splits. Found multiple possibilities.");
+        goto skip_knapsack;
+    }
+
+    if (!sack_solve (items, n_items, target, &toclear_list, &run))
+        goto skip_knapsack;
+
+    /* Auto-clear also refuses a unique combination if, removing its
+     * splits in turn, one of the amounts on the way can be reached
+     * some other way. Three splits of the same amount are only cleared
+     * by hand. */
+    for (gsize i = 0; i < n_items && !msg; i++)
+    {
+        if (!g_list_find (toclear_list, items[i].split))
+            continue;
+        partial += items[i].units;
+        if (partial != target && bits_test (&twice, partial))
+            msg = _("Cannot uniquely clear splits. Found multiple possibilities.");
     }
 
  skip_knapsack:
-    g_hash_table_destroy (sack);
+    g_free (once.words);
+    g_free (twice.words);
+    g_free (items);
     g_list_free (nc_list);
 
+    if (run.cancelled)
+        msg = _("Auto-clear was cancelled.");
+
     if (msg)
     {
         *errmsg = g_strdup (msg);
@@ -493,3 +688,12 @@ gnc_account_get_autoclear_splits (Account *account, gnc_numeric toclear_value,
     *errmsg = NULL;
     return toclear_list;
 }
+
+GList *
+gnc_account_get_autoclear_splits (Account *account, gnc_numeric toclear_value,
+                                  gchar **errmsg)
+{
+    return gnc_account_get_autoclear_splits_full (account, toclear_value,
+                                                  INT64_MAX, NULL, NULL,
+                                                  errmsg);
+}
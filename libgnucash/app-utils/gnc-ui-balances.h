@@ -154,4 +154,21 @@ gchar * gnc_ui_owner_get_print_report_balance (GncOwner *owner,
  */
 GList * gnc_account_get_autoclear_splits (Account *account, gnc_numeric toclear_value,
                                           gchar **errmsg);
+
+/** Polled while looking for the splits to clear; returning TRUE stops
+ *  the search. */
+typedef gboolean (*GncAutoclearCancelFunc) (gpointer user_data);
+
+/** Like gnc_account_get_autoclear_splits(), leaving out the uncleared
+ *  splits posted after end_date; pass INT64_MAX to consider them all.
+ *  cancel, if given, is called with cancel_data as the search goes on;
+ *  once it returns TRUE no splits are returned and *errmsg says the
+ *  search was cancelled.
+ */
+GList * gnc_account_get_autoclear_splits_full (Account *account,
+                                               gnc_numeric toclear_value,
+                                               time64 end_date,
+                                               GncAutoclearCancelFunc cancel,
+                                               gpointer cancel_data,
+                                               gchar **errmsg);
 #endif /* GNC_UI_BALANCES_H_ */
@@ -62,9 +62,6 @@
 #define GNC_PREF_CURRENCY_CHOICE_LOCALE "currency-choice-locale"
 #define GNC_PREF_CURRENCY_CHOICE_OTHER  "currency-choice-other"
 #define GNC_PREF_CURRENCY_OTHER         "currency-other"
-#define GNC_PREF_REVERSED_ACCTS_NONE    "reversed-accounts-none"
-#define GNC_PREF_REVERSED_ACCTS_CREDIT  "reversed-accounts-credit"
-#define GNC_PREF_REVERSED_ACCTS_INC_EXP "reversed-accounts-incomeexpense"
 #define GNC_PREF_PRICES_FORCE_DECIMAL   "force-price-decimal"
 
 static QofLogModule log_module = GNC_MOD_GUI;
@@ -44,6 +44,11 @@ typedef QofSession * (*QofSessionCB) (void);
 
 
 gchar *gnc_normalize_account_separator (const gchar* separator);
+
+/* Which accounts have their balances reversed for display */
+#define GNC_PREF_REVERSED_ACCTS_NONE    "reversed-accounts-none"
+#define GNC_PREF_REVERSED_ACCTS_CREDIT  "reversed-accounts-credit"
+#define GNC_PREF_REVERSED_ACCTS_INC_EXP "reversed-accounts-incomeexpense"
 gboolean gnc_reverse_balance(const Account *account);
 
 /* Backward compatibility *******************************************
@@ -0,0 +1,87 @@
+/********************************************************************
+ * bench-autoclear.cpp: Benchmarks for the Auto-Clear solver.       *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, you can retrieve it from        *
+ * https://www.gnu.org/licenses/old-licenses/gpl-2.0.html            *
+ * or contact:                                                      *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ ********************************************************************/
+
+/* Times gnc_account_get_autoclear_splits on a card account with 50,
+ * 200 and 1000 uncleared charges of up to 500.00, asking to clear every
+ * third one. Not run by ctest; build the bench-autoclear target and run
+ * it by hand, optionally passing a random seed.
+ */
+
+#include "config.h"
+
+extern "C" {
+#include "../gnc-ui-balances.h"
+}
+#include <Split.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+using Clock = std::chrono::steady_clock;
+
+int
+main (int argc, char** argv)
+{
+    unsigned seed = argc > 1 ? std::strtoul (argv[1], nullptr, 10) : 1;
+    const int split_counts[] = {50, 200, 1000};
+    std::mt19937 rng (seed);
+    std::uniform_int_distribution<gint64> cents (1, 50000);
+    qof_init ();
+
+    for (auto n_splits : split_counts)
+    {
+        auto book = qof_book_new ();
+        auto account = xaccMallocAccount (book);
+        gint64 toclear = 0;
+
+        xaccAccountBeginEdit (account);
+        for (auto i = 0; i < n_splits; ++i)
+        {
+            auto split = xaccMallocSplit (book);
+            auto amount = -cents (rng);
+            xaccSplitSetAmount (split, gnc_numeric_create (amount, 100));
+            xaccSplitSetReconcile (split, NREC);
+            xaccSplitSetAccount (split, account);
+            gnc_account_insert_split (account, split);
+            if (i % 3 == 0)
+                toclear += amount;
+        }
+        xaccAccountCommitEdit (account);
+
+        char* err = nullptr;
+        auto start = Clock::now ();
+        auto splits = gnc_account_get_autoclear_splits
+            (account, gnc_numeric_create (toclear, 100), &err);
+        auto ms = std::chrono::duration<double, std::milli> (Clock::now () - start).count ();
+        printf ("%5d uncleared splits %9.2f ms  %s\n", n_splits, ms,
+                err ? err : "cleared");
+
+        g_free (err);
+        g_list_free (splits);
+        qof_book_destroy (book);
+    }
+
+    qof_close ();
+    return 0;
+}
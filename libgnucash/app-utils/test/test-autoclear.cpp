@@ -107,6 +107,23 @@ TestCase ambiguousTestCase = {
     },
 };
 
+// Every combination of the splits adds up to a different amount: far more
+// amounts than a table of them could hold.
+static TestCase
+make_powers_test_case ()
+{
+    TestCase test_case;
+    for (int i = 0; i < 25; i++)
+        test_case.splits.push_back ({ "Power", -(INT64_C(1) << i), false });
+    test_case.tests = {
+        { -((INT64_C(1) << 24) + (1 << 3) + 1), NULL },
+        { -((INT64_C(1) << 25) - 1), NULL },
+    };
+    return test_case;
+}
+
+TestCase powersTestCase = make_powers_test_case ();
+
 class AutoClearTest : public ::testing::TestWithParam<TestCase *> {
 protected:
     std::shared_ptr<QofBook> m_book;
@@ -156,6 +173,35 @@ TEST_P(AutoClearTest, DoesAutoClear) {
     }
 }
 
+static gboolean
+cancel_now (gpointer user_data)
+{
+    ++*static_cast<int*>(user_data);
+    return TRUE;
+}
+
+TEST(AutoClearCancel, StopsSearch) {
+    std::shared_ptr<QofBook> book(qof_book_new(), qof_book_destroy);
+    Account *account = xaccMallocAccount(book.get());
+    xaccAccountBeginEdit(account);
+    for (auto amount : { -10, -20, -40 }) {
+        Split *split = xaccMallocSplit(book.get());
+        xaccSplitSetAmount(split, gnc_numeric_create(amount, DENOM));
+        xaccSplitSetAccount(split, account);
+        gnc_account_insert_split(account, split);
+    }
+    xaccAccountCommitEdit(account);
+
+    int calls = 0;
+    char *err;
+    GList *splits_to_clear = gnc_account_get_autoclear_splits_full
+        (account, gnc_numeric_create(-30, DENOM), INT64_MAX, cancel_now, &calls, &err);
+    EXPECT_EQ(splits_to_clear, nullptr);
+    EXPECT_STREQ(err, "Auto-clear was cancelled.");
+    EXPECT_EQ(calls, 1);
+    g_free(err);
+}
+
 #ifndef INSTANTIATE_TEST_SUITE_P
 // Silence "no previous declaration for" which is treated as error, due to -Werror
 testing::internal::ParamGenerator<TestCase*> gtest_InstantiationAutoClearTestAutoClearTest_EvalGenerator_();
@@ -169,6 +215,7 @@ INSTANTIATE_TEST_SUITE_P(
     AutoClearTest,
     ::testing::Values(
         &easyTestCase,
-        &ambiguousTestCase
+        &ambiguousTestCase,
+        &powersTestCase
     )
 );
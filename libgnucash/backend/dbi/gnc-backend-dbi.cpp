@@ -848,6 +848,7 @@ GncDbiBackend<Type>::session_end ()
 {
     ENTER (" ");
 
+    flush_pending ();
     finalize_version_info ();
     connect(nullptr);
 
@@ -965,6 +966,13 @@ GncDbiBackend<Type>::safe_sync (QofBook* book)
     g_return_if_fail (book != nullptr);
 
     ENTER ("book=%p, primary=%p", book, m_book);
+    /* Write queued commits before the tables are moved aside so that they
+     * don't end up in the backup. */
+    if (!flush_pending())
+    {
+        LEAVE ("Failed to write queued changes");
+        return;
+    }
     if (!conn->begin_transaction())
     {
         LEAVE("Failed to obtain a transaction.");
@@ -1008,6 +1016,13 @@ GncDbiBackend<DbType::DBI_MYSQL>::safe_sync (QofBook* book)
     g_return_if_fail (book != nullptr);
 
     ENTER ("book=%p, primary=%p", book, m_book);
+    /* Write queued commits before the tables are moved aside so that they
+     * don't end up in the backup. */
+    if (!flush_pending())
+    {
+        LEAVE ("Failed to write queued changes");
+        return;
+    }
     if (!conn->table_operation (TableOpType::backup))
     {
         set_error(ERR_BACKEND_SERVER_ERR);
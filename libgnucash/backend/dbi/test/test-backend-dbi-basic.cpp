@@ -54,6 +54,8 @@ extern "C"
 /* For test_conn_index_functions */
 #include "../gnc-backend-dbi.hpp"
 #include "../gnc-backend-dbi.h"
+#include <gnc-sql-result.hpp>
+#include <guid.hpp>
 extern "C"
 {
 #include <unittest-support.h>
@@ -423,6 +425,376 @@ test_dbi_store_and_reload (Fixture* fixture, gconstpointer pData)
     qof_session_destroy (session_3);
 }
 
+/* Change, add and remove nested slots of an account that is already in
+ * the database, which saves only the changed slot rows, then load it
+ * back and compare. */
+static KvpValue*
+make_list_value (std::vector<KvpValue*> values)
+{
+    GList* list = nullptr;
+    for (auto value : values)
+        list = g_list_append (list, value);
+    return new KvpValue {list};
+}
+
+static void
+set_slot (KvpFrame* frame, Path path, KvpValue* value)
+{
+    delete frame->set_path (path, value);
+}
+
+static void
+test_dbi_slots_delta (Fixture* fixture, gconstpointer pData)
+{
+    const gchar* url = (const gchar*)pData;
+    auto msg = "[GncDbiSqlConnection::unlock_database()] There was no lock entry in the Lock table";
+    auto log_domain = nullptr;
+    auto loglevel = static_cast<GLogLevelFlags> (G_LOG_LEVEL_WARNING |
+                                                 G_LOG_FLAG_FATAL);
+    TestErrorStruct* check = test_error_struct_new (log_domain, loglevel, msg);
+    fixture->hdlrs = test_log_set_fatal_handler (fixture->hdlrs, check,
+                                                 (GLogFunc)test_checked_handler);
+    if (fixture->filename)
+        url = fixture->filename;
+
+    auto book = qof_session_get_book (fixture->session);
+    auto table = gnc_commodity_table_get_table (book);
+    auto currency = gnc_commodity_table_lookup (table, GNC_COMMODITY_NS_CURRENCY,
+                                                "CAD");
+    auto acct = xaccMallocAccount (book);
+    xaccAccountBeginEdit (acct);
+    xaccAccountSetType (acct, ACCT_TYPE_BANK);
+    xaccAccountSetName (acct, "Slots");
+    xaccAccountSetCommodity (acct, currency);
+    auto frame = qof_instance_get_slots (QOF_INSTANCE (acct));
+    set_slot (frame, {"nested", "changed"}, new KvpValue {INT64_C (1)});
+    set_slot (frame, {"nested", "removed"}, new KvpValue {g_strdup ("gone")});
+    set_slot (frame, {"nested", "kept", "deep"}, new KvpValue {2.5});
+    set_slot (frame, {"list-val"},
+              make_list_value ({new KvpValue {INT64_C (1)},
+                                new KvpValue {g_strdup ("two")}}));
+    set_slot (frame, {"frame-to-scalar", "child"}, new KvpValue {INT64_C (3)});
+    set_slot (frame, {"scalar-to-frame"}, new KvpValue {INT64_C (4)});
+    gnc_account_append_child (gnc_book_get_root_account (book), acct);
+    xaccAccountCommitEdit (acct);
+    auto guid = *qof_instance_get_guid (QOF_INSTANCE (acct));
+
+    // Save the session data
+    auto session_2 = qof_session_new (qof_book_new());
+    qof_session_begin (session_2, url, SESSION_NEW_OVERWRITE);
+    g_assert_cmpint (qof_session_get_error (session_2), == , ERR_BACKEND_NO_ERR);
+    qof_session_swap_data (fixture->session, session_2);
+    qof_book_mark_session_dirty (qof_session_get_book (session_2));
+    qof_session_save (session_2, NULL);
+    g_assert_cmpint (qof_session_get_error (session_2), == , ERR_BACKEND_NO_ERR);
+
+    // Edit the slots; committing the account writes the difference
+    xaccAccountBeginEdit (acct);
+    set_slot (frame, {"nested", "changed"}, new KvpValue {INT64_C (10)});
+    set_slot (frame, {"nested", "removed"}, nullptr);
+    set_slot (frame, {"nested", "kept", "added"}, new KvpValue {g_strdup ("new")});
+    set_slot (frame, {"list-val"},
+              make_list_value ({new KvpValue {INT64_C (1)},
+                                new KvpValue {g_strdup ("three")},
+                                new KvpValue {INT64_C (4)}}));
+    set_slot (frame, {"frame-to-scalar"}, new KvpValue {g_strdup ("scalar")});
+    set_slot (frame, {"scalar-to-frame"}, nullptr);
+    set_slot (frame, {"scalar-to-frame", "child"}, new KvpValue {INT64_C (5)});
+    xaccAccountSetDescription (acct, "Slots changed");
+    xaccAccountCommitEdit (acct);
+    g_assert_cmpint (qof_session_get_error (session_2), == , ERR_BACKEND_NO_ERR);
+
+    // An unchanged frame writes nothing and must stay intact
+    xaccAccountBeginEdit (acct);
+    xaccAccountSetDescription (acct, "Slots unchanged");
+    xaccAccountCommitEdit (acct);
+    g_assert_cmpint (qof_session_get_error (session_2), == , ERR_BACKEND_NO_ERR);
+
+    // Reload the session data
+    auto session_3 = qof_session_new (qof_book_new());
+    qof_session_begin (session_3, url, SESSION_READ_ONLY);
+    g_assert_cmpint (qof_session_get_error (session_3), == , ERR_BACKEND_NO_ERR);
+    qof_session_load (session_3, NULL);
+    g_assert_cmpint (qof_session_get_error (session_3), == , ERR_BACKEND_NO_ERR);
+
+    auto acct_3 = xaccAccountLookup (&guid, qof_session_get_book (session_3));
+    g_assert (acct_3 != nullptr);
+    auto frame_3 = qof_instance_get_slots (QOF_INSTANCE (acct_3));
+    g_assert (compare (frame, frame_3) == 0);
+    g_assert (frame_3->get_slot ({"nested", "removed"}) == nullptr);
+    g_assert_cmpint (frame_3->get_slot ({"nested", "changed"})->get<int64_t> (),
+                     == , 10);
+    g_assert_cmpstr (frame_3->get_slot ({"frame-to-scalar"})->get<const char*> (),
+                     == , "scalar");
+    g_assert_cmpint (frame_3->get_slot ({"scalar-to-frame", "child"})->get<int64_t> (),
+                     == , 5);
+    g_assert_cmpuint (g_list_length (frame_3->get_slot ({"list-val"})->get<GList*> ()),
+                      == , 3);
+
+    /* fixture->session belongs to the fixture and teardown() will clean it up */
+    qof_session_end (session_2);
+    qof_session_destroy (session_2);
+    qof_session_end (session_3);
+    qof_session_destroy (session_3);
+}
+
+/* Open a database with only its recent transactions loaded and check
+ * that what walks an account's splits gets the older ones too: a
+ * balance as of an old date, and deleting an account, which must leave
+ * none of its splits behind in the database. */
+static Account*
+make_account (QofBook* book, gnc_commodity* currency, const char* name)
+{
+    auto acct = xaccMallocAccount (book);
+    xaccAccountBeginEdit (acct);
+    xaccAccountSetType (acct, ACCT_TYPE_BANK);
+    xaccAccountSetName (acct, name);
+    xaccAccountSetCommodity (acct, currency);
+    gnc_account_append_child (gnc_book_get_root_account (book), acct);
+    xaccAccountCommitEdit (acct);
+    return acct;
+}
+
+static void
+make_transfer (QofBook* book, gnc_commodity* currency, Account* to,
+               Account* from, int days_ago, gint64 cents)
+{
+    auto amount = gnc_numeric_create (cents, 100);
+    auto tx = xaccMallocTransaction (book);
+    xaccTransBeginEdit (tx);
+    xaccTransSetCurrency (tx, currency);
+    xaccTransSetDatePostedSecsNormalized (tx, gnc_time (nullptr) -
+                                          days_ago * 24 * 60 * 60);
+    auto split = xaccMallocSplit (book);
+    xaccTransAppendSplit (tx, split);
+    xaccSplitSetAccount (split, to);
+    xaccSplitSetAmount (split, amount);
+    xaccSplitSetValue (split, amount);
+    split = xaccMallocSplit (book);
+    xaccTransAppendSplit (tx, split);
+    xaccSplitSetAccount (split, from);
+    xaccSplitSetAmount (split, gnc_numeric_neg (amount));
+    xaccSplitSetValue (split, gnc_numeric_neg (amount));
+    xaccTransCommitEdit (tx);
+}
+
+static QofSession*
+open_session (const gchar* url, SessionOpenMode mode, int days)
+{
+    auto session = qof_session_new (qof_book_new());
+    qof_session_begin (session, url, mode);
+    g_assert_cmpint (qof_session_get_error (session), == , ERR_BACKEND_NO_ERR);
+    auto sql_be = static_cast<GncSqlBackend*>(qof_session_get_backend (session));
+    sql_be->set_lazy_load_days (days);
+    qof_session_load (session, NULL);
+    g_assert_cmpint (qof_session_get_error (session), == , ERR_BACKEND_NO_ERR);
+    return session;
+}
+
+static void
+test_dbi_lazy_load (Fixture* fixture, gconstpointer pData)
+{
+    const gchar* url = (const gchar*)pData;
+    auto msg = "[GncDbiSqlConnection::unlock_database()] There was no lock entry in the Lock table";
+    auto log_domain = nullptr;
+    auto loglevel = static_cast<GLogLevelFlags> (G_LOG_LEVEL_WARNING |
+                                                 G_LOG_FLAG_FATAL);
+    TestErrorStruct* check = test_error_struct_new (log_domain, loglevel, msg);
+    fixture->hdlrs = test_log_set_fatal_handler (fixture->hdlrs, check,
+                                                 (GLogFunc)test_checked_handler);
+    if (fixture->filename)
+        url = fixture->filename;
+
+    auto book = qof_session_get_book (fixture->session);
+    auto table = gnc_commodity_table_get_table (book);
+    auto currency = gnc_commodity_table_lookup (table, GNC_COMMODITY_NS_CURRENCY,
+                                                "CAD");
+    auto kept = make_account (book, currency, "Kept");
+    auto gone = make_account (book, currency, "Gone");
+    auto other = make_account (book, currency, "Other");
+    make_transfer (book, currency, kept, other, 400, 1000);
+    make_transfer (book, currency, kept, other, 300, 2000);
+    make_transfer (book, currency, kept, other, 5, 500);
+    make_transfer (book, currency, gone, other, 200, 700);
+    make_transfer (book, currency, gone, other, 3, 100);
+    auto kept_guid = *qof_instance_get_guid (QOF_INSTANCE (kept));
+    auto gone_guid = *qof_instance_get_guid (QOF_INSTANCE (gone));
+
+    // Save the session data
+    auto session_2 = qof_session_new (qof_book_new());
+    qof_session_begin (session_2, url, SESSION_NEW_OVERWRITE);
+    g_assert_cmpint (qof_session_get_error (session_2), == , ERR_BACKEND_NO_ERR);
+    qof_session_swap_data (fixture->session, session_2);
+    qof_book_mark_session_dirty (qof_session_get_book (session_2));
+    qof_session_save (session_2, NULL);
+    g_assert_cmpint (qof_session_get_error (session_2), == , ERR_BACKEND_NO_ERR);
+    qof_session_end (session_2);
+    qof_session_destroy (session_2);
+
+    // Load the last 30 days
+    auto session_3 = open_session (url, SESSION_NORMAL_OPEN, 30);
+    auto book_3 = qof_session_get_book (session_3);
+    auto txs_3 = qof_book_get_collection (book_3, GNC_ID_TRANS);
+    auto kept_3 = xaccAccountLookup (&kept_guid, book_3);
+    auto gone_3 = xaccAccountLookup (&gone_guid, book_3);
+    g_assert (kept_3 != nullptr && gone_3 != nullptr);
+    auto n_recent = qof_collection_count (txs_3);
+    g_assert (gnc_numeric_equal (xaccAccountGetBalance (kept_3),
+                                 gnc_numeric_create (3500, 100)));
+
+    // Deleting an account loads and deletes all of its splits
+    xaccAccountBeginEdit (gone_3);
+    xaccAccountDestroy (gone_3);
+    g_assert_cmpint (qof_session_get_error (session_3), == , ERR_BACKEND_NO_ERR);
+    g_assert_cmpuint (qof_collection_count (txs_3), == , n_recent + 1);
+
+    // A balance before the loaded dates loads the account's splits from
+    // that date on only, here none
+    auto date = gnc_time (nullptr) - 250 * 24 * 60 * 60;
+    g_assert (gnc_numeric_equal (xaccAccountGetBalanceAsOfDate (kept_3, date),
+                                 gnc_numeric_create (3000, 100)));
+    g_assert_cmpuint (qof_collection_count (txs_3), == , n_recent + 1);
+    auto early = gnc_time (nullptr) - 350 * 24 * 60 * 60;
+    g_assert (gnc_numeric_equal (xaccAccountGetBalanceAsOfDate (kept_3, early),
+                                 gnc_numeric_create (1000, 100)));
+    g_assert_cmpuint (qof_collection_count (txs_3), == , n_recent + 2);
+    g_assert_cmpuint (g_list_length (xaccAccountGetSplitListSince (kept_3, early)),
+                      == , 2);
+
+    // The whole split list still loads the rest of the account
+    g_assert_cmpuint (g_list_length (xaccAccountGetSplitList (kept_3)), == , 3);
+    g_assert_cmpuint (qof_collection_count (txs_3), == , n_recent + 3);
+    g_assert (gnc_numeric_equal (xaccAccountGetBalance (kept_3),
+                                 gnc_numeric_create (3500, 100)));
+    qof_session_end (session_3);
+    qof_session_destroy (session_3);
+
+    // Reload everything; no split may be left in the deleted account
+    auto session_4 = open_session (url, SESSION_NORMAL_OPEN, 0);
+    auto book_4 = qof_session_get_book (session_4);
+    g_assert (xaccAccountLookup (&gone_guid, book_4) == nullptr);
+    auto sql_be = static_cast<GncSqlBackend*>(qof_session_get_backend (session_4));
+    auto stmt = sql_be->create_statement_from_sql (
+        "SELECT guid FROM splits WHERE account_guid = '" +
+        gnc::GUID(gone_guid).to_string() + "'");
+    auto result = sql_be->execute_select_statement (stmt);
+    g_assert (result != nullptr);
+    g_assert_cmpuint (result->size (), == , 0);
+    auto kept_4 = xaccAccountLookup (&kept_guid, book_4);
+    g_assert (gnc_numeric_equal (xaccAccountGetBalanceAsOfDate (kept_4, date),
+                                 gnc_numeric_create (3000, 100)));
+    qof_session_end (session_4);
+    qof_session_destroy (session_4);
+}
+
+/* Damage stored balance checkpoints other than the latest ones. Loading
+ * trusts them, but checking them on request or after the version which
+ * last checked them changed must notice and repair the damage. Then check
+ * that a read-only session builds missing ones without storing them. */
+static size_t
+count_checkpoint_rows (QofSession* session)
+{
+    auto sql_be = static_cast<GncSqlBackend*>(qof_session_get_backend (session));
+    auto stmt = sql_be->create_statement_from_sql ("SELECT account_guid FROM "
+                                                   "balance_checkpoints");
+    auto result = sql_be->execute_select_statement (stmt);
+    g_assert (result != nullptr);
+    return result->size ();
+}
+
+static void
+test_dbi_checkpoints (Fixture* fixture, gconstpointer pData)
+{
+    const gchar* url = (const gchar*)pData;
+    auto msg = "[GncDbiSqlConnection::unlock_database()] There was no lock entry in the Lock table";
+    auto log_domain = nullptr;
+    auto loglevel = static_cast<GLogLevelFlags> (G_LOG_LEVEL_WARNING |
+                                                 G_LOG_FLAG_FATAL);
+    TestErrorStruct* check = test_error_struct_new (log_domain, loglevel, msg);
+    auto rebuilt = "[GncSqlTransBackend::load_checkpoints()] The balance checkpoints don't match the splits, rebuilding them.";
+    TestErrorStruct* check_rebuilt = test_error_struct_new ("gnc.backend.sql",
+                                                            loglevel, rebuilt);
+    test_add_error (check);
+    test_add_error (check_rebuilt);
+    fixture->hdlrs = test_log_set_fatal_handler (fixture->hdlrs, check,
+                                                 (GLogFunc)test_list_handler);
+    if (fixture->filename)
+        url = fixture->filename;
+
+    auto book = qof_session_get_book (fixture->session);
+    auto table = gnc_commodity_table_get_table (book);
+    auto currency = gnc_commodity_table_lookup (table, GNC_COMMODITY_NS_CURRENCY,
+                                                "CAD");
+    auto acct = make_account (book, currency, "Checked");
+    auto other = make_account (book, currency, "Other");
+    make_transfer (book, currency, acct, other, 100, 1000);
+    make_transfer (book, currency, acct, other, 70, 2000);
+    make_transfer (book, currency, acct, other, 40, 4000);
+    auto guid = *qof_instance_get_guid (QOF_INSTANCE (acct));
+
+    // Save the session data
+    auto session_2 = qof_session_new (qof_book_new());
+    qof_session_begin (session_2, url, SESSION_NEW_OVERWRITE);
+    g_assert_cmpint (qof_session_get_error (session_2), == , ERR_BACKEND_NO_ERR);
+    qof_session_swap_data (fixture->session, session_2);
+    qof_book_mark_session_dirty (qof_session_get_book (session_2));
+    qof_session_save (session_2, NULL);
+    g_assert_cmpint (qof_session_get_error (session_2), == , ERR_BACKEND_NO_ERR);
+    qof_session_end (session_2);
+    qof_session_destroy (session_2);
+
+    // Load them once, which stores them, and damage all but the latest
+    auto damage = "UPDATE balance_checkpoints SET balance_num = balance_num + 1 "
+        "WHERE account_guid = '" + gnc::GUID(guid).to_string () +
+        "' AND balance_num > 0 AND balance_num < 7000";
+    auto session_3 = open_session (url, SESSION_NORMAL_OPEN, 0);
+    g_assert_cmpuint (count_checkpoint_rows (session_3), > , 0);
+    auto sql_be = static_cast<GncSqlBackend*>(qof_session_get_backend (session_3));
+    auto stmt = sql_be->create_statement_from_sql (damage);
+    g_assert_cmpint (sql_be->execute_nonselect_statement (stmt), > , 0);
+    qof_session_end (session_3);
+    qof_session_destroy (session_3);
+
+    // The damage is trusted at open and repaired on request
+    auto date = gnc_time (nullptr) - 55 * 24 * 60 * 60;
+    auto session_4 = open_session (url, SESSION_NORMAL_OPEN, 0);
+    g_assert_cmpint (check_rebuilt->hits, == , 0);
+    auto acct_4 = xaccAccountLookup (&guid, qof_session_get_book (session_4));
+    sql_be = static_cast<GncSqlBackend*>(qof_session_get_backend (session_4));
+    sql_be->verify_checkpoints ();
+    g_assert_cmpint (check_rebuilt->hits, == , 1);
+    g_assert (gnc_numeric_equal (xaccAccountGetBalanceAsOfDate (acct_4, date),
+                                 gnc_numeric_create (3000, 100)));
+
+    // and repaired at open when another version last checked them
+    stmt = sql_be->create_statement_from_sql (damage);
+    g_assert_cmpint (sql_be->execute_nonselect_statement (stmt), > , 0);
+    sql_be->set_table_version ("balance_checkpoints-verified", 1);
+    qof_session_end (session_4);
+    qof_session_destroy (session_4);
+
+    session_4 = open_session (url, SESSION_NORMAL_OPEN, 0);
+    g_assert_cmpint (check_rebuilt->hits, == , 2);
+    acct_4 = xaccAccountLookup (&guid, qof_session_get_book (session_4));
+    g_assert (gnc_numeric_equal (xaccAccountGetBalanceAsOfDate (acct_4, date),
+                                 gnc_numeric_create (3000, 100)));
+    sql_be = static_cast<GncSqlBackend*>(qof_session_get_backend (session_4));
+    stmt = sql_be->create_statement_from_sql ("DELETE FROM balance_checkpoints");
+    g_assert_cmpint (sql_be->execute_nonselect_statement (stmt), != , -1);
+    qof_session_end (session_4);
+    qof_session_destroy (session_4);
+
+    auto session_5 = open_session (url, SESSION_READ_ONLY, 0);
+    auto acct_5 = xaccAccountLookup (&guid, qof_session_get_book (session_5));
+    g_assert (gnc_account_get_balance_checkpoint (acct_5, date, nullptr));
+    g_assert (gnc_numeric_equal (xaccAccountGetBalanceAsOfDate (acct_5, date),
+                                 gnc_numeric_create (3000, 100)));
+    g_assert_cmpuint (count_checkpoint_rows (session_5), == , 0);
+    qof_session_end (session_5);
+    qof_session_destroy (session_5);
+    test_clear_error_list ();
+}
+
 /** Test the safe_save mechanism.  Beware that this test used on its
  * own doesn't ensure that the resave is done safely, only that the
  * database is intact and unchanged after the save. To observe the
@@ -644,6 +1016,12 @@ create_dbi_test_suite (const char* dbm_name, const char* url)
     auto subsuite = g_strdup_printf ("%s/%s", suitename, dbm_name);
     GNC_TEST_ADD (subsuite, "store_and_reload", Fixture, url, setup,
                   test_dbi_store_and_reload, teardown);
+    GNC_TEST_ADD (subsuite, "slots_delta", Fixture, url, setup_memory,
+                  test_dbi_slots_delta, teardown);
+    GNC_TEST_ADD (subsuite, "lazy_load", Fixture, url, setup_memory,
+                  test_dbi_lazy_load, teardown);
+    GNC_TEST_ADD (subsuite, "checkpoints", Fixture, url, setup_memory,
+                  test_dbi_checkpoints, teardown);
     GNC_TEST_ADD (subsuite, "safe_save", Fixture, url, setup_memory,
                   test_dbi_safe_save, teardown);
     GNC_TEST_ADD (subsuite, "version_control", Fixture, url, setup_memory,
@@ -40,8 +40,11 @@ extern "C"
 #endif
 }
 
+#include <algorithm>
 #include <string>
 #include <sstream>
+#include <unordered_map>
+#include <vector>
 
 #include "gnc-sql-connection.hpp"
 #include "gnc-sql-backend.hpp"
@@ -75,6 +78,8 @@ struct slot_info_t
     KvpValue* pKvpValue;
     std::string path;
     std::string parent_path;
+    /* If set, save_slot collects the rows here instead of inserting them. */
+    std::vector<PairVec>* rows = nullptr;
 };
 
 
@@ -570,6 +575,7 @@ slot_info_copy (slot_info_t* pInfo, GncGUID* guid)
     newSlot->pList = pInfo->pList;
     newSlot->context = pInfo->context;
     newSlot->pKvpValue = pInfo->pKvpValue;
+    newSlot->rows = pInfo->rows;
     if (!pInfo->path.empty())
         newSlot->parent_path = pInfo->path + "/";
     else
@@ -577,6 +583,31 @@ slot_info_copy (slot_info_t* pInfo, GncGUID* guid)
     return newSlot;
 }
 
+/* The column values of the slot described by pInfo, as they would be
+ * inserted.
+ */
+static PairVec
+slot_values (slot_info_t* pInfo)
+{
+    PairVec vec;
+    for (auto const& table_row : col_table)
+        if (!table_row->is_autoincr())
+            table_row->add_to_query (TABLE_NAME, pInfo, vec);
+    return vec;
+}
+
+static bool
+insert_slot (slot_info_t& slot_info)
+{
+    if (slot_info.rows != nullptr)
+    {
+        slot_info.rows->push_back (slot_values (&slot_info));
+        return true;
+    }
+    return slot_info.be->do_db_operation (OP_DB_INSERT, TABLE_NAME, TABLE_NAME,
+                                          &slot_info, col_table);
+}
+
 static void
 save_slot (const char* key, KvpValue* value, slot_info_t & slot_info)
 {
@@ -600,11 +631,7 @@ save_slot (const char* key, KvpValue* value, slot_info_t & slot_info)
         slot_info_t* pNewInfo = slot_info_copy (&slot_info, guid);
         KvpValue* oldValue = slot_info.pKvpValue;
         slot_info.pKvpValue = new KvpValue {guid};
-        slot_info.is_ok = slot_info.be->do_db_operation(OP_DB_INSERT,
-                                                            TABLE_NAME,
-                                                            TABLE_NAME,
-                                                            &slot_info,
-                                                            col_table);
+        slot_info.is_ok = insert_slot (slot_info);
         g_return_if_fail (slot_info.is_ok);
         pKvpFrame->for_each_slot_temp (save_slot, *pNewInfo);
         delete slot_info.pKvpValue;
@@ -618,11 +645,7 @@ save_slot (const char* key, KvpValue* value, slot_info_t & slot_info)
         slot_info_t* pNewInfo = slot_info_copy (&slot_info, guid);
         KvpValue* oldValue = slot_info.pKvpValue;
         slot_info.pKvpValue = new KvpValue {guid};  // Transfer ownership!
-        slot_info.is_ok = slot_info.be->do_db_operation(OP_DB_INSERT,
-                                                            TABLE_NAME,
-                                                            TABLE_NAME,
-                                                            &slot_info,
-                                                            col_table);
+        slot_info.is_ok = insert_slot (slot_info);
         g_return_if_fail (slot_info.is_ok);
         for (auto cursor = value->get<GList*> (); cursor; cursor = cursor->next)
         {
@@ -636,16 +659,340 @@ save_slot (const char* key, KvpValue* value, slot_info_t & slot_info)
     break;
     default:
     {
-        slot_info.is_ok = slot_info.be->do_db_operation (OP_DB_INSERT,
-                                                             TABLE_NAME,
-                                                             TABLE_NAME,
-                                                             &slot_info,
-                                                             col_table);
+        slot_info.is_ok = insert_slot (slot_info);
     }
     break;
     }
 }
 
+/* ----------------------------------------------------------------- */
+/* Delta saving.
+ *
+ * Rather than deleting every slot row of an object and inserting the whole
+ * frame again, the rows already in the database are read one frame level at
+ * a time and compared with the frame in memory. Nested frames whose row is
+ * still a frame are compared recursively, reusing their stored guid; rows
+ * whose value changed are updated, rows that no longer exist are deleted
+ * and new slots are inserted, with the deletes and inserts each sent as one
+ * statement per batch.
+ *
+ * The comparison is done against the database instead of by recording
+ * changes in the frame because KVP values are routinely modified in place
+ * through the pointers returned by KvpFrame::get_slot, which a frame
+ * can't observe.
+ */
+
+/* Number of rows or guids put in one statement. */
+static const size_t SLOT_BATCH_SIZE = 200;
+
+struct stored_slot_t
+{
+    int64_t id;
+    std::string name;
+    KvpValue::Type type;
+    GncGUID child_guid;  /* For frame and list rows */
+    bool has_child;
+    PairVec values;      /* For scalar rows, as slot_values would render them */
+    bool seen;
+};
+
+using StoredSlots = std::unordered_map<std::string, std::vector<stored_slot_t>>;
+
+struct pending_frame_t
+{
+    KvpFrame* frame;
+    GncGUID guid;
+    std::string parent_path;
+};
+
+struct slot_delta_t
+{
+    std::vector<PairVec> inserts;
+    std::vector<std::pair<int64_t, PairVec>> updates;
+    std::vector<int64_t> deletes;
+    std::vector<GncGUID> deleted_children;
+};
+
+static void
+read_stored_slot (GncSqlBackend* sql_be, GncSqlRow& row, StoredSlots& stored)
+{
+    stored_slot_t slot;
+    std::string obj_guid;
+    try
+    {
+        slot.id = row.get_int_at_col (col_table[id_col]->name());
+        obj_guid = row.get_string_at_col (col_table[obj_guid_col]->name());
+        slot.name = row.get_string_at_col (col_table[name_col]->name());
+        slot.type = static_cast<KvpValue::Type>(
+            row.get_int_at_col (col_table[slot_type_col]->name()));
+    }
+    catch (std::invalid_argument&)
+    {
+        return;
+    }
+    slot.seen = false;
+    slot.has_child = false;
+    if (slot.type == KvpValue::Type::FRAME || slot.type == KvpValue::Type::GLIST)
+    {
+        try
+        {
+            auto val = row.get_string_at_col (col_table[guid_val_col]->name());
+            slot.has_child = string_to_guid (val.c_str(), &slot.child_guid);
+        }
+        catch (std::invalid_argument&)
+        {
+        }
+    }
+    else
+    {
+        /* Load the value as the loader would, then render it the way it
+         * would be saved so that it compares equal to an unchanged slot. */
+        KvpFrame scratch;
+        slot_info_t info = { NULL, NULL, TRUE, NULL, KvpValue::Type::INVALID,
+                             NULL, LIST, NULL, "" };
+        info.be = sql_be;
+        info.pKvpFrame = &scratch;
+        gnc_sql_load_object (sql_be, row, TABLE_NAME, &info, col_table);
+        if (info.pList != nullptr)
+        {
+            GncGUID guid;
+            string_to_guid (obj_guid.c_str(), &guid);
+            info.guid = &guid;
+            info.path = slot.name;
+            info.value_type = slot.type;
+            info.pKvpValue = static_cast<KvpValue*>(info.pList->data);
+            slot.values = slot_values (&info);
+        }
+        g_list_free_full (info.pList, [](gpointer value) {
+                delete static_cast<KvpValue*>(value); });
+    }
+    stored[obj_guid].push_back (std::move (slot));
+}
+
+static bool
+read_stored_slots (GncSqlBackend* sql_be,
+                   const std::vector<pending_frame_t>& frames,
+                   StoredSlots& stored)
+{
+    for (size_t start = 0; start < frames.size(); start += SLOT_BATCH_SIZE)
+    {
+        std::string sql{"SELECT * FROM " TABLE_NAME " WHERE obj_guid IN ("};
+        auto end = std::min (frames.size(), start + SLOT_BATCH_SIZE);
+        for (auto i = start; i < end; ++i)
+        {
+            if (i > start)
+                sql += ",";
+            sql += "'" + gnc::GUID{frames[i].guid}.to_string() + "'";
+        }
+        sql += ")";
+        auto stmt = sql_be->create_statement_from_sql (sql);
+        if (stmt == nullptr)
+            return false;
+        auto result = sql_be->execute_select_statement (stmt);
+        if (result == nullptr)
+            return false;
+        for (auto row : *result)
+            read_stored_slot (sql_be, row, stored);
+        delete result;
+    }
+    return true;
+}
+
+static void
+drop_stored_slot (stored_slot_t& slot, slot_delta_t& delta)
+{
+    delta.deletes.push_back (slot.id);
+    if (slot.has_child)
+        delta.deleted_children.push_back (slot.child_guid);
+}
+
+static bool
+compare_frame (GncSqlBackend* sql_be, pending_frame_t& pending,
+               std::vector<stored_slot_t>& stored, slot_delta_t& delta,
+               std::vector<pending_frame_t>& next_level)
+{
+    std::unordered_map<std::string, stored_slot_t*> by_name;
+    for (auto& slot : stored)
+        by_name.emplace (slot.name, &slot);
+
+    bool is_ok = true;
+    pending.frame->for_each_slot_temp (
+        [&](const char* key, KvpValue* value)
+        {
+            if (!is_ok)
+                return;
+            auto path = pending.parent_path + key;
+            auto type = value->get_type ();
+            stored_slot_t* old = nullptr;
+            auto iter = by_name.find (path);
+            if (iter != by_name.end() && !iter->second->seen)
+            {
+                old = iter->second;
+                old->seen = true;
+            }
+
+            if (old && type == KvpValue::Type::FRAME &&
+                old->type == KvpValue::Type::FRAME && old->has_child)
+            {
+                next_level.push_back ({value->get<KvpFrame*>(),
+                                       old->child_guid, path + "/"});
+                return;
+            }
+
+            slot_info_t info = { NULL, NULL, TRUE, NULL, KvpValue::Type::INVALID,
+                                 NULL, FRAME, NULL, "" };
+            info.be = sql_be;
+            info.guid = &pending.guid;
+            info.parent_path = pending.parent_path;
+            info.rows = &delta.inserts;
+
+            if (old && type == old->type && type != KvpValue::Type::FRAME &&
+                type != KvpValue::Type::GLIST && !old->values.empty())
+            {
+                info.path = path;
+                info.value_type = type;
+                info.pKvpValue = value;
+                auto values = slot_values (&info);
+                if (values == old->values)
+                    return;
+                /* Columns the old value had but the new one doesn't must be
+                 * cleared. */
+                for (auto const& old_col : old->values)
+                    if (std::find_if (values.begin(), values.end(),
+                                      [&old_col](const PairVec::value_type& col)
+                                      { return col.first == old_col.first; })
+                        == values.end())
+                        values.emplace_back (old_col.first, "NULL");
+                delta.updates.emplace_back (old->id, std::move (values));
+                return;
+            }
+
+            if (old)
+                drop_stored_slot (*old, delta);
+            save_slot (key, value, info);
+            is_ok = info.is_ok;
+        });
+
+    for (auto& slot : stored)
+        if (!slot.seen)
+            drop_stored_slot (slot, delta);
+    return is_ok;
+}
+
+static bool
+execute_sql (GncSqlBackend* sql_be, const std::string& sql)
+{
+    auto stmt = sql_be->create_statement_from_sql (sql);
+    return stmt != nullptr && sql_be->execute_nonselect_statement (stmt) != -1;
+}
+
+/* Insert rows, SLOT_BATCH_SIZE at a time, each batch as one multi-row
+ * INSERT. Rows can lack columns whose value is NULL, so the column list is
+ * the union of all of them. */
+static bool
+insert_slot_rows (GncSqlBackend* sql_be, const std::vector<PairVec>& rows)
+{
+    for (size_t start = 0; start < rows.size(); start += SLOT_BATCH_SIZE)
+    {
+        auto end = std::min (rows.size(), start + SLOT_BATCH_SIZE);
+        std::vector<std::string> columns;
+        for (auto i = start; i < end; ++i)
+            for (auto const& col : rows[i])
+                if (std::find (columns.begin(), columns.end(), col.first) ==
+                    columns.end())
+                    columns.push_back (col.first);
+
+        std::string sql{"INSERT INTO " TABLE_NAME "("};
+        for (auto const& col : columns)
+        {
+            if (&col != &columns.front())
+                sql += ",";
+            sql += col;
+        }
+        sql += ") VALUES";
+        for (auto i = start; i < end; ++i)
+        {
+            sql += i > start ? ",(" : "(";
+            for (auto const& col : columns)
+            {
+                if (&col != &columns.front())
+                    sql += ",";
+                auto value = std::find_if (rows[i].begin(), rows[i].end(),
+                                           [&col](const PairVec::value_type& v)
+                                           { return v.first == col; });
+                sql += value == rows[i].end() ? std::string{"NULL"} : value->second;
+            }
+            sql += ")";
+        }
+        if (!execute_sql (sql_be, sql))
+            return false;
+    }
+    return true;
+}
+
+static bool
+apply_slot_delta (GncSqlBackend* sql_be, const slot_delta_t& delta)
+{
+    for (auto const& child : delta.deleted_children)
+        if (!gnc_sql_slots_delete (sql_be, &child))
+            return false;
+
+    for (size_t start = 0; start < delta.deletes.size(); start += SLOT_BATCH_SIZE)
+    {
+        auto end = std::min (delta.deletes.size(), start + SLOT_BATCH_SIZE);
+        std::ostringstream sql;
+        sql << "DELETE FROM " TABLE_NAME " WHERE " << col_table[id_col]->name()
+            << " IN (";
+        for (auto i = start; i < end; ++i)
+            sql << (i > start ? "," : "") << delta.deletes[i];
+        sql << ")";
+        if (!execute_sql (sql_be, sql.str()))
+            return false;
+    }
+
+    for (auto const& update : delta.updates)
+    {
+        std::ostringstream sql;
+        sql << "UPDATE " TABLE_NAME " SET ";
+        for (auto const& col : update.second)
+        {
+            if (&col != &update.second.front())
+                sql << ",";
+            sql << col.first << "=" << col.second;
+        }
+        sql << " WHERE " << col_table[id_col]->name() << "=" << update.first;
+        if (!execute_sql (sql_be, sql.str()))
+            return false;
+    }
+
+    return insert_slot_rows (sql_be, delta.inserts);
+}
+
+static gboolean
+save_slots_delta (GncSqlBackend* sql_be, const GncGUID* guid, KvpFrame* pFrame)
+{
+    slot_delta_t delta;
+    std::vector<pending_frame_t> level{{pFrame, *guid, ""}};
+    while (!level.empty())
+    {
+        StoredSlots stored;
+        if (!read_stored_slots (sql_be, level, stored))
+            return FALSE;
+        std::vector<pending_frame_t> next_level;
+        for (auto& pending : level)
+        {
+            auto& slots = stored[gnc::GUID{pending.guid}.to_string()];
+            if (!compare_frame (sql_be, pending, slots, delta, next_level))
+                return FALSE;
+        }
+        level.swap (next_level);
+    }
+    DEBUG ("%" G_GSIZE_FORMAT " inserts, %" G_GSIZE_FORMAT " updates, %"
+           G_GSIZE_FORMAT " deletes", delta.inserts.size(),
+           delta.updates.size(), delta.deletes.size());
+    return apply_slot_delta (sql_be, delta);
+}
+
 gboolean
 gnc_sql_slots_save (GncSqlBackend* sql_be, const GncGUID* guid, gboolean is_infant,
                     QofInstance* inst)
@@ -658,17 +1005,17 @@ gnc_sql_slots_save (GncSqlBackend* sql_be, const GncGUID* guid, gboolean is_infa
     g_return_val_if_fail (guid != NULL, FALSE);
     g_return_val_if_fail (pFrame != NULL, FALSE);
 
-    // If this is not saving into a new db, clear out the old saved slots first
+    // If this is not saving into a new db, update the old saved slots
     if (!sql_be->pristine() && !is_infant)
-    {
-        (void)gnc_sql_slots_delete (sql_be, guid);
-    }
+        return save_slots_delta (sql_be, guid, pFrame);
 
+    std::vector<PairVec> rows;
     slot_info.be = sql_be;
     slot_info.guid = guid;
+    slot_info.rows = &rows;
     pFrame->for_each_slot_temp (save_slot, slot_info);
 
-    return slot_info.is_ok;
+    return slot_info.is_ok && insert_slot_rows (sql_be, rows);
 }
 
 gboolean
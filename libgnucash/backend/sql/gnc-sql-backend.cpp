@@ -69,6 +69,8 @@ static QofLogModule log_module = G_LOG_DOMAIN;
 #define MAX_TABLE_NAME_LEN 50
 #define TABLE_COL_NAME "table_name"
 #define VERSION_COL_NAME "table_version"
+#define GNC_PREF_SQL_WRITE_BEHIND "sql-write-behind-ms"
+#define GNC_PREF_SQL_LAZY_LOAD "sql-lazy-load-days"
 
 using StrVec = std::vector<std::string>;
 
@@ -88,11 +90,24 @@ GncSqlBackend::GncSqlBackend(GncSqlConnection *conn, QofBook* book) :
         connect (conn);
 }
 
+GncSqlBackend::~GncSqlBackend()
+{
+    if (!m_pending.empty())
+        PWARN ("Discarding %" G_GSIZE_FORMAT " unwritten commits",
+               m_pending.size());
+    clear_pending();
+}
+
 void
 GncSqlBackend::connect(GncSqlConnection *conn) noexcept
 {
     if (m_conn != nullptr && m_conn != conn)
+    {
+        /* Write anything still queued while the old connection is open. */
+        flush_pending();
+        clear_pending();
         delete m_conn;
+    }
     finalize_version_info();
     m_conn = conn;
 }
@@ -288,6 +303,8 @@ GncSqlBackend::load (QofBook* book, QofBackendLoadType loadType)
 
         auto num_types = m_backend_registry.size();
         auto num_done = 0;
+        auto lazy_days = m_lazy_load_days >= 0 ? m_lazy_load_days :
+            gnc_prefs_get_int (GNC_PREFS_GROUP_GENERAL, GNC_PREF_SQL_LAZY_LOAD);
 
         /* Load any initial stuff. Some of this needs to happen in a certain order */
         for (auto type : fixed_load_order)
@@ -297,7 +314,17 @@ GncSqlBackend::load (QofBook* book, QofBackendLoadType loadType)
             if (obe)
             {
                 update_progress(num_done * 100 / num_types);
-                obe->load_all(this);
+                if (lazy_days > 0 && type == GNC_ID_TRANS)
+                {
+                    /* Older transactions are loaded when a query needs
+                     * them, see load_for_query(). */
+                    auto since = gnc_time64_get_day_start (gnc_time (nullptr))
+                        - static_cast<time64>(lazy_days) * 24 * 60 * 60;
+                    std::static_pointer_cast<GncSqlTransBackend>(obe)->
+                        load_since (this, since);
+                }
+                else
+                    obe->load_all(this);
             }
         }
         for (auto type : business_fixed_load_order)
@@ -319,6 +346,10 @@ GncSqlBackend::load (QofBook* book, QofBackendLoadType loadType)
 
         gnc_account_foreach_descendant(root, (AccountCb)xaccAccountCommitEdit,
                                        nullptr);
+
+        auto obe = std::static_pointer_cast<GncSqlTransBackend>(
+            m_backend_registry.get_object_backend (GNC_ID_TRANS));
+        obe->load_checkpoints (this);
     }
     else if (loadType == LOAD_TYPE_LOAD_ALL)
     {
@@ -341,6 +372,45 @@ GncSqlBackend::load (QofBook* book, QofBackendLoadType loadType)
     qof_book_mark_session_saved (book);
     finish_progress();
 
+    if (loadType == LOAD_TYPE_INITIAL_LOAD)
+    {
+        auto latency = gnc_prefs_get_int (GNC_PREFS_GROUP_GENERAL,
+                                          GNC_PREF_SQL_WRITE_BEHIND);
+        set_write_behind (latency > 0 ? latency : 0);
+    }
+
+    LEAVE ("");
+}
+
+bool
+GncSqlBackend::may_write() const noexcept
+{
+    if (m_conn == nullptr || m_conn->read_only())
+        return false;
+    if (m_book != nullptr && qof_book_is_readonly (m_book))
+        return false;
+    return get_table_version ("Gnucash-Resave") <= GNUCASH_RESAVE_VERSION;
+}
+
+void
+GncSqlBackend::load_for_query (QofBook* book, QofQuery* query)
+{
+    if (m_loading || m_in_query || book != m_book)
+        return;
+
+    auto obe = std::static_pointer_cast<GncSqlTransBackend>(
+        m_backend_registry.get_object_backend (GNC_ID_TRANS));
+    if (!obe || !obe->lazy())
+        return;
+
+    ENTER ("sql_be=%p, book=%p, query=%p", this, book, query);
+    m_in_query = true;
+    m_loading = true;
+    qof_event_suspend ();
+    obe->load_for_query (this, query);
+    qof_event_resume ();
+    m_loading = false;
+    m_in_query = false;
     LEAVE ("");
 }
 
@@ -461,6 +531,16 @@ GncSqlBackend::sync(QofBook* book)
     g_return_if_fail (book != NULL);
     g_return_if_fail (m_conn != nullptr);
 
+    /* When changes to the open book are being written behind, saving it
+     * only has to write what is still queued. */
+    if (book == m_book && !m_pending.empty() && !m_is_pristine_db)
+    {
+        ENTER ("book=%p, flushing queued changes", book);
+        flush_pending();
+        LEAVE ("book=%p", book);
+        return;
+    }
+
     reset_version_info();
     ENTER ("book=%p, sql_be->book=%p", book, m_book);
     update_progress(101.0);
@@ -469,7 +549,8 @@ GncSqlBackend::sync(QofBook* book)
     m_is_pristine_db = true;
     create_tables();
 
-    /* Save all contents */
+    /* Save all contents. That covers anything still waiting to be written
+     * behind, so it's marked clean along with the rest of the book. */
     m_book = book;
     auto is_ok = m_conn->begin_transaction();
 
@@ -508,6 +589,12 @@ GncSqlBackend::sync(QofBook* book)
     if (is_ok)
     {
         m_is_pristine_db = false;
+        for (auto inst : m_pending)
+        {
+            qof_instance_mark_clean (inst);
+            qof_instance_set_infant (inst, FALSE);
+        }
+        clear_pending();
 
         /* Mark the session as clean -- though it shouldn't ever get
          * marked dirty with this backend
@@ -609,30 +696,25 @@ GncSqlBackend::commit (QofInstance* inst)
         return;
     }
 
-    if (!m_conn->begin_transaction ())
+    if (m_write_behind_ms > 0)
     {
-        PERR ("begin_transaction failed\n");
-        LEAVE ("Rolled back - database transaction begin error");
+        queue_commit (inst);
+        /* A destroyed instance is freed as soon as this returns, so it and
+         * everything queued before it must be written now. */
+        if (is_destroying || m_pending.size() >= m_write_behind_batch)
+            flush_pending ();
+        LEAVE ("queued");
         return;
     }
 
-    bool is_ok = true;
-
-    auto obe = m_backend_registry.get_object_backend(std::string{inst->e_type});
-    if (obe != nullptr)
-        is_ok = obe->commit(this, inst);
-    else
+    if (!m_conn->begin_transaction ())
     {
-        PERR ("Unknown object type '%s'\n", inst->e_type);
-        (void)m_conn->rollback_transaction ();
-
-        // Don't let unknown items still mark the book as being dirty
-        qof_book_mark_session_saved(m_book);
-        qof_instance_mark_clean (inst);
-        LEAVE ("Rolled back - unknown object type");
+        PERR ("begin_transaction failed\n");
+        LEAVE ("Rolled back - database transaction begin error");
         return;
     }
-    if (!is_ok)
+
+    if (!commit_instance (inst))
     {
         // Error - roll it back
         (void)m_conn->rollback_transaction();
@@ -650,6 +732,189 @@ GncSqlBackend::commit (QofInstance* inst)
     LEAVE ("");
 }
 
+/* Write one instance with its object backend inside the caller's database
+ * transaction. Returns false on a database error; instances of unknown type
+ * are logged, marked clean and otherwise ignored.
+ */
+bool
+GncSqlBackend::commit_instance (QofInstance* inst) noexcept
+{
+    auto obe = m_backend_registry.get_object_backend(std::string{inst->e_type});
+    if (obe == nullptr)
+    {
+        PERR ("Unknown object type '%s'\n", inst->e_type);
+
+        // Don't let unknown items still mark the book as being dirty
+        qof_book_mark_session_saved(m_book);
+        qof_instance_mark_clean (inst);
+        return true;
+    }
+    return obe->commit(this, inst);
+}
+
+/* ================================================================= */
+/* Write-behind support */
+
+/* Nobody waits for the result of a timed flush, so a failure is reported
+ * the way a failed commit is, through the engine's commit error handler.
+ * The retries report nothing more until a flush succeeds. The error also
+ * stays with the backend for qof_session_get_error(). */
+gboolean
+GncSqlBackend::flush_pending_timeout (gpointer data) noexcept
+{
+    auto sql_be = static_cast<GncSqlBackend*>(data);
+    if (sql_be->flush_pending ())
+    {
+        sql_be->m_flush_error_reported = false;
+        return G_SOURCE_REMOVE;
+    }
+
+    auto err = sql_be->get_error ();
+    if (err == ERR_BACKEND_NO_ERR)
+        return G_SOURCE_REMOVE;
+    sql_be->set_error (err);
+    if (!sql_be->m_flush_error_reported)
+    {
+        sql_be->m_flush_error_reported = true;
+        gnc_engine_signal_commit_error (err);
+    }
+    return G_SOURCE_REMOVE;
+}
+
+void
+GncSqlBackend::set_write_behind (unsigned int max_latency_ms,
+                                 size_t max_batch) noexcept
+{
+    if (max_latency_ms == 0)
+        flush_pending ();
+    m_write_behind_ms = max_latency_ms;
+    m_write_behind_batch = std::max (max_batch, size_t{1});
+}
+
+void
+GncSqlBackend::queue_commit (QofInstance* inst) noexcept
+{
+    if (m_pending_set.insert (inst).second)
+    {
+        g_object_ref (inst);
+        m_pending.push_back (inst);
+    }
+    /* The balance checkpoints only change when a transaction is written,
+     * so the accounts mustn't use them while one is queued. */
+    if (GNC_IS_TRANSACTION (inst))
+        std::static_pointer_cast<GncSqlTransBackend>(
+            m_backend_registry.get_object_backend (GNC_ID_TRANS))->
+            use_checkpoints (m_book, false);
+    if (m_flush_source == 0)
+        m_flush_source = g_timeout_add (m_write_behind_ms,
+                                        flush_pending_timeout, this);
+}
+
+void
+GncSqlBackend::clear_pending () noexcept
+{
+    if (m_flush_source != 0)
+    {
+        g_source_remove (m_flush_source);
+        m_flush_source = 0;
+    }
+    for (auto inst : m_pending)
+        g_object_unref (inst);
+    m_pending.clear();
+    m_pending_set.clear();
+}
+
+void
+GncSqlBackend::verify_checkpoints () noexcept
+{
+    g_return_if_fail (m_book != nullptr);
+
+    flush_pending ();
+    auto trans_obe = std::static_pointer_cast<GncSqlTransBackend>(
+        m_backend_registry.get_object_backend (GNC_ID_TRANS));
+    trans_obe->load_checkpoints (this, true);
+}
+
+bool
+GncSqlBackend::flush_pending () noexcept
+{
+    if (m_flush_source != 0)
+    {
+        g_source_remove (m_flush_source);
+        m_flush_source = 0;
+    }
+    if (m_pending.empty() || m_conn == nullptr)
+        return m_pending.empty();
+
+    ENTER ("%" G_GSIZE_FORMAT " queued instances", m_pending.size());
+    /* Instances that have been opened for editing again since they were
+     * queued are left for the next flush so that half-edited objects are
+     * never written; their pending commit_edit will queue them anyway. */
+    std::vector<QofInstance*> batch, deferred;
+    for (auto inst : m_pending)
+    {
+        if (qof_instance_get_editlevel (inst) > 0 &&
+            !qof_instance_get_destroying (inst))
+            deferred.push_back (inst);
+        else
+            batch.push_back (inst);
+    }
+
+    bool is_ok = batch.empty() || m_conn->begin_transaction ();
+    for (auto inst : batch)
+    {
+        if (!is_ok)
+            break;
+        is_ok = commit_instance (inst);
+    }
+    if (!batch.empty())
+    {
+        if (is_ok)
+            is_ok = m_conn->commit_transaction ();
+        else
+            (void)m_conn->rollback_transaction ();
+    }
+
+    auto trans_obe = std::static_pointer_cast<GncSqlTransBackend>(
+        m_backend_registry.get_object_backend (GNC_ID_TRANS));
+    if (!is_ok)
+    {
+        /* Leave everything queued and dirty; the next commit, save or
+         * flush_pending() will retry. The checkpoints were updated for
+         * commits that have been rolled back, so reread them. */
+        set_error (ERR_BACKEND_SERVER_ERR);
+        if (!batch.empty())
+            trans_obe->load_checkpoints (this);
+        if (m_write_behind_ms > 0)
+            m_flush_source = g_timeout_add (m_write_behind_ms,
+                                             flush_pending_timeout, this);
+        LEAVE ("Rolled back - database error");
+        return false;
+    }
+
+    /* The instances are in the database now: qof_commit_edit saw them
+     * still dirty and left them infants, so their next commit would
+     * insert them again. */
+    for (auto inst : batch)
+    {
+        qof_instance_mark_clean (inst);
+        qof_instance_set_infant (inst, FALSE);
+        m_pending_set.erase (inst);
+        g_object_unref (inst);
+    }
+    m_pending.swap (deferred);
+    if (std::none_of (m_pending.begin(), m_pending.end(),
+                      [](QofInstance* inst) {
+                          return GNC_IS_TRANSACTION (inst); }))
+        trans_obe->use_checkpoints (m_book, true);
+    if (!m_pending.empty() && m_write_behind_ms > 0)
+        m_flush_source = g_timeout_add (m_write_behind_ms,
+                                         flush_pending_timeout, this);
+    else
+        qof_book_mark_session_saved (m_book);
+    LEAVE ("");
+    return true;
+}
 
 /**
  * Sees if the version table exists, and if it does, loads the info into
@@ -32,6 +32,7 @@ extern "C"
 #include <memory>
 #include <exception>
 #include <sstream>
+#include <unordered_set>
 #include <vector>
 #include <qof-backend.hpp>
 
@@ -66,13 +67,21 @@ class GncSqlBackend : public QofBackend
 {
 public:
     GncSqlBackend(GncSqlConnection *conn, QofBook* book);
-    virtual ~GncSqlBackend() = default;
+    virtual ~GncSqlBackend();
     /**
      * Load the contents of an SQL database into a book.
      *
      * @param book Book to be loaded
      */
     void load(QofBook*, QofBackendLoadType) override;
+    /**
+     * Load the transactions a query might match which weren't loaded by
+     * load() because the book was opened with only recent transactions.
+     *
+     * @param book Book being queried
+     * @param query Query about to be run
+     */
+    void load_for_query(QofBook*, QofQuery*) override;
     /**
      * Save the contents of a book to an SQL database.
      *
@@ -97,6 +106,50 @@ public:
      * @param inst Object being edited
      */
     void rollback(QofInstance*) override;
+    /**
+     * Enable or disable write-behind mode.
+     *
+     * In write-behind mode commit() doesn't write each instance in its own
+     * database transaction. Instead it queues it, coalescing repeated
+     * commits of the same instance, and the queue is written in a single
+     * database transaction when it reaches @a max_batch instances, when
+     * @a max_latency_ms milliseconds have passed since the first queued
+     * commit, when an instance is destroyed, or when flush_pending() is
+     * called. Queued instances stay dirty, and so does the book, until they
+     * have been written. A timed flush that fails is retried and reported
+     * through the engine's commit error handler. Disabling write-behind
+     * flushes the queue.
+     *
+     * @param max_latency_ms Longest time a commit may wait to be written;
+     * 0 disables write-behind.
+     * @param max_batch Number of queued instances which forces a flush.
+     */
+    void set_write_behind(unsigned int max_latency_ms,
+                          size_t max_batch = 256) noexcept;
+    bool write_behind() const noexcept { return m_write_behind_ms > 0; }
+    /**
+     * Override the sql-lazy-load-days preference when the book is loaded.
+     *
+     * @param days Load only the transactions posted in the past @a days
+     * days; 0 loads all of them and a negative number uses the preference.
+     */
+    void set_lazy_load_days(int days) noexcept { m_lazy_load_days = days; }
+    /**
+     * Write all queued instances in one database transaction. When this
+     * returns true everything committed so far is in the database.
+     *
+     * @return true if the queue was empty or was written successfully;
+     * false if the database transaction failed, in which case the instances
+     * remain queued and dirty.
+     */
+    bool flush_pending() noexcept;
+    /**
+     * Check the stored balance checkpoints against the splits in the
+     * database and rebuild them if they differ. Loading a book trusts
+     * them, so this is for when another program may have changed the
+     * splits.
+     */
+    void verify_checkpoints() noexcept;
     /** Connect the backend to a GncSqlConnection.
      * Sets up version info. Calling with nullptr clears the connection and
      * destroys the version info.
@@ -237,6 +290,12 @@ public:
     QofBook* book() const noexcept { return m_book; }
     void set_loading(bool loading) noexcept { m_loading = loading; }
     bool pristine() const noexcept { return m_is_pristine_db; }
+    /**
+     * Whether data which isn't the user's, like caches, may be written to
+     * the database: not if the session or the book is read-only, or if the
+     * database was written by a newer version.
+     */
+    bool may_write() const noexcept;
     void update_progress(double pct) const noexcept;
     void finish_progress() const noexcept;
 
@@ -254,6 +313,10 @@ private:
     bool write_transactions();
     bool write_template_transactions();
     bool write_schedXactions();
+    bool commit_instance(QofInstance*) noexcept;
+    void queue_commit(QofInstance*) noexcept;
+    void clear_pending() noexcept;
+    static gboolean flush_pending_timeout(gpointer) noexcept;
     GncSqlStatementPtr build_insert_statement (const char* table_name,
                                                QofIdTypeConst obj_name,
                                                gpointer pObject,
@@ -288,6 +351,13 @@ private:
     };
     ObjectBackendRegistry m_backend_registry;
     std::vector<gnc_commodity*> m_postload_commodities;
+    unsigned int m_write_behind_ms = 0;  /**< 0 if write-behind is off */
+    size_t m_write_behind_batch = 256;
+    int m_lazy_load_days = -1;           /**< < 0 to use the preference */
+    unsigned int m_flush_source = 0;     /**< GSource id of the flush timer */
+    bool m_flush_error_reported = false; /**< The flush timer has failed */
+    std::vector<QofInstance*> m_pending; /**< Queued commits in order */
+    std::unordered_set<QofInstance*> m_pending_set;
 };
 
 #endif //__GNC_SQL_BACKEND_HPP__
@@ -97,6 +97,8 @@ public:
                            bool retry) noexcept = 0;
     virtual bool verify() noexcept = 0;
     virtual bool retry_connection(const char* msg) noexcept = 0;
+    /** Returns true if the session was opened read-only */
+    virtual bool read_only() const noexcept = 0;
 
 };
 
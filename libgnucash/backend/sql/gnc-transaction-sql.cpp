@@ -43,12 +43,14 @@ extern "C"
 #include "engine-helpers.h"
 #include "gnc-commodity.h"
 #include "gnc-engine.h"
+#include <gnc-prefs.h>
 
 #ifdef S_SPLINT_S
 #include "splint-defs.h"
 #endif
 }
 
+#include <algorithm>
 #include <string>
 #include <sstream>
 
@@ -71,6 +73,11 @@ static QofLogModule log_module = G_LOG_DOMAIN;
 #define TX_TABLE_VERSION 4
 #define SPLIT_TABLE "splits"
 #define SPLIT_TABLE_VERSION 5
+#define CHECKPOINT_TABLE "balance_checkpoints"
+#define CHECKPOINT_TABLE_VERSION 1
+/* Version entry holding the GnuCash version which last checked the
+ * checkpoints against the splits. */
+#define CHECKPOINT_VERIFIED "balance_checkpoints-verified"
 
 struct split_info_t : public write_objects_t
 {
@@ -141,6 +148,142 @@ static const EntryVec tx_guid_col_table
     gnc_sql_make_table_entry<CT_GUID>("tx_guid", 0, 0, "guid"),
 };
 
+/* A stored balance checkpoint of one account. */
+typedef struct
+{
+    GncGUID guid;
+    GncBalanceCheckpoint checkpoint;
+} checkpoint_row_t;
+
+static void
+set_checkpoint_guid (gpointer pObject, gpointer pValue)
+{
+    static_cast<checkpoint_row_t*>(pObject)->guid =
+        *static_cast<GncGUID*>(pValue);
+}
+
+static void
+set_checkpoint_date (gpointer pObject, time64 date)
+{
+    static_cast<checkpoint_row_t*>(pObject)->checkpoint.date = date;
+}
+
+static void
+set_checkpoint_balance (gpointer pObject, gnc_numeric value)
+{
+    static_cast<checkpoint_row_t*>(pObject)->checkpoint.balance = value;
+}
+
+static void
+set_checkpoint_cleared_balance (gpointer pObject, gnc_numeric value)
+{
+    static_cast<checkpoint_row_t*>(pObject)->checkpoint.cleared_balance = value;
+}
+
+static void
+set_checkpoint_reconciled_balance (gpointer pObject, gnc_numeric value)
+{
+    static_cast<checkpoint_row_t*>(pObject)->checkpoint.reconciled_balance =
+        value;
+}
+
+static const EntryVec checkpoint_col_table
+{
+    gnc_sql_make_table_entry<CT_GUID>("account_guid", 0, COL_NNUL, nullptr,
+                                      (QofSetterFunc)set_checkpoint_guid),
+    gnc_sql_make_table_entry<CT_TIME>("checkpoint_date", 0, COL_NNUL, nullptr,
+                                      (QofSetterFunc)set_checkpoint_date),
+    gnc_sql_make_table_entry<CT_NUMERIC>("balance", 0, COL_NNUL, nullptr,
+                                    (QofSetterFunc)set_checkpoint_balance),
+    gnc_sql_make_table_entry<CT_NUMERIC>("cleared_balance", 0, COL_NNUL,
+                                         nullptr,
+                             (QofSetterFunc)set_checkpoint_cleared_balance),
+    gnc_sql_make_table_entry<CT_NUMERIC>("reconciled_balance", 0, COL_NNUL,
+                                         nullptr,
+                             (QofSetterFunc)set_checkpoint_reconciled_balance),
+};
+
+static void
+set_split_amount_account (gpointer pObject, gpointer pValue)
+{
+    auto amount = static_cast<split_amount_t*>(pObject);
+    amount->acct = xaccAccountLookup (static_cast<GncGUID*>(pValue),
+                                      amount->sql_be->book());
+}
+
+static void
+set_split_amount_reconcile_state (gpointer pObject, gpointer pValue)
+{
+    static_cast<split_amount_t*>(pObject)->reconcile_state =
+        static_cast<const char*>(pValue)[0];
+}
+
+static void
+set_split_amount_amount (gpointer pObject, gnc_numeric value)
+{
+    static_cast<split_amount_t*>(pObject)->amount = value;
+}
+
+static void
+set_split_amount_post_date (gpointer pObject, time64 date)
+{
+    static_cast<split_amount_t*>(pObject)->post_date = date;
+}
+
+static const EntryVec split_amount_col_table
+{
+    gnc_sql_make_table_entry<CT_GUID>("account_guid", 0, 0, nullptr,
+                                (QofSetterFunc)set_split_amount_account),
+    gnc_sql_make_table_entry<CT_STRING>("reconcile_state", 1, 0, nullptr,
+                                (QofSetterFunc)set_split_amount_reconcile_state),
+    gnc_sql_make_table_entry<CT_NUMERIC>("quantity", 0, 0, nullptr,
+                                (QofSetterFunc)set_split_amount_amount),
+    gnc_sql_make_table_entry<CT_TIME>("post_date", 0, 0, nullptr,
+                                (QofSetterFunc)set_split_amount_post_date),
+};
+
+/**
+ * Reads the account, reconcile state, amount and post date of the splits
+ * selected by a condition on the joined split and transaction tables,
+ * without creating any objects.
+ *
+ * @param sql_be SQL backend
+ * @param where The condition; empty for all splits
+ * @param amounts Filled in with the splits in order of post date
+ * @return true if the database could be read
+ */
+static bool
+read_split_amounts (GncSqlBackend* sql_be, const std::string& where,
+                    std::vector<split_amount_t>& amounts)
+{
+    std::string sql("SELECT " SPLIT_TABLE ".account_guid AS account_guid, "
+                    SPLIT_TABLE ".reconcile_state AS reconcile_state, "
+                    SPLIT_TABLE ".quantity_num AS quantity_num, "
+                    SPLIT_TABLE ".quantity_denom AS quantity_denom, "
+                    TRANSACTION_TABLE ".post_date AS post_date FROM "
+                    SPLIT_TABLE " INNER JOIN " TRANSACTION_TABLE " ON "
+                    SPLIT_TABLE ".tx_guid = " TRANSACTION_TABLE ".guid");
+    if (!where.empty())
+        sql += " WHERE " + where;
+    sql += " ORDER BY " TRANSACTION_TABLE ".post_date";
+
+    auto stmt = sql_be->create_statement_from_sql (sql);
+    auto result = sql_be->execute_select_statement (stmt);
+    if (result == nullptr)
+        return false;
+    for (auto row : *result)
+    {
+        split_amount_t amount{sql_be, nullptr, NREC,
+                              gnc_numeric_error (GNC_ERROR_ARG), 0};
+        gnc_sql_load_object (sql_be, row, nullptr, &amount,
+                             split_amount_col_table);
+        if (gnc_numeric_check (amount.amount) != GNC_ERROR_OK)
+            return false;
+        amounts.push_back (amount);
+    }
+    return true;
+}
+
 GncSqlTransBackend::GncSqlTransBackend() :
     GncSqlObjectBackend(TX_TABLE_VERSION, GNC_ID_TRANS,
                         TRANSACTION_TABLE, tx_col_table) {}
@@ -391,6 +534,11 @@ query_transactions (GncSqlBackend* sql_be, std::string selector)
     for (auto instance : instances)
          xaccTransCommitEdit(GNC_TRANSACTION(instance));
 
+    /* Keep the account balances of a partially loaded book unchanged. */
+    auto obe = std::static_pointer_cast<GncSqlTransBackend>(
+        sql_be->get_object_backend (GNC_ID_TRANS));
+    if (obe && obe->lazy())
+        obe->adjust_start_balances (instances);
 }
 
 
@@ -432,6 +580,18 @@ GncSqlTransBackend::create_tables (GncSqlBackend* sql_be)
         PINFO ("Transactions table upgraded from version %d to version %d\n",
                version, m_version);
     }
+
+    if (sql_be->get_table_version (CHECKPOINT_TABLE) == 0 && sql_be->may_write())
+    {
+        (void)sql_be->create_table (CHECKPOINT_TABLE, CHECKPOINT_TABLE_VERSION,
+                                    checkpoint_col_table);
+        ok = sql_be->create_index ("checkpoint_account_index",
+                                   CHECKPOINT_TABLE, account_guid_col_table);
+        if (!ok)
+        {
+            PERR ("Unable to create index\n");
+        }
+    }
 }
 void
 GncSqlSplitBackend::create_tables (GncSqlBackend* sql_be)
@@ -588,6 +748,29 @@ GncSqlTransBackend::commit (GncSqlBackend* sql_be, QofInstance* inst)
 
     auto pTx = GNC_TRANS(inst);
     auto is_infant = qof_instance_get_infant (inst);
+
+    /* The checkpoints follow the database, so read the splits as they were
+     * before anything is written. A pristine database is being written
+     * from scratch, and its checkpoints will be built when it is loaded. */
+    std::vector<split_amount_t> old_amounts;
+    if (m_checkpoints_to != 0 && sql_be->pristine())
+        reset_checkpoints (sql_be->book());
+    auto track_checkpoints = m_checkpoints_to != 0;
+    if (track_checkpoints && !is_infant)
+    {
+        const std::string stkey(split_col_table[1]->name()); //tx_guid
+        if (!read_split_amounts (sql_be, SPLIT_TABLE "." + stkey + " = '" +
+                                 gnc::GUID(*qof_instance_get_guid (inst)).to_string() +
+                                 "'", old_amounts))
+        {
+            /* The stored ones are checked when the book is next loaded. */
+            PWARN ("Unable to read the splits, discarding the balance "
+                   "checkpoints.");
+            reset_checkpoints (sql_be->book());
+            track_checkpoints = false;
+        }
+    }
+
     if (qof_instance_get_destroying (inst))
     {
         op = OP_DB_DELETE;
@@ -673,6 +856,10 @@ GncSqlTransBackend::commit (GncSqlBackend* sql_be, QofInstance* inst)
               xaccAccountGetName (acc),
               err);
     }
+    else if (track_checkpoints)
+    {
+        update_checkpoints (sql_be, pTx, old_amounts);
+    }
     return is_ok;
 }
 
@@ -720,6 +907,23 @@ GncSqlTransBackend::load_all (GncSqlBackend* sql_be)
     gnc_account_foreach_descendant(root, (AccountCb)xaccAccountBeginEdit,
                                    nullptr);
     query_transactions (sql_be, "");
+    if (m_lazy)
+    {
+        /* Everything is in memory now, so the starting balances must be
+         * zero; set them exactly rather than trusting the arithmetic. */
+        for (auto& entry : m_start_balances)
+        {
+            gnc_account_set_start_balance (entry.first, gnc_numeric_zero ());
+            gnc_account_set_start_cleared_balance (entry.first,
+                                                   gnc_numeric_zero ());
+            gnc_account_set_start_reconciled_balance (entry.first,
+                                                      gnc_numeric_zero ());
+            gnc_account_set_splits_loaded_since (entry.first, INT64_MIN);
+        }
+        m_start_balances.clear();
+        m_loaded_accounts.clear();
+        m_lazy = false;
+    }
     gnc_account_foreach_descendant(root, (AccountCb)xaccAccountCommitEdit,
                                    nullptr);
 }
@@ -945,6 +1149,816 @@ static const EntryVec acct_balances_col_table
                                          (QofSetterFunc)set_acct_bal_balance),
 };
 
+/* ----------------------------------------------------------------- */
+static void
+set_start_balances (const acct_balances_t& bal)
+{
+    gnc_account_set_start_balance (bal.acct, bal.balance);
+    gnc_account_set_start_cleared_balance (bal.acct, bal.cleared_balance);
+    gnc_account_set_start_reconciled_balance (bal.acct,
+                                              bal.reconciled_balance);
+}
+
+void
+GncSqlTransBackend::load_since (GncSqlBackend* sql_be, time64 since)
+{
+    g_return_if_fail (sql_be != NULL);
+
+    auto book = sql_be->book();
+    auto root = gnc_book_get_root_account (book);
+    m_start_balances.clear();
+    m_loaded_accounts.clear();
+    m_account_since.clear();
+
+    /* Nothing is loaded yet, so the starting balances are the totals of all
+     * of the splits in the database. Summing in the database is far cheaper
+     * than loading the splits, but only splits with the same denominator can
+     * be added there. */
+    const std::string sakey(split_col_table[2]->name()); //account_guid
+    const std::string srkey(split_col_table[5]->name()); //reconcile_state
+    std::string sql("SELECT " + sakey + ", " + srkey +
+                    ", SUM(quantity_num) AS quantity_num, quantity_denom FROM "
+                    SPLIT_TABLE " GROUP BY " + sakey + ", " + srkey +
+                    ", quantity_denom");
+    auto stmt = sql_be->create_statement_from_sql (sql);
+    auto result = sql_be->execute_select_statement (stmt);
+    bool is_ok = result != nullptr;
+    if (is_ok)
+    {
+        for (auto row : *result)
+        {
+            single_acct_balance_t bal{sql_be, nullptr, NREC,
+                                      gnc_numeric_error (GNC_ERROR_ARG)};
+            gnc_sql_load_object (sql_be, row, nullptr, &bal,
+                                 acct_balances_col_table);
+            if (gnc_numeric_check (bal.balance) != GNC_ERROR_OK)
+            {
+                is_ok = false;
+                break;
+            }
+            if (bal.acct == nullptr)
+                continue;
+            auto& totals = m_start_balances.emplace (
+                bal.acct, acct_balances_t{bal.acct, gnc_numeric_zero (),
+                                          gnc_numeric_zero (),
+                                          gnc_numeric_zero ()}).first->second;
+            totals.balance = gnc_numeric_add_fixed (totals.balance,
+                                                    bal.balance);
+            if (bal.reconcile_state != NREC)
+                totals.cleared_balance =
+                    gnc_numeric_add_fixed (totals.cleared_balance,
+                                           bal.balance);
+            if (bal.reconcile_state == YREC || bal.reconcile_state == FREC)
+                totals.reconciled_balance =
+                    gnc_numeric_add_fixed (totals.reconciled_balance,
+                                           bal.balance);
+        }
+    }
+    if (!is_ok)
+    {
+        PWARN ("Unable to sum the splits in the database, loading all "
+               "transactions.");
+        m_start_balances.clear();
+        load_all (sql_be);
+        return;
+    }
+
+    gnc_account_foreach_descendant (root, (AccountCb)xaccAccountBeginEdit,
+                                    nullptr);
+    for (auto& entry : m_start_balances)
+        set_start_balances (entry.second);
+    m_lazy = true;
+    m_loaded_since = since;
+
+    /* A selector starting with '(' is taken as a subquery, so this mustn't
+     * be parenthesized. */
+    GncDateTime time(since);
+    const std::string tdkey(tx_col_table[3]->name()); //post_date
+    query_transactions (sql_be, tdkey + " >= '" + time.format_iso8601() +
+                        "' OR " + tdkey + " IS NULL");
+    /* Only accounts with splits in the database can be missing some. */
+    for (auto& entry : m_start_balances)
+        gnc_account_set_splits_loaded_since (entry.first, since);
+    gnc_account_foreach_descendant (root, (AccountCb)xaccAccountCommitEdit,
+                                    nullptr);
+}
+
+void
+GncSqlTransBackend::adjust_start_balances (const InstanceVec& txs) noexcept
+{
+    std::unordered_set<Account*> changed;
+    for (auto inst : txs)
+    {
+        for (auto node = xaccTransGetSplitList (GNC_TRANSACTION (inst));
+             node != nullptr; node = node->next)
+        {
+            auto split = static_cast<Split*>(node->data);
+            auto entry = m_start_balances.find (xaccSplitGetAccount (split));
+            if (entry == m_start_balances.end())
+                continue;
+            auto& bal = entry->second;
+            auto amount = xaccSplitGetAmount (split);
+            auto state = xaccSplitGetReconcile (split);
+            bal.balance = gnc_numeric_sub_fixed (bal.balance, amount);
+            if (state != NREC)
+                bal.cleared_balance =
+                    gnc_numeric_sub_fixed (bal.cleared_balance, amount);
+            if (state == YREC || state == FREC)
+                bal.reconciled_balance =
+                    gnc_numeric_sub_fixed (bal.reconciled_balance, amount);
+            changed.insert (bal.acct);
+        }
+    }
+    for (auto acct : changed)
+    {
+        set_start_balances (m_start_balances[acct]);
+        xaccAccountRecomputeBalance (acct);
+    }
+}
+
+static bool
+param_path_is (QofQueryParamList* path, std::initializer_list<const char*> names)
+{
+    for (auto name : names)
+    {
+        if (path == nullptr || g_strcmp0 (static_cast<char*>(path->data),
+                                          name) != 0)
+            return false;
+        path = path->next;
+    }
+    return path == nullptr;
+}
+
+/* The earliest post date of the transactions the term matches, or
+ * INT64_MIN if it doesn't limit them to a lower bound. */
+static time64
+term_since (QofQueryTerm* term, bool is_split)
+{
+    auto pred = qof_query_term_get_pred_data (term);
+    auto path = qof_query_term_get_param_path (term);
+    if (g_strcmp0 (pred->type_name, QOF_TYPE_DATE) != 0)
+        return INT64_MIN;
+    if (is_split ? !param_path_is (path, {SPLIT_TRANS, TRANS_DATE_POSTED}) :
+        !param_path_is (path, {TRANS_DATE_POSTED}))
+        return INT64_MIN;
+
+    auto inverted = qof_query_term_is_inverted (term);
+    auto lower_bound = inverted ?
+        (pred->how == QOF_COMPARE_LT || pred->how == QOF_COMPARE_LTE) :
+        (pred->how == QOF_COMPARE_GT || pred->how == QOF_COMPARE_GTE);
+    /* Day matches compare against the start of the day. */
+    auto date = ((query_date_t)pred)->date;
+    return lower_bound ? gnc_time64_get_day_start (date) : INT64_MIN;
+}
+
+/* Adds the accounts to which the term restricts splits to accounts and
+ * returns true, or returns false if the term doesn't restrict accounts. */
+static bool
+term_accounts (QofQueryTerm* term, QofBook* book,
+               std::vector<Account*>& accounts)
+{
+    auto pred = qof_query_term_get_pred_data (term);
+    auto path = qof_query_term_get_param_path (term);
+    if (g_strcmp0 (pred->type_name, QOF_TYPE_GUID) != 0 ||
+        qof_query_term_is_inverted (term))
+        return false;
+
+    auto guid_data = (query_guid_t)pred;
+    if (!((guid_data->options == QOF_GUID_MATCH_ANY &&
+           param_path_is (path, {SPLIT_ACCOUNT, QOF_PARAM_GUID})) ||
+          (guid_data->options == QOF_GUID_MATCH_ALL &&
+           param_path_is (path, {SPLIT_TRANS, TRANS_SPLITLIST,
+                                 SPLIT_ACCOUNT_GUID}))))
+        return false;
+
+    for (auto node = guid_data->guids; node != nullptr; node = node->next)
+    {
+        auto acct = xaccAccountLookup (static_cast<GncGUID*>(node->data), book);
+        if (acct != nullptr)
+            accounts.push_back (acct);
+    }
+    return true;
+}
+
+/* Adds the GUID strings of the lots to which the term restricts splits to
+ * lots and returns true, or returns false if it doesn't restrict lots. */
+static bool
+term_lots (QofQueryTerm* term, std::vector<std::string>& lots)
+{
+    auto pred = qof_query_term_get_pred_data (term);
+    auto path = qof_query_term_get_param_path (term);
+    if (g_strcmp0 (pred->type_name, QOF_TYPE_GUID) != 0 ||
+        qof_query_term_is_inverted (term))
+        return false;
+
+    auto guid_data = (query_guid_t)pred;
+    if (guid_data->options != QOF_GUID_MATCH_ANY ||
+        !param_path_is (path, {SPLIT_LOT, QOF_PARAM_GUID}))
+        return false;
+
+    for (auto node = guid_data->guids; node != nullptr; node = node->next)
+        lots.push_back (gnc::GUID(*static_cast<GncGUID*>(node->data)).to_string());
+    return true;
+}
+
+void
+GncSqlTransBackend::load_for_query (GncSqlBackend* sql_be, QofQuery* query)
+{
+    g_return_if_fail (sql_be != NULL);
+    g_return_if_fail (query != NULL);
+
+    if (!m_lazy)
+        return;
+
+    auto search_for = qof_query_get_search_for (query);
+    auto is_split = g_strcmp0 (search_for, GNC_ID_SPLIT) == 0;
+    if (!is_split && g_strcmp0 (search_for, GNC_ID_TRANS) != 0)
+        return;
+
+    /* The terms are a sum of products: an OR-term is satisfied by what is
+     * already loaded if it is limited to recent dates, and otherwise needs
+     * the lots or accounts it is limited to, the latter from its earliest
+     * date if it has one, or everything. */
+    std::vector<Account*> accounts;
+    std::unordered_map<Account*, time64> windows;
+    std::vector<std::string> lots;
+    auto or_terms = qof_query_get_terms (query);
+    auto need_all = or_terms == nullptr;
+    for (auto or_node = or_terms; or_node != nullptr && !need_all;
+         or_node = or_node->next)
+    {
+        std::vector<Account*> term_accts;
+        std::vector<std::string> lot_guids;
+        auto since = INT64_MIN;
+        auto restricted = false;
+        auto in_lots = false;
+        for (auto and_node = static_cast<GList*>(or_node->data);
+             and_node != nullptr; and_node = and_node->next)
+        {
+            auto term = static_cast<QofQueryTerm*>(and_node->data);
+            since = std::max (since, term_since (term, is_split));
+            if (is_split && term_accounts (term, sql_be->book(), term_accts))
+                restricted = true;
+            else if (is_split && !in_lots && term_lots (term, lot_guids))
+                in_lots = true;
+        }
+        if (since >= m_loaded_since)
+            continue;
+        if (in_lots && !restricted)
+            lots.insert (lots.end(), lot_guids.begin(), lot_guids.end());
+        else if (!restricted)
+            need_all = true;
+        else if (since == INT64_MIN)
+            accounts.insert (accounts.end(), term_accts.begin(),
+                             term_accts.end());
+        else
+            for (auto acct : term_accts)
+            {
+                auto window = windows.emplace (acct, since).first;
+                window->second = std::min (window->second, since);
+            }
+    }
+
+    if (need_all)
+    {
+        PINFO ("Query needs all transactions");
+        load_all (sql_be);
+        return;
+    }
+
+    accounts.erase (std::remove_if (accounts.begin(), accounts.end(),
+                                    [this](Account* acct) {
+                                        return m_loaded_accounts.count (acct);
+                                    }), accounts.end());
+    std::sort (accounts.begin(), accounts.end());
+    accounts.erase (std::unique (accounts.begin(), accounts.end()),
+                    accounts.end());
+    if (!accounts.empty())
+    {
+        PINFO ("Loading the transactions of %" G_GSIZE_FORMAT " accounts",
+               accounts.size());
+        load_accounts (sql_be, accounts);
+    }
+
+    for (const auto& window : windows)
+        if (!m_loaded_accounts.count (window.first))
+            load_account_since (sql_be, window.first, window.second);
+
+    if (!lots.empty())
+    {
+        PINFO ("Loading the transactions of %" G_GSIZE_FORMAT " lots",
+               lots.size());
+        load_lots (sql_be, lots);
+    }
+}
+
+/* Load the transactions with splits in the lots, given by GUID string. */
+void
+GncSqlTransBackend::load_lots (GncSqlBackend* sql_be,
+                               const std::vector<std::string>& lots)
+{
+    const std::string stkey(split_col_table[1]->name()); //tx_guid
+    const std::string slkey(split_col_table[9]->name()); //lot_guid
+    std::string sql("(SELECT DISTINCT ");
+    sql += stkey + " FROM " SPLIT_TABLE " WHERE " + slkey + " IN (";
+    for (const auto& lot : lots)
+    {
+        if (&lot != &lots.front())
+            sql += ",";
+        sql += "'" + lot + "'";
+    }
+    sql += "))";
+
+    auto root = gnc_book_get_root_account (sql_be->book());
+    gnc_account_foreach_descendant (root, (AccountCb)xaccAccountBeginEdit,
+                                    nullptr);
+    query_transactions (sql_be, sql);
+    gnc_account_foreach_descendant (root, (AccountCb)xaccAccountCommitEdit,
+                                    nullptr);
+}
+
+/* Load the transactions of the account posted from since up to what is
+ * already loaded of it. */
+void
+GncSqlTransBackend::load_account_since (GncSqlBackend* sql_be, Account* acct,
+                                        time64 since)
+{
+    auto loaded = m_account_since.find (acct);
+    auto until = loaded == m_account_since.end() ? m_loaded_since :
+        loaded->second;
+    if (since >= until)
+        return;
+
+    PINFO ("Loading the transactions of %s posted since %" G_GINT64_FORMAT,
+           xaccAccountGetName (acct), since);
+    const std::string tpkey(tx_col_table[0]->name()); //guid
+    const std::string tdkey(tx_col_table[3]->name()); //post_date
+    const std::string stkey(split_col_table[1]->name()); //txn_guid
+    const std::string sakey(split_col_table[2]->name()); //account_guid
+    GncDateTime from(since), to(until);
+    /* A plain condition, as a selector starting with '(' is a subquery. */
+    std::string sql(tpkey + " IN (SELECT " + stkey + " FROM " SPLIT_TABLE
+                    " WHERE " + sakey + " = '" +
+                    gnc::GUID(*qof_instance_get_guid (acct)).to_string() +
+                    "') AND " + tdkey + " >= '" + from.format_iso8601() +
+                    "' AND " + tdkey + " < '" + to.format_iso8601() + "'");
+
+    auto root = gnc_book_get_root_account (sql_be->book());
+    gnc_account_foreach_descendant (root, (AccountCb)xaccAccountBeginEdit,
+                                    nullptr);
+    query_transactions (sql_be, sql);
+    gnc_account_foreach_descendant (root, (AccountCb)xaccAccountCommitEdit,
+                                    nullptr);
+    m_account_since[acct] = since;
+    gnc_account_set_splits_loaded_since (acct, since);
+}
+
+void
+GncSqlTransBackend::load_accounts (GncSqlBackend* sql_be,
+                                   const std::vector<Account*>& accounts)
+{
+    const std::string stkey(split_col_table[1]->name()); //txn_guid
+    const std::string sakey(split_col_table[2]->name()); //account_guid
+    std::string sql("(SELECT DISTINCT ");
+    sql += stkey + " FROM " SPLIT_TABLE " WHERE " + sakey + " IN (";
+    for (auto acct : accounts)
+    {
+        if (acct != accounts.front())
+            sql += ",";
+        sql += "'" + gnc::GUID(*qof_instance_get_guid (acct)).to_string() + "'";
+    }
+    sql += "))";
+
+    auto root = gnc_book_get_root_account (sql_be->book());
+    gnc_account_foreach_descendant (root, (AccountCb)xaccAccountBeginEdit,
+                                    nullptr);
+    query_transactions (sql_be, sql);
+    gnc_account_foreach_descendant (root, (AccountCb)xaccAccountCommitEdit,
+                                    nullptr);
+    m_loaded_accounts.insert (accounts.begin(), accounts.end());
+    for (auto acct : accounts)
+        gnc_account_set_splits_loaded_since (acct, INT64_MIN);
+}
+
+/* ----------------------------------------------------------------- */
+/* Balance checkpoints
+ *
+ * The balances table holds, for every account with splits, its balances
+ * from the splits posted before the start of each month up to the start
+ * of the current one. Commits keep it up to date by applying the
+ * difference between the splits of a transaction as they were in the
+ * database and as they are being written.
+ */
+
+static time64
+month_start (time64 t, int months_after)
+{
+    struct tm tm;
+    gnc_localtime_r (&t, &tm);
+    tm.tm_mday = 1;
+    tm.tm_hour = tm.tm_min = tm.tm_sec = 0;
+    tm.tm_mon += months_after;
+    tm.tm_year += tm.tm_mon / 12;
+    tm.tm_mon %= 12;
+    tm.tm_isdst = -1;
+    return gnc_mktime (&tm);
+}
+
+static std::string
+sql_time (time64 t)
+{
+    GncDateTime time(t);
+    return "'" + time.format_iso8601() + "'";
+}
+
+static void
+add_to_checkpoint (GncBalanceCheckpoint& checkpoint, const split_amount_t& split,
+                   bool subtract)
+{
+    auto amount = subtract ? gnc_numeric_neg (split.amount) : split.amount;
+    checkpoint.balance = gnc_numeric_add_fixed (checkpoint.balance, amount);
+    if (split.reconcile_state != NREC)
+        checkpoint.cleared_balance =
+            gnc_numeric_add_fixed (checkpoint.cleared_balance, amount);
+    if (split.reconcile_state == YREC || split.reconcile_state == FREC)
+        checkpoint.reconciled_balance =
+            gnc_numeric_add_fixed (checkpoint.reconciled_balance, amount);
+}
+
+/* The splits of each account with a GUID, by account GUID string, in the
+ * order of the amounts. */
+using AmountsByAccount =
+    std::unordered_map<std::string, std::vector<const split_amount_t*>>;
+
+static AmountsByAccount
+amounts_by_account (const std::vector<split_amount_t>& amounts)
+{
+    AmountsByAccount by_acct;
+    for (const auto& amount : amounts)
+        if (amount.acct != nullptr)
+            by_acct[gnc::GUID(*qof_instance_get_guid (amount.acct)).to_string()]
+                .push_back (&amount);
+    return by_acct;
+}
+
+void
+GncSqlTransBackend::load_checkpoints (GncSqlBackend* sql_be, bool verify)
+{
+    g_return_if_fail (sql_be != NULL);
+
+    auto book = sql_be->book();
+    reset_checkpoints (book);
+
+    /* A read-only session builds them in memory and keeps them there. */
+    m_save_checkpoints = sql_be->may_write();
+    if (sql_be->get_table_version (CHECKPOINT_TABLE) != 0)
+    {
+        auto stmt = sql_be->create_statement_from_sql ("SELECT * FROM "
+                                                       CHECKPOINT_TABLE);
+        auto result = sql_be->execute_select_statement (stmt);
+        if (result == nullptr)
+            return;
+        for (auto row : *result)
+        {
+            checkpoint_row_t cp{*guid_null (),
+                                {0, gnc_numeric_zero (), gnc_numeric_zero (),
+                                 gnc_numeric_zero ()}};
+            gnc_sql_load_object (sql_be, row, nullptr, &cp,
+                                 checkpoint_col_table);
+            if (guid_equal (&cp.guid, guid_null ()) || cp.checkpoint.date == 0)
+                continue;
+            auto& entry = m_checkpoints[gnc::GUID(cp.guid).to_string()];
+            entry.guid = cp.guid;
+            entry.checkpoints.push_back (cp.checkpoint);
+            m_checkpoints_to = std::max (m_checkpoints_to, cp.checkpoint.date);
+        }
+        for (auto& entry : m_checkpoints)
+            std::sort (entry.second.checkpoints.begin(),
+                       entry.second.checkpoints.end(),
+                       [](const GncBalanceCheckpoint& a,
+                          const GncBalanceCheckpoint& b) {
+                           return a.date < b.date; });
+    }
+    else if (m_save_checkpoints)
+        return;
+
+    /* Another program may have changed the splits without updating the
+     * checkpoints. Checking them reads every split, so the stored ones are
+     * trusted unless the caller asks for a check or the book was last
+     * checked by another version of GnuCash or of the table. */
+    auto version = gnc_prefs_get_long_version ();
+    if (sql_be->get_table_version (CHECKPOINT_TABLE) != CHECKPOINT_TABLE_VERSION ||
+        sql_be->get_table_version (CHECKPOINT_VERIFIED) != version)
+        verify = true;
+    if (m_checkpoints_to != 0 && verify && !checkpoints_match (sql_be))
+    {
+        PWARN ("The balance checkpoints don't match the splits, "
+               "rebuilding them.");
+        if (m_save_checkpoints)
+        {
+            auto del = sql_be->create_statement_from_sql ("DELETE FROM "
+                                                          CHECKPOINT_TABLE);
+            if (sql_be->execute_nonselect_statement (del) == -1)
+            {
+                reset_checkpoints (book);
+                return;
+            }
+        }
+        m_checkpoints.clear();
+        m_checkpoints_to = 0;
+    }
+
+    if (!extend_checkpoints (sql_be, month_start (gnc_time (nullptr), 0)))
+    {
+        PWARN ("Unable to build the balance checkpoints.");
+        reset_checkpoints (book);
+        return;
+    }
+    if (verify && m_save_checkpoints)
+        sql_be->set_table_version (CHECKPOINT_VERIFIED, version);
+    if (m_use_checkpoints)
+    {
+        m_use_checkpoints = false;
+        use_checkpoints (book, true);
+    }
+}
+
+bool
+GncSqlTransBackend::checkpoints_match (GncSqlBackend* sql_be)
+{
+    const std::string tdkey(tx_col_table[3]->name()); //post_date
+    std::vector<split_amount_t> amounts;
+    if (!read_split_amounts (sql_be, TRANSACTION_TABLE "." + tdkey + " < " +
+                             sql_time (m_checkpoints_to), amounts))
+        return false;
+
+    auto by_acct = amounts_by_account (amounts);
+    for (const auto& entry : by_acct)
+        if (m_checkpoints.find (entry.first) == m_checkpoints.end())
+            return false;
+
+    auto same = [](const GncBalanceCheckpoint& a, const GncBalanceCheckpoint& b) {
+        return gnc_numeric_equal (a.balance, b.balance) &&
+            gnc_numeric_equal (a.cleared_balance, b.cleared_balance) &&
+            gnc_numeric_equal (a.reconciled_balance, b.reconciled_balance);
+    };
+    for (const auto& entry : m_checkpoints)
+    {
+        const auto& cps = entry.second.checkpoints;
+        if (cps.empty() || cps.back().date != m_checkpoints_to)
+            return false;
+        auto splits = by_acct.find (entry.first);
+        size_t i = 0, n = splits == by_acct.end() ? 0 : splits->second.size();
+        GncBalanceCheckpoint running{0, gnc_numeric_zero (),
+                                     gnc_numeric_zero (), gnc_numeric_zero ()};
+        for (const auto& cp : cps)
+        {
+            for (; i < n && splits->second[i]->post_date < cp.date; ++i)
+                add_to_checkpoint (running, *splits->second[i], false);
+            if (!same (running, cp))
+                return false;
+        }
+    }
+    return true;
+}
+
+bool
+GncSqlTransBackend::extend_checkpoints (GncSqlBackend* sql_be, time64 until)
+{
+    if (m_checkpoints_to >= until)
+        return true;
+
+    auto from = m_checkpoints_to;
+    const std::string tdkey(tx_col_table[3]->name()); //post_date
+    std::string where(TRANSACTION_TABLE "." + tdkey + " < " + sql_time (until));
+    if (from != 0)
+        where += " AND " TRANSACTION_TABLE "." + tdkey + " >= " +
+            sql_time (from);
+    std::vector<split_amount_t> amounts;
+    if (!read_split_amounts (sql_be, where, amounts))
+        return false;
+
+    auto by_acct = amounts_by_account (amounts);
+
+    /* Carry each account's balances forward a month at a time, adding the
+     * splits posted in between; accounts without new splits just repeat
+     * their last checkpoint. */
+    for (const auto& entry : by_acct)
+    {
+        auto& acct_cps = m_checkpoints[entry.first];
+        acct_cps.guid = *qof_instance_get_guid (entry.second.front()->acct);
+    }
+    for (auto& entry : m_checkpoints)
+    {
+        auto& cps = entry.second.checkpoints;
+        auto splits = by_acct.find (entry.first);
+        GncBalanceCheckpoint running{0, gnc_numeric_zero (),
+                                     gnc_numeric_zero (), gnc_numeric_zero ()};
+        time64 next;
+        if (!cps.empty())
+        {
+            running = cps.back();
+            next = month_start (running.date, 1);
+        }
+        else if (splits != by_acct.end())
+            next = month_start (splits->second.front()->post_date, 1);
+        else
+            continue;
+
+        size_t i = 0;
+        for (; next <= until; next = month_start (next, 1))
+        {
+            for (; splits != by_acct.end() && i < splits->second.size() &&
+                     splits->second[i]->post_date < next; ++i)
+                add_to_checkpoint (running, *splits->second[i], false);
+            running.date = next;
+            cps.push_back (running);
+        }
+    }
+
+    m_checkpoints_to = until;
+    if (!m_save_checkpoints)
+        return true;
+    for (const auto& entry : m_checkpoints)
+        if (!write_checkpoints (sql_be, entry.first, from))
+            return false;
+    return true;
+}
+
+bool
+GncSqlTransBackend::write_checkpoints (GncSqlBackend* sql_be,
+                                       const std::string& acct_guid,
+                                       time64 after)
+{
+    const std::string agkey(checkpoint_col_table[0]->name());
+    const std::string cdkey(checkpoint_col_table[1]->name());
+    std::string sql("DELETE FROM " CHECKPOINT_TABLE " WHERE " + agkey + " = '" +
+                    acct_guid + "'");
+    if (after != 0)
+        sql += " AND " + cdkey + " > " + sql_time (after);
+    auto stmt = sql_be->create_statement_from_sql (sql);
+    if (sql_be->execute_nonselect_statement (stmt) == -1)
+        return false;
+
+    std::string columns(agkey + ", " + cdkey);
+    for (auto i = 2U; i < checkpoint_col_table.size(); ++i)
+    {
+        std::string name(checkpoint_col_table[i]->name());
+        columns += ", " + name + "_num, " + name + "_denom";
+    }
+
+    /* Several rows per statement, as slots are saved. */
+    const size_t batch_size = 100;
+    const auto& cps = m_checkpoints[acct_guid].checkpoints;
+    auto cp = std::upper_bound (cps.begin(), cps.end(), after,
+                                [](time64 date, const GncBalanceCheckpoint& c) {
+                                    return date < c.date; });
+    while (cp != cps.end())
+    {
+        std::ostringstream values;
+        for (size_t n = 0; n < batch_size && cp != cps.end(); ++n, ++cp)
+        {
+            values << (n ? ", " : "") << "('" << acct_guid << "', "
+                   << sql_time (cp->date);
+            for (auto num : {cp->balance, cp->cleared_balance,
+                             cp->reconciled_balance})
+                values << ", " << num.num << ", " << num.denom;
+            values << ")";
+        }
+        stmt = sql_be->create_statement_from_sql ("INSERT INTO " CHECKPOINT_TABLE
+                                                  " (" + columns + ") VALUES " +
+                                                  values.str());
+        if (sql_be->execute_nonselect_statement (stmt) == -1)
+            return false;
+    }
+    return true;
+}
+
+void
+GncSqlTransBackend::update_checkpoints (GncSqlBackend* sql_be, Transaction* tx,
+                                        const std::vector<split_amount_t>& old)
+{
+    std::vector<split_amount_t> now;
+    if (!qof_instance_get_destroying (tx))
+    {
+        for (auto node = xaccTransGetSplitList (tx); node != nullptr;
+             node = node->next)
+        {
+            auto split = static_cast<Split*>(node->data);
+            if (xaccSplitGetParent (split) != tx ||
+                qof_instance_get_destroying (split))
+                continue;
+            now.push_back ({sql_be, xaccSplitGetAccount (split),
+                            xaccSplitGetReconcile (split),
+                            xaccSplitGetAmount (split), xaccTransGetDate (tx)});
+        }
+    }
+
+    /* Unchanged splits cancel out. */
+    std::vector<split_amount_t> removed(old);
+    auto same = [](const split_amount_t& a, const split_amount_t& b) {
+        return a.acct == b.acct && a.reconcile_state == b.reconcile_state &&
+            a.post_date == b.post_date && gnc_numeric_equal (a.amount, b.amount);
+    };
+    now.erase (std::remove_if (now.begin(), now.end(),
+                               [&](const split_amount_t& a) {
+                                   auto match = std::find_if (removed.begin(),
+                                                              removed.end(),
+                                                              [&](const split_amount_t& b) {
+                                                                  return same (a, b); });
+                                   if (match == removed.end())
+                                       return false;
+                                   removed.erase (match);
+                                   return true; }), now.end());
+
+    std::unordered_map<std::string, time64> changed;
+    auto apply = [&](const split_amount_t& split, bool subtract) {
+        if (split.acct == nullptr || split.post_date >= m_checkpoints_to)
+            return;
+        auto key = gnc::GUID(*qof_instance_get_guid (split.acct)).to_string();
+        auto& entry = m_checkpoints[key];
+        entry.guid = *qof_instance_get_guid (split.acct);
+        auto& cps = entry.checkpoints;
+
+        /* An account has checkpoints from the month after its first split,
+         * so a split posted earlier needs (zero) ones before them. */
+        auto stop = cps.empty() ? month_start (m_checkpoints_to, 1) :
+            cps.front().date;
+        std::vector<GncBalanceCheckpoint> fill;
+        for (auto date = month_start (split.post_date, 1); date < stop;
+             date = month_start (date, 1))
+            fill.push_back ({date, gnc_numeric_zero (), gnc_numeric_zero (),
+                             gnc_numeric_zero ()});
+        cps.insert (cps.begin(), fill.begin(), fill.end());
+
+        for (auto& cp : cps)
+            if (cp.date > split.post_date)
+                add_to_checkpoint (cp, split, subtract);
+        auto earliest = changed.emplace (key, split.post_date).first;
+        earliest->second = std::min (earliest->second, split.post_date);
+    };
+    for (const auto& split : removed)
+        apply (split, true);
+    for (const auto& split : now)
+        apply (split, false);
+
+    auto book = sql_be->book();
+    for (const auto& entry : changed)
+    {
+        if (m_save_checkpoints &&
+            !write_checkpoints (sql_be, entry.first, entry.second))
+        {
+            PERR ("Unable to save the balance checkpoints, discarding them.");
+            auto del = sql_be->create_statement_from_sql ("DELETE FROM "
+                                                          CHECKPOINT_TABLE);
+            (void)sql_be->execute_nonselect_statement (del);
+            reset_checkpoints (book);
+            return;
+        }
+        if (!m_use_checkpoints)
+            continue;
+        const auto& acct_cps = m_checkpoints[entry.first];
+        auto acct = xaccAccountLookup (&acct_cps.guid, book);
+        if (acct != nullptr)
+            gnc_account_set_balance_checkpoints (acct,
+                                                 acct_cps.checkpoints.data(),
+                                                 acct_cps.checkpoints.size());
+    }
+}
+
+void
+GncSqlTransBackend::use_checkpoints (QofBook* book, bool use) noexcept
+{
+    if (use == m_use_checkpoints)
+        return;
+    m_use_checkpoints = use;
+    for (const auto& entry : m_checkpoints)
+    {
+        auto acct = xaccAccountLookup (&entry.second.guid, book);
+        if (acct == nullptr)
+            continue;
+        if (use)
+            gnc_account_set_balance_checkpoints (acct,
+                                                 entry.second.checkpoints.data(),
+                                                 entry.second.checkpoints.size());
+        else
+            gnc_account_set_balance_checkpoints (acct, nullptr, 0);
+    }
+}
+
+void
+GncSqlTransBackend::reset_checkpoints (QofBook* book) noexcept
+{
+    for (const auto& entry : m_checkpoints)
+    {
+        auto acct = book ? xaccAccountLookup (&entry.second.guid, book) : nullptr;
+        if (acct != nullptr)
+            gnc_account_set_balance_checkpoints (acct, nullptr, 0);
+    }
+    m_checkpoints.clear();
+    m_checkpoints_to = 0;
+}
+
 /* ----------------------------------------------------------------- */
 template<> void
 GncSqlColumnTableEntryImpl<CT_TXREF>::load (const GncSqlBackend* sql_be,
@@ -35,6 +35,30 @@ extern "C"
 #include "qof.h"
 #include "Account.h"
 }
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+typedef struct
+{
+    Account* acct;
+    gnc_numeric balance;
+    gnc_numeric cleared_balance;
+    gnc_numeric reconciled_balance;
+} acct_balances_t;
+
+/** The account, reconcile state, amount and post date of a split, as
+ * read directly from the database. */
+typedef struct
+{
+    const GncSqlBackend* sql_be;
+    Account* acct;
+    char reconcile_state;
+    gnc_numeric amount;
+    time64 post_date;
+} split_amount_t;
+
 class GncSqlTransBackend : public GncSqlObjectBackend
 {
 public:
@@ -42,6 +66,96 @@ public:
     void load_all(GncSqlBackend*) override;
     void create_tables(GncSqlBackend*) override;
     bool commit (GncSqlBackend* sql_be, QofInstance* inst) override;
+    /**
+     * Loads the transactions posted on or after a date and the template
+     * transactions, leaving the rest in the database until a query needs
+     * them. Each account's starting balances are set to the sum of its
+     * splits which weren't loaded, so account balances are the same as if
+     * everything had been loaded, and the accounts are told from when
+     * their splits are loaded so that anything walking them loads the rest
+     * first through load_for_query().
+     *
+     * Loaded transactions stay in memory until the book is closed; there
+     * is no memory budget and nothing is evicted, so a session that walks
+     * the whole history of many accounts ends up with all of it loaded.
+     * Callers which only need recent splits should ask for a date window
+     * with gnc_account_load_splits_since() rather than for all of them.
+     *
+     * @param sql_be SQL backend
+     * @param since Earliest post date to load
+     */
+    void load_since (GncSqlBackend* sql_be, time64 since);
+    /**
+     * Loads the transactions that a query might match if they aren't loaded
+     * yet: those with splits in the lots the query restricts splits to, or
+     * those of the accounts it restricts them to, from the earliest post
+     * date it allows if it has one, or all of them if the query isn't
+     * restricted to such lots or accounts or to the dates already loaded.
+     *
+     * @param sql_be SQL backend
+     * @param query The query about to be run
+     */
+    void load_for_query (GncSqlBackend* sql_be, QofQuery* query);
+    /**
+     * Subtracts the splits of newly loaded transactions from the starting
+     * balances of their accounts.
+     *
+     * @param txs The transactions which were just loaded
+     */
+    void adjust_start_balances (const InstanceVec& txs) noexcept;
+    /** True while some transactions are still only in the database. */
+    bool lazy() const noexcept { return m_lazy; }
+    /**
+     * Loads the monthly balance checkpoints of every account, adds those
+     * for months which have ended since they were last stored (building
+     * them all if there are none), and gives them to the accounts.
+     *
+     * The stored checkpoints are only checked against the splits, which
+     * means reading all of them, when @a verify is set or when they were
+     * last checked by a different GnuCash version or table version; if
+     * they don't match they are rebuilt.
+     *
+     * @param sql_be SQL backend
+     * @param verify True to check the stored checkpoints in any case.
+     */
+    void load_checkpoints (GncSqlBackend* sql_be, bool verify = false);
+    /**
+     * Gives the accounts their checkpoints, or takes them away while
+     * commits which would change them are queued.
+     *
+     * @param use True to give the checkpoints to the accounts.
+     */
+    void use_checkpoints (QofBook* book, bool use) noexcept;
+private:
+    struct AccountCheckpoints
+    {
+        GncGUID guid;
+        std::vector<GncBalanceCheckpoint> checkpoints;
+    };
+    void load_accounts (GncSqlBackend* sql_be,
+                        const std::vector<Account*>& accounts);
+    void load_account_since (GncSqlBackend* sql_be, Account* acct,
+                             time64 since);
+    void load_lots (GncSqlBackend* sql_be, const std::vector<std::string>& lots);
+    bool checkpoints_match (GncSqlBackend* sql_be);
+    bool extend_checkpoints (GncSqlBackend* sql_be, time64 until);
+    void update_checkpoints (GncSqlBackend* sql_be, Transaction* tx,
+                             const std::vector<split_amount_t>& old);
+    void reset_checkpoints (QofBook* book) noexcept;
+    bool write_checkpoints (GncSqlBackend* sql_be,
+                            const std::string& acct_guid, time64 after);
+    bool m_lazy = false;
+    time64 m_loaded_since = 0;
+    std::unordered_set<Account*> m_loaded_accounts;
+    /** Accounts loaded further back than m_loaded_since, and from when. */
+    std::unordered_map<Account*, time64> m_account_since;
+    std::unordered_map<Account*, acct_balances_t> m_start_balances;
+    /** Checkpoints by account GUID string; built up to m_checkpoints_to. */
+    std::unordered_map<std::string, AccountCheckpoints> m_checkpoints;
+    time64 m_checkpoints_to = 0;
+    bool m_use_checkpoints = true;
+    /** False if the session mustn't write them to the database. */
+    bool m_save_checkpoints = true;
 };
 
 class GncSqlSplitBackend : public GncSqlObjectBackend
@@ -61,13 +175,5 @@ public:
  */
 void gnc_sql_transaction_load_tx_for_account (GncSqlBackend* sql_be,
                                               Account* account);
-typedef struct
-{
-    Account* acct;
-    gnc_numeric balance;
-    gnc_numeric cleared_balance;
-    gnc_numeric reconciled_balance;
-} acct_balances_t;
-
 
 #endif /* GNC_TRANSACTION_SQL_H */
@@ -26,7 +26,12 @@ extern "C"
 #include <string.h>
 #include <glib.h>
 #include <unittest-support.h>
+#include <Transaction.h>
+#include <gnc-commodity.h>
+#include <gnc-engine.h>
 }
+#include <functional>
+#include <vector>
 /* Add specific headers for this class */
 #include "../gnc-sql-connection.hpp"
 #include "../gnc-sql-backend.hpp"
@@ -88,8 +93,11 @@ private:
 class GncMockSqlStatement : public GncSqlStatement
 {
 public:
-    const char* to_sql() const { return "SELECT * FROM foo"; }
+    GncMockSqlStatement(const std::string& sql) : m_sql{sql} {}
+    const char* to_sql() const { return m_sql.c_str(); }
     void add_where_cond (QofIdTypeConst, const PairVec&) {}
+private:
+    std::string m_sql;
 };
 
 
@@ -99,16 +107,17 @@ public:
     GncMockSqlConnection() : m_result{this} {}
     GncSqlResultPtr execute_select_statement (const GncSqlStatementPtr&)
         noexcept override { return &m_result; }
-    int execute_nonselect_statement (const GncSqlStatementPtr&)
-        noexcept override { return 1; }
-    GncSqlStatementPtr create_statement_from_sql (const std::string&)
+    int execute_nonselect_statement (const GncSqlStatementPtr& stmt)
+        noexcept override { m_executed.push_back (stmt->to_sql()); return 1; }
+    GncSqlStatementPtr create_statement_from_sql (const std::string& sql)
         const noexcept override {
-        return std::unique_ptr<GncMockSqlStatement>(new GncMockSqlStatement); }
+        return std::unique_ptr<GncMockSqlStatement>(new GncMockSqlStatement{sql}); }
     bool does_table_exist (const std::string&) const noexcept override {
         return true; }
     bool begin_transaction () noexcept override { return true;}
     bool rollback_transaction () noexcept override { return true; }
-    bool commit_transaction () noexcept override { return true; }
+    bool commit_transaction () noexcept override {
+        ++m_commits; return !m_fail_commits; }
     bool create_table (const std::string&, const ColVec&)
         const noexcept override { return false; }
     bool create_index (const std::string&, const std::string&,
@@ -121,8 +130,25 @@ public:
     void set_error(QofBackendError error, unsigned int repeat, bool retry) noexcept override { return; }
     bool verify() noexcept override { return true; }
     bool retry_connection(const char* msg) noexcept override { return true; }
+    bool read_only() const noexcept override { return false; }
+    /** The number of statements executed that start with @a prefix. */
+    int count_executed (const std::string& prefix) const
+    {
+        int count = 0;
+        for (const auto& sql : m_executed)
+            if (sql.compare (0, prefix.size(), prefix) == 0)
+                ++count;
+        return count;
+    }
+    void clear_executed () { m_executed.clear(); }
+    /** Make commit_transaction() fail, as a lost server would. */
+    void fail_commits (bool fail) { m_fail_commits = fail; }
+    int commits () const { return m_commits; }
 private:
     GncMockSqlResult m_result;
+    std::vector<std::string> m_executed;
+    bool m_fail_commits = false;
+    int m_commits = 0;
 };
 
 /* gnc_sql_init
@@ -337,6 +363,186 @@ test_gnc_sql_commit_edit (void)
     g_object_unref (book);
     delete sql_be;
 }
+static void
+test_gnc_sql_commit_write_behind (void)
+{
+    GncMockSqlConnection conn;
+
+    qof_object_initialize ();
+    auto book = qof_book_new();
+    auto sql_be = new GncMockSqlBackend (&conn, book);
+    gnc_account_create_root (book);
+    sql_be->set_write_behind (60000);
+    g_assert (sql_be->write_behind ());
+
+    /* A commit is only queued: the book stays dirty until it's flushed. */
+    qof_instance_set_dirty_flag (QOF_INSTANCE (book), TRUE);
+    qof_book_mark_session_dirty (book);
+    sql_be->commit (QOF_INSTANCE (book));
+    g_assert (qof_instance_get_dirty_flag (QOF_INSTANCE (book)));
+    g_assert (qof_book_session_not_saved (book));
+
+    /* Committing again coalesces with the queued commit. */
+    sql_be->commit (QOF_INSTANCE (book));
+    g_assert (sql_be->flush_pending ());
+    g_assert (!qof_instance_get_dirty_flag (QOF_INSTANCE (book)));
+    g_assert (!qof_book_session_not_saved (book));
+
+    /* An instance being edited again isn't written until it's committed. */
+    qof_instance_set_dirty_flag (QOF_INSTANCE (book), TRUE);
+    qof_book_mark_session_dirty (book);
+    sql_be->commit (QOF_INSTANCE (book));
+    qof_begin_edit (QOF_INSTANCE (book));
+    g_assert (sql_be->flush_pending ());
+    g_assert (qof_instance_get_dirty_flag (QOF_INSTANCE (book)));
+    qof_commit_edit (QOF_INSTANCE (book));
+
+    /* Turning write-behind off writes whatever is left. */
+    sql_be->set_write_behind (0);
+    g_assert (!sql_be->write_behind ());
+    g_assert (!qof_instance_get_dirty_flag (QOF_INSTANCE (book)));
+    g_assert (!qof_book_session_not_saved (book));
+
+    g_object_unref (book);
+    delete sql_be;
+}
+
+static void
+commit_error_cb (gpointer data, QofBackendError errcode)
+{
+    static_cast<std::vector<QofBackendError>*>(data)->push_back (errcode);
+}
+
+/* Run the main loop until @a done or until a second has passed. */
+static bool
+run_main_loop_until (const std::function<bool()>& done)
+{
+    auto deadline = g_get_monotonic_time () + G_USEC_PER_SEC;
+    while (!done ())
+    {
+        if (g_get_monotonic_time () > deadline)
+            return false;
+        if (!g_main_context_iteration (nullptr, FALSE))
+            g_usleep (1000);
+    }
+    return true;
+}
+
+/* Nothing waits for a timed flush, so its failure must go to the commit
+ * error handler, once until a flush succeeds, and stay on the backend. */
+static void
+test_gnc_sql_commit_write_behind_error (void)
+{
+    GncMockSqlConnection conn;
+    std::vector<QofBackendError> errors;
+
+    qof_object_initialize ();
+    auto book = qof_book_new();
+    auto sql_be = new GncMockSqlBackend (&conn, book);
+    gnc_account_create_root (book);
+    gnc_engine_add_commit_error_callback (commit_error_cb, &errors);
+    sql_be->set_write_behind (1);
+
+    conn.fail_commits (true);
+    qof_instance_set_dirty_flag (QOF_INSTANCE (book), TRUE);
+    sql_be->commit (QOF_INSTANCE (book));
+    /* The first timed flush and two retries. */
+    g_assert (run_main_loop_until ([&conn]{ return conn.commits () >= 3; }));
+    g_assert_cmpuint (errors.size (), ==, 1);
+    g_assert_cmpint (errors[0], ==, ERR_BACKEND_SERVER_ERR);
+    g_assert (qof_instance_get_dirty_flag (QOF_INSTANCE (book)));
+    g_assert (sql_be->check_error ());
+
+    /* A retry succeeds once the server is back. */
+    conn.fail_commits (false);
+    g_assert (run_main_loop_until ([book]{
+                return !qof_instance_get_dirty_flag (QOF_INSTANCE (book)); }));
+    g_assert_cmpint (sql_be->get_error (), ==, ERR_BACKEND_SERVER_ERR);
+    g_assert_cmpuint (errors.size (), ==, 1);
+
+    /* After that success, the next failure is reported again. */
+    conn.fail_commits (true);
+    qof_instance_set_dirty_flag (QOF_INSTANCE (book), TRUE);
+    sql_be->commit (QOF_INSTANCE (book));
+    g_assert (run_main_loop_until ([&errors]{ return errors.size () == 2; }));
+    g_assert_cmpint (errors[1], ==, ERR_BACKEND_SERVER_ERR);
+
+    conn.fail_commits (false);
+    sql_be->set_write_behind (0);
+    g_assert (!qof_instance_get_dirty_flag (QOF_INSTANCE (book)));
+    gnc_engine_add_commit_error_callback (nullptr, nullptr);
+    g_object_unref (book);
+    delete sql_be;
+}
+
+/* Instances created and flushed by write-behind must be updated, not
+ * inserted again, the next time they're written. */
+static void
+test_gnc_sql_commit_write_behind_infants (void)
+{
+    GncMockSqlConnection conn;
+
+    qof_object_initialize ();
+    auto book = qof_book_new();
+    auto sql_be = new GncMockSqlBackend (&conn, book);
+    gnc_account_create_root (book);
+    sql_be->set_write_behind (60000);
+
+    auto currency = gnc_commodity_new (book, "Gnu Rand", "CURRENCY", "GNR",
+                                       "", 240);
+    auto acc = xaccMallocAccount (book);
+    xaccAccountBeginEdit (acc);
+    xaccAccountSetCommodity (acc, currency);
+    xaccAccountSetName (acc, "Write behind");
+    xaccAccountCommitEdit (acc);
+    auto trans = xaccMallocTransaction (book);
+    xaccTransBeginEdit (trans);
+    xaccTransSetCurrency (trans, currency);
+    xaccTransSetDescription (trans, "Write behind");
+    xaccTransCommitEdit (trans);
+    g_assert (qof_instance_get_infant (QOF_INSTANCE (acc)));
+    g_assert (qof_instance_get_infant (QOF_INSTANCE (trans)));
+
+    /* The engine has no backend here, so commit them by hand. */
+    sql_be->commit (QOF_INSTANCE (acc));
+    sql_be->commit (QOF_INSTANCE (trans));
+    conn.clear_executed ();
+    g_assert (sql_be->flush_pending ());
+    g_assert (!qof_instance_get_dirty_flag (QOF_INSTANCE (acc)));
+    g_assert (!qof_instance_get_dirty_flag (QOF_INSTANCE (trans)));
+    g_assert (!qof_instance_get_infant (QOF_INSTANCE (acc)));
+    g_assert (!qof_instance_get_infant (QOF_INSTANCE (trans)));
+    g_assert_cmpint (conn.count_executed ("INSERT INTO accounts"), ==, 1);
+    g_assert_cmpint (conn.count_executed ("INSERT INTO transactions"), ==, 1);
+
+    xaccAccountBeginEdit (acc);
+    xaccAccountSetName (acc, "Write behind again");
+    xaccAccountCommitEdit (acc);
+    xaccTransBeginEdit (trans);
+    xaccTransSetDescription (trans, "Write behind again");
+    xaccTransCommitEdit (trans);
+    g_assert (qof_instance_get_dirty_flag (QOF_INSTANCE (acc)));
+    g_assert (qof_instance_get_dirty_flag (QOF_INSTANCE (trans)));
+    sql_be->commit (QOF_INSTANCE (acc));
+    sql_be->commit (QOF_INSTANCE (trans));
+    conn.clear_executed ();
+    g_assert (sql_be->flush_pending ());
+    g_assert (!qof_instance_get_dirty_flag (QOF_INSTANCE (acc)));
+    g_assert (!qof_instance_get_dirty_flag (QOF_INSTANCE (trans)));
+    g_assert_cmpint (conn.count_executed ("INSERT INTO accounts"), ==, 0);
+    g_assert_cmpint (conn.count_executed ("INSERT INTO transactions"), ==, 0);
+    g_assert_cmpint (conn.count_executed ("UPDATE accounts"), ==, 1);
+    g_assert_cmpint (conn.count_executed ("UPDATE transactions"), ==, 1);
+
+    sql_be->set_write_behind (0);
+    xaccTransBeginEdit (trans);
+    xaccTransDestroy (trans);
+    xaccTransCommitEdit (trans);
+    xaccAccountBeginEdit (acc);
+    xaccAccountDestroy (acc);
+    g_object_unref (book);
+    delete sql_be;
+}
 /* handle_and_term
 static void
 handle_and_term (QofQueryTerm* pTerm, GString* sql)// 2
@@ -857,6 +1063,9 @@ test_suite_gnc_backend_sql (void)
 // GNC_TEST_ADD (suitename, "gnc sql rollback edit", Fixture, nullptr, test_gnc_sql_rollback_edit,  teardown);
 // GNC_TEST_ADD (suitename, "commit cb", Fixture, nullptr, test_commit_cb,  teardown);
     GNC_TEST_ADD_FUNC (suitename, "gnc sql commit edit", test_gnc_sql_commit_edit);
+    GNC_TEST_ADD_FUNC (suitename, "gnc sql commit write behind", test_gnc_sql_commit_write_behind);
+    GNC_TEST_ADD_FUNC (suitename, "gnc sql commit write behind infants", test_gnc_sql_commit_write_behind_infants);
+    GNC_TEST_ADD_FUNC (suitename, "gnc sql commit write behind error", test_gnc_sql_commit_write_behind_error);
 // GNC_TEST_ADD (suitename, "handle and term", Fixture, nullptr, test_handle_and_term,  teardown);
 // GNC_TEST_ADD (suitename, "compile query cb", Fixture, nullptr, test_compile_query_cb,  teardown);
 // GNC_TEST_ADD (suitename, "gnc sql compile query", Fixture, nullptr, test_gnc_sql_compile_query,  teardown);
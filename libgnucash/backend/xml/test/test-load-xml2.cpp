@@ -44,6 +44,7 @@ extern "C"
 #include <TransLog.h>
 #include <gnc-engine.h>
 #include <gnc-prefs.h>
+#include <qof-string-cache.h>
 
 #include <unittest-support.h>
 #include <test-engine-stuff.h>
@@ -116,6 +117,45 @@ test_load_file (const char* filename)
     qof_session_end (session);
 }
 
+static void
+open_and_close (const char* filename)
+{
+    auto session = qof_session_new (nullptr);
+    remove_locks (filename);
+    auto ignore_lock = (g_strcmp0 (g_getenv ("SRCDIR"), ".") != 0);
+    qof_session_begin (session, filename,
+                       ignore_lock ? SESSION_READ_ONLY : SESSION_NORMAL_OPEN);
+    qof_session_load (session, NULL);
+    qof_session_end (session);
+    qof_session_destroy (session);
+}
+
+/* Closing a book must give back the strings its load interned, so that
+ * opening and closing it again leaves the string cache where it was. */
+static void
+test_reload_releases_strings (const char* filename)
+{
+    QofStringCacheStats first, second;
+
+    open_and_close (filename);
+    qof_string_cache_get_stats (&first);
+    open_and_close (filename);
+    qof_string_cache_get_stats (&second);
+
+    do_test_args (second.strings == first.strings,
+                  "string cache size after reopening", __FILE__, __LINE__,
+                  "%" G_GSIZE_FORMAT " strings after first close, %"
+                  G_GSIZE_FORMAT " after second, file [%s]",
+                  first.strings, second.strings, filename);
+    do_test_args (second.bytes_stored == first.bytes_stored,
+                  "string cache bytes after reopening", __FILE__, __LINE__,
+                  "%" G_GSIZE_FORMAT " bytes after first close, %"
+                  G_GSIZE_FORMAT " after second, file [%s]",
+                  first.bytes_stored, second.bytes_stored, filename);
+    do_test (second.immortal_strings == 0,
+             "loading a book made strings immortal");
+}
+
 int
 main (int argc, char** argv)
 {
@@ -161,6 +201,12 @@ main (int argc, char** argv)
 
     g_dir_close (xml2_dir);
 
+    {
+        gchar* to_open = g_build_filename (location, "abc.gml2", (gchar*)NULL);
+        test_reload_releases_strings (to_open);
+        g_free (to_open);
+    }
+
     if (files_tested == 0)
     {
         failure ("handled 0 files in test-load-xml2");
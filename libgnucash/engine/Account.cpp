@@ -36,6 +36,7 @@ extern "C" {
 #include <string.h>
 
 #include "AccountP.h"
+#include "Query.h"
 #include "Split.h"
 #include "Transaction.h"
 #include "TransactionP.h"
@@ -44,11 +45,15 @@ extern "C" {
 #include "gnc-lot.h"
 #include "gnc-pricedb.h"
 #include "qofinstance-p.h"
+#include "qof-backend.hpp"
 #include "gnc-features.h"
 #include "guid.hpp"
 
+#include <algorithm>
 #include <numeric>
 #include <map>
+#include <unordered_map>
+#include <vector>
 
 static QofLogModule log_module = GNC_MOD_ACCOUNT;
 
@@ -305,6 +310,101 @@ mark_account (Account *acc)
 /********************************************************************\
 \********************************************************************/
 
+/* The account's splits with, for each position, the lowest running
+ * balance from there to the last split, so that the projected minimum
+ * balance doesn't have to walk back from the end of the list. It also
+ * keeps where the last dates asked for fell in the list, so that asking
+ * again for "today" is a comparison and a new date a binary search on
+ * one side of it. Only valid while the splits are sorted and their
+ * balances current, so it's dropped whenever they're redone. */
+struct AccountSplitIndex
+{
+    std::vector<Split*> splits;
+    std::vector<gnc_numeric> lowest_from;
+    time64 before_date = INT64_MIN;
+    size_t before_pos = 0;      /* number of splits posted before it */
+    time64 through_date = INT64_MIN;
+    size_t through_pos = 0;     /* number posted at or before it */
+};
+
+static void
+account_free_split_index (AccountPrivate *priv)
+{
+    delete priv->split_index;
+    priv->split_index = nullptr;
+}
+
+static AccountSplitIndex*
+account_get_split_index (const Account *acc)
+{
+    auto priv = GET_PRIVATE(acc);
+    if (priv->sort_dirty || priv->balance_dirty)
+        return nullptr;
+    if (priv->split_index)
+        return priv->split_index;
+
+    auto index = new AccountSplitIndex;
+    for (auto node = priv->splits; node; node = node->next)
+    {
+        auto split = static_cast<Split*>(node->data);
+        /* Splits without a transaction sort last but have no date, so
+         * the dates wouldn't be in order. */
+        if (!xaccSplitGetParent (split))
+        {
+            delete index;
+            return nullptr;
+        }
+        index->splits.push_back (split);
+    }
+
+    auto n = index->splits.size ();
+    index->lowest_from.resize (n);
+    for (auto i = n; i-- > 0;)
+    {
+        auto balance = xaccSplitGetBalance (index->splits[i]);
+        if (i == n - 1 ||
+            gnc_numeric_compare (balance, index->lowest_from[i + 1]) < 0)
+            index->lowest_from[i] = balance;
+        else
+            index->lowest_from[i] = index->lowest_from[i + 1];
+    }
+    priv->split_index = index;
+    return index;
+}
+
+/* The number of the index's splits posted before date, or at or before
+ * it if through is set. */
+static size_t
+split_index_count (AccountSplitIndex *index, time64 date, bool through)
+{
+    auto& cached_date = through ? index->through_date : index->before_date;
+    auto& cached_pos = through ? index->through_pos : index->before_pos;
+    if (cached_date == date && cached_date != INT64_MIN)
+        return cached_pos;
+
+    auto posted_before = [date, through](Split *split)
+    {
+        auto posted = xaccTransGetDate (xaccSplitGetParent (split));
+        return through ? posted <= date : posted < date;
+    };
+    auto begin = index->splits.begin ();
+    auto end = index->splits.end ();
+    if (cached_date != INT64_MIN)
+    {
+        if (date > cached_date)
+            begin += cached_pos;
+        else
+            end = begin + cached_pos;
+    }
+    cached_pos = std::partition_point (begin, end, posted_before) -
+        index->splits.begin ();
+    cached_date = date;
+    return cached_pos;
+}
+
+/********************************************************************\
+\********************************************************************/
+
 /* GObject Initialization */
 G_DEFINE_TYPE_WITH_PRIVATE(Account, gnc_account, QOF_TYPE_INSTANCE)
 
@@ -341,9 +441,12 @@ gnc_account_init(Account* acc)
     priv->starting_cleared_balance = gnc_numeric_zero();
     priv->starting_reconciled_balance = gnc_numeric_zero();
     priv->balance_dirty = FALSE;
+    priv->balance_checkpoints = NULL;
 
     priv->splits = NULL;
     priv->sort_dirty = FALSE;
+    priv->splits_loaded_since = INT64_MIN;
+    priv->split_index = NULL;
 }
 
 static void
@@ -1354,6 +1457,13 @@ xaccFreeAccount (Account *acc)
         priv->lots = NULL;
     }
 
+    if (priv->balance_checkpoints)
+    {
+        g_array_free (priv->balance_checkpoints, TRUE);
+        priv->balance_checkpoints = NULL;
+    }
+    account_free_split_index (priv);
+
     /* Next, clean up the splits */
     /* NB there shouldn't be any splits by now ... they should
      * have been all been freed by CommitEdit().  We can remove this
@@ -1535,6 +1645,9 @@ xaccAccountDestroy (Account *acc)
 {
     g_return_if_fail(GNC_IS_ACCOUNT(acc));
 
+    /* Splits which are only in the backend's database would be left
+     * pointing at a deleted account. */
+    gnc_account_load_all_splits (acc);
     qof_instance_set_destroying(acc, TRUE);
 
     xaccAccountCommitEdit (acc);
@@ -1978,6 +2091,7 @@ xaccAccountSortSplits (Account *acc, gboolean force)
     priv->splits = g_list_sort(priv->splits, (GCompareFunc)xaccSplitOrder);
     priv->sort_dirty = FALSE;
     priv->balance_dirty = TRUE;
+    account_free_split_index (priv);
 }
 
 static void
@@ -2174,8 +2288,11 @@ xaccAccountMoveAllSplits (Account *accfrom, Account *accto)
     g_return_if_fail(GNC_IS_ACCOUNT(accto));
 
     /* optimizations */
+    if (accfrom == accto)
+        return;
+    gnc_account_load_all_splits (accfrom);
     from_priv = GET_PRIVATE(accfrom);
-    if (!from_priv->splits || accfrom == accto)
+    if (!from_priv->splits)
         return;
 
     /* check for book mix-up */
@@ -2301,6 +2418,7 @@ xaccAccountRecomputeBalance (Account * acc)
     priv->cleared_balance = cleared_balance;
     priv->reconciled_balance = reconciled_balance;
     priv->balance_dirty = FALSE;
+    account_free_split_index (priv);
 }
 
 /********************************************************************\
@@ -2574,6 +2692,7 @@ xaccAccountSetCommodity (Account * acc, gnc_commodity * com)
     priv->non_standard_scu = FALSE;
 
     /* iterate over splits */
+    gnc_account_load_all_splits (acc);
     for (lp = priv->splits; lp; lp = lp->next)
     {
         Split *s = (Split *) lp->data;
@@ -3415,6 +3534,101 @@ gnc_account_set_start_reconciled_balance (Account *acc,
     priv->balance_dirty = TRUE;
 }
 
+void
+gnc_account_set_splits_loaded_since (Account *acc, time64 since)
+{
+    g_return_if_fail(GNC_IS_ACCOUNT(acc));
+    GET_PRIVATE(acc)->splits_loaded_since = since;
+}
+
+void
+gnc_account_load_all_splits (const Account *acc)
+{
+    gnc_account_load_splits_since (acc, INT64_MIN);
+}
+
+void
+gnc_account_load_splits_since (const Account *acc, time64 since)
+{
+    g_return_if_fail(GNC_IS_ACCOUNT(acc));
+
+    if (GET_PRIVATE(acc)->splits_loaded_since <= since)
+        return;
+    auto book = qof_instance_get_book (acc);
+    auto be = qof_book_get_backend (book);
+    if (!be || qof_book_shutting_down (book))
+        return;
+
+    /* The backend moves splits_loaded_since back to what it loaded. */
+    auto query = qof_query_create_for (GNC_ID_SPLIT);
+    qof_query_set_book (query, book);
+    xaccQueryAddSingleAccountMatch (query, const_cast<Account*>(acc),
+                                    QOF_QUERY_AND);
+    if (since != INT64_MIN)
+        xaccQueryAddDateMatchTT (query, TRUE, since, FALSE, 0, QOF_QUERY_AND);
+    be->load_for_query (book, query);
+    qof_query_destroy (query);
+}
+
+void
+gnc_account_set_balance_checkpoints (Account *acc,
+                                     const GncBalanceCheckpoint *checkpoints,
+                                     guint n_checkpoints)
+{
+    AccountPrivate *priv;
+
+    g_return_if_fail(GNC_IS_ACCOUNT(acc));
+    g_return_if_fail(checkpoints != NULL || n_checkpoints == 0);
+
+    priv = GET_PRIVATE(acc);
+    if (n_checkpoints == 0)
+    {
+        if (priv->balance_checkpoints)
+            g_array_free (priv->balance_checkpoints, TRUE);
+        priv->balance_checkpoints = NULL;
+        return;
+    }
+
+    if (priv->balance_checkpoints)
+        g_array_set_size (priv->balance_checkpoints, 0);
+    else
+        priv->balance_checkpoints =
+            g_array_sized_new (FALSE, FALSE, sizeof (GncBalanceCheckpoint),
+                               n_checkpoints);
+    g_array_append_vals (priv->balance_checkpoints, checkpoints, n_checkpoints);
+}
+
+gboolean
+gnc_account_get_balance_checkpoint (const Account *acc, time64 date,
+                                    GncBalanceCheckpoint *checkpoint)
+{
+    GArray *checkpoints;
+    guint lo = 0, hi;
+
+    g_return_val_if_fail(GNC_IS_ACCOUNT(acc), FALSE);
+
+    checkpoints = GET_PRIVATE(acc)->balance_checkpoints;
+    if (!checkpoints)
+        return FALSE;
+
+    /* Find the first checkpoint after date; the one before it is ours. */
+    hi = checkpoints->len;
+    while (lo < hi)
+    {
+        guint mid = lo + (hi - lo) / 2;
+        if (g_array_index (checkpoints, GncBalanceCheckpoint, mid).date <= date)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    if (lo == 0)
+        return FALSE;
+
+    if (checkpoint)
+        *checkpoint = g_array_index (checkpoints, GncBalanceCheckpoint, lo - 1);
+    return TRUE;
+}
+
 gnc_numeric
 xaccAccountGetBalance (const Account *acc)
 {
@@ -3449,6 +3663,15 @@ xaccAccountGetProjectedMinimumBalance (const Account *acc)
 
     priv = GET_PRIVATE(acc);
     today = gnc_time64_get_today_end();
+    if (auto index = account_get_split_index (acc))
+    {
+        if (index->splits.empty ())
+            return lowest;
+        /* Everything from the last split posted by today on. */
+        auto pos = split_index_count (index, today, true);
+        return index->lowest_from[pos ? pos - 1 : 0];
+    }
+
     for (node = g_list_last(priv->splits); node; node = node->prev)
     {
         Split *split = static_cast<Split*>(node->data);
@@ -3484,21 +3707,70 @@ GetBalanceAsOfDate (Account *acc, time64 date, gboolean ignclosing)
      * values rather than gints.
      */
     Split *latest = nullptr;
+    GncBalanceCheckpoint checkpoint;
 
     g_return_val_if_fail(GNC_IS_ACCOUNT(acc), gnc_numeric_zero());
 
+    /* Checkpoints don't track closing transactions. Otherwise start from
+     * the checkpoint and add the account's splits posted since, which
+     * needs only those splits to be loaded. */
+    if (!ignclosing && gnc_account_get_balance_checkpoint (acc, date,
+                                                           &checkpoint) &&
+        checkpoint.date >= GET_PRIVATE(acc)->splits_loaded_since)
+    {
+        auto balance = checkpoint.balance;
+        if (checkpoint.date == date)
+            return balance;
+        xaccAccountSortSplits (acc, TRUE); /* just in case, normally a noop */
+        xaccAccountRecomputeBalance (acc); /* just in case, normally a noop */
+        if (auto index = account_get_split_index (acc))
+        {
+            auto from = split_index_count (index, checkpoint.date, false);
+            auto to = split_index_count (index, date, false);
+            for (auto i = from; i < to; ++i)
+                balance = gnc_numeric_add_fixed (balance,
+                                                 xaccSplitGetAmount (index->splits[i]));
+            return balance;
+        }
+        for (GList *lp = GET_PRIVATE(acc)->splits; lp; lp = lp->next)
+        {
+            auto split = static_cast<Split*>(lp->data);
+            auto posted = xaccTransGetDate (xaccSplitGetParent (split));
+            if (posted >= date)
+                break;
+            if (posted >= checkpoint.date)
+                balance = gnc_numeric_add_fixed (balance,
+                                                 xaccSplitGetAmount (split));
+        }
+        return balance;
+    }
+
+    /* The running balances of the loaded splits start from the sum of
+     * those which aren't, so they are right before date once all of the
+     * splits posted from date on are loaded. */
+    gnc_account_load_splits_since (acc, date);
     xaccAccountSortSplits (acc, TRUE); /* just in case, normally a noop */
     xaccAccountRecomputeBalance (acc); /* just in case, normally a noop */
 
-    for (GList *lp = GET_PRIVATE(acc)->splits; lp; lp = lp->next)
+    if (auto index = account_get_split_index (acc))
     {
-        if (xaccTransGetDate (xaccSplitGetParent ((Split *)lp->data)) >= date)
-            break;
-        latest = (Split *)lp->data;
+        auto pos = split_index_count (index, date, false);
+        if (pos)
+            latest = index->splits[pos - 1];
+    }
+    else
+    {
+        for (GList *lp = GET_PRIVATE(acc)->splits; lp; lp = lp->next)
+        {
+            if (xaccTransGetDate (xaccSplitGetParent ((Split *)lp->data)) >= date)
+                break;
+            latest = (Split *)lp->data;
+        }
     }
 
     if (!latest)
-        return gnc_numeric_zero();
+        return ignclosing ? GET_PRIVATE(acc)->starting_noclosing_balance :
+            GET_PRIVATE(acc)->starting_balance;
 
     if (ignclosing)
         return xaccSplitGetNoclosingBalance (latest);
@@ -3525,6 +3797,7 @@ xaccAccountGetReconciledBalanceAsOfDate (Account *acc, time64 date)
 
     g_return_val_if_fail(GNC_IS_ACCOUNT(acc), gnc_numeric_zero());
 
+    gnc_account_load_all_splits (acc);
     for (GList *node = GET_PRIVATE(acc)->splits; node; node = node->next)
     {
         Split *split = (Split*) node->data;
@@ -3877,6 +4150,225 @@ xaccAccountGetNoclosingBalanceChangeForPeriod (Account *acc, time64 t1,
     return gnc_numeric_sub(b2, b1, GNC_DENOM_AUTO, GNC_HOW_DENOM_FIXED);
 }
 
+/********************************************************************\
+\********************************************************************/
+
+struct GncBalanceMatrix
+{
+    struct Row
+    {
+        Account *account;
+        std::vector<gnc_commodity*> commodities;
+        /* One run of balances per commodity, in column order. */
+        std::vector<gnc_numeric> balances;
+    };
+
+    GncBalanceFlags flags;
+    std::vector<Row> rows;
+    std::vector<time64> dates;
+    bool computed = false;
+
+    void compute ();
+};
+
+/* Whether the balance walk for flags counts split. */
+static bool
+balance_counts_split (Split *split, GncBalanceFlags flags)
+{
+    if ((flags & GNC_BALANCE_CLEARED_ONLY) &&
+        xaccSplitGetReconcile (split) == NREC)
+        return false;
+    if ((flags & GNC_BALANCE_EXCLUDE_CLOSING) &&
+        xaccTransGetIsClosingTxn (xaccSplitGetParent (split)))
+        return false;
+    return true;
+}
+
+/* The sum of the splits not in memory that balance_counts_split would
+ * count. Backends keep that for one flag at a time; no starting balance
+ * covers both, but once every split is loaded there are none left to
+ * count. */
+static gnc_numeric
+starting_balance_for (Account *acc, GncBalanceFlags flags)
+{
+    auto priv = GET_PRIVATE (acc);
+    auto cleared = flags & GNC_BALANCE_CLEARED_ONLY;
+    auto noclosing = flags & GNC_BALANCE_EXCLUDE_CLOSING;
+
+    if (cleared && noclosing)
+    {
+        if (priv->splits_loaded_since == INT64_MIN)
+            return gnc_numeric_zero ();
+        PWARN ("Account %s has no starting balance excluding closing "
+               "transactions; using the cleared one", priv->accountName);
+        return priv->starting_cleared_balance;
+    }
+    if (cleared)
+        return priv->starting_cleared_balance;
+    if (noclosing)
+        return priv->starting_noclosing_balance;
+    return priv->starting_balance;
+}
+
+/* The account's balance at each of the sorted dates, walking its
+ * splits once. */
+static std::vector<gnc_numeric>
+balances_at_dates (Account *acc, const std::vector<time64>& dates,
+                   GncBalanceFlags flags)
+{
+    std::vector<gnc_numeric> ret;
+    if (dates.empty ())
+        return ret;
+
+    /* The starting balance covers the splits which aren't loaded, so
+     * only those posted after the first date are needed. */
+    gnc_account_load_splits_since (acc, dates.front ());
+    auto priv = GET_PRIVATE (acc);
+    auto balance = starting_balance_for (acc, flags);
+
+    xaccAccountSortSplits (acc, TRUE); /* just in case, normally a noop */
+    ret.reserve (dates.size ());
+    auto node = priv->splits;
+    for (auto date : dates)
+    {
+        for (; node; node = node->next)
+        {
+            auto split = static_cast<Split*> (node->data);
+            if (xaccTransGetDate (xaccSplitGetParent (split)) > date)
+                break;
+            if (balance_counts_split (split, flags))
+                balance = gnc_numeric_add_fixed (balance,
+                                                 xaccSplitGetAmount (split));
+        }
+        ret.push_back (balance);
+    }
+    return ret;
+}
+
+void
+GncBalanceMatrix::compute ()
+{
+    auto n_dates = dates.size ();
+    std::vector<size_t> order (n_dates);
+    std::iota (order.begin (), order.end (), 0);
+    std::stable_sort (order.begin (), order.end (),
+                      [this](size_t a, size_t b) { return dates[a] < dates[b]; });
+    std::vector<time64> sorted;
+    sorted.reserve (n_dates);
+    for (auto col : order)
+        sorted.push_back (dates[col]);
+
+    /* Parents and children are often both rows; walk each account once. */
+    std::unordered_map<Account*, std::vector<gnc_numeric>> cache;
+    for (auto& row : rows)
+    {
+        auto accts = g_list_prepend (flags & GNC_BALANCE_INCLUDE_CHILDREN ?
+                                     gnc_account_get_descendants (row.account) :
+                                     nullptr, row.account);
+        row.commodities.clear ();
+        row.balances.clear ();
+        for (auto node = accts; node; node = node->next)
+        {
+            auto acc = static_cast<Account*> (node->data);
+            auto spot = cache.find (acc);
+            if (spot == cache.end ())
+                spot = cache.emplace (acc, balances_at_dates (acc, sorted, flags)).first;
+
+            auto comm = xaccAccountGetCommodity (acc);
+            auto pos = std::find_if (row.commodities.begin (), row.commodities.end (),
+                                     [comm](gnc_commodity *c)
+                                     { return gnc_commodity_equal (c, comm); });
+            auto n = pos - row.commodities.begin ();
+            if (pos == row.commodities.end ())
+            {
+                row.commodities.push_back (comm);
+                row.balances.resize (row.balances.size () + n_dates,
+                                     gnc_numeric_zero ());
+            }
+            for (size_t i = 0; i < n_dates; ++i)
+            {
+                auto& cell = row.balances[n * n_dates + order[i]];
+                cell = gnc_numeric_add_fixed (cell, spot->second[i]);
+            }
+        }
+        g_list_free (accts);
+    }
+    computed = true;
+}
+
+GncBalanceMatrix *
+gnc_balance_matrix_new (GncBalanceFlags flags)
+{
+    auto matrix = new GncBalanceMatrix;
+    matrix->flags = flags;
+    return matrix;
+}
+
+void
+gnc_balance_matrix_free (GncBalanceMatrix *matrix)
+{
+    delete matrix;
+}
+
+guint
+gnc_balance_matrix_add_account (GncBalanceMatrix *matrix, Account *account)
+{
+    g_return_val_if_fail (matrix && GNC_IS_ACCOUNT (account), 0);
+    matrix->rows.push_back ({account, {}, {}});
+    matrix->computed = false;
+    return matrix->rows.size () - 1;
+}
+
+guint
+gnc_balance_matrix_add_date (GncBalanceMatrix *matrix, time64 date)
+{
+    g_return_val_if_fail (matrix, 0);
+    matrix->dates.push_back (date);
+    matrix->computed = false;
+    return matrix->dates.size () - 1;
+}
+
+guint
+gnc_balance_matrix_get_n_dates (GncBalanceMatrix *matrix)
+{
+    g_return_val_if_fail (matrix, 0);
+    return matrix->dates.size ();
+}
+
+static GncBalanceMatrix::Row *
+balance_matrix_row (GncBalanceMatrix *matrix, guint row)
+{
+    g_return_val_if_fail (matrix && row < matrix->rows.size (), nullptr);
+    if (!matrix->computed)
+        matrix->compute ();
+    return &matrix->rows[row];
+}
+
+guint
+gnc_balance_matrix_get_n_commodities (GncBalanceMatrix *matrix, guint row)
+{
+    auto r = balance_matrix_row (matrix, row);
+    return r ? r->commodities.size () : 0;
+}
+
+gnc_commodity *
+gnc_balance_matrix_get_commodity (GncBalanceMatrix *matrix, guint row, guint n)
+{
+    auto r = balance_matrix_row (matrix, row);
+    g_return_val_if_fail (r && n < r->commodities.size (), nullptr);
+    return r->commodities[n];
+}
+
+gnc_numeric
+gnc_balance_matrix_get_balance (GncBalanceMatrix *matrix, guint row, guint n,
+                                guint column)
+{
+    auto r = balance_matrix_row (matrix, row);
+    g_return_val_if_fail (r && n < r->commodities.size () &&
+                          column < matrix->dates.size (), gnc_numeric_zero ());
+    return r->balances[n * matrix->dates.size () + column];
+}
+
 
 /********************************************************************\
 \********************************************************************/
@@ -3896,10 +4388,24 @@ SplitList *
 xaccAccountGetSplitList (const Account *acc)
 {
     g_return_val_if_fail(GNC_IS_ACCOUNT(acc), NULL);
+    gnc_account_load_all_splits (acc);
     xaccAccountSortSplits((Account*)acc, FALSE);  // normally a noop
     return GET_PRIVATE(acc)->splits;
 }
 
+SplitList *
+xaccAccountGetSplitListSince (const Account *acc, time64 since)
+{
+    g_return_val_if_fail(GNC_IS_ACCOUNT(acc), NULL);
+    gnc_account_load_splits_since (acc, since);
+    xaccAccountSortSplits((Account*)acc, FALSE);  // normally a noop
+    auto node = GET_PRIVATE(acc)->splits;
+    while (node &&
+           xaccTransGetDate (xaccSplitGetParent (static_cast<Split*>(node->data))) < since)
+        node = node->next;
+    return node;
+}
+
 gint64
 xaccAccountCountSplits (const Account *acc, gboolean include_children)
 {
@@ -5013,6 +5519,7 @@ finder_help_function(const Account *acc, const char *description,
     /* Why is this loop iterated backwards ?? Presumably because the split
      * list is in date order, and the most recent matches should be
      * returned!?  */
+    gnc_account_load_all_splits (acc);
     priv = GET_PRIVATE(acc);
     for (slp = g_list_last(priv->splits); slp; slp = slp->prev)
     {
@@ -5133,6 +5640,7 @@ gnc_account_merge_children (Account *parent)
             gnc_account_merge_children (acc_a);
 
             /* consolidate transactions */
+            gnc_account_load_all_splits (acc_b);
             while (priv_b->splits)
                 xaccSplitSetAccount (static_cast <Split*> (priv_b->splits->data), acc_a);
 
@@ -5231,6 +5739,7 @@ xaccAccountStagedTransactionTraversal (const Account *acc,
 
     if (!acc) return 0;
 
+    gnc_account_load_all_splits (acc);
     priv = GET_PRIVATE(acc);
     for (split_p = priv->splits; split_p; split_p = next)
     {
@@ -5280,6 +5789,7 @@ gnc_account_tree_staged_transaction_traversal (const Account *acc,
     }
 
     /* Now this account */
+    gnc_account_load_all_splits (acc);
     for (split_p = priv->splits; split_p; split_p = g_list_next(split_p))
     {
         s = static_cast <Split*> (split_p->data);
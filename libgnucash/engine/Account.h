@@ -355,6 +355,70 @@ void gnc_account_set_start_cleared_balance (Account *acc,
 void gnc_account_set_start_reconciled_balance (Account *acc,
         const gnc_numeric start_baln);
 
+/** Tell the account that only its splits posted on or after @a since
+ *  are sure to be loaded, the others possibly being only in the
+ *  backend's database.  This routine is intended for use with backends
+ *  that return a partial list of splits as described for
+ *  gnc_account_set_start_balance().  Until the backend sets it back to
+ *  INT64_MIN, everything that walks the account's splits, directly or
+ *  through xaccAccountGetSplitList(), first has the backend load the
+ *  rest of them by passing a query for the account's splits to its
+ *  load_for_query hook.
+ *
+ *  @param acc The account.
+ *  @param since The earliest post date of the loaded splits, or
+ *  INT64_MIN if all of them are loaded. */
+void gnc_account_set_splits_loaded_since (Account *acc, time64 since);
+
+/** Have the backend load the splits of the account which aren't loaded
+ *  yet, if there are any; see gnc_account_set_splits_loaded_since().
+ *
+ *  @param acc The account. */
+void gnc_account_load_all_splits (const Account *acc);
+
+/** Have the backend load the splits of the account posted on or after
+ *  @a since which aren't loaded yet, leaving older ones in its database.
+ *  Backends which can't load a window of an account load all of them.
+ *  Nothing loaded is unloaded again while the book is open.
+ *
+ *  @param acc The account.
+ *  @param since The earliest post date of the splits needed. */
+void gnc_account_load_splits_since (const Account *acc, time64 since);
+
+/** The balances of an account from all of its splits posted before
+ *  @a date, whether or not those splits are loaded. */
+typedef struct
+{
+    time64 date;
+    gnc_numeric balance;
+    gnc_numeric cleared_balance;
+    gnc_numeric reconciled_balance;
+} GncBalanceCheckpoint;
+
+/** Give the account a set of balance checkpoints, replacing any it had.
+ *  This routine is intended for use with backends which store
+ *  checkpoints, typically one per month, and keep them up to date as
+ *  splits are committed.  xaccAccountGetBalanceAsOfDate() then starts
+ *  from the latest checkpoint at or before the date instead of from the
+ *  account's first split.
+ *
+ *  @param acc The account.
+ *  @param checkpoints The checkpoints, sorted by date; they are copied.
+ *  @param n_checkpoints The number of checkpoints; 0 removes them all. */
+void gnc_account_set_balance_checkpoints (Account *acc,
+                                          const GncBalanceCheckpoint *checkpoints,
+                                          guint n_checkpoints);
+
+/** Find the latest balance checkpoint of the account dated at or before
+ *  @a date.
+ *
+ *  @param acc The account.
+ *  @param date The date.
+ *  @param checkpoint Filled in with the checkpoint if one is found.
+ *  @return TRUE if a checkpoint was found. */
+gboolean gnc_account_get_balance_checkpoint (const Account *acc, time64 date,
+                                             GncBalanceCheckpoint *checkpoint);
+
 /** Tell the account that the running balances may be incorrect and
  *  need to be recomputed.
  *
@@ -621,6 +685,47 @@ gnc_numeric xaccAccountGetNoclosingBalanceChangeForPeriod (
 gnc_numeric xaccAccountGetBalanceChangeForPeriod (
     Account *acc, time64 date1, time64 date2, gboolean recurse);
 
+/** Flags controlling the balances computed by a GncBalanceMatrix. */
+typedef enum
+{
+    GNC_BALANCE_INCLUDE_CHILDREN = 1 << 0, /**< Add in all descendants */
+    GNC_BALANCE_CLEARED_ONLY = 1 << 1,     /**< Skip unreconciled splits */
+    GNC_BALANCE_EXCLUDE_CLOSING = 1 << 2,  /**< Skip closing transactions */
+} GncBalanceFlags;
+
+/** A GncBalanceMatrix computes the balances of a set of accounts at a
+ *  set of dates, for reports that need many of them. Add the accounts
+ *  (rows) and dates (columns), then read the balances; each account's
+ *  splits are walked once however many dates and rows use it.
+ *
+ *  A balance at a date includes the splits posted on or before it. A
+ *  row holds one balance per date for each commodity found in the
+ *  account and, with GNC_BALANCE_INCLUDE_CHILDREN, its descendants.
+ *  The balances are computed when first read and aren't updated if the
+ *  accounts change afterwards.
+ */
+typedef struct GncBalanceMatrix GncBalanceMatrix;
+
+GncBalanceMatrix *gnc_balance_matrix_new (GncBalanceFlags flags);
+void gnc_balance_matrix_free (GncBalanceMatrix *matrix);
+/** @return The row index of the account. */
+guint gnc_balance_matrix_add_account (GncBalanceMatrix *matrix,
+                                      Account *account);
+/** @return The column index of the date. Dates needn't be sorted. */
+guint gnc_balance_matrix_add_date (GncBalanceMatrix *matrix, time64 date);
+/** @return The number of dates added. */
+guint gnc_balance_matrix_get_n_dates (GncBalanceMatrix *matrix);
+/** @return The number of commodities in the row. */
+guint gnc_balance_matrix_get_n_commodities (GncBalanceMatrix *matrix,
+                                            guint row);
+gnc_commodity *gnc_balance_matrix_get_commodity (GncBalanceMatrix *matrix,
+                                                 guint row, guint n);
+/** @return The balance in the row's nth commodity at the date in
+ *  column. */
+gnc_numeric gnc_balance_matrix_get_balance (GncBalanceMatrix *matrix,
+                                            guint row, guint n,
+                                            guint column);
+
 /** @} */
 
 /** @name Account Children and Parents.
@@ -1032,6 +1137,13 @@ gboolean xaccAccountIsEquityType(GNCAccountType t);
  */
 SplitList* xaccAccountGetSplitList (const Account *account);
 
+/** Like xaccAccountGetSplitList(), but only the splits posted on or after
+ *  @a since are sure to be loaded. Returns the node of the account's list
+ *  holding the first of them; the nodes before it, if any, are loaded
+ *  splits posted earlier.
+ */
+SplitList* xaccAccountGetSplitListSince (const Account *account, time64 since);
+
 
 /** The xaccAccountCountSplits() routine returns the number of all
  *    the splits in the account. xaccAccountCountSplits is O(N). if
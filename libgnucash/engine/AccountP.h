@@ -116,8 +116,18 @@ typedef struct AccountPrivate
 
     gboolean balance_dirty;     /* balances in splits incorrect */
 
+    /* Sorted GncBalanceCheckpoint array set by backends, or NULL */
+    GArray *balance_checkpoints;
+
     GList *splits;              /* list of split pointers */
     gboolean sort_dirty;        /* sort order of splits is bad */
+    /* Earliest post date of the splits sure to be loaded, set by
+     * backends which load only recent splits; INT64_MIN if all are */
+    time64 splits_loaded_since;
+
+    /* Lowest future balances and cached date positions in splits, built
+     * when needed while neither flag above is set, or NULL */
+    struct AccountSplitIndex *split_index;
 
     LotList   *lots;		/* list of lot pointers */
     GNCPolicy *policy;		/* Cached pointer to policy method */
@@ -124,6 +124,9 @@ gnc_split_init(Split* split)
 
     split->gains = GAINS_STATUS_UNKNOWN;
     split->gains_split = NULL;
+
+    split->date_index_iter = NULL;
+    split->date_index_key = 0;
 }
 
 static void
@@ -716,6 +719,13 @@ xaccFreeSplit (Split *split)
     split->orig_acc    = NULL;
 
     split->date_reconciled = 0;
+
+    if (split->date_index_iter)
+    {
+        g_sequence_remove (split->date_index_iter);
+        split->date_index_iter = NULL;
+    }
+
     G_OBJECT_CLASS (QOF_INSTANCE_GET_CLASS (&split->inst))->dispose(G_OBJECT (split));
     // Is this right?
     if (split->gains_split) split->gains_split->gains_split = NULL;
@@ -2163,6 +2173,147 @@ xaccSplitUnvoid(Split *split)
     qof_instance_set_dirty (QOF_INSTANCE (split));
 }
 
+/********************************************************************\
+ * Posted-date index                                                *
+ *                                                                  *
+ * A GSequence of all of a book's splits which have a parent        *
+ * transaction, ordered by the posted date of that transaction.     *
+ * The date is copied into the split when it is filed so that the   *
+ * order stays consistent while other transactions are being edited.*
+\********************************************************************/
+
+#define GNC_SPLIT_DATE_INDEX "gnc-split-date-index"
+
+static gint
+split_date_index_cmp (gconstpointer a, gconstpointer b, gpointer user_data)
+{
+    const Split *sa = a, *sb = b;
+
+    if (sa->date_index_key != sb->date_index_key)
+        return sa->date_index_key < sb->date_index_key ? -1 : 1;
+    if (sa == sb)
+        return 0;
+    return sa < sb ? -1 : 1;
+}
+
+/* Compare against a start date probe, which sorts before the splits
+ * posted at that date, for g_sequence_search. */
+static gint
+split_date_search_cmp (gconstpointer a, gconstpointer b, gpointer probe)
+{
+    const time64 start = *(const time64*)probe;
+
+    if (a == probe)
+        return ((const Split*)b)->date_index_key < start ? 1 : -1;
+    if (b == probe)
+        return ((const Split*)a)->date_index_key < start ? -1 : 1;
+    return split_date_index_cmp (a, b, NULL);
+}
+
+static void
+split_date_index_add_cb (QofInstance *inst, gpointer data)
+{
+    Split *split = GNC_SPLIT (inst);
+
+    if (!split->parent)
+        return;
+
+    split->date_index_key = xaccTransGetDate (split->parent);
+    split->date_index_iter = g_sequence_append (data, split);
+}
+
+static void
+split_date_index_forget_cb (gpointer data, gpointer user_data)
+{
+    ((Split*)data)->date_index_iter = NULL;
+}
+
+static void
+split_date_index_destroy (QofBook *book, gpointer key, gpointer data)
+{
+    g_sequence_foreach (data, split_date_index_forget_cb, NULL);
+    g_sequence_free (data);
+}
+
+static GSequence *
+split_date_index_get (QofBook *book, gboolean create)
+{
+    GSequence *index;
+
+    if (!book || qof_book_shutting_down (book))
+        return NULL;
+
+    index = qof_book_get_data (book, GNC_SPLIT_DATE_INDEX);
+    if (index || !create)
+        return index;
+
+    ENTER ("book=%p", book);
+    index = g_sequence_new (NULL);
+    qof_collection_foreach (qof_book_get_collection (book, GNC_ID_SPLIT),
+                            split_date_index_add_cb, index);
+    g_sequence_sort (index, split_date_index_cmp, NULL);
+    qof_book_set_data_fin (book, GNC_SPLIT_DATE_INDEX, index,
+                           split_date_index_destroy);
+    LEAVE ("%d splits", g_sequence_get_length (index));
+    return index;
+}
+
+void
+xaccSplitUpdateDateIndex (Split *split)
+{
+    GSequence *index;
+    time64 date;
+
+    if (!split) return;
+
+    index = split_date_index_get (qof_instance_get_book (split), FALSE);
+    if (!index) return;
+
+    if (!split->parent || qof_instance_get_destroying (split))
+    {
+        if (split->date_index_iter)
+            g_sequence_remove (split->date_index_iter);
+        split->date_index_iter = NULL;
+        return;
+    }
+
+    date = xaccTransGetDate (split->parent);
+    if (split->date_index_iter && date == split->date_index_key)
+        return;
+
+    if (split->date_index_iter)
+        g_sequence_remove (split->date_index_iter);
+    split->date_index_key = date;
+    split->date_index_iter = g_sequence_insert_sorted (index, split,
+                                                       split_date_index_cmp,
+                                                       NULL);
+}
+
+void
+xaccBookForeachSplitInDateRange (QofBook *book, time64 start, time64 end,
+                                 QofInstanceForeachCB cb, gpointer user_data)
+{
+    GSequence *index;
+    GSequenceIter *iter;
+
+    g_return_if_fail (cb);
+
+    index = split_date_index_get (book, TRUE);
+    if (!index) return;
+
+    /* Where start would go is the first split posted on or after it. */
+    for (iter = g_sequence_search (index, &start, split_date_search_cmp,
+                                   &start);
+         !g_sequence_iter_is_end (iter); iter = g_sequence_iter_next (iter))
+    {
+        Split *split = g_sequence_get (iter);
+
+        if (split->date_index_key > end)
+            break;
+        cb (QOF_INSTANCE (split), user_data);
+    }
+}
+
 /********************************************************************\
 \********************************************************************/
 /* QofObject function implementation */
@@ -2332,6 +2483,11 @@ gboolean xaccSplitRegister (void)
                         NULL);
     qof_class_register (SPLIT_CORR_ACCT_CODE,
                         (QofSortFunc)xaccSplitCompareOtherAccountCodes, NULL);
+    qof_query_register_date_index (GNC_ID_SPLIT,
+                                   qof_query_build_param_list (SPLIT_TRANS,
+                                                               TRANS_DATE_POSTED,
+                                                               NULL),
+                                   xaccBookForeachSplitInDateRange);
 
     return qof_object_register (&split_object_def);
 }
@@ -463,6 +463,19 @@ int xaccSplitCompareOtherAccountCodes(const Split *sa, const Split *sb);
  * or "Split" for Account Code.
  */
 
+/** Call @a cb on each split of @a book whose transaction was posted
+ * between @a start and @a end inclusive, in order of posted date.
+ *
+ * The splits are taken from a per-book index that is built on the
+ * first call and afterwards kept up to date by xaccTransCommitEdit(),
+ * so posted dates changed in a transaction that is still open are not
+ * reflected until it is committed. The callback must not commit
+ * transactions.
+ */
+void xaccBookForeachSplitInDateRange (QofBook *book, time64 start, time64 end,
+                                      QofInstanceForeachCB cb,
+                                      gpointer user_data);
+
 char * xaccSplitGetCorrAccountFullName(const Split *sa);
 /** document me */
 const char * xaccSplitGetCorrAccountName(const Split *sa);
@@ -126,6 +126,11 @@ struct split_s
     gnc_numeric  noclosing_balance;
     gnc_numeric  cleared_balance;
     gnc_numeric  reconciled_balance;
+
+    /* Position of this split in the book's posted-date index and the
+     * posted date it was filed under, see xaccSplitUpdateDateIndex. */
+    GSequenceIter *date_index_iter;
+    time64 date_index_key;
 };
 
 struct _SplitClass
@@ -166,6 +171,11 @@ gnc_numeric xaccSplitsComputeValue (GList *splits, const Split * skip_me,
 /* Code to register Split type with the engine */
 gboolean xaccSplitRegister (void);
 
+/* Refile the split in its book's posted-date index after its
+ * transaction has been committed. Does nothing until the index has
+ * been built by a first range query. */
+void xaccSplitUpdateDateIndex (Split *split);
+
 /* The xaccSplitDetermineGainStatus() routine will analyze the
  *   the split, and try to set the internal status flags
  *   appropriately for the split.  These flags indicate if the split
@@ -1631,6 +1631,10 @@ static void trans_cleanup_commit(Transaction *trans)
     /* Good question.  Who knows?  */
     xaccTransSortSplits(trans);
 
+    /* Keep the book's posted-date index in step. */
+    for (node = trans->splits; node; node = node->next)
+        xaccSplitUpdateDateIndex (node->data);
+
     /* Put back to zero. */
     qof_instance_decrease_editlevel(trans);
     g_assert(qof_instance_get_editlevel(trans) == 0);
@@ -94,6 +94,9 @@ typedef struct GNCLotPrivate
 
     /* traversal marker, handy for preventing recursion */
     unsigned char marker;
+
+    /* TRUE once the backend has been asked for the lot's splits */
+    gboolean splits_loaded;
 } GNCLotPrivate;
 
 #define GET_PRIVATE(o) \
@@ -416,12 +419,43 @@ gnc_lot_set_closed_unknown(GNCLot* lot)
     }
 }
 
+/* Have a backend which keeps some transactions in its database load
+ * those with splits in the lot, once; the rest of the lot's account can
+ * stay there. */
+static void
+lot_load_all_splits (const GNCLot *lot, GNCLotPrivate* priv)
+{
+    QofBook *book;
+    QofBackend *be;
+    QofQuery *query;
+
+    if (priv->splits_loaded || !priv->account)
+        return;
+    priv->splits_loaded = TRUE;
+
+    book = qof_instance_get_book (QOF_INSTANCE (lot));
+    be = qof_book_get_backend (book);
+    if (!be || qof_book_shutting_down (book))
+        return;
+
+    query = qof_query_create_for (GNC_ID_SPLIT);
+    qof_query_set_book (query, book);
+    qof_query_add_guid_match (query,
+                              qof_query_build_param_list (SPLIT_LOT,
+                                                          QOF_PARAM_GUID, NULL),
+                              qof_instance_get_guid (QOF_INSTANCE (lot)),
+                              QOF_QUERY_AND);
+    qof_backend_load_for_query (be, book, query);
+    qof_query_destroy (query);
+}
+
 SplitList *
 gnc_lot_get_split_list (const GNCLot *lot)
 {
     GNCLotPrivate* priv;
     if (!lot) return NULL;
     priv = GET_PRIVATE(lot);
+    lot_load_all_splits (lot, priv);
     return priv->splits;
 }
 
@@ -430,6 +464,7 @@ gint gnc_lot_count_splits (const GNCLot *lot)
     GNCLotPrivate* priv;
     if (!lot) return 0;
     priv = GET_PRIVATE(lot);
+    lot_load_all_splits (lot, priv);
     return g_list_length (priv->splits);
 }
 
@@ -496,6 +531,7 @@ gnc_lot_get_balance (GNCLot *lot)
     if (!lot) return zero;
 
     priv = GET_PRIVATE(lot);
+    lot_load_all_splits (lot, priv);
     if (!priv->splits)
     {
         priv->is_closed = FALSE;
@@ -543,6 +579,7 @@ gnc_lot_get_balance_before (const GNCLot *lot, const Split *split,
     if (lot == NULL) return;
 
     priv = GET_PRIVATE(lot);
+    lot_load_all_splits (lot, priv);
     if (priv->splits)
     {
         Transaction *ta, *tb;
@@ -663,6 +700,7 @@ gnc_lot_get_earliest_split (GNCLot *lot)
     GNCLotPrivate* priv;
     if (!lot) return NULL;
     priv = GET_PRIVATE(lot);
+    lot_load_all_splits (lot, priv);
     if (! priv->splits) return NULL;
     priv->splits = g_list_sort (priv->splits, (GCompareFunc) xaccSplitOrderDateOnly);
     return priv->splits->data;
@@ -677,6 +715,7 @@ gnc_lot_get_latest_split (GNCLot *lot)
 
     if (!lot) return NULL;
     priv = GET_PRIVATE(lot);
+    lot_load_all_splits (lot, priv);
     if (! priv->splits) return NULL;
     priv->splits = g_list_sort (priv->splits, (GCompareFunc) xaccSplitOrderDateOnly);
 
@@ -0,0 +1,652 @@
+/********************************************************************\
+ * gnc-split-table.cpp -- Filtered, sorted and grouped split lists  *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ *                                                                  *
+\********************************************************************/
+
+extern "C"
+{
+#include <config.h>
+
+#include <glib.h>
+#include <string.h>
+
+#include "Account.h"
+#include "Query.h"
+#include "Split.h"
+#include "Transaction.h"
+#include "gnc-date.h"
+}
+
+#include "gnc-split-table.h"
+
+#include <algorithm>
+#include <regex>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+static QofLogModule log_module = GNC_MOD_ENGINE;
+
+enum class SortKey
+{
+    NONE,
+    ACCOUNT_NAME,
+    ACCOUNT_CODE,
+    DATE,
+    RECONCILED_DATE,
+    RECONCILED_STATUS,
+    REGISTER_ORDER,
+    CORR_ACCOUNT_NAME,
+    CORR_ACCOUNT_CODE,
+    AMOUNT,
+    DESCRIPTION,
+    NUMBER,
+    T_NUMBER,
+    MEMO,
+    NOTES,
+};
+
+enum class DateGroup
+{
+    NONE,
+    DAY,
+    WEEK,
+    MONTH,
+    QUARTER,
+    YEAR,
+};
+
+struct KeyName
+{
+    const char* name;
+    SortKey key;
+};
+
+static const KeyName key_names[] =
+{
+    {"none", SortKey::NONE},
+    {"account-name", SortKey::ACCOUNT_NAME},
+    {"account-code", SortKey::ACCOUNT_CODE},
+    {"date", SortKey::DATE},
+    {"reconciled-date", SortKey::RECONCILED_DATE},
+    {"reconciled-status", SortKey::RECONCILED_STATUS},
+    {"register-order", SortKey::REGISTER_ORDER},
+    {"corresponding-acc-name", SortKey::CORR_ACCOUNT_NAME},
+    {"corresponding-acc-code", SortKey::CORR_ACCOUNT_CODE},
+    {"amount", SortKey::AMOUNT},
+    {"description", SortKey::DESCRIPTION},
+    {"number", SortKey::NUMBER},
+    {"t-number", SortKey::T_NUMBER},
+    {"memo", SortKey::MEMO},
+    {"notes", SortKey::NOTES},
+};
+
+struct DateGroupName
+{
+    const char* name;
+    DateGroup group;
+};
+
+static const DateGroupName date_group_names[] =
+{
+    {"none", DateGroup::NONE},
+    {"daily", DateGroup::DAY},
+    {"weekly", DateGroup::WEEK},
+    {"monthly", DateGroup::MONTH},
+    {"quarterly", DateGroup::QUARTER},
+    {"yearly", DateGroup::YEAR},
+};
+
+struct TableKey
+{
+    SortKey key = SortKey::NONE;
+    DateGroup date_group = DateGroup::NONE;
+    bool ascending = true;
+    bool subtotal = false;
+};
+
+/* The value a split has for a key. Splits whose values are both NONE
+ * compare equal, like the report's sortvalue functions returning #f. */
+struct KeyValue
+{
+    enum class Kind { NONE, INTEGER, NUMERIC, STRING } kind = Kind::NONE;
+    gint64 integer = 0;
+    gnc_numeric numeric = gnc_numeric_zero ();
+    std::string string;         /* the value, for grouping */
+    std::string collation;      /* its collation key, for sorting */
+};
+
+struct SplitRow
+{
+    Split* split;
+    KeyValue sort_value[2];
+    GncSplitTableGroupEnd group_end = GNC_SPLIT_TABLE_NO_END;
+};
+
+struct GncSplitTable
+{
+    TableKey keys[2];
+    bool split_action = false;
+
+    bool account_filter = false;
+    bool account_exclude = false;
+    std::unordered_set<const Account*> accounts;
+
+    bool matcher = false;
+    bool matcher_exclude = false;
+    bool matcher_regex = false;
+    bool matcher_case_insensitive = false;
+    std::string pattern;        /* casefolded if matcher_case_insensitive */
+    std::regex regex;
+
+    std::vector<SplitRow> rows;
+};
+
+GncSplitTable *
+gnc_split_table_new (void)
+{
+    return new GncSplitTable;
+}
+
+void
+gnc_split_table_free (GncSplitTable *table)
+{
+    delete table;
+}
+
+void
+gnc_split_table_set_split_action (GncSplitTable *table, gboolean split_action)
+{
+    g_return_if_fail (table);
+    table->split_action = split_action;
+}
+
+void
+gnc_split_table_set_account_filter (GncSplitTable *table, AccountList *accounts,
+                                    gboolean exclude)
+{
+    g_return_if_fail (table);
+    table->account_filter = true;
+    table->account_exclude = exclude;
+    table->accounts.clear ();
+    for (auto node = accounts; node; node = g_list_next (node))
+        table->accounts.insert (static_cast<const Account*> (node->data));
+}
+
+gboolean
+gnc_split_table_set_matcher (GncSplitTable *table, const char *pattern,
+                             gboolean regex, gboolean case_insensitive,
+                             gboolean exclude)
+{
+    g_return_val_if_fail (table && pattern, FALSE);
+    if (regex)
+    {
+        auto flags = std::regex::extended | std::regex::nosubs;
+        if (case_insensitive)
+            flags |= std::regex::icase;
+        try
+        {
+            table->regex = std::regex (pattern, flags);
+        }
+        catch (const std::regex_error& err)
+        {
+            PWARN ("Invalid transaction filter %s: %s", pattern, err.what ());
+            table->matcher = false;
+            return FALSE;
+        }
+        table->pattern = pattern;
+    }
+    else if (case_insensitive)
+    {
+        auto folded = g_utf8_casefold (pattern, -1);
+        table->pattern = folded;
+        g_free (folded);
+    }
+    else
+        table->pattern = pattern;
+
+    table->matcher = true;
+    table->matcher_regex = regex;
+    table->matcher_case_insensitive = case_insensitive;
+    table->matcher_exclude = exclude;
+    return TRUE;
+}
+
+gboolean
+gnc_split_table_set_sort_key (GncSplitTable *table, guint level,
+                              const char *key, const char *date_group,
+                              gboolean ascending, gboolean subtotal)
+{
+    g_return_val_if_fail (table && level < 2 && key, FALSE);
+    auto key_name = std::find_if (std::begin (key_names), std::end (key_names),
+                                  [key](auto& kn){ return !strcmp (kn.name, key); });
+    if (key_name == std::end (key_names))
+    {
+        PWARN ("Unknown sort key %s", key);
+        return FALSE;
+    }
+    auto group = DateGroup::NONE;
+    if (date_group)
+    {
+        auto gn = std::find_if (std::begin (date_group_names),
+                                std::end (date_group_names),
+                                [date_group](auto& gn)
+                                { return !strcmp (gn.name, date_group); });
+        if (gn == std::end (date_group_names))
+        {
+            PWARN ("Unknown date grouping %s", date_group);
+            return FALSE;
+        }
+        group = gn->group;
+    }
+    auto& table_key = table->keys[level];
+    table_key.key = key_name->key;
+    table_key.date_group = group;
+    table_key.ascending = ascending;
+    table_key.subtotal = subtotal;
+    return TRUE;
+}
+
+/* Filters */
+
+static bool
+is_filter_member (const GncSplitTable *table, const Split *split)
+{
+    for (auto node = xaccTransGetSplitList (xaccSplitGetParent (split));
+         node; node = g_list_next (node))
+    {
+        auto other = static_cast<const Split*> (node->data);
+        if (other != split &&
+            table->accounts.count (xaccSplitGetAccount (other)))
+            return true;
+    }
+    return false;
+}
+
+static bool
+string_matches (const GncSplitTable *table, const char *str)
+{
+    if (!str)
+        str = "";
+    if (table->matcher_regex)
+        return std::regex_search (str, table->regex);
+    if (!table->matcher_case_insensitive)
+        return strstr (str, table->pattern.c_str ()) != nullptr;
+
+    auto folded = g_utf8_casefold (str, -1);
+    auto found = strstr (folded, table->pattern.c_str ()) != nullptr;
+    g_free (folded);
+    return found;
+}
+
+static bool
+split_passes_filters (const GncSplitTable *table, const Split *split)
+{
+    if (table->account_filter &&
+        is_filter_member (table, split) == table->account_exclude)
+        return false;
+
+    if (table->matcher)
+    {
+        auto trans = xaccSplitGetParent (split);
+        auto matches = string_matches (table, xaccTransGetDescription (trans)) ||
+            string_matches (table, xaccTransGetNotes (trans)) ||
+            string_matches (table, xaccSplitGetMemo (split));
+        if (matches == table->matcher_exclude)
+            return false;
+    }
+    return true;
+}
+
+/* Key values */
+
+/* The day of the week weeks start on, 1 for Sunday. */
+static gint
+week_start (void)
+{
+    static gint start = 0;
+    if (!start)
+    {
+        start = gnc_start_of_week ();
+        if (!start)
+        {
+            PWARN ("cannot determine start of week. using Sunday");
+            start = 1;
+        }
+    }
+    return start;
+}
+
+/* Matches time64-day, time64-week etc. in trep-engine.scm, so that the
+ * groups are the ones the report labels. */
+static gint64
+date_group_value (time64 time, DateGroup group)
+{
+    struct tm tm;
+    if (group != DateGroup::WEEK && !gnc_localtime_r (&time, &tm))
+        return 0;
+
+    switch (group)
+    {
+    case DateGroup::DAY:
+        return (tm.tm_year + 1900) * 500 + tm.tm_yday + 1;
+    case DateGroup::WEEK:
+    {
+        const gint64 day = 86400;
+        auto start = gnc_time64_get_day_start (time) - (1 + week_start ()) * day;
+        auto week = 7 * day;
+        return start >= 0 ? start / week : -((-start + week - 1) / week);
+    }
+    case DateGroup::MONTH:
+        return (tm.tm_year + 1900) * 100 + tm.tm_mon + 1;
+    case DateGroup::QUARTER:
+        return (tm.tm_year + 1900) * 10 + tm.tm_mon / 3 + 1;
+    case DateGroup::YEAR:
+        return tm.tm_year + 1900;
+    default:
+        return 0;
+    }
+}
+
+static void
+set_string_value (KeyValue& value, const char *str, bool collate)
+{
+    value.kind = KeyValue::Kind::STRING;
+    value.string = str ? str : "";
+    if (collate)
+    {
+        auto key = g_utf8_collate_key (value.string.c_str (), -1);
+        value.collation = key;
+        g_free (key);
+    }
+}
+
+static void
+set_integer_value (KeyValue& value, gint64 integer)
+{
+    value.kind = KeyValue::Kind::INTEGER;
+    value.integer = integer;
+}
+
+/* The length of the tail of reconcile-list in trep-engine.scm that
+ * starts at the split's status. */
+static gint64
+reconcile_status_value (char status)
+{
+    static const char order[] = {NREC, CREC, YREC, FREC, VREC};
+    auto pos = std::find (std::begin (order), std::end (order), status);
+    return std::end (order) - pos;
+}
+
+static void
+key_value (const GncSplitTable *table, Split *split, SortKey key,
+           DateGroup date_group, bool collate, KeyValue& value)
+{
+    auto trans = xaccSplitGetParent (split);
+    switch (key)
+    {
+    case SortKey::ACCOUNT_NAME:
+    {
+        auto name = gnc_account_get_full_name (xaccSplitGetAccount (split));
+        set_string_value (value, name, collate);
+        g_free (name);
+        break;
+    }
+    case SortKey::ACCOUNT_CODE:
+        set_string_value (value, xaccAccountGetCode (xaccSplitGetAccount (split)),
+                          collate);
+        break;
+    case SortKey::DATE:
+        if (date_group != DateGroup::NONE)
+            set_integer_value (value, date_group_value (xaccTransGetDate (trans),
+                                                        date_group));
+        break;
+    case SortKey::RECONCILED_DATE:
+        if (date_group != DateGroup::NONE)
+            set_integer_value (value,
+                               date_group_value (xaccSplitGetDateReconciled (split),
+                                                 date_group));
+        break;
+    case SortKey::RECONCILED_STATUS:
+        set_integer_value (value, reconcile_status_value (xaccSplitGetReconcile (split)));
+        break;
+    case SortKey::CORR_ACCOUNT_NAME:
+    {
+        auto name = xaccSplitGetCorrAccountFullName (split);
+        set_string_value (value, name, collate);
+        g_free (name);
+        break;
+    }
+    case SortKey::CORR_ACCOUNT_CODE:
+        set_string_value (value, xaccSplitGetCorrAccountCode (split), collate);
+        break;
+    case SortKey::AMOUNT:
+        value.kind = KeyValue::Kind::NUMERIC;
+        value.numeric = xaccSplitGetValue (split);
+        break;
+    case SortKey::DESCRIPTION:
+        set_string_value (value, xaccTransGetDescription (trans), collate);
+        break;
+    case SortKey::NUMBER:
+        set_string_value (value, table->split_action ? xaccSplitGetAction (split) :
+                          xaccTransGetNum (trans), collate);
+        break;
+    case SortKey::T_NUMBER:
+        set_string_value (value, xaccTransGetNum (trans), collate);
+        break;
+    case SortKey::MEMO:
+        set_string_value (value, xaccSplitGetMemo (split), collate);
+        break;
+    case SortKey::NOTES:
+        set_string_value (value, xaccTransGetNotes (trans), collate);
+        break;
+    default:
+        /* Register order and none leave the query's order alone. */
+        break;
+    }
+}
+
+/* Subtotal groups of date keys are taken from the posted date whichever
+ * date is sorted on, as the report's date-subtotal-list does. */
+static void
+group_value (const GncSplitTable *table, Split *split, const TableKey& key,
+             KeyValue& value)
+{
+    if (key.key == SortKey::DATE || key.key == SortKey::RECONCILED_DATE)
+    {
+        if (key.date_group != DateGroup::NONE)
+            set_integer_value (value,
+                               date_group_value (xaccTransGetDate (xaccSplitGetParent (split)),
+                                                 key.date_group));
+    }
+    else
+        key_value (table, split, key.key, key.date_group, false, value);
+}
+
+static int
+compare_values (const KeyValue& a, const KeyValue& b)
+{
+    if (a.kind == KeyValue::Kind::NONE || b.kind == KeyValue::Kind::NONE)
+        return 0;
+    switch (a.kind)
+    {
+    case KeyValue::Kind::INTEGER:
+        return a.integer < b.integer ? -1 : a.integer > b.integer;
+    case KeyValue::Kind::NUMERIC:
+        return gnc_numeric_compare (a.numeric, b.numeric);
+    case KeyValue::Kind::STRING:
+        return a.collation.compare (b.collation);
+    default:
+        return 0;
+    }
+}
+
+static bool
+same_group (const KeyValue& a, const KeyValue& b)
+{
+    if (a.kind != b.kind)
+        return false;
+    switch (a.kind)
+    {
+    case KeyValue::Kind::INTEGER:
+        return a.integer == b.integer;
+    case KeyValue::Kind::NUMERIC:
+        return gnc_numeric_equal (a.numeric, b.numeric);
+    case KeyValue::Kind::STRING:
+        return a.string == b.string;
+    default:
+        return true;
+    }
+}
+
+static void
+sort_rows (GncSplitTable *table)
+{
+    bool any_key = false;
+    for (auto level = 0; level < 2; ++level)
+    {
+        const auto& key = table->keys[level];
+        for (auto& row : table->rows)
+            key_value (table, row.split, key.key, key.date_group, true,
+                       row.sort_value[level]);
+        any_key = any_key || key.key != SortKey::NONE;
+    }
+    if (!any_key)
+        return;
+
+    std::stable_sort (table->rows.begin (), table->rows.end (),
+                      [table](const SplitRow& a, const SplitRow& b)
+                      {
+                          for (auto level = 0; level < 2; ++level)
+                          {
+                              auto cmp = compare_values (a.sort_value[level],
+                                                         b.sort_value[level]);
+                              if (cmp)
+                                  return table->keys[level].ascending ? cmp < 0 : cmp > 0;
+                          }
+                          return false;
+                      });
+}
+
+static void
+find_group_ends (GncSplitTable *table)
+{
+    auto& primary = table->keys[0];
+    auto& secondary = table->keys[1];
+    KeyValue current[2], next[2];
+
+    if (table->rows.empty () || !(primary.subtotal || secondary.subtotal))
+        return;
+
+    if (primary.subtotal)
+        group_value (table, table->rows[0].split, primary, next[0]);
+    if (secondary.subtotal)
+        group_value (table, table->rows[0].split, secondary, next[1]);
+
+    for (size_t i = 0; i < table->rows.size (); ++i)
+    {
+        bool last = i + 1 == table->rows.size ();
+        std::swap (current[0], next[0]);
+        std::swap (current[1], next[1]);
+        if (!last)
+        {
+            auto split = table->rows[i + 1].split;
+            next[0] = next[1] = KeyValue ();
+            if (primary.subtotal)
+                group_value (table, split, primary, next[0]);
+            if (secondary.subtotal)
+                group_value (table, split, secondary, next[1]);
+        }
+
+        auto& end = table->rows[i].group_end;
+        if (primary.subtotal && (last || !same_group (current[0], next[0])))
+            end = GNC_SPLIT_TABLE_PRIMARY_END;
+        else if (secondary.subtotal && (last || !same_group (current[1], next[1])))
+            end = GNC_SPLIT_TABLE_SECONDARY_END;
+    }
+}
+
+void
+gnc_split_table_build (GncSplitTable *table, SplitList *splits, gboolean sort)
+{
+    g_return_if_fail (table);
+    ENTER ("table %p, %u splits", table, g_list_length (splits));
+
+    table->rows.clear ();
+    for (auto node = splits; node; node = g_list_next (node))
+    {
+        auto split = static_cast<Split*> (node->data);
+        if (split_passes_filters (table, split))
+            table->rows.push_back (SplitRow {split});
+    }
+
+    if (sort)
+        sort_rows (table);
+    find_group_ends (table);
+
+    LEAVE ("%zu rows", table->rows.size ());
+}
+
+void
+gnc_split_table_run (GncSplitTable *table, QofQuery *query,
+                     gboolean unique_trans, gboolean sort)
+{
+    g_return_if_fail (table && query);
+    if (unique_trans)
+    {
+        auto splits = xaccQueryGetSplitsUniqueTrans (query);
+        gnc_split_table_build (table, splits, sort);
+        g_list_free (splits);
+    }
+    else
+        gnc_split_table_build (table, qof_query_run (query), sort);
+}
+
+guint
+gnc_split_table_get_n_rows (const GncSplitTable *table)
+{
+    g_return_val_if_fail (table, 0);
+    return table->rows.size ();
+}
+
+SplitList *
+gnc_split_table_get_splits (const GncSplitTable *table)
+{
+    g_return_val_if_fail (table, nullptr);
+    GList *splits = nullptr;
+    for (auto row = table->rows.rbegin (); row != table->rows.rend (); ++row)
+        splits = g_list_prepend (splits, row->split);
+    return splits;
+}
+
+Split *
+gnc_split_table_get_split (const GncSplitTable *table, guint row)
+{
+    g_return_val_if_fail (table && row < table->rows.size (), nullptr);
+    return table->rows[row].split;
+}
+
+GncSplitTableGroupEnd
+gnc_split_table_get_group_end (const GncSplitTable *table, guint row)
+{
+    g_return_val_if_fail (table && row < table->rows.size (),
+                          GNC_SPLIT_TABLE_NO_END);
+    return table->rows[row].group_end;
+}
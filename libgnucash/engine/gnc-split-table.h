@@ -0,0 +1,125 @@
+/********************************************************************\
+ * gnc-split-table.h -- Filtered, sorted and grouped split lists    *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ *                                                                  *
+\********************************************************************/
+/** @addtogroup Engine
+    @{ */
+/** @file gnc-split-table.h
+    @brief The split list of a transaction report, built in one pass.
+
+    A GncSplitTable takes the splits found by a query, drops the ones
+    rejected by the transaction report's filters, sorts the rest by up
+    to two keys and records where the subtotal groups of each key end,
+    so that the report only has to format the rows.
+
+    Sort keys are named as in the transaction report's options:
+    "account-name", "account-code", "date", "reconciled-date",
+    "reconciled-status", "register-order", "corresponding-acc-name",
+    "corresponding-acc-code", "amount", "description", "number",
+    "t-number", "memo", "notes" and "none". Date keys are grouped with
+    "none", "daily", "weekly", "monthly", "quarterly" or "yearly".
+    Strings are compared with the locale's collation.
+*/
+
+#ifndef GNC_SPLIT_TABLE_H
+#define GNC_SPLIT_TABLE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <glib.h>
+#include "qofquery.h"
+#include "gnc-engine.h"
+
+/** Which subtotal groups end after a row. A primary group ending also
+ *  ends the secondary group it contains. */
+typedef enum
+{
+    GNC_SPLIT_TABLE_NO_END = 0,
+    GNC_SPLIT_TABLE_SECONDARY_END = 1,
+    GNC_SPLIT_TABLE_PRIMARY_END = 2,
+} GncSplitTableGroupEnd;
+
+typedef struct GncSplitTable GncSplitTable;
+
+GncSplitTable *gnc_split_table_new (void);
+void gnc_split_table_free (GncSplitTable *table);
+
+/** Sort "number" by the split's action instead of the transaction's
+ *  number, as books using split action for num do. */
+void gnc_split_table_set_split_action (GncSplitTable *table,
+                                       gboolean split_action);
+
+/** Keep only the splits with another split in the same transaction in
+ *  one of accounts or, if exclude is set, only those without. */
+void gnc_split_table_set_account_filter (GncSplitTable *table,
+                                         AccountList *accounts,
+                                         gboolean exclude);
+
+/** Keep only the splits whose description, notes or memo contain
+ *  pattern or, if exclude is set, only those where none of them does.
+ *
+ *  @param regex Whether pattern is a POSIX extended regular expression.
+ *  @return FALSE if pattern isn't a valid regular expression. The
+ *  filter is then left unset.
+ */
+gboolean gnc_split_table_set_matcher (GncSplitTable *table,
+                                      const char *pattern, gboolean regex,
+                                      gboolean case_insensitive,
+                                      gboolean exclude);
+
+/** Set the primary (level 0) or secondary (level 1) key.
+ *
+ *  @param date_group How date keys are grouped, both for sorting and
+ *  for subtotals; ignored for other keys.
+ *  @param subtotal Whether the key's groups are reported by
+ *  gnc_split_table_get_group_end().
+ *  @return FALSE if key or date_group isn't known.
+ */
+gboolean gnc_split_table_set_sort_key (GncSplitTable *table, guint level,
+                                       const char *key, const char *date_group,
+                                       gboolean ascending, gboolean subtotal);
+
+/** Replace the table's rows with the splits that pass its filters,
+ *  stably sorted by its keys if sort is set. The list isn't changed. */
+void gnc_split_table_build (GncSplitTable *table, SplitList *splits,
+                            gboolean sort);
+
+/** Like gnc_split_table_build() with the result of running query, or
+ *  with at most one split per transaction if unique_trans is set. */
+void gnc_split_table_run (GncSplitTable *table, QofQuery *query,
+                          gboolean unique_trans, gboolean sort);
+
+guint gnc_split_table_get_n_rows (const GncSplitTable *table);
+/** @return A newly allocated list of the rows' splits. */
+SplitList *gnc_split_table_get_splits (const GncSplitTable *table);
+Split *gnc_split_table_get_split (const GncSplitTable *table, guint row);
+/** @return The subtotal groups ending after row. The last row ends
+ *  the groups of every key with subtotals. */
+GncSplitTableGroupEnd gnc_split_table_get_group_end (const GncSplitTable *table,
+                                                     guint row);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* GNC_SPLIT_TABLE_H */
+/** @} */
@@ -22,17 +22,207 @@
 **********************************************************************/
 
 #include "gncIDSearch.h"
+#include "gncVendor.h"
+#include "qofclass-p.h"
 
 typedef enum
 {   UNDEFINED,
     CUSTOMER,
     VENDOR,
     INVOICE,
-    BILL
+    BILL,
+    EMPLOYEE,
+    JOB
 }GncSearchType;
 
-static void * search(QofBook * book, const gchar *id, void * object, GncSearchType type);
+/* A book keeps, for each type of business object looked up here, a
+ * hash table from ID to the objects with that ID, so that importers
+ * calling these functions for every row don't search all the objects
+ * each time. The tables are built on the first lookup and then follow
+ * the objects' create, modify and destroy events, which the objects
+ * generate when they are committed.
+ */
+#define GNC_ID_SEARCH_INDEX "gnc-id-search-index"
+
+typedef struct
+{
+    /* ID -> GList* of the objects with that ID, usually just one.
+     * The lists are replaced in place, so the table doesn't own them. */
+    GHashTable *by_id;
+    /* object -> the ID it is filed under */
+    GHashTable *ids;
+} IDIndex;
+
+static gint id_index_event_handler_id = 0;
+
+static void * search(QofBook * book, const gchar *id, GncSearchType type);
 static QofLogModule log_module = G_LOG_DOMAIN;
+
+static QofIdTypeConst
+search_type_id (GncSearchType type)
+{
+    switch (type)
+    {
+    case CUSTOMER:
+        return GNC_ID_CUSTOMER;
+    case VENDOR:
+        return GNC_ID_VENDOR;
+    case INVOICE:
+    case BILL:
+        return GNC_ID_INVOICE;
+    case EMPLOYEE:
+        return GNC_ID_EMPLOYEE;
+    case JOB:
+        return GNC_ID_JOB;
+    default:
+        return NULL;
+    }
+}
+
+/* The key an object is filed under. Invoices and bills are numbered
+ * separately, so the key of an invoice also holds its type. */
+static gchar *
+id_index_key (QofIdTypeConst type_id, gpointer object)
+{
+    const gchar *id = NULL;
+
+    if (!g_strcmp0 (type_id, GNC_ID_CUSTOMER))
+        id = gncCustomerGetID (object);
+    else if (!g_strcmp0 (type_id, GNC_ID_VENDOR))
+        id = gncVendorGetID (object);
+    else if (!g_strcmp0 (type_id, GNC_ID_EMPLOYEE))
+        id = gncEmployeeGetID (object);
+    else if (!g_strcmp0 (type_id, GNC_ID_JOB))
+        id = gncJobGetID (object);
+    else if (!g_strcmp0 (type_id, GNC_ID_INVOICE))
+        return g_strdup_printf ("%d:%s", gncInvoiceGetType (object),
+                                gncInvoiceGetID (object) ? gncInvoiceGetID (object) : "");
+
+    return g_strdup (id ? id : "");
+}
+
+static void
+id_index_remove (IDIndex *index, gpointer object)
+{
+    gchar *key;
+    GList *objects;
+
+    if (!g_hash_table_lookup_extended (index->ids, object, NULL, (gpointer*)&key))
+        return;
+
+    objects = g_list_remove (g_hash_table_lookup (index->by_id, key), object);
+    if (objects)
+        g_hash_table_insert (index->by_id, g_strdup (key), objects);
+    else
+        g_hash_table_remove (index->by_id, key);
+    g_hash_table_remove (index->ids, object);
+}
+
+static void
+id_index_add (IDIndex *index, QofIdTypeConst type_id, gpointer object)
+{
+    gchar *key;
+    GList *objects;
+
+    if (qof_instance_get_destroying (object))
+        return;
+
+    key = id_index_key (type_id, object);
+    objects = g_hash_table_lookup (index->by_id, key);
+    g_hash_table_insert (index->by_id, g_strdup (key),
+                         g_list_prepend (objects, object));
+    g_hash_table_insert (index->ids, object, key);
+}
+
+static void
+id_index_add_cb (QofInstance *inst, gpointer data)
+{
+    id_index_add (data, inst->e_type, inst);
+}
+
+static void
+id_index_free (gpointer data)
+{
+    IDIndex *index = data;
+    GHashTableIter iter;
+    gpointer objects;
+
+    g_hash_table_iter_init (&iter, index->by_id);
+    while (g_hash_table_iter_next (&iter, NULL, &objects))
+        g_list_free (objects);
+    g_hash_table_destroy (index->by_id);
+    g_hash_table_destroy (index->ids);
+    g_free (index);
+}
+
+static void
+id_search_index_destroy (QofBook *book, gpointer key, gpointer data)
+{
+    g_hash_table_destroy (data);
+}
+
+static void
+id_index_handle_events (QofInstance *entity, QofEventId event_type,
+                        gpointer user_data, gpointer event_data)
+{
+    QofBook *book;
+    GHashTable *indexes;
+    IDIndex *index;
+
+    if (!(event_type & (QOF_EVENT_CREATE | QOF_EVENT_MODIFY | QOF_EVENT_DESTROY)))
+        return;
+
+    book = qof_instance_get_book (entity);
+    if (!book || qof_book_shutting_down (book))
+        return;
+    indexes = qof_book_get_data (book, GNC_ID_SEARCH_INDEX);
+    if (!indexes)
+        return;
+    index = g_hash_table_lookup (indexes, entity->e_type);
+    if (!index)
+        return;
+
+    id_index_remove (index, entity);
+    if (!(event_type & QOF_EVENT_DESTROY))
+        id_index_add (index, entity->e_type, entity);
+}
+
+static IDIndex *
+id_index_get (QofBook *book, QofIdTypeConst type_id)
+{
+    GHashTable *indexes;
+    IDIndex *index;
+
+    if (qof_book_shutting_down (book))
+        return NULL;
+
+    indexes = qof_book_get_data (book, GNC_ID_SEARCH_INDEX);
+    if (!indexes)
+    {
+        if (!id_index_event_handler_id)
+            id_index_event_handler_id =
+                qof_event_register_handler (id_index_handle_events, NULL);
+        indexes = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                         NULL, id_index_free);
+        qof_book_set_data_fin (book, GNC_ID_SEARCH_INDEX, indexes,
+                               id_search_index_destroy);
+    }
+
+    index = g_hash_table_lookup (indexes, type_id);
+    if (index)
+        return index;
+
+    ENTER ("book=%p type=%s", book, type_id);
+    index = g_new0 (IDIndex, 1);
+    index->by_id = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+    index->ids = g_hash_table_new_full (NULL, NULL, NULL, g_free);
+    qof_collection_foreach (qof_book_get_collection (book, type_id),
+                            id_index_add_cb, index);
+    g_hash_table_insert (indexes, (gpointer)type_id, index);
+    LEAVE ("%d ids", g_hash_table_size (index->by_id));
+    return index;
+}
+
 /***********************************************************************
  * Search the book for a Customer/Invoice/Bill with the same ID.
  * If it exists return a valid object, if not then returns NULL.
@@ -45,38 +235,38 @@ static QofLogModule log_module = G_LOG_DOMAIN;
 GncCustomer *
 gnc_search_customer_on_id (QofBook * book, const gchar *id)
 {
-    GncCustomer *customer = NULL;
-    GncSearchType type = CUSTOMER;
-    customer = (GncCustomer*)search(book, id, customer, type);
-    return customer;
+    return (GncCustomer*)search(book, id, CUSTOMER);
 }
 
 GncInvoice *
 gnc_search_invoice_on_id (QofBook * book, const gchar *id)
 {
-    GncInvoice *invoice = NULL;
-    GncSearchType type = INVOICE;
-    invoice = (GncInvoice*)search(book, id, invoice, type);
-    return invoice;
+    return (GncInvoice*)search(book, id, INVOICE);
 }
 
 /* Essentially identical to above.*/
 GncInvoice *
 gnc_search_bill_on_id (QofBook * book, const gchar *id)
 {
-    GncInvoice *bill =  NULL;
-    GncSearchType type = BILL;
-    bill = (GncInvoice*)search(book, id, bill, type);
-    return bill;
+    return (GncInvoice*)search(book, id, BILL);
 }
 
 GncVendor *
 gnc_search_vendor_on_id (QofBook * book, const gchar *id)
 {
-    GncVendor *vendor =  NULL;
-    GncSearchType type = VENDOR;
-    vendor = (GncVendor*)search(book, id, vendor, type);
-    return vendor;
+    return (GncVendor*)search(book, id, VENDOR);
+}
+
+GncEmployee *
+gnc_search_employee_on_id (QofBook * book, const gchar *id)
+{
+    return (GncEmployee*)search(book, id, EMPLOYEE);
+}
+
+GncJob *
+gnc_search_job_on_id (QofBook * book, const gchar *id)
+{
+    return (GncJob*)search(book, id, JOB);
 }
 
 
@@ -84,80 +274,43 @@ gnc_search_vendor_on_id (QofBook * book, const gchar *id)
  * Generic search called after setting up stuff
  * DO NOT call directly but type tests should fail anyway
  ****************************************************************/
-static void * search(QofBook * book, const gchar *id, void * object, GncSearchType type)
-{
-    void *c;
-    GList *result;
-    QofQuery *q;
-    gint len;
-    QofQueryPredData* string_pred_data;
-    
+static void * search(QofBook * book, const gchar *id, GncSearchType type)
+{
+    QofIdTypeConst type_id = search_type_id (type);
+    IDIndex *index;
+    GList *objects;
+    gchar *key;
+    QofSortFunc sort;
+    void *object;
+
     PINFO("Type = %d", type);
-    g_return_val_if_fail (type, NULL);
+    g_return_val_if_fail (type_id, NULL);
     g_return_val_if_fail (id, NULL);
     g_return_val_if_fail (book, NULL);
 
-    // Build the query
-    q = qof_query_create ();
-    qof_query_set_book (q, book);
-    // Search only the id field
-    string_pred_data = qof_query_string_predicate (QOF_COMPARE_EQUAL, id, QOF_STRING_MATCH_NORMAL, FALSE);
-    if (type == CUSTOMER)
-    {
-        qof_query_search_for(q,GNC_CUSTOMER_MODULE_NAME);
-        qof_query_add_term (q, qof_query_build_param_list("CUSTOMER_ID"), string_pred_data, QOF_QUERY_AND);
-    }
-    else if (type ==  INVOICE || type ==  BILL)
-    {
-        qof_query_search_for(q,GNC_INVOICE_MODULE_NAME);
-        qof_query_add_term (q, qof_query_build_param_list("INVOICE_ID"), string_pred_data, QOF_QUERY_AND);
-    }
-    else if (type == VENDOR)
-    {
-        qof_query_search_for(q,GNC_VENDOR_MODULE_NAME);
-        qof_query_add_term (q, qof_query_build_param_list("VENDOR_ID"), string_pred_data, QOF_QUERY_AND);
-    }
-
+    index = id_index_get (book, type_id);
+    if (!index)
+        return NULL;
 
-    // Run the query
-    result = qof_query_run (q);
+    if (type == INVOICE)
+        key = g_strdup_printf ("%d:%s", GNC_INVOICE_CUST_INVOICE, id);
+    else if (type == BILL)
+        key = g_strdup_printf ("%d:%s", GNC_INVOICE_VEND_INVOICE, id);
+    else
+        key = g_strdup (id);
+    objects = g_hash_table_lookup (index->by_id, key);
+    g_free (key);
+    if (!objects)
+        return NULL;
 
-    // now compare _exactly_
-    len = g_list_length (result);
-    if (result && (len > 0))
+    /* Where several objects share the ID return the first in the
+     * type's default sort order, as a query for it would. */
+    object = objects->data;
+    sort = qof_class_get_default_sort (type_id);
+    for (GList *node = objects->next; sort && node; node = node->next)
     {
-        result = g_list_first (result);
-
-        while (result)
-        {
-            c = result->data;
-            
-            if (type == CUSTOMER && strcmp(id, gncCustomerGetID(c)) == 0)
-            {
-                // correct id found
-                object = c;
-                break;
-            }
-            else if (type == INVOICE && strcmp(id, gncInvoiceGetID(c)) == 0 
-                        && gncInvoiceGetType(c) == GNC_INVOICE_CUST_INVOICE)
-            {
-                object = c;
-                break;
-            }
-            else if (type == BILL && strcmp(id, gncInvoiceGetID(c)) == 0 
-                        && gncInvoiceGetType(c) == GNC_INVOICE_VEND_INVOICE)
-            {
-                object = c;
-                break;
-            }
-            else if (type == VENDOR && strcmp(id, gncVendorGetID(c)) == 0)
-            {
-                object = c;
-                break;
-            }
-            result = g_list_next (result);
-        }
+        if (sort (node->data, object) < 0)
+            object = node->data;
     }
-    qof_query_destroy (q);
     return object;
 }
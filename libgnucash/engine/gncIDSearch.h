@@ -30,6 +30,8 @@
 #include "gncCustomerP.h"
 //#include "gncCustomer.h"
 #include "gncInvoice.h"
+#include "gncEmployee.h"
+#include "gncJob.h"
 #include "gncBusiness.h"
 // query
 
@@ -42,5 +44,7 @@ GncCustomer * gnc_search_customer_on_id  (QofBook *book, const gchar *id);
 GncInvoice  * gnc_search_invoice_on_id   (QofBook *book, const gchar *id);
 GncInvoice  * gnc_search_bill_on_id   (QofBook *book, const gchar *id);
 GncVendor  * gnc_search_vendor_on_id   (QofBook *book, const gchar *id);
+GncEmployee * gnc_search_employee_on_id (QofBook *book, const gchar *id);
+GncJob      * gnc_search_job_on_id      (QofBook *book, const gchar *id);
 
 #endif
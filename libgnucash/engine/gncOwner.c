@@ -632,6 +632,7 @@ void gncOwnerAttachToLot (const GncOwner *owner, GNCLot *lot)
 		      GNC_OWNER_GUID, gncOwnerGetGUID (owner),
 		      NULL);
     gnc_lot_commit_edit (lot);
+    gncOwnerLotIndexUpdate (lot);
 }
 
 gboolean gncOwnerGetOwnerFromLot (GNCLot *lot, GncOwner *owner)
@@ -1468,6 +1469,303 @@ gncOwnerGetCommoditiesList (const GncOwner *owner)
     return (g_list_prepend (NULL, gncOwnerGetCurrency(owner)));
 }
 
+/*********************************************************************/
+/* Owner to open lots index                                          */
+
+/* A book keeps an index from each end owner to its open lots so that
+ * an owner's balance doesn't have to be found by searching the lots of
+ * every account in the book. Each entry also keeps the running sum of
+ * the balances that count towards the owner's balance: those of its
+ * invoice lots in accounts of the owner's types and currency. The
+ * index is built the first time a balance is asked for and is then
+ * kept up to date as lots change.
+ */
+
+#define GNC_OWNER_LOT_INDEX "gnc-owner-lot-index"
+
+typedef struct
+{
+    GncGUID guid;
+    GncOwnerType type;
+    /* The currency the balance was summed in */
+    gnc_commodity *currency;
+    gnc_numeric balance;
+    /* GNCLot* -> OwnerLot* */
+    GHashTable *lots;
+} OwnerLots;
+
+typedef struct
+{
+    OwnerLots *owner_lots;
+    gnc_numeric balance;
+    gboolean counted;
+} OwnerLot;
+
+typedef struct
+{
+    /* end owner's GncGUID* -> OwnerLots* */
+    GHashTable *owners;
+    /* GNCLot* -> OwnerLot* */
+    GHashTable *lots;
+} OwnerLotIndex;
+
+static gint owner_lot_index_event_handler_id = 0;
+
+static void
+owner_lots_free (gpointer data)
+{
+    OwnerLots *owner_lots = data;
+
+    g_hash_table_destroy (owner_lots->lots);
+    g_free (owner_lots);
+}
+
+static gboolean
+owner_lot_counts (const OwnerLots *owner_lots, GNCLot *lot)
+{
+    Account *account = gnc_lot_get_account (lot);
+    GNCAccountType type;
+
+    if (!account || !gncInvoiceGetInvoiceFromLot (lot))
+        return FALSE;
+
+    type = xaccAccountGetType (account);
+    switch (owner_lots->type)
+    {
+    case GNC_OWNER_CUSTOMER:
+        if (type != ACCT_TYPE_RECEIVABLE)
+            return FALSE;
+        break;
+    case GNC_OWNER_VENDOR:
+    case GNC_OWNER_EMPLOYEE:
+        if (type != ACCT_TYPE_PAYABLE)
+            return FALSE;
+        break;
+    default:
+        if (type != ACCT_TYPE_NONE)
+            return FALSE;
+    }
+    return gnc_commodity_equal (owner_lots->currency,
+                                xaccAccountGetCommodity (account));
+}
+
+static void
+owner_lots_adjust (OwnerLots *owner_lots, gnc_numeric amount, gboolean add)
+{
+    int fraction = gnc_commodity_get_fraction (owner_lots->currency);
+
+    if (add)
+        owner_lots->balance = gnc_numeric_add (owner_lots->balance, amount, fraction,
+                                               GNC_HOW_RND_ROUND_HALF_UP);
+    else
+        owner_lots->balance = gnc_numeric_sub (owner_lots->balance, amount, fraction,
+                                               GNC_HOW_RND_ROUND_HALF_UP);
+}
+
+static void
+owner_lot_index_remove (OwnerLotIndex *index, GNCLot *lot)
+{
+    OwnerLot *owner_lot = g_hash_table_lookup (index->lots, lot);
+
+    if (!owner_lot)
+        return;
+
+    if (owner_lot->counted)
+        owner_lots_adjust (owner_lot->owner_lots, owner_lot->balance, FALSE);
+    g_hash_table_remove (owner_lot->owner_lots->lots, lot);
+    g_hash_table_remove (index->lots, lot);
+}
+
+static void
+owner_lot_index_add (OwnerLotIndex *index, GNCLot *lot)
+{
+    OwnerLots *owner_lots;
+    OwnerLot *owner_lot;
+    GncOwner lot_owner;
+    const GncOwner *end_owner;
+    GncInvoice *invoice;
+
+    if (qof_instance_get_destroying (lot) || gnc_lot_is_closed (lot))
+        return;
+
+    /* Determine the owner associated to the lot, as
+     * gncOwnerLotMatchOwnerFunc does */
+    invoice = gncInvoiceGetInvoiceFromLot (lot);
+    if (invoice)
+        end_owner = gncOwnerGetEndOwner (gncInvoiceGetOwner (invoice));
+    else if (gncOwnerGetOwnerFromLot (lot, &lot_owner))
+        end_owner = gncOwnerGetEndOwner (&lot_owner);
+    else
+        return;
+    if (!end_owner || !gncOwnerGetGUID (end_owner))
+        return;
+
+    owner_lots = g_hash_table_lookup (index->owners, gncOwnerGetGUID (end_owner));
+    if (!owner_lots)
+    {
+        owner_lots = g_new0 (OwnerLots, 1);
+        owner_lots->guid = *gncOwnerGetGUID (end_owner);
+        owner_lots->type = gncOwnerGetType (end_owner);
+        owner_lots->currency = gncOwnerGetCurrency (end_owner);
+        owner_lots->balance = gnc_numeric_zero ();
+        owner_lots->lots = g_hash_table_new_full (NULL, NULL, NULL, g_free);
+        g_hash_table_insert (index->owners, &owner_lots->guid, owner_lots);
+    }
+
+    owner_lot = g_new0 (OwnerLot, 1);
+    owner_lot->owner_lots = owner_lots;
+    owner_lot->balance = gnc_lot_get_balance (lot);
+    owner_lot->counted = owner_lot_counts (owner_lots, lot);
+    if (owner_lot->counted)
+        owner_lots_adjust (owner_lots, owner_lot->balance, TRUE);
+    g_hash_table_insert (owner_lots->lots, lot, owner_lot);
+    g_hash_table_insert (index->lots, lot, owner_lot);
+}
+
+static void
+owner_lot_index_add_cb (QofInstance *inst, gpointer data)
+{
+    owner_lot_index_add (data, GNC_LOT (inst));
+}
+
+static void
+owner_lot_index_destroy (QofBook *book, gpointer key, gpointer data)
+{
+    OwnerLotIndex *index = data;
+
+    g_hash_table_destroy (index->lots);
+    g_hash_table_destroy (index->owners);
+    g_free (index);
+}
+
+static void
+owner_lot_index_handle_events (QofInstance *entity, QofEventId event_type,
+                               gpointer user_data, gpointer event_data)
+{
+    if (!GNC_IS_LOT (entity))
+        return;
+
+    if (event_type & QOF_EVENT_DESTROY)
+    {
+        QofBook *book = qof_instance_get_book (entity);
+        OwnerLotIndex *index;
+
+        if (!book || qof_book_shutting_down (book))
+            return;
+        index = qof_book_get_data (book, GNC_OWNER_LOT_INDEX);
+        if (index)
+            owner_lot_index_remove (index, GNC_LOT (entity));
+    }
+    else if (event_type & (QOF_EVENT_CREATE | QOF_EVENT_MODIFY))
+        gncOwnerLotIndexUpdate (GNC_LOT (entity));
+}
+
+static OwnerLotIndex *
+owner_lot_index_get (QofBook *book, gboolean create)
+{
+    OwnerLotIndex *index;
+
+    if (!book || qof_book_shutting_down (book))
+        return NULL;
+
+    index = qof_book_get_data (book, GNC_OWNER_LOT_INDEX);
+    if (index || !create)
+        return index;
+
+    ENTER ("book=%p", book);
+    if (!owner_lot_index_event_handler_id)
+        owner_lot_index_event_handler_id =
+            qof_event_register_handler (owner_lot_index_handle_events, NULL);
+
+    index = g_new0 (OwnerLotIndex, 1);
+    index->owners = g_hash_table_new_full (guid_hash_to_guint,
+                                           guid_g_hash_table_equal,
+                                           NULL, owner_lots_free);
+    index->lots = g_hash_table_new (NULL, NULL);
+    qof_collection_foreach (qof_book_get_collection (book, GNC_ID_LOT),
+                            owner_lot_index_add_cb, index);
+    qof_book_set_data_fin (book, GNC_OWNER_LOT_INDEX, index,
+                           owner_lot_index_destroy);
+    LEAVE ("%d owners", g_hash_table_size (index->owners));
+    return index;
+}
+
+void
+gncOwnerLotIndexUpdate (GNCLot *lot)
+{
+    OwnerLotIndex *index;
+
+    if (!lot) return;
+
+    index = owner_lot_index_get (qof_instance_get_book (lot), FALSE);
+    if (!index) return;
+
+    owner_lot_index_remove (index, lot);
+    owner_lot_index_add (index, lot);
+}
+
+static OwnerLots *
+owner_lot_index_lookup (const GncOwner *owner)
+{
+    OwnerLotIndex *index;
+    QofBook *book;
+
+    if (!gncOwnerGetGUID (owner))
+        return NULL;
+
+    book = qof_instance_get_book (qofOwnerGetOwner (owner));
+    index = owner_lot_index_get (book, TRUE);
+    if (!index)
+        return NULL;
+
+    return g_hash_table_lookup (index->owners, gncOwnerGetGUID (owner));
+}
+
+GList *
+gncOwnerGetOpenLots (const GncOwner *owner)
+{
+    OwnerLots *owner_lots;
+
+    g_return_val_if_fail (owner, NULL);
+
+    owner_lots = owner_lot_index_lookup (owner);
+    if (!owner_lots)
+        return NULL;
+
+    return g_list_sort (g_hash_table_get_keys (owner_lots->lots),
+                        (GCompareFunc)gncOwnerLotsSortFunc);
+}
+
+/* The sum of the balances of the owner's open invoice lots, summed
+ * again if the owner's currency changed since the lots were added. */
+static gnc_numeric
+owner_lot_index_get_balance (const GncOwner *owner)
+{
+    OwnerLots *owner_lots = owner_lot_index_lookup (owner);
+    gnc_commodity *currency = gncOwnerGetCurrency (owner);
+    GHashTableIter iter;
+    gpointer key, value;
+
+    if (!owner_lots)
+        return gnc_numeric_zero ();
+
+    if (!gnc_commodity_equal (owner_lots->currency, currency))
+    {
+        owner_lots->currency = currency;
+        owner_lots->balance = gnc_numeric_zero ();
+        g_hash_table_iter_init (&iter, owner_lots->lots);
+        while (g_hash_table_iter_next (&iter, &key, &value))
+        {
+            OwnerLot *owner_lot = value;
+
+            owner_lot->counted = owner_lot_counts (owner_lots, key);
+            if (owner_lot->counted)
+                owner_lots_adjust (owner_lots, owner_lot->balance, TRUE);
+        }
+    }
+    return owner_lots->balance;
+}
+
 /*********************************************************************/
 /* Owner balance calculation routines                                */
 
@@ -1496,43 +1794,7 @@ gncOwnerGetBalanceInCurrency (const GncOwner *owner,
     else
     {
         /* No valid cache value found for balance. Let's recalculate */
-        GList *acct_list  = gnc_account_get_descendants (gnc_book_get_root_account (book));
-        GList *acct_types = gncOwnerGetAccountTypesList (owner);
-        GList *acct_node;
-
-        /* For each account */
-        for (acct_node = acct_list; acct_node; acct_node = acct_node->next)
-        {
-            Account *account = acct_node->data;
-            GList *lot_list = NULL, *lot_node;
-
-            /* Check if this account can have lots for the owner, otherwise skip to next */
-            if (g_list_index (acct_types, (gpointer)xaccAccountGetType (account))
-                    == -1)
-                continue;
-
-
-            if (!gnc_commodity_equal (owner_currency, xaccAccountGetCommodity (account)))
-                continue;
-
-            /* Get a list of open lots for this owner and account */
-            lot_list = xaccAccountFindOpenLots (account, gncOwnerLotMatchOwnerFunc,
-                                                (gpointer)owner, NULL);
-            /* For each lot */
-            for (lot_node = lot_list; lot_node; lot_node = lot_node->next)
-            {
-                GNCLot *lot = lot_node->data;
-                gnc_numeric lot_balance = gnc_lot_get_balance (lot);
-                GncInvoice *invoice = gncInvoiceGetInvoiceFromLot(lot);
-                if (invoice)
-                balance = gnc_numeric_add (balance, lot_balance,
-                                            gnc_commodity_get_fraction (owner_currency), GNC_HOW_RND_ROUND_HALF_UP);
-            }
-            g_list_free (lot_list);
-        }
-        g_list_free (acct_list);
-        g_list_free (acct_types);
-
+        balance = owner_lot_index_get_balance (owner);
         gncOwnerSetCachedBalance (owner, &balance);
     }
 
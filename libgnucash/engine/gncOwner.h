@@ -316,6 +316,13 @@ gnc_numeric
 gncOwnerGetBalanceInCurrency (const GncOwner *owner,
                               const gnc_commodity *report_currency);
 
+/** Returns the open lots of an owner, from invoices as well as
+ *  pre-payments, sorted with gncOwnerLotsSortFunc. The owner must be
+ *  an end owner: a job has no lots of its own. The list must be freed
+ *  by the caller, but not the lots.
+ */
+GList * gncOwnerGetOpenLots (const GncOwner *owner);
+
 #define OWNER_TYPE        "type"
 #define OWNER_TYPE_STRING "type-string"  /**< Allows the type to be handled externally. */
 #define OWNER_CUSTOMER    "customer"
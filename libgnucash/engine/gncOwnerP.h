@@ -33,6 +33,9 @@
 gboolean gncOwnerRegister (void);
 const gnc_numeric *gncOwnerGetCachedBalance (const GncOwner *owner);
 void gncOwnerSetCachedBalance (const GncOwner *owner, const gnc_numeric *new_bal);
+/** Refile lot in its book's owner to open lots index, for changes to
+ *  a lot that don't generate an event. */
+void gncOwnerLotIndexUpdate (GNCLot *lot);
 
 
 #endif /* GNC_OWNERP_H_ */
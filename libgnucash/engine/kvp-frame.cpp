@@ -47,12 +47,13 @@ static const char delim = '/';
 
 KvpFrameImpl::KvpFrameImpl(const KvpFrameImpl & rhs) noexcept
 {
+    m_valuemap.reserve (rhs.m_valuemap.size ());
     std::for_each(rhs.m_valuemap.begin(), rhs.m_valuemap.end(),
         [this](const map_type::value_type & a)
         {
             auto key = static_cast<char *>(qof_string_cache_insert(a.first));
             auto val = new KvpValueImpl(*a.second);
-            this->m_valuemap.insert({key,val});
+            this->m_valuemap.emplace_back(key,val);
         }
     );
 }
@@ -68,89 +69,168 @@ KvpFrameImpl::~KvpFrameImpl() noexcept
     m_valuemap.clear();
 }
 
+KvpFrameImpl::KeyPath
+KvpFrameImpl::split_path (std::string_view path) noexcept
+{
+    KeyPath ret;
+    while (!path.empty ())
+    {
+        auto pos = path.find (delim);
+        auto key = path.substr (0, pos);
+        if (!key.empty ())
+            ret.push_back (key);
+        if (pos == std::string_view::npos)
+            break;
+        path.remove_prefix (pos + 1);
+    }
+    return ret;
+}
+
+KvpFrameImpl::KeyPath
+KvpFrameImpl::key_path (Path const & path) noexcept
+{
+    return KeyPath (path.begin (), path.end ());
+}
+
+/* Keys are interned, so a caller passing a key that came from the cache
+ * usually matches on the pointer before any characters are compared. */
+static inline int
+key_compare (const char * one, std::string_view two) noexcept
+{
+    if (one == two.data ())
+        return 0;
+    return std::string_view {one}.compare (two);
+}
+
+KvpFrameImpl::map_type::iterator
+KvpFrameImpl::find_slot (std::string_view key) noexcept
+{
+    auto spot = std::lower_bound (m_valuemap.begin (), m_valuemap.end (), key,
+                                  [](const map_type::value_type & a,
+                                     std::string_view k)
+                                  { return key_compare (a.first, k) < 0; });
+    if (spot != m_valuemap.end () && key_compare (spot->first, key) == 0)
+        return spot;
+    return m_valuemap.end ();
+}
+
+KvpFrameImpl::map_type::const_iterator
+KvpFrameImpl::find_slot (std::string_view key) const noexcept
+{
+    return const_cast<KvpFrameImpl*>(this)->find_slot (key);
+}
+
 KvpFrame *
-KvpFrame::get_child_frame_or_nullptr (Path const & path) noexcept
+KvpFrame::get_child_frame_or_nullptr (KeyPath::const_iterator first,
+                                      KeyPath::const_iterator last) noexcept
 {
-    if (!path.size ())
-        return this;
-    auto key = path.front ();
-    if (m_valuemap.find (key.c_str ()) == m_valuemap.end ())
-        return nullptr;
-    auto child = m_valuemap.at (key.c_str ())->get <KvpFrame *> ();
-    Path send;
-    std::copy (path.begin () + 1, path.end (), std::back_inserter (send));
-    return child->get_child_frame_or_nullptr (send);
+    auto frame = this;
+    for (; first != last; ++first)
+    {
+        auto spot = frame->find_slot (*first);
+        if (spot == frame->m_valuemap.end ())
+            return nullptr;
+        frame = spot->second->get <KvpFrame *> ();
+        if (!frame)
+            return nullptr;
+    }
+    return frame;
 }
 
 KvpFrame *
-KvpFrame::get_child_frame_or_create (Path const & path) noexcept
+KvpFrame::get_child_frame_or_create (KeyPath::const_iterator first,
+                                     KeyPath::const_iterator last) noexcept
 {
-    if (!path.size ())
-        return this;
-    auto key = path.front ();
-    auto spot = m_valuemap.find (key.c_str ());
-    if (spot == m_valuemap.end () || spot->second->get_type () != KvpValue::Type::FRAME)
-        delete set_impl (key.c_str (), new KvpValue {new KvpFrame});
-    Path send;
-    std::copy (path.begin () + 1, path.end (), std::back_inserter (send));
-    auto child_val = m_valuemap.at (key.c_str ());
-    auto child = child_val->get <KvpFrame *> ();
-    return child->get_child_frame_or_create (send);
+    auto frame = this;
+    for (; first != last; ++first)
+    {
+        auto spot = frame->find_slot (*first);
+        if (spot == frame->m_valuemap.end () || spot->second->get_type () != KvpValue::Type::FRAME)
+        {
+            auto child = new KvpFrame;
+            delete frame->set_impl (*first, new KvpValue {child});
+            frame = child;
+        }
+        else
+            frame = spot->second->get <KvpFrame *> ();
+    }
+    return frame;
 }
 
 
 KvpValue *
-KvpFrame::set_impl (std::string const & key, KvpValue * value) noexcept
+KvpFrame::set_impl (std::string_view key, KvpValue * value) noexcept
 {
     KvpValue * ret {};
-    auto spot = m_valuemap.find (key.c_str ());
-    if (spot != m_valuemap.end ())
+    auto spot = std::lower_bound (m_valuemap.begin (), m_valuemap.end (), key,
+                                  [](const map_type::value_type & a,
+                                     std::string_view k)
+                                  { return key_compare (a.first, k) < 0; });
+    auto found = spot != m_valuemap.end () && key_compare (spot->first, key) == 0;
+    if (found)
     {
-        qof_string_cache_remove (spot->first);
         ret = spot->second;
+        if (value)
+        {
+            spot->second = value;
+            return ret;
+        }
+        qof_string_cache_remove (spot->first);
         m_valuemap.erase (spot);
     }
-    if (value)
+    else if (value)
     {
-        auto cachedkey = static_cast <char const *> (qof_string_cache_insert (key.c_str ()));
-        m_valuemap.emplace (cachedkey, value);
+        std::string keystr {key};
+        auto cachedkey = static_cast <char const *> (qof_string_cache_insert (keystr.c_str ()));
+        m_valuemap.emplace (spot, cachedkey, value);
     }
     return ret;
 }
 
 KvpValue *
-KvpFrameImpl::set (Path path, KvpValue* value) noexcept
+KvpFrameImpl::set (Path const & path, KvpValue* value) noexcept
 {
     if (path.empty())
         return nullptr;
-    auto key = path.back ();
-    path.pop_back ();
-    auto target = get_child_frame_or_nullptr (path);
+    auto keys = key_path (path);
+    auto target = get_child_frame_or_nullptr (keys.cbegin (), keys.cend () - 1);
     if (!target)
         return nullptr;
-    return target->set_impl (key, value);
+    return target->set_impl (keys.back (), value);
 }
 
 KvpValue *
-KvpFrameImpl::set_path (Path path, KvpValue* value) noexcept
+KvpFrameImpl::set_path (Path const & path, KvpValue* value) noexcept
 {
-    auto key = path.back();
-    path.pop_back();
-    auto target = get_child_frame_or_create (path);
+    return set_path_impl (key_path (path), value);
+}
+
+KvpValue *
+KvpFrameImpl::set_path_impl (KeyPath const & keys, KvpValue* value) noexcept
+{
+    if (keys.empty ())
+        return nullptr;
+    auto target = get_child_frame_or_create (keys.cbegin (), keys.cend () - 1);
     if (!target)
         return nullptr;
-    return target->set_impl (key, value);
+    return target->set_impl (keys.back (), value);
 }
 
 KvpValue *
-KvpFrameImpl::get_slot (Path path) noexcept
+KvpFrameImpl::get_slot (Path const & path) noexcept
 {
-    auto key = path.back();
-    path.pop_back();
-    auto target = get_child_frame_or_nullptr (path);
+    return get_slot_impl (key_path (path));
+}
+
+KvpValue *
+KvpFrameImpl::get_slot_impl (KeyPath const & keys) noexcept
+{
+    if (keys.empty ())
+        return nullptr;
+    auto target = get_child_frame_or_nullptr (keys.cbegin (), keys.cend () - 1);
     if (!target)
         return nullptr;
-    auto spot = target->m_valuemap.find (key.c_str ());
+    auto spot = target->find_slot (keys.back ());
     if (spot != target->m_valuemap.end ())
         return spot->second;
     return nullptr;
@@ -218,7 +298,7 @@ int compare(const KvpFrameImpl & one, const KvpFrameImpl & two) noexcept
 {
     for (const auto & a : one.m_valuemap)
     {
-        auto otherspot = two.m_valuemap.find(a.first);
+        auto otherspot = two.find_slot(a.first);
         if (otherspot == two.m_valuemap.end())
         {
             return 1;
@@ -85,8 +85,12 @@
 #define GNC_KVP_FRAME_TYPE
 
 #include "kvp-value.hpp"
-#include <map>
+#include "qof-arena.hpp"
+#include <boost/container/small_vector.hpp>
 #include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
 #include <vector>
 #include <cstring>
 #include <algorithm>
@@ -108,17 +112,19 @@ using KvpEntry = std::pair <std::vector <std::string>, KvpValue*>;
  */
 struct KvpFrameImpl
 {
-    class cstring_comparer
-    {
-    public:
-	/* Returns true if one is less than two. */
-	bool operator()(const char * one, const char * two) const
-	    {
-		auto ret = std::strcmp(one, two) < 0;
-		return ret;
-	    }
-    };
-    using map_type = std::map<const char *, KvpValue*, cstring_comparer>;
+    /* Most frames hold only a handful of slots, so they're kept in a
+     * vector sorted by key with room for the first few inside the frame
+     * itself. The keys are interned in the QOF string cache.
+     *
+     * Unlike the std::map this replaced, adding or removing a slot moves
+     * the other slots, invalidating every iterator and reference into
+     * m_valuemap. The KvpValues and child frames are separate
+     * allocations, so pointers to them stay valid until their own slot is
+     * replaced or removed: hold those, never a find_slot iterator, across
+     * set_impl. */
+    static constexpr std::size_t inline_slots = 2;
+    using map_type = boost::container::small_vector<std::pair<const char *, KvpValue*>,
+                                                   inline_slots>;
 
     public:
     KvpFrameImpl() noexcept {};
@@ -133,6 +139,13 @@ struct KvpFrameImpl
      */
     ~KvpFrameImpl() noexcept;
 
+    /**
+     * Frames created while a book is loading come from the book's arena,
+     * see qof-arena.hpp.
+     */
+    static void* operator new(std::size_t size) { return qof_arena_operator_new(size); }
+    static void operator delete(void* ptr) noexcept { qof_arena_operator_delete(ptr); }
+
     /**
      * Set the value with the key in the immediate frame, replacing and
      * returning the old value if it exists or nullptr if it doesn't. Takes
@@ -156,7 +169,7 @@ struct KvpFrameImpl
      * @param newvalue: The value to set at key.
      * @return The old value if there was one or nullptr.
      */
-    KvpValue* set(Path path, KvpValue* newvalue) noexcept;
+    KvpValue* set(Path const & path, KvpValue* newvalue) noexcept;
      /**
      * Set the value with the key in a subframe following the keys in path,
      * replacing and returning the old value if it exists or nullptr if it
@@ -168,7 +181,18 @@ struct KvpFrameImpl
      * @param newvalue: The value to set at key.
      * @return The old value if there was one or nullptr.
      */
-    KvpValue* set_path(Path path, KvpValue* newvalue) noexcept;
+    KvpValue* set_path(Path const & path, KvpValue* newvalue) noexcept;
+    /**
+     * As set_path, with the path given as a '/'-delimited string. Empty
+     * keys are skipped.
+     */
+    template <typename T, std::enable_if_t<std::is_convertible_v<T const &,
+                                                                 std::string_view>,
+                                           int> = 0>
+    KvpValue* set_path(T const & path, KvpValue* newvalue) noexcept
+    {
+        return set_path_impl (split_path (path), newvalue);
+    }
     /**
      * Make a string representation of the frame. Mostly useful for debugging.
      * @return A std::string representing the frame and all its children.
@@ -191,11 +215,23 @@ struct KvpFrameImpl
      * @param path: Path of keys leading to the desired value.
      * @return The value at the key or nullptr.
      */
-    KvpValue* get_slot(Path keys) noexcept;
+    KvpValue* get_slot(Path const & keys) noexcept;
+    /** As get_slot, with the path given as a '/'-delimited string. Empty
+     * keys are skipped.
+     */
+    template <typename T, std::enable_if_t<std::is_convertible_v<T const &,
+                                                                 std::string_view>,
+                                           int> = 0>
+    KvpValue* get_slot(T const & path) noexcept
+    {
+        return get_slot_impl (split_path (path));
+    }
 
     /** The function should be of the form:
      * <anything> func (char const *, KvpValue *, data_type &);
-     * Do not pass nullptr as the function.
+     * Do not pass nullptr as the function. The function must not add
+     * or remove slots in this frame; collect the keys and change them
+     * after the iteration instead.
      */
     template <typename func_type, typename data_type>
     void for_each_slot_temp(func_type const &, data_type &) const noexcept;
@@ -205,7 +241,8 @@ struct KvpFrameImpl
 
     /**
      * Like for_each_slot, but doesn't traverse nested values. This will only loop
-     * over root-level values whose keys match the specified prefix.
+     * over root-level values whose keys match the specified prefix. The same
+     * restriction on changing the frame applies.
      */
     template <typename func_type, typename data_type>
     void for_each_slot_prefix(std::string const & prefix, func_type const &, data_type &) const noexcept;
@@ -229,10 +266,20 @@ struct KvpFrameImpl
     private:
     map_type m_valuemap;
 
-    KvpFrame * get_child_frame_or_nullptr (Path const &) noexcept;
-    KvpFrame * get_child_frame_or_create (Path const &) noexcept;
+    using KeyPath = boost::container::small_vector<std::string_view, 8>;
+    static KeyPath split_path (std::string_view) noexcept;
+    static KeyPath key_path (Path const &) noexcept;
+
+    map_type::iterator find_slot (std::string_view) noexcept;
+    map_type::const_iterator find_slot (std::string_view) const noexcept;
+    KvpFrame * get_child_frame_or_nullptr (KeyPath::const_iterator,
+                                           KeyPath::const_iterator) noexcept;
+    KvpFrame * get_child_frame_or_create (KeyPath::const_iterator,
+                                          KeyPath::const_iterator) noexcept;
+    KvpValue * get_slot_impl (KeyPath const &) noexcept;
+    KvpValue * set_path_impl (KeyPath const &, KvpValue *) noexcept;
     void flatten_kvp_impl(std::vector <std::string>, std::vector <KvpEntry> &) const noexcept;
-    KvpValue * set_impl (std::string const &, KvpValue *) noexcept;
+    KvpValue * set_impl (std::string_view, KvpValue *) noexcept;
 };
 
 template<typename func_type, typename data_type>
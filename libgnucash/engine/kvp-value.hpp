@@ -34,6 +34,7 @@ extern "C"
 #include <boost/type_traits/is_nothrow_move_assignable.hpp>
 #endif
 #include <boost/variant.hpp>
+#include "qof-arena.hpp"
 
 //Must be a struct because it's exposed to C so that it can in turn be
 //translated to/from Scheme.
@@ -106,6 +107,13 @@ struct KvpValueImpl
      */
     ~KvpValueImpl() noexcept;
 
+    /**
+     * Values created while a book is loading come from the book's arena,
+     * see qof-arena.hpp.
+     */
+    static void* operator new(std::size_t size) { return qof_arena_operator_new(size); }
+    static void operator delete(void* ptr) noexcept { qof_arena_operator_delete(ptr); }
+
     /**
      * Replaces the frame within this KvpValueImpl.
      *
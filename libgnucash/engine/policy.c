@@ -138,11 +138,12 @@ DirectionPolicyGetSplit (GNCPolicy *pcy, GNCLot *lot, short reverse)
     otrans = osplit ? xaccSplitGetParent (osplit) : 0;
     open_time = xaccTransRetDatePosted (otrans);
 
-    /* Walk over *all* splits in the account, till we find one that
-     * hasn't been assigned to a lot.  Return that split.
+    /* Walk over the splits in the account from open_time on, till we
+     * find one that hasn't been assigned to a lot.  Return that split.
      * Make use of the fact that the splits in an account are
-     * already in date order; so we don't have to sort. */
-    node = xaccAccountGetSplitList (lot_account);
+     * already in date order; so we don't have to sort, and earlier
+     * splits needn't be loaded. */
+    node = xaccAccountGetSplitListSince (lot_account, open_time);
     if (reverse)
     {
         node = g_list_last (node);
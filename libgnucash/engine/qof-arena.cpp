@@ -0,0 +1,148 @@
+/********************************************************************\
+ * qof-arena.cpp -- Bulk allocation of engine objects               *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ *                                                                  *
+\********************************************************************/
+
+#include "qof-arena.hpp"
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <new>
+
+static constexpr std::size_t alignment = alignof(std::max_align_t);
+
+static thread_local QofArena* s_current = nullptr;
+
+/* The address ranges of the chunks of every live arena, by start
+ * address, so that qof_arena_operator_delete can tell where an object
+ * came from without storing anything next to it. Arenas may be created
+ * and destroyed in any thread. */
+static std::mutex s_chunks_mutex;
+static std::map<const char*, const char*> s_chunks;
+static std::atomic<std::size_t> s_num_chunks{0};
+
+static bool
+in_arena_chunk(const void* ptr) noexcept
+{
+    /* An object from an arena keeps the arena alive, so with no chunks
+     * left ptr can only have come from the free store. */
+    if (s_num_chunks.load(std::memory_order_acquire) == 0)
+        return false;
+
+    auto addr = static_cast<const char*>(ptr);
+    std::lock_guard<std::mutex> lock{s_chunks_mutex};
+    auto chunk = s_chunks.upper_bound(addr);
+    if (chunk == s_chunks.begin())
+        return false;
+    --chunk;
+    return addr < chunk->second;
+}
+
+QofArena::QofArena(std::size_t chunk_size) :
+    m_chunk_size{chunk_size}
+{
+}
+
+QofArena::~QofArena()
+{
+    {
+        std::lock_guard<std::mutex> lock{s_chunks_mutex};
+        for (auto chunk : m_chunks)
+            s_chunks.erase(chunk);
+        s_num_chunks.store(s_chunks.size(), std::memory_order_release);
+    }
+    for (auto chunk : m_chunks)
+        ::operator delete(chunk);
+}
+
+char*
+QofArena::new_chunk(std::size_t size)
+{
+    auto chunk = static_cast<char*>(::operator new(size));
+    m_chunks.push_back(chunk);
+    {
+        std::lock_guard<std::mutex> lock{s_chunks_mutex};
+        s_chunks.emplace(chunk, chunk + size);
+        s_num_chunks.store(s_chunks.size(), std::memory_order_release);
+    }
+    m_reserved += size;
+    return chunk;
+}
+
+void*
+QofArena::allocate(std::size_t size)
+{
+    size = (size + alignment - 1) & ~(alignment - 1);
+    ++m_allocations;
+    m_used += size;
+
+    /* Big requests get a chunk of their own so as not to waste the
+     * rest of the current one. */
+    if (size > m_chunk_size / 4)
+        return new_chunk(size);
+
+    if (static_cast<std::size_t>(m_end - m_next) < size)
+    {
+        m_next = new_chunk(m_chunk_size);
+        m_end = m_next + m_chunk_size;
+    }
+
+    auto retval = m_next;
+    m_next += size;
+    return retval;
+}
+
+QofArena*
+QofArena::current() noexcept
+{
+    return s_current;
+}
+
+QofArena::Scope::Scope(QofArena* arena) noexcept :
+    m_prev{s_current}
+{
+    s_current = arena;
+}
+
+QofArena::Scope::~Scope()
+{
+    s_current = m_prev;
+}
+
+void*
+qof_arena_operator_new(std::size_t size)
+{
+    auto arena = QofArena::current();
+    return arena ? arena->allocate(size) : ::operator new(size);
+}
+
+void
+qof_arena_operator_delete(void* ptr) noexcept
+{
+    if (ptr && !in_arena_chunk(ptr))
+        ::operator delete(ptr);
+}
+
+bool
+qof_arena_allocated(const void* ptr) noexcept
+{
+    return ptr && in_arena_chunk(ptr);
+}
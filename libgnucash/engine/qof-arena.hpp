@@ -0,0 +1,111 @@
+/********************************************************************\
+ * qof-arena.hpp -- Bulk allocation of engine objects               *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ *                                                                  *
+\********************************************************************/
+/** @addtogroup Object
+ * @{
+ * @file qof-arena.hpp
+ * @brief Bump allocator for engine objects created while loading a book.
+ *
+ * An initial load creates millions of small objects, KVP frames and
+ * values among them, most of which live exactly as long as the book. A
+ * QofArena carves them out of large chunks and gives all of the memory
+ * back at once when it is destroyed, which happens when the book is
+ * finalized, after all of its objects are gone. Deleting an object that
+ * came from an arena is a no-op; its memory is reclaimed with the arena.
+ *
+ * Classes opt in by routing their operator new and operator delete to
+ * qof_arena_operator_new() and qof_arena_operator_delete(), which use
+ * the arena made current with a QofArena::Scope, or the free store when
+ * there is none. Nothing is stored with the objects: deleting one looks
+ * its address up in the chunks of the live arenas, which is skipped
+ * while there are none.
+ */
+
+#ifndef QOF_ARENA_HPP
+#define QOF_ARENA_HPP
+
+#include <cstddef>
+#include <vector>
+
+class QofArena
+{
+public:
+    static constexpr std::size_t default_chunk_size = 256 * 1024;
+
+    explicit QofArena(std::size_t chunk_size = default_chunk_size);
+    QofArena(const QofArena&) = delete;
+    QofArena& operator=(const QofArena&) = delete;
+    /** Releases all memory handed out by the arena. */
+    ~QofArena();
+
+    /** Return size bytes, suitably aligned for any type. Throws
+     * std::bad_alloc if no more memory can be obtained. */
+    void* allocate(std::size_t size);
+
+    /** @return The number of allocations made from the arena. */
+    std::size_t allocations() const noexcept { return m_allocations; }
+    /** @return The number of bytes handed out. */
+    std::size_t bytes_used() const noexcept { return m_used; }
+    /** @return The number of bytes obtained from the system. */
+    std::size_t bytes_reserved() const noexcept { return m_reserved; }
+
+    /** @return The arena new objects are allocated from in this thread,
+     * or nullptr. */
+    static QofArena* current() noexcept;
+
+    /** Make an arena current for the lifetime of the Scope. Scopes
+     * nest; a nullptr arena suspends arena allocation. */
+    class Scope
+    {
+    public:
+        explicit Scope(QofArena* arena) noexcept;
+        ~Scope();
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    private:
+        QofArena* m_prev;
+    };
+
+private:
+    char* new_chunk(std::size_t size);
+
+    std::vector<char*> m_chunks;
+    char* m_next = nullptr;
+    char* m_end = nullptr;
+    std::size_t m_chunk_size;
+    std::size_t m_allocations = 0;
+    std::size_t m_used = 0;
+    std::size_t m_reserved = 0;
+};
+
+/** Allocate from the current arena, or from the free store if none. */
+void* qof_arena_operator_new(std::size_t size);
+
+/** Free ptr, returned by qof_arena_operator_new(), unless it came from
+ * an arena. */
+void qof_arena_operator_delete(void* ptr) noexcept;
+
+/** @return Whether ptr, returned by qof_arena_operator_new(), came from
+ * an arena. */
+bool qof_arena_allocated(const void* ptr) noexcept;
+
+/** @} */
+#endif //QOF_ARENA_HPP
@@ -169,6 +169,13 @@ qof_backend_rollback_instance (QofBackend* qof_be, QofInstance* inst)
     ((QofBackend*)qof_be)->rollback(inst);
 }
 
+void
+qof_backend_load_for_query (QofBackend* qof_be, QofBook* book, QofQuery* query)
+{
+    if (qof_be == nullptr || query == nullptr) return;
+    qof_be->load_for_query(book, query);
+}
+
 gboolean
 qof_load_backend_library (const char *directory, const char* module_name)
 {
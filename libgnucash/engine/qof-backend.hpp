@@ -212,6 +212,13 @@ public:
  *    better to wait for the query).
  */
     virtual void load (QofBook*, QofBackendLoadType) = 0;
+/**
+ *    Called before a query is run on a book. A backend which didn't load
+ *    everything in load() should load any objects that the query might
+ *    match; the query itself is then run against the objects in the book as
+ *    usual. The default does nothing.
+ */
+    virtual void load_for_query (QofBook*, QofQuery*) {}
 /**
  *    Called when the engine is about to make a change to a data structure. It
  *    could provide an advisory lock on data, but no backend does this.
@@ -37,46 +37,273 @@ extern "C"
 #include "qof.h"
 }
 
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <limits>
+#include <mutex>
+#include <vector>
+
 /* Uncomment if you need to log anything.
 static QofLogModule log_module = QOF_MOD_UTIL;
 */
 /* =================================================================== */
 /* The QOF string cache                                                */
 /*                                                                     */
-/* The cache is a GHashTable where a copy of the string is the key,    */
-/* and a ref count is the value                                        */
+/* The cache is split into shards selected by the string's hash, each  */
+/* protected by its own mutex.  Every cached string lives in a single  */
+/* allocation that carries its hash, length and refcount in front of   */
+/* the characters; the shard is an open-addressed table of pointers to */
+/* those entries, so a unique string costs exactly one allocation.     */
+/* Searches that ignore case attach the string's casefolded form to    */
+/* its entry the first time they see it.                               */
 /* =================================================================== */
 
-static GHashTable* qof_string_cache = NULL;
+namespace
+{
+
+struct CacheEntry
+{
+    guint hash;
+    guint32 refcount;
+    gsize length;
+    char* folded;               /* qof_utf8_casefold_normalize (str) or NULL */
+    char str[1];
+};
+
+inline void
+free_entry (CacheEntry* entry)
+{
+    g_free (entry->folded);
+    g_free (entry);
+}
+
+/* Refcount value marking a string interned while the cache was in
+ * immortal mode; such strings are never counted and never removed
+ * before qof_string_cache_destroy. */
+constexpr guint32 immortal_refcount = std::numeric_limits<guint32>::max();
+constexpr std::size_t num_shards = 16;
+constexpr std::size_t initial_slots = 256;
+
+/* Marks a slot whose entry was removed so that probing continues past it. */
+char tombstone_marker;
+CacheEntry* const tombstone = reinterpret_cast<CacheEntry*>(&tombstone_marker);
+
+inline guint
+string_hash (const char* str, gsize* length)
+{
+    /* The same djb2 variant as g_str_hash, also measuring the string. */
+    guint32 h = 5381;
+    const char* p = str;
+    for (; *p; ++p)
+        h = (h << 5) + h + static_cast<unsigned char>(*p);
+    *length = p - str;
+    /* djb2 leaves the high bits of short strings nearly constant, so
+     * spread every input bit over the whole word with the murmur3
+     * finalizer before they pick a shard. */
+    h ^= h >> 16;
+    h *= 0x85ebca6bU;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35U;
+    h ^= h >> 16;
+    return h;
+}
+
+class CacheShard
+{
+public:
+    char* insert (const char* key, guint hash, gsize length, bool immortal);
+    void remove (const char* key, guint hash, gsize length);
+    const char* casefold (const char* key, guint hash, gsize length);
+    void clear ();
+    void add_stats (QofStringCacheStats* stats);
+
+private:
+    std::size_t find_slot (const char* key, guint hash, gsize length) const;
+    void grow ();
+
+    std::mutex m_mutex;
+    std::vector<CacheEntry*> m_slots;
+    std::size_t m_used = 0;       /* live entries */
+    std::size_t m_filled = 0;     /* live entries + tombstones */
+    guint64 m_inserts = 0;
+    guint64 m_hits = 0;
+    guint64 m_bytes_saved = 0;
+    gsize m_bytes_stored = 0;
+    gsize m_immortal = 0;
+};
 
-static GHashTable*
-qof_get_string_cache(void)
+std::size_t
+CacheShard::find_slot (const char* key, guint hash, gsize length) const
 {
-    if (!qof_string_cache)
+    auto mask = m_slots.size() - 1;
+    auto first_free = m_slots.size();
+    for (auto i = static_cast<std::size_t>(hash) & mask; ; i = (i + 1) & mask)
     {
-        qof_string_cache = g_hash_table_new_full(
-                               g_str_hash,               /* hash_func          */
-                               g_str_equal,              /* key_equal_func     */
-                               g_free,                   /* key_destroy_func   */
-                               g_free);                  /* value_destroy_func */
+        auto entry = m_slots[i];
+        if (!entry)
+            return first_free < m_slots.size() ? first_free : i;
+        if (entry == tombstone)
+        {
+            if (first_free == m_slots.size())
+                first_free = i;
+            continue;
+        }
+        if (entry->hash == hash && entry->length == length &&
+            memcmp (entry->str, key, length) == 0)
+            return i;
     }
-    return qof_string_cache;
 }
 
+void
+CacheShard::grow ()
+{
+    std::vector<CacheEntry*> old;
+    old.swap (m_slots);
+    auto size = old.empty() ? initial_slots : old.size();
+    /* Only double when the table is really full of live entries; a table
+     * clogged with tombstones is just rebuilt at the same size. */
+    if (m_used * 4 >= size)
+        size *= 2;
+    m_slots.assign (size, nullptr);
+    auto mask = size - 1;
+    for (auto entry : old)
+    {
+        if (!entry || entry == tombstone)
+            continue;
+        auto i = static_cast<std::size_t>(entry->hash) & mask;
+        while (m_slots[i])
+            i = (i + 1) & mask;
+        m_slots[i] = entry;
+    }
+    m_filled = m_used;
+}
+
+char*
+CacheShard::insert (const char* key, guint hash, gsize length, bool immortal)
+{
+    std::lock_guard<std::mutex> lock {m_mutex};
+    ++m_inserts;
+    if ((m_filled + 1) * 2 > m_slots.size())
+        grow ();
+    auto slot = find_slot (key, hash, length);
+    auto entry = m_slots[slot];
+    if (entry && entry != tombstone)
+    {
+        ++m_hits;
+        m_bytes_saved += length + 1;
+        if (entry->refcount != immortal_refcount)
+        {
+            if (immortal)
+            {
+                entry->refcount = immortal_refcount;
+                ++m_immortal;
+            }
+            else
+                ++entry->refcount;
+        }
+        return entry->str;
+    }
+
+    entry = static_cast<CacheEntry*>(g_malloc (offsetof(CacheEntry, str) +
+                                               length + 1));
+    entry->hash = hash;
+    entry->length = length;
+    entry->refcount = immortal ? immortal_refcount : 1;
+    entry->folded = nullptr;
+    memcpy (entry->str, key, length + 1);
+    if (!m_slots[slot])
+        ++m_filled;
+    m_slots[slot] = entry;
+    ++m_used;
+    m_bytes_stored += length + 1;
+    if (immortal)
+        ++m_immortal;
+    return entry->str;
+}
+
+void
+CacheShard::remove (const char* key, guint hash, gsize length)
+{
+    std::lock_guard<std::mutex> lock {m_mutex};
+    if (m_slots.empty())
+        return;
+    auto slot = find_slot (key, hash, length);
+    auto entry = m_slots[slot];
+    if (!entry || entry == tombstone || entry->refcount == immortal_refcount)
+        return;
+    if (--entry->refcount > 0)
+        return;
+    m_slots[slot] = tombstone;
+    --m_used;
+    m_bytes_stored -= length + 1;
+    free_entry (entry);
+}
+
+const char*
+CacheShard::casefold (const char* key, guint hash, gsize length)
+{
+    std::lock_guard<std::mutex> lock {m_mutex};
+    if (m_slots.empty())
+        return nullptr;
+    auto entry = m_slots[find_slot (key, hash, length)];
+    /* Only the cached copy itself has a folded form: an equal string
+     * elsewhere may be freed or changed behind the cache's back. */
+    if (!entry || entry == tombstone || entry->str != key)
+        return nullptr;
+    if (!entry->folded)
+        entry->folded = qof_utf8_casefold_normalize (entry->str);
+    return entry->folded;
+}
+
+void
+CacheShard::clear ()
+{
+    std::lock_guard<std::mutex> lock {m_mutex};
+    for (auto entry : m_slots)
+        if (entry && entry != tombstone)
+            free_entry (entry);
+    std::vector<CacheEntry*>().swap (m_slots);
+    m_used = m_filled = 0;
+    m_inserts = m_hits = m_bytes_saved = 0;
+    m_bytes_stored = m_immortal = 0;
+}
+
+void
+CacheShard::add_stats (QofStringCacheStats* stats)
+{
+    std::lock_guard<std::mutex> lock {m_mutex};
+    stats->inserts += m_inserts;
+    stats->hits += m_hits;
+    stats->bytes_saved += m_bytes_saved;
+    stats->strings += m_used;
+    stats->immortal_strings += m_immortal;
+    stats->bytes_stored += m_bytes_stored;
+}
+
+std::array<CacheShard, num_shards> qof_string_cache;
+std::atomic<int> qof_string_cache_immortal_depth {0};
+
+inline CacheShard&
+shard_for (guint hash)
+{
+    /* The low bits index the slots inside the shard, so pick the shard
+     * from the high bits. */
+    return qof_string_cache[(hash >> 28) % num_shards];
+}
+
+} // anonymous namespace
+
 void
 qof_string_cache_init(void)
 {
-    (void)qof_get_string_cache();
 }
 
 void
 qof_string_cache_destroy (void)
 {
-    if (qof_string_cache)
-    {
-        g_hash_table_destroy(qof_string_cache);
-    }
-    qof_string_cache = NULL;
+    for (auto& shard : qof_string_cache)
+        shard.clear ();
 }
 
 /* If the key exists in the cache, check the refcount.  If 1, just
@@ -86,21 +313,9 @@ qof_string_cache_remove(const char * key)
 {
     if (key)
     {
-        GHashTable* cache = qof_get_string_cache();
-        gpointer value;
-        gpointer cache_key;
-        if (g_hash_table_lookup_extended(cache, key, &cache_key, &value))
-        {
-            guint* refcount = (guint*)value;
-            if (*refcount == 1)
-            {
-                g_hash_table_remove(cache, key);
-            }
-            else
-            {
-                --(*refcount);
-            }
-        }
+        gsize length;
+        auto hash = string_hash (key, &length);
+        shard_for (hash).remove (key, hash, length);
     }
 }
 
@@ -111,27 +326,51 @@ qof_string_cache_insert(const char * key)
 {
     if (key)
     {
-        GHashTable* cache = qof_get_string_cache();
-        gpointer value;
-        gpointer cache_key;
-        if (g_hash_table_lookup_extended(cache, key, &cache_key, &value))
-        {
-            guint* refcount = (guint*)value;
-            ++(*refcount);
-            return static_cast <char *> (cache_key);
-        }
-        else
-        {
-            gpointer new_key = g_strdup(static_cast<const char*>(key));
-            guint* refcount = static_cast<unsigned int*>(g_malloc(sizeof(guint)));
-            *refcount = 1;
-            g_hash_table_insert(cache, new_key, refcount);
-            return static_cast <char *> (new_key);
-        }
+        gsize length;
+        auto hash = string_hash (key, &length);
+        auto immortal = qof_string_cache_immortal_depth.load (std::memory_order_relaxed) > 0;
+        return shard_for (hash).insert (key, hash, length, immortal);
     }
     return NULL;
 }
 
+const char *
+qof_string_cache_casefold (const char * str)
+{
+    if (!str)
+        return NULL;
+    if (!*str)
+        return "";
+    gsize length;
+    auto hash = string_hash (str, &length);
+    return shard_for (hash).casefold (str, hash, length);
+}
+
+void
+qof_string_cache_begin_immortal (void)
+{
+    ++qof_string_cache_immortal_depth;
+}
+
+void
+qof_string_cache_end_immortal (void)
+{
+    if (qof_string_cache_immortal_depth.fetch_sub (1) <= 0)
+    {
+        ++qof_string_cache_immortal_depth;
+        g_warning ("qof_string_cache_end_immortal called without a matching begin");
+    }
+}
+
+void
+qof_string_cache_get_stats (QofStringCacheStats *stats)
+{
+    g_return_if_fail (stats);
+    memset (stats, 0, sizeof (*stats));
+    for (auto& shard : qof_string_cache)
+        shard.add_stats (stats);
+}
+
 char *
 qof_string_cache_replace(char const * dst, char const * src)
 {
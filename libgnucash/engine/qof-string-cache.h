@@ -33,6 +33,8 @@
 #ifndef QOF_STRING_UTIL_H
 #define QOF_STRING_UTIL_H
 
+#include <glib.h>
+
 #ifdef __cplusplus
 extern "C"
 {
@@ -66,7 +68,9 @@ extern "C"
  * Note that all the work is done when inserting or removing.  Once
  * cached the strings are just plain C strings.
  *
- * The string cache is demand-created on first use.
+ * The string cache is demand-created on first use. It is safe to use
+ * from several threads at once: the strings are spread over a number
+ * of independently locked shards by their hash.
  *
  **/
 
@@ -86,6 +90,50 @@ void qof_string_cache_remove(const char * key);
 */
 char * qof_string_cache_insert(const char * key);
 
+/** Get the casefolded and normalized form of a cached string, as
+ * qof_utf8_casefold_normalize() returns it, for comparisons that ignore
+ * case. The form is computed the first time it's asked for and kept
+ * with the string, so it stays valid as long as the string does.
+ *
+ * @param str A string returned by qof_string_cache_insert().
+ * @return The folded form, or NULL if str isn't a string from the
+ * cache. "" is returned for any empty string.
+ */
+const char * qof_string_cache_casefold(const char * str);
+
+/** Begin a bulk-insert section, such as loading a book.  Until the
+ * matching qof_string_cache_end_immortal(), newly inserted strings (and
+ * existing ones inserted again) are made immortal: they are not
+ * refcounted, qof_string_cache_remove() ignores them, and they are only
+ * freed by qof_string_cache_destroy().  This trades holding on to
+ * strings that are later released for skipping the refcount bookkeeping.
+ * Calls may be nested. The section is process wide, so it also covers
+ * strings other threads insert meanwhile; use it only for data that
+ * lives until the cache is destroyed, not for a book that may be closed.
+ */
+void qof_string_cache_begin_immortal(void);
+
+/** End a section started with qof_string_cache_begin_immortal(). */
+void qof_string_cache_end_immortal(void);
+
+/** Counters describing the effectiveness of the string cache. */
+typedef struct
+{
+    guint64 inserts;          /**< Calls to qof_string_cache_insert() */
+    guint64 hits;             /**< Inserts that found the string cached */
+    guint64 bytes_saved;      /**< Bytes not duplicated thanks to hits */
+    gsize strings;            /**< Distinct strings currently cached */
+    gsize immortal_strings;   /**< Strings pinned by immortal mode */
+    gsize bytes_stored;       /**< Bytes of string data currently cached */
+} QofStringCacheStats;
+
+/** Fill @a stats with the cache's counters since the last
+ * qof_string_cache_destroy(). The cache is safe to use from several
+ * threads; the counters are gathered shard by shard and so are only a
+ * consistent snapshot when no other thread is using the cache.
+ */
+void qof_string_cache_get_stats(QofStringCacheStats *stats);
+
 /** Same as CACHE_REPLACE below, but safe to call from C++.
  */
 char * qof_string_cache_replace(const char * dst, const char * src);
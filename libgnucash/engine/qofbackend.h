@@ -137,6 +137,9 @@ typedef struct QofBackend QofBackend;
 /* Temporary wrapper so that we don't have to expose qof-backend.hpp to Transaction.c */
     gboolean qof_backend_can_rollback (QofBackend*);
     void qof_backend_rollback_instance (QofBackend*, QofInstance*);
+/** Load the objects a query may match that are not in memory yet, for
+ * backends that load lazily; see QofBackend::load_for_query. */
+    void qof_backend_load_for_query (QofBackend*, QofBook*, struct _QofQuery*);
 
 /** \brief Load a QOF-compatible backend shared library.
 
@@ -86,6 +86,12 @@ void qof_book_print_dirty (const QofBook *book);
 /* @} */
 #ifdef __cplusplus
 }
+
+class QofArena;
+/** Return the arena holding objects created while loading the book,
+ *  creating it if necessary. It is released when the book is
+ *  finalized, after all of the book's objects have been destroyed. */
+QofArena* qof_book_get_arena (QofBook *book);
 #endif
 
 #endif /* QOF_BOOK_P_H */
@@ -58,11 +58,13 @@ extern "C"
 #include "qofobject-p.h"
 #include "qofbookslots.h"
 #include "kvp-frame.hpp"
+#include "qof-arena.hpp"
 // For GNC_ID_ROOT_ACCOUNT:
 #include "AccountP.h"
 
 static QofLogModule log_module = QOF_MOD_ENGINE;
 #define AB_KEY "hbci"
+#define QOF_BOOK_ARENA "qof-book-arena"
 #define AB_TEMPLATES "template-list"
 
 enum
@@ -453,6 +455,37 @@ qof_book_destroy (QofBook *book)
     LEAVE ("book=%p", book);
 }
 
+static void
+book_arena_free (gpointer data)
+{
+    auto arena = static_cast<QofArena*>(data);
+
+    PINFO ("releasing arena: %" G_GSIZE_FORMAT " allocations, %" G_GSIZE_FORMAT
+           " bytes used, %" G_GSIZE_FORMAT " reserved",
+           arena->allocations(), arena->bytes_used(),
+           arena->bytes_reserved());
+    delete arena;
+}
+
+QofArena*
+qof_book_get_arena (QofBook *book)
+{
+    g_return_val_if_fail (book, nullptr);
+
+    /* The arena has to outlive everything allocated from it, the
+     * book's own KVP frame included, so it goes with the object data
+     * that GObject releases last of all when the book is finalized. */
+    auto arena = static_cast<QofArena*>(g_object_get_data (G_OBJECT (book),
+                                                           QOF_BOOK_ARENA));
+    if (!arena)
+    {
+        arena = new QofArena;
+        g_object_set_data_full (G_OBJECT (book), QOF_BOOK_ARENA, arena,
+                                book_arena_free);
+    }
+    return arena;
+}
+
 /* ====================================================================== */
 
 gboolean
@@ -33,6 +33,7 @@ extern "C"
 
 /* Static Variables ************************************************/
 static guint   suspend_counter   = 0;
+static guint   suppressed_count  = 0;
 static gint    next_handler_id   = 1;
 static guint   handler_run_level = 0;
 static guint   pending_deletes   = 0;
@@ -237,9 +238,18 @@ qof_event_gen (QofInstance *entity, QofEventId event_id, gpointer event_data)
         return;
 
     if (suspend_counter)
+    {
+        suppressed_count++;
         return;
+    }
 
     qof_event_generate_internal (entity, event_id, event_data);
 }
 
+guint
+qof_event_get_suppressed_count (void)
+{
+    return suppressed_count;
+}
+
 /* =========================== END OF FILE ======================= */
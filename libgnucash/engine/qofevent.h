@@ -139,6 +139,11 @@ void qof_event_suspend (void);
 /** Resume engine event generation. */
 void qof_event_resume (void);
 
+/** The number of events dropped while suspended so far. Handlers that
+ *  keep caches up to date from events can compare it with the count
+ *  they last saw to find out whether they missed any. */
+guint qof_event_get_suppressed_count (void);
+
 #ifdef __cplusplus
 }
 #endif
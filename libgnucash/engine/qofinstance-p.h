@@ -57,6 +57,10 @@ void qof_instance_set_last_update (QofInstance *inst, time64 time);
  *  collection flag at all. */
 void qof_instance_set_dirty_flag (gconstpointer inst, gboolean flag);
 
+/** Set the flag telling that the instance was never saved. Reserved
+ *  for backends that write instances outside of qof_commit_edit(). */
+void qof_instance_set_infant (gpointer inst, gboolean infant);
+
 /** Set the GncGUID of this instance */
 void qof_instance_set_guid (gpointer inst, const GncGUID *guid);
 
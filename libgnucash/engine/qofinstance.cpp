@@ -669,6 +669,13 @@ qof_instance_set_dirty_flag (gconstpointer inst, gboolean flag)
     GET_PRIVATE(inst)->dirty = flag;
 }
 
+void
+qof_instance_set_infant (gpointer inst, gboolean infant)
+{
+    g_return_if_fail(QOF_IS_INSTANCE(inst));
+    GET_PRIVATE(inst)->infant = infant;
+}
+
 void
 qof_instance_mark_clean (QofInstance *inst)
 {
@@ -106,6 +106,19 @@ struct _QofQuery
     GList *           results;
 };
 
+/* A registered ordered index over a date parameter of an object type */
+typedef struct _QofQueryDateIndex
+{
+    QofQueryParamList *     param_list;
+    QofQueryDateIndexForeach foreach;
+} QofQueryDateIndex;
+
+/* Date comparisons with QOF_DATE_MATCH_DAY round both sides to mid-day,
+ * so widen the index range enough to cover any timezone. */
+#define DATE_INDEX_DAY_SLOP (2 * 24 * 60 * 60)
+
+static GHashTable *date_indexes = NULL;
+
 typedef struct _QofQueryCB
 {
     QofQuery *        query;
@@ -536,7 +549,10 @@ static void compile_terms (QofQuery *q)
              */
 
             if (qt->param_fcns && resObj)
+            {
                 qt->pred_fcn = qof_query_core_get_predicate (resObj->param_type);
+                qof_query_core_predicate_compile (qt->pdata);
+            }
             else
                 qt->pred_fcn = NULL;
         }
@@ -814,13 +830,83 @@ static GList * qof_query_run_internal (QofQuery *q,
     return matching_objects;
 }
 
+/* Find a range of dates of the registered date index which contains
+ * every object that can match the query, i.e. every OR-term carries
+ * at least one bound on the indexed parameter. */
+static gboolean
+query_date_index_range (const QofQuery *q, const QofQueryDateIndex *idx,
+                        time64 *start, time64 *end)
+{
+    gboolean first = TRUE;
+
+    if (!q->terms) return FALSE;
+
+    for (const GList *or_ptr = q->terms; or_ptr; or_ptr = or_ptr->next)
+    {
+        time64 lo = G_MININT64, hi = G_MAXINT64;
+
+        for (const GList *and_ptr = static_cast<GList*>(or_ptr->data); and_ptr;
+             and_ptr = and_ptr->next)
+        {
+            const QofQueryTerm *qt = static_cast<QofQueryTerm*>(and_ptr->data);
+            time64 date, slop;
+
+            if (qt->invert || param_list_cmp (qt->param_list, idx->param_list))
+                continue;
+            if (!qof_query_date_predicate_get_date (qt->pdata, &date))
+                continue;
+
+            slop = ((query_date_t)qt->pdata)->options == QOF_DATE_MATCH_DAY ?
+                   DATE_INDEX_DAY_SLOP : 0;
+
+            switch (qt->pdata->how)
+            {
+            case QOF_COMPARE_LT:
+            case QOF_COMPARE_LTE:
+                hi = MIN (hi, date + slop);
+                break;
+            case QOF_COMPARE_GT:
+            case QOF_COMPARE_GTE:
+                lo = MAX (lo, date - slop);
+                break;
+            case QOF_COMPARE_EQUAL:
+                lo = MAX (lo, date - slop);
+                hi = MIN (hi, date + slop);
+                break;
+            default:
+                break;
+            }
+        }
+
+        if (lo == G_MININT64 && hi == G_MAXINT64)
+            return FALSE;
+
+        *start = first ? lo : MIN (*start, lo);
+        *end = first ? hi : MAX (*end, hi);
+        first = FALSE;
+    }
+    return TRUE;
+}
+
 static void qof_query_run_cb(QofQueryCB* qcb, gpointer cb_arg)
 {
     GList *node;
 
+    QofQueryDateIndex *idx = NULL;
+    time64 start = 0, end = 0;
+
     (void)cb_arg; /* unused */
     g_return_if_fail(qcb);
 
+    if (date_indexes)
+        idx = static_cast<QofQueryDateIndex*>(g_hash_table_lookup (date_indexes,
+                                                                   qcb->query->search_for));
+    if (idx && !query_date_index_range (qcb->query, idx, &start, &end))
+        idx = NULL;
+    if (idx)
+        PINFO ("using date index for %s from %" G_GINT64_FORMAT
+               " to %" G_GINT64_FORMAT, qcb->query->search_for, start, end);
+
     for (node = qcb->query->books; node; node = node->next)
     {
         QofBook* book = static_cast<QofBook*>(node->data);
@@ -839,9 +925,19 @@ static void qof_query_run_cb(QofQueryCB* qcb, gpointer cb_arg)
             }
         }
 #endif
-        /* And then iterate over all the objects */
-        qof_object_foreach (qcb->query->search_for, book,
-                            (QofInstanceForeachCB) check_item_cb, qcb);
+        /* Give a backend that loads lazily a chance to load what we need. */
+        QofBackend* book_be = qof_book_get_backend (book);
+        if (book_be)
+            book_be->load_for_query (book, qcb->query);
+
+        /* And then iterate over all the objects, or over just those in
+         * the date range if the object type has a date index. */
+        if (idx)
+            idx->foreach (book, start, end,
+                          (QofInstanceForeachCB) check_item_cb, qcb);
+        else
+            qof_object_foreach (qcb->query->search_for, book,
+                                (QofInstanceForeachCB) check_item_cb, qcb);
     }
 }
 
@@ -876,6 +972,87 @@ qof_query_run_subquery (QofQuery *subq, const QofQuery* primaryq)
                                   (gpointer)primaryq);
 }
 
+GList *
+qof_query_run_incremental (QofQuery *q, GList *objects, GList *removed)
+{
+    GHashTable *recheck;
+    GList *results = NULL, *matches = NULL, *node;
+    gboolean sorted;
+
+    if (!q) return NULL;
+
+    /* The cached results can only be patched if they are complete and
+     * still describe the current terms. */
+    if (q->changed || q->max_results > -1)
+        return qof_query_run (q);
+
+    ENTER (" q=%p", q);
+    sorted = q->primary_sort.comp_fcn || q->primary_sort.obj_cmp ||
+             (q->primary_sort.use_default && q->defaultSort);
+
+    recheck = g_hash_table_new (g_direct_hash, g_direct_equal);
+    for (node = objects; node; node = node->next)
+    {
+        QofInstance *inst = QOF_INSTANCE (node->data);
+
+        if (!inst || g_hash_table_contains (recheck, inst))
+            continue;
+        g_hash_table_add (recheck, inst);
+
+        if (g_strcmp0 (inst->e_type, q->search_for) ||
+            !g_list_find (q->books, qof_instance_get_book (inst)))
+            continue;
+
+        if (check_object (q, inst))
+            matches = g_list_prepend (matches, inst);
+    }
+
+    /* Removed objects are never dereferenced, just dropped. */
+    for (node = removed; node; node = node->next)
+        g_hash_table_add (recheck, node->data);
+
+    /* Drop the stale entries for the rechecked and removed objects. */
+    for (node = q->results; node; node = node->next)
+        if (!g_hash_table_contains (recheck, node->data))
+            results = g_list_prepend (results, node->data);
+    results = g_list_reverse (results);
+    g_hash_table_destroy (recheck);
+
+    if (sorted)
+    {
+        /* Merge the (few) new matches into the already sorted results. */
+        GList *merged = NULL, *r = results, *m;
+
+        matches = g_list_sort_with_data (matches, sort_func, q);
+        for (m = matches; m; m = m->next)
+        {
+            while (r && sort_func (r->data, m->data, q) <= 0)
+            {
+                merged = g_list_prepend (merged, r->data);
+                r = r->next;
+            }
+            merged = g_list_prepend (merged, m->data);
+        }
+        for (; r; r = r->next)
+            merged = g_list_prepend (merged, r->data);
+
+        g_list_free (results);
+        g_list_free (matches);
+        results = g_list_reverse (merged);
+    }
+    else
+        results = g_list_concat (results, g_list_reverse (matches));
+
+    g_list_free (q->results);
+    q->results = results;
+
+    PINFO ("rechecked %d objects, removed %d, %d results",
+           g_list_length (objects), g_list_length (removed),
+           g_list_length (results));
+    LEAVE (" q=%p", q);
+    return results;
+}
+
 GList *
 qof_query_last_run (QofQuery *query)
 {
@@ -1347,8 +1524,40 @@ void qof_query_init (void)
     LEAVE ("Completed initialization of QofQuery");
 }
 
+static void
+free_date_index (gpointer data)
+{
+    QofQueryDateIndex *idx = static_cast<QofQueryDateIndex*>(data);
+
+    g_slist_free (idx->param_list);
+    g_free (idx);
+}
+
+void qof_query_register_date_index (QofIdTypeConst obj_type,
+                                    QofQueryParamList *param_list,
+                                    QofQueryDateIndexForeach foreach)
+{
+    QofQueryDateIndex *idx;
+
+    g_return_if_fail (obj_type && param_list && foreach);
+
+    if (!date_indexes)
+        date_indexes = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                              NULL, free_date_index);
+
+    idx = g_new0 (QofQueryDateIndex, 1);
+    idx->param_list = param_list;
+    idx->foreach = foreach;
+    g_hash_table_replace (date_indexes, (gpointer)obj_type, idx);
+}
+
 void qof_query_shutdown (void)
 {
+    if (date_indexes)
+    {
+        g_hash_table_destroy (date_indexes);
+        date_indexes = NULL;
+    }
     qof_class_shutdown ();
     qof_query_core_shutdown ();
 }
@@ -237,6 +237,49 @@ GList * qof_query_last_run (QofQuery *query);
 GList * qof_query_run_subquery (QofQuery *subquery,
                                 const QofQuery* primary_query);
 
+/** Bring the results of the last run up to date after a known set of
+ *  objects has changed, instead of re-running the query over the
+ *  whole book.  Each of @a objects is dropped from the previous
+ *  results and merged back in sort order if it still matches.
+ *  Objects which are not of the searched-for type or not in one of
+ *  the query's books are ignored.
+ *
+ *  @a removed lists the objects destroyed since the last run.  They
+ *  are dropped from the results and only compared by address, so they
+ *  may already have been freed; they must not also be in @a objects.
+ *  If the query terms changed since the last run or the query has a
+ *  result limit, this simply performs qof_query_run().
+ *
+ *  Do NOT free the resulting list.  This list is managed internally
+ *  by QofQuery.
+ */
+GList * qof_query_run_incremental (QofQuery *query, GList *objects,
+                                   GList *removed);
+
+/** Iterate over the objects of a book whose indexed date lies between
+ *  start and end inclusive.  The callback must not change the dates
+ *  of the objects it is handed.
+ */
+typedef void (*QofQueryDateIndexForeach) (QofBook *book, time64 start,
+                                          time64 end, QofInstanceForeachCB cb,
+                                          gpointer user_data);
+
+/** Register an ordered index on a date parameter of an object type.
+ *  When every OR-term of a query for @a obj_type bounds the date
+ *  reached through @a param_list, the query only iterates over the
+ *  objects in that date range instead of over the whole book.  The
+ *  terms are still checked for each object, so the index only has to
+ *  return a superset of the matches.
+ *
+ *  @param obj_type The object type the index applies to.
+ *  @param param_list The path to the indexed date parameter, as for
+ *  qof_query_add_term().  It is owned by the query subsystem afterwards.
+ *  @param foreach The range iterator.
+ */
+void qof_query_register_date_index (QofIdTypeConst obj_type,
+                                    QofQueryParamList *param_list,
+                                    QofQueryDateIndexForeach foreach);
+
 /** Remove all query terms from query.  query matches nothing
  *  after qof_query_clear().
  */
@@ -52,6 +52,10 @@ QofCompareFunc qof_query_core_get_compare (gchar const *type);
 /* Compare two predicates */
 gboolean qof_query_core_predicate_equal (const QofQueryPredData *p1, const QofQueryPredData *p2);
 
+/* Prepare the predicate data for matching many objects; called when
+ * the query's terms are compiled. */
+void qof_query_core_predicate_compile (QofQueryPredData *pdata);
+
 /* Predicate Data Structures:
  *
  * These are defined such that you can cast between these types and
@@ -69,6 +73,9 @@ typedef struct
     gboolean		is_regex;
     gchar *		matchstring;
     regex_t		compiled;
+    /* matchstring casefolded and normalized, for case insensitive
+     * matches without a regex */
+    gchar *		folded;
 } query_string_def, *query_string_t;
 
 typedef struct
@@ -90,6 +97,9 @@ typedef struct
     QofQueryPredData	pd;
     QofGuidMatch	options;
     GList *	guids;
+    /* The distinct guids hashed for lookup, built when the query is
+     * compiled if there are enough of them to be worth it. */
+    gpointer	guid_set;
 } query_guid_def, *query_guid_t;
 
 typedef struct
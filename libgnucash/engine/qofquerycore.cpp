@@ -26,6 +26,7 @@
 
 #include <glib.h>
 #include <stdlib.h>
+#include <unordered_set>
 
 #include "qof.h"
 #include "qofquerycore-p.h"
@@ -150,16 +151,25 @@ string_match_predicate (gpointer object,
     {
         if (pdata->options == QOF_STRING_MATCH_CASEINSENSITIVE)
         {
+            /* Most strings searched, like descriptions and memos, are
+             * cached and keep their folded form, so that each distinct
+             * one is only folded once however many objects share it. */
+            const char *folded = qof_string_cache_casefold (s);
+            gchar *tmp = NULL;
+            if (!folded)
+                folded = tmp = qof_utf8_casefold_normalize (s);
+
             if (pd->how == QOF_COMPARE_CONTAINS || pd->how == QOF_COMPARE_NCONTAINS)
             {
-                if (qof_utf8_substr_nocase (s, pdata->matchstring)) //uses strstr
+                if (strstr (folded, pdata->folded))
                     ret = 1;
             }
             else
             {
-                 if (safe_strcasecmp (s, pdata->matchstring) == 0) //uses collate
+                if (g_strcmp0 (folded, pdata->folded) == 0)
                     ret = 1;
             }
+            g_free (tmp);
         }
         else
         {
@@ -248,6 +258,7 @@ string_free_pdata (QofQueryPredData *pd)
     if (pdata->is_regex)
         regfree (&pdata->compiled);
 
+    g_free (pdata->folded);
     g_free (pdata->matchstring);
     g_free (pdata);
 }
@@ -309,6 +320,8 @@ qof_query_string_predicate (QofQueryCompare how,
         }
         pdata->is_regex = TRUE;
     }
+    else if (options == QOF_STRING_MATCH_CASEINSENSITIVE)
+        pdata->folded = qof_utf8_casefold_normalize (str);
 
     return ((QofQueryPredData*)pdata);
 }
@@ -589,6 +602,47 @@ debcred_to_string (gpointer object, QofParam *getter)
 
 /* QOF_TYPE_GUID =================================================== */
 
+struct GuidHash
+{
+    size_t operator() (const GncGUID& guid) const
+    {
+        return guid_hash_to_guint (&guid);
+    }
+};
+
+struct GuidEqual
+{
+    bool operator() (const GncGUID& a, const GncGUID& b) const
+    {
+        return guid_equal (&a, &b);
+    }
+};
+
+using GuidSet = std::unordered_set<GncGUID, GuidHash, GuidEqual>;
+
+/* Below this many guids walking the list is as fast as hashing. */
+#define GUID_SET_MIN_SIZE 8
+
+static gboolean
+guid_in_pdata (query_guid_t pdata, const GncGUID *guid)
+{
+    GList *node;
+
+    if (!guid)
+        return FALSE;
+    if (pdata->guid_set)
+    {
+        auto set = static_cast<GuidSet*>(pdata->guid_set);
+        return set->find (*guid) != set->end ();
+    }
+    for (node = pdata->guids; node; node = node->next)
+    {
+        if (guid_equal (static_cast<GncGUID*>(node->data), guid))
+            return TRUE;
+    }
+    return FALSE;
+}
+
 static int
 guid_match_predicate (gpointer object, QofParam *getter,
                       QofQueryPredData *pd)
@@ -596,6 +650,7 @@ guid_match_predicate (gpointer object, QofParam *getter,
     query_guid_t pdata = (query_guid_t)pd;
     GList *node, *o_list;
     const GncGUID *guid = NULL;
+    gboolean found = FALSE;
 
     VERIFY_PREDICATE (query_guid_type);
 
@@ -608,11 +663,31 @@ guid_match_predicate (gpointer object, QofParam *getter,
          * object list
          */
 
+        if (pdata->guid_set)
+        {
+            /* Count the distinct predicate guids seen in the object list;
+             * they're all accounted for when the count reaches the size
+             * of the set.
+             */
+            auto set = static_cast<GuidSet*>(pdata->guid_set);
+            GuidSet seen;
+
+            for (o_list = static_cast<GList*>(object); o_list;
+                 o_list = o_list->next)
+            {
+                guid = ((query_guid_getter)getter->param_getfcn) (o_list->data, getter);
+                if (guid && set->find (*guid) != set->end ())
+                    seen.insert (*guid);
+            }
+            found = (seen.size () != set->size ());
+            break;
+        }
+
         for (node = pdata->guids; node; node = node->next)
         {
             /* See if this GncGUID matches the object's guid */
             for (o_list = static_cast<GList*>(object); o_list;
-		 o_list = static_cast<GList*>(o_list->next))
+                 o_list = static_cast<GList*>(o_list->next))
             {
                 guid = ((query_guid_getter)getter->param_getfcn) (o_list->data, getter);
                 if (guid_equal (static_cast<GncGUID*>(node->data), guid))
@@ -629,10 +704,9 @@ guid_match_predicate (gpointer object, QofParam *getter,
 
         /*
          * The match is complete.  If node == NULL then we've successfully
-         * found a match for all the guids in the predicate.  Return
-         * appropriately below.
+         * found a match for all the guids in the predicate.
          */
-
+        found = (node != NULL);
         break;
 
     case QOF_GUID_MATCH_LIST_ANY:
@@ -644,29 +718,10 @@ guid_match_predicate (gpointer object, QofParam *getter,
 
         o_list = ((query_glist_getter)getter->param_getfcn) (object, getter);
 
-        for (node = o_list; node; node = node->next)
-        {
-            GList *node2;
-
-            /* Search the predicate data for a match */
-            for (node2 = pdata->guids; node2; node2 = node2->next)
-            {
-                if (guid_equal (static_cast<GncGUID*>(node->data),
-				static_cast<GncGUID*>(node2->data)))
-                    break;
-            }
-
-            /* Check to see if we found a match.  If so, break now */
-            if (node2 != NULL)
-                break;
-        }
+        for (node = o_list; node && !found; node = node->next)
+            found = guid_in_pdata (pdata, static_cast<GncGUID*>(node->data));
 
         g_list_free(o_list);
-
-        /* yea, node may point to an invalid location, but that's ok.
-         * we're not _USING_ the value, just checking that it's non-NULL
-         */
-
         break;
 
     default:
@@ -676,22 +731,19 @@ guid_match_predicate (gpointer object, QofParam *getter,
          */
 
         guid = ((query_guid_getter)getter->param_getfcn) (object, getter);
-        for (node = pdata->guids; node; node = node->next)
-        {
-            if (guid_equal (static_cast<GncGUID*>(node->data), guid))
-                break;
-        }
+        found = guid_in_pdata (pdata, guid);
     }
 
+    /* For QOF_GUID_MATCH_ALL found means a predicate guid is missing. */
     switch (pdata->options)
     {
     case QOF_GUID_MATCH_ANY:
     case QOF_GUID_MATCH_LIST_ANY:
-        return (node != NULL);
+        return found;
         break;
     case QOF_GUID_MATCH_NONE:
     case QOF_GUID_MATCH_ALL:
-        return (node == NULL);
+        return !found;
         break;
     case QOF_GUID_MATCH_NULL:
         return ((guid == NULL) || guid_equal(guid, guid_null()));
@@ -702,6 +754,22 @@ guid_match_predicate (gpointer object, QofParam *getter,
     }
 }
 
+static void
+guid_compile_pdata (QofQueryPredData *pd)
+{
+    query_guid_t pdata = (query_guid_t)pd;
+    GList *node;
+
+    if (pdata->guid_set ||
+        g_list_length (pdata->guids) < GUID_SET_MIN_SIZE)
+        return;
+
+    auto set = new GuidSet;
+    for (node = pdata->guids; node; node = node->next)
+        set->insert (*static_cast<GncGUID*>(node->data));
+    pdata->guid_set = set;
+}
+
 static void
 guid_free_pdata (QofQueryPredData *pd)
 {
@@ -713,6 +781,7 @@ guid_free_pdata (QofQueryPredData *pd)
         guid_free (static_cast<GncGUID*>(node->data));
     }
     g_list_free (pdata->guids);
+    delete static_cast<GuidSet*>(pdata->guid_set);
     g_free (pdata);
 }
 
@@ -1815,3 +1884,13 @@ qof_query_core_predicate_equal (const QofQueryPredData *p1, const QofQueryPredDa
 
     return pred_equal (p1, p2);
 }
+
+void
+qof_query_core_predicate_compile (QofQueryPredData *pdata)
+{
+    g_return_if_fail (pdata);
+    g_return_if_fail (pdata->type_name);
+
+    if (!g_strcmp0 (pdata->type_name, query_guid_type))
+        guid_compile_pdata (pdata);
+}
@@ -59,6 +59,7 @@ static QofLogModule log_module = QOF_MOD_SESSION;
 #include "qof-backend.hpp"
 #include "qofsession.hpp"
 #include "gnc-backend-prov.hpp"
+#include "qof-arena.hpp"
 
 #include <vector>
 #include <boost/algorithm/string.hpp>
@@ -226,6 +227,9 @@ QofSessionImpl::load (QofPercentageFunc percentage_func) noexcept
      */
     if (m_backend)
     {
+        /* Objects created by the initial load mostly live as long as
+         * the book, so take them from the book's arena. */
+        QofArena::Scope arena_scope {qof_book_get_arena (m_book)};
         m_backend->set_percentage(percentage_func);
         m_backend->load (m_book, LOAD_TYPE_INITIAL_LOAD);
         push_error (m_backend->get_error(), {});
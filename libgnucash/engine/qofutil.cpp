@@ -50,23 +50,29 @@ g_hash_table_foreach_sorted(GHashTable *hash_table, GHFunc func, gpointer user_d
     g_list_free(keys);
 }
 
+gchar *
+qof_utf8_casefold_normalize (const gchar *str)
+{
+    gchar *casefold, *normalized;
+
+    g_return_val_if_fail (str, NULL);
+
+    casefold = g_utf8_casefold (str, -1);
+    normalized = g_utf8_normalize (casefold, -1, G_NORMALIZE_ALL);
+    g_free (casefold);
+    return normalized;
+}
+
 gboolean
 qof_utf8_substr_nocase (const gchar *haystack, const gchar *needle)
 {
-    gchar *haystack_casefold, *haystack_normalized;
-    gchar *needle_casefold, *needle_normalized;
+    gchar *haystack_normalized, *needle_normalized;
     gchar *p;
 
     g_return_val_if_fail (haystack && needle, FALSE);
 
-    haystack_casefold = g_utf8_casefold (haystack, -1);
-    haystack_normalized = g_utf8_normalize (haystack_casefold, -1,
-                                            G_NORMALIZE_ALL);
-    g_free (haystack_casefold);
-
-    needle_casefold = g_utf8_casefold (needle, -1);
-    needle_normalized = g_utf8_normalize (needle_casefold, -1, G_NORMALIZE_ALL);
-    g_free (needle_casefold);
+    haystack_normalized = qof_utf8_casefold_normalize (haystack);
+    needle_normalized = qof_utf8_casefold_normalize (needle);
 
     p = strstr (haystack_normalized, needle_normalized);
     g_free (haystack_normalized);
@@ -182,6 +182,11 @@ void g_hash_table_foreach_sorted(GHashTable *hash_table, GHFunc func, gpointer u
  * otherwise. */
 gboolean qof_utf8_substr_nocase (const gchar *haystack, const gchar *needle);
 
+/** Casefold str and normalize it with G_NORMALIZE_ALL, the form in
+ * which qof_utf8_substr_nocase() compares strings. The caller must
+ * g_free() the result. */
+gchar *qof_utf8_casefold_normalize (const gchar *str);
+
 /** case sensitive comparison of strings da and db - either
 may be NULL. A non-NULL string is greater than a NULL string.
 
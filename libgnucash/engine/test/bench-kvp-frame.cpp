@@ -0,0 +1,175 @@
+/********************************************************************
+ * bench-kvp-frame.cpp: Memory and lookup benchmarks for KvpFrame.  *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, you can retrieve it from        *
+ * https://www.gnu.org/licenses/old-licenses/gpl-2.0.html            *
+ * or contact:                                                      *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ ********************************************************************/
+
+/* Compares KvpFrame with the std::map layout it replaced, using frames
+ * shaped like the ones splits carry: two or three short keys at the top
+ * level. Not run by ctest; build the bench-kvp-frame target and run it
+ * by hand, optionally passing the number of frames.
+ */
+
+extern "C"
+{
+#include <config.h>
+#include <qof.h>
+}
+
+#include "../kvp-value.hpp"
+#include "../kvp-frame.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <new>
+
+static std::size_t bytes_allocated = 0;
+static std::size_t allocations = 0;
+
+void* operator new (std::size_t size)
+{
+    bytes_allocated += size;
+    ++allocations;
+    if (auto ptr = std::malloc (size))
+        return ptr;
+    throw std::bad_alloc {};
+}
+
+void operator delete (void* ptr) noexcept
+{
+    std::free (ptr);
+}
+
+void operator delete (void* ptr, std::size_t) noexcept
+{
+    std::free (ptr);
+}
+
+/* The layout KvpFrameImpl used before it became a flat vector. */
+struct cstring_comparer
+{
+    bool operator()(const char * one, const char * two) const
+    {
+        return std::strcmp (one, two) < 0;
+    }
+};
+using OldFrame = std::map<const char *, KvpValue*, cstring_comparer>;
+
+static const char* keys[] = {"online_id", "date-posted", "lot-split"};
+static const int n_keys = 3;
+
+using Clock = std::chrono::steady_clock;
+
+static double
+elapsed_ms (Clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli> (Clock::now () - start).count ();
+}
+
+static void
+report (const char* what, std::size_t bytes, std::size_t allocs,
+        std::size_t n_frames, double ms)
+{
+    printf ("%-28s %8.1f bytes/frame %6.2f allocs/frame %9.2f ms\n", what,
+            static_cast<double> (bytes) / n_frames,
+            static_cast<double> (allocs) / n_frames, ms);
+}
+
+int
+main (int argc, char** argv)
+{
+    std::size_t n_frames = argc > 1 ? std::strtoul (argv[1], nullptr, 10) : 200000;
+    const int lookups = 10;
+    qof_init ();
+
+    /* Intern the keys outside the measurements; a book holds them anyway. */
+    const char* cached[n_keys];
+    for (auto i = 0; i < n_keys; ++i)
+        cached[i] = qof_string_cache_insert (keys[i]);
+
+    for (auto n_slots = 1; n_slots <= n_keys; ++n_slots)
+    {
+        printf ("%d slot(s) per frame, %zu frames\n", n_slots, n_frames);
+
+        auto bytes = bytes_allocated;
+        auto allocs = allocations;
+        auto start = Clock::now ();
+        auto old_frames = std::make_unique<OldFrame[]> (n_frames);
+        for (std::size_t f = 0; f < n_frames; ++f)
+            for (auto i = 0; i < n_slots; ++i)
+                old_frames[f].emplace (qof_string_cache_insert (keys[i]),
+                                       new KvpValue {INT64_C (1)});
+        report ("  std::map build", bytes_allocated - bytes,
+                allocations - allocs, n_frames, elapsed_ms (start));
+
+        bytes = bytes_allocated;
+        allocs = allocations;
+        start = Clock::now ();
+        auto frames = std::make_unique<KvpFrame[]> (n_frames);
+        for (std::size_t f = 0; f < n_frames; ++f)
+            for (auto i = 0; i < n_slots; ++i)
+                frames[f].set ({keys[i]}, new KvpValue {INT64_C (1)});
+        report ("  KvpFrame build", bytes_allocated - bytes,
+                allocations - allocs, n_frames, elapsed_ms (start));
+
+        std::size_t found = 0;
+        start = Clock::now ();
+        for (auto l = 0; l < lookups; ++l)
+            for (std::size_t f = 0; f < n_frames; ++f)
+                found += old_frames[f].find (keys[n_slots - 1]) != old_frames[f].end ();
+        report ("  std::map find", 0, 0, n_frames, elapsed_ms (start));
+
+        start = Clock::now ();
+        for (auto l = 0; l < lookups; ++l)
+            for (std::size_t f = 0; f < n_frames; ++f)
+                found += frames[f].get_slot ({keys[n_slots - 1]}) != nullptr;
+        report ("  KvpFrame get_slot(Path)", 0, 0, n_frames, elapsed_ms (start));
+
+        start = Clock::now ();
+        for (auto l = 0; l < lookups; ++l)
+            for (std::size_t f = 0; f < n_frames; ++f)
+                found += frames[f].get_slot (keys[n_slots - 1]) != nullptr;
+        report ("  KvpFrame get_slot(string)", 0, 0, n_frames, elapsed_ms (start));
+
+        start = Clock::now ();
+        for (auto l = 0; l < lookups; ++l)
+            for (std::size_t f = 0; f < n_frames; ++f)
+                found += frames[f].get_slot (cached[n_slots - 1]) != nullptr;
+        report ("  KvpFrame get_slot(interned)", 0, 0, n_frames, elapsed_ms (start));
+
+        if (found != 4 * lookups * n_frames)
+            printf ("  lookups failed: %zu\n", found);
+
+        for (std::size_t f = 0; f < n_frames; ++f)
+            for (auto& slot : old_frames[f])
+            {
+                qof_string_cache_remove (slot.first);
+                delete slot.second;
+            }
+    }
+
+    for (auto i = 0; i < n_keys; ++i)
+        qof_string_cache_remove (cached[i]);
+    qof_close ();
+    return 0;
+}
@@ -0,0 +1,148 @@
+/********************************************************************
+ * bench-query-guid.cpp: Benchmarks for GncGUID list query terms.   *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, you can retrieve it from        *
+ * https://www.gnu.org/licenses/old-licenses/gpl-2.0.html            *
+ * or contact:                                                      *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ ********************************************************************/
+
+/* Matches the splits of a book against account lists of 1, 50 and 1000
+ * GUIDs, the way an account-filtered report does, both by walking the
+ * predicate's list and through the set built when the query is
+ * compiled. Not run by ctest; build the bench-query-guid target and run
+ * it by hand, optionally passing the number of splits.
+ */
+
+extern "C"
+{
+#include <config.h>
+#include <qof.h>
+#include "../Account.h"
+#include "../Query.h"
+#include "../Split.h"
+#include "../Transaction.h"
+#include "../cashobjects.h"
+#include "../gnc-commodity.h"
+}
+
+#include "../qofquerycore-p.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+static double
+elapsed_ms (Clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli> (Clock::now () - start).count ();
+}
+
+static const int n_accounts = 1000;
+
+int
+main (int argc, char** argv)
+{
+    std::size_t n_splits = argc > 1 ? std::strtoul (argv[1], nullptr, 10) : 1000000;
+    const int guid_counts[] = {1, 50, 1000};
+    qof_init ();
+    cashobjects_register ();
+
+    auto book = qof_book_new ();
+    auto currency = gnc_commodity_new (book, "US Dollar", "CURRENCY",
+                                       "USD", "0", 100);
+    auto root = gnc_account_create_root (book);
+    std::vector<Account*> accounts;
+    for (auto i = 0; i < n_accounts; ++i)
+    {
+        auto account = xaccMallocAccount (book);
+        xaccAccountBeginEdit (account);
+        xaccAccountSetCommodity (account, currency);
+        xaccAccountCommitEdit (account);
+        gnc_account_append_child (root, account);
+        accounts.push_back (account);
+    }
+
+    /* Two splits per transaction, so the pairs cover every account. */
+    auto start = Clock::now ();
+    std::vector<Split*> splits;
+    splits.reserve (n_splits);
+    for (std::size_t s = 0; s < n_splits; s += 2)
+    {
+        auto trans = xaccMallocTransaction (book);
+        xaccTransBeginEdit (trans);
+        xaccTransSetCurrency (trans, currency);
+        for (auto k = 0; k < 2 && s + k < n_splits; ++k)
+        {
+            auto split = xaccMallocSplit (book);
+            xaccSplitSetParent (split, trans);
+            xaccSplitSetAccount (split, accounts[(s + k) % n_accounts]);
+            splits.push_back (split);
+        }
+        xaccTransCommitEdit (trans);
+    }
+    printf ("%zu splits in %d accounts built in %.2f ms\n", n_splits,
+            n_accounts, elapsed_ms (start));
+
+    auto param = qof_class_get_parameter (GNC_ID_SPLIT, SPLIT_ACCOUNT_GUID);
+    auto predicate = qof_query_core_get_predicate (QOF_TYPE_GUID);
+
+    for (auto n_guids : guid_counts)
+    {
+        GList* guids = nullptr;
+        for (auto i = n_guids - 1; i >= 0; --i)
+            guids = g_list_prepend (guids, (gpointer)xaccAccountGetGUID (accounts[i]));
+        printf ("%d GUID(s)\n", n_guids);
+
+        auto pdata = qof_query_guid_predicate (QOF_GUID_MATCH_ANY, guids);
+        std::size_t list_found = 0;
+        start = Clock::now ();
+        for (auto split : splits)
+            list_found += predicate (split, param, pdata);
+        printf ("  %-24s %9.2f ms\n", "list predicate", elapsed_ms (start));
+
+        qof_query_core_predicate_compile (pdata);
+        std::size_t set_found = 0;
+        start = Clock::now ();
+        for (auto split : splits)
+            set_found += predicate (split, param, pdata);
+        printf ("  %-24s %9.2f ms\n", "compiled predicate", elapsed_ms (start));
+        qof_query_core_predicate_free (pdata);
+
+        auto query = qof_query_create_for (GNC_ID_SPLIT);
+        qof_query_set_book (query, book);
+        xaccQueryAddAccountGUIDMatch (query, guids, QOF_GUID_MATCH_ANY,
+                                      QOF_QUERY_AND);
+        start = Clock::now ();
+        auto result = qof_query_run (query);
+        printf ("  %-24s %9.2f ms\n", "qof_query_run", elapsed_ms (start));
+
+        if (list_found != set_found || g_list_length (result) != set_found)
+            printf ("  matches differ: %zu %zu %u\n", list_found, set_found,
+                    g_list_length (result));
+        qof_query_destroy (query);
+        g_list_free (guids);
+    }
+
+    xaccAccountBeginEdit (root);
+    xaccAccountDestroy (root);
+    qof_book_destroy (book);
+    qof_close ();
+    return 0;
+}
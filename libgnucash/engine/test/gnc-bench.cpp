@@ -0,0 +1,489 @@
+/********************************************************************
+ * gnc-bench.cpp: Benchmarks of the engine over a generated book.   *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, you can retrieve it from        *
+ * https://www.gnu.org/licenses/old-licenses/gpl-2.0.html            *
+ * or contact:                                                      *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ ********************************************************************/
+
+/* Times the scrub, query, balance and price conversion paths over a
+ * generated book, then saving it to and loading it from an XML file
+ * and a SQLite database. The book is built with the random helpers of
+ * the test core seeded from --seed, so the same options give the same
+ * book and the results can be compared between commits. They are
+ * written to stdout as one JSON object.
+ *
+ * Not run by ctest; build the gnc-bench target and run it from the
+ * build directory with GNC_UNINSTALLED=1 and GNC_BUILDDIR set to it, so
+ * that the backends are found. A backend that can't be loaded is
+ * skipped. Run with --help for the size options.
+ */
+
+extern "C"
+{
+#include <config.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <qof.h>
+#include "../Account.h"
+#include "../Query.h"
+#include "../Scrub.h"
+#include "../Split.h"
+#include "../Transaction.h"
+#include "../gnc-commodity.h"
+#include "../gnc-engine.h"
+#include "../gnc-pricedb.h"
+#include "test-stuff.h"
+}
+
+#include "../kvp-value.hpp"
+#include "../qofinstance-p.h"
+#include "test-engine-stuff.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+static double
+elapsed_ms (Clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli> (Clock::now () - start).count ();
+}
+
+static gint opt_seed = 1;
+static gint opt_accounts = 100;
+static gint opt_transactions = 100;
+static gint opt_commodities = 10;
+static gint opt_prices = 250;
+static gint opt_kvp = 2;
+static gchar* opt_dir = nullptr;
+
+static GOptionEntry options[] =
+{
+    {"seed", 's', 0, G_OPTION_ARG_INT, &opt_seed,
+     "Seed of the generated book", "N"},
+    {"accounts", 'a', 0, G_OPTION_ARG_INT, &opt_accounts,
+     "Number of accounts", "N"},
+    {"transactions", 't', 0, G_OPTION_ARG_INT, &opt_transactions,
+     "Number of transactions per account", "N"},
+    {"commodities", 'c', 0, G_OPTION_ARG_INT, &opt_commodities,
+     "Number of commodities besides the currency", "N"},
+    {"prices", 'p', 0, G_OPTION_ARG_INT, &opt_prices,
+     "Number of prices per commodity", "N"},
+    {"kvp", 'k', 0, G_OPTION_ARG_INT, &opt_kvp,
+     "Number of KVP slots per transaction", "N"},
+    {"dir", 'd', 0, G_OPTION_ARG_FILENAME, &opt_dir,
+     "Directory for the saved files, the temporary directory by default",
+     "DIR"},
+    {nullptr}
+};
+
+/* Ten years of dates, so date ranges and prices have something to span. */
+static const int n_days = 3652;
+static const int n_dates = 12;
+
+struct BenchBook
+{
+    QofBook* book;
+    gnc_commodity* currency;
+    std::vector<gnc_commodity*> commodities;
+    std::vector<Account*> accounts;
+    std::vector<Account*> cash_accounts;
+    time64 start;
+};
+
+struct BenchResult
+{
+    std::string name;
+    double ms;
+    std::size_t count;
+};
+
+static std::vector<BenchResult> results;
+
+static void
+add_result (const char* name, Clock::time_point start, std::size_t count)
+{
+    results.push_back ({name, elapsed_ms (start), count});
+}
+
+static time64
+random_date (const BenchBook& bb)
+{
+    return bb.start + (time64)get_random_int_in_range (0, n_days - 1) * 86400;
+}
+
+static gnc_numeric
+random_amount (void)
+{
+    return gnc_numeric_create (get_random_int_in_range (-1000000, 1000000), 100);
+}
+
+static void
+make_commodities (BenchBook& bb)
+{
+    auto table = gnc_commodity_table_get_table (bb.book);
+    bb.currency = gnc_commodity_table_lookup (table, GNC_COMMODITY_NS_CURRENCY,
+                                              "USD");
+    for (auto i = 0; i < opt_commodities; ++i)
+    {
+        auto mnemonic = g_strdup_printf ("BENCH%d", i);
+        auto commodity = gnc_commodity_new (bb.book, mnemonic, "BENCH",
+                                            mnemonic, "", 10000);
+        bb.commodities.push_back (gnc_commodity_table_insert (table, commodity));
+        g_free (mnemonic);
+    }
+}
+
+/* Every commodity gets opt_prices prices in the currency, evenly spread
+ * over the dates and following a random walk. */
+static void
+make_prices (BenchBook& bb)
+{
+    auto pdb = gnc_pricedb_get_db (bb.book);
+    for (auto commodity : bb.commodities)
+    {
+        auto value = gnc_numeric_create (get_random_int_in_range (100, 100000), 100);
+        for (auto i = 0; i < opt_prices; ++i)
+        {
+            auto step = gnc_numeric_create (get_random_int_in_range (-200, 200), 100);
+            if (gnc_numeric_positive_p (gnc_numeric_add (value, step, 100,
+                                                         GNC_HOW_RND_ROUND)))
+                value = gnc_numeric_add (value, step, 100, GNC_HOW_RND_ROUND);
+            auto price = gnc_price_create (bb.book);
+            gnc_price_begin_edit (price);
+            gnc_price_set_commodity (price, commodity);
+            gnc_price_set_currency (price, bb.currency);
+            gnc_price_set_time64 (price, bb.start +
+                                  (time64)i * n_days / opt_prices * 86400);
+            gnc_price_set_source (price, PRICE_SOURCE_USER_PRICE);
+            gnc_price_set_typestr (price, PRICE_TYPE_LAST);
+            gnc_price_set_value (price, value);
+            gnc_price_commit_edit (price);
+            gnc_pricedb_add_price (pdb, price);
+            gnc_price_unref (price);
+        }
+    }
+}
+
+/* The first account and every one after a commodity account hold the
+ * currency; the others cycle through the commodities. */
+static void
+make_accounts (BenchBook& bb)
+{
+    auto root = gnc_account_create_root (bb.book);
+    auto n_kinds = bb.commodities.size () + 1;
+    for (auto i = 0; i < opt_accounts; ++i)
+    {
+        auto kind = i % n_kinds;
+        auto account = xaccMallocAccount (bb.book);
+        auto name = g_strdup_printf ("Account %d", i);
+        xaccAccountBeginEdit (account);
+        xaccAccountSetName (account, name);
+        if (kind == 0)
+        {
+            xaccAccountSetType (account, ACCT_TYPE_BANK);
+            xaccAccountSetCommodity (account, bb.currency);
+            bb.cash_accounts.push_back (account);
+        }
+        else
+        {
+            xaccAccountSetType (account, ACCT_TYPE_STOCK);
+            xaccAccountSetCommodity (account, bb.commodities[kind - 1]);
+        }
+        xaccAccountCommitEdit (account);
+        gnc_account_append_child (root, account);
+        bb.accounts.push_back (account);
+        g_free (name);
+    }
+}
+
+static void
+add_kvp (Transaction* trans)
+{
+    static const int types[] = {KvpValue::Type::INT64, KvpValue::Type::STRING,
+                                KvpValue::Type::NUMERIC, KvpValue::Type::GUID};
+    auto slots = qof_instance_get_slots (QOF_INSTANCE (trans));
+    for (auto i = 0; i < opt_kvp; ++i)
+    {
+        auto value = get_random_kvp_value (types[i % G_N_ELEMENTS (types)]);
+        if (!value)
+            continue;
+        delete slots->set ({"bench", "slot" + std::to_string (i)}, value);
+    }
+    qof_instance_set_dirty (QOF_INSTANCE (trans));
+}
+
+/* Each account gets opt_transactions transactions with a cash account
+ * on the other side. */
+static void
+make_transactions (BenchBook& bb)
+{
+    for (auto account : bb.accounts)
+    {
+        auto commodity = xaccAccountGetCommodity (account);
+        for (auto i = 0; i < opt_transactions; ++i)
+        {
+            auto other = bb.cash_accounts[get_random_int_in_range (0, bb.cash_accounts.size () - 1)];
+            auto value = random_amount ();
+            auto amount = value;
+            if (commodity != bb.currency)
+                amount = gnc_numeric_create (get_random_int_in_range (-100000, 100000), 10000);
+
+            auto trans = xaccMallocTransaction (bb.book);
+            xaccTransBeginEdit (trans);
+            xaccTransSetCurrency (trans, bb.currency);
+            xaccTransSetDatePostedSecsNormalized (trans, random_date (bb));
+            auto description = get_random_string_length_in_range (5, 30);
+            xaccTransSetDescription (trans, description);
+            g_free (description);
+
+            auto split = xaccMallocSplit (bb.book);
+            xaccSplitSetParent (split, trans);
+            xaccSplitSetAccount (split, account);
+            xaccSplitSetValue (split, value);
+            xaccSplitSetAmount (split, amount);
+
+            auto other_split = xaccMallocSplit (bb.book);
+            xaccSplitSetParent (other_split, trans);
+            xaccSplitSetAccount (other_split, other);
+            xaccSplitSetValue (other_split, gnc_numeric_neg (value));
+            xaccSplitSetAmount (other_split, gnc_numeric_neg (value));
+
+            add_kvp (trans);
+            xaccTransCommitEdit (trans);
+        }
+    }
+}
+
+static std::vector<time64>
+bench_dates (const BenchBook& bb)
+{
+    std::vector<time64> dates;
+    for (auto i = 1; i <= n_dates; ++i)
+        dates.push_back (bb.start + (time64)i * n_days / n_dates * 86400);
+    return dates;
+}
+
+static void
+run_query (const char* name, QofQuery* query, QofBook* book)
+{
+    qof_query_set_book (query, book);
+    auto start = Clock::now ();
+    auto found = qof_query_run (query);
+    add_result (name, start, g_list_length (found));
+    qof_query_destroy (query);
+}
+
+static void
+bench_queries (const BenchBook& bb)
+{
+    run_query ("query_all_splits", qof_query_create_for (GNC_ID_SPLIT), bb.book);
+
+    auto query = qof_query_create_for (GNC_ID_SPLIT);
+    auto middle = bb.start + (time64)n_days / 2 * 86400;
+    xaccQueryAddDateMatchTT (query, TRUE, middle, TRUE, middle + 30 * 86400,
+                             QOF_QUERY_AND);
+    run_query ("query_date_range", query, bb.book);
+
+    query = qof_query_create_for (GNC_ID_SPLIT);
+    xaccQueryAddSingleAccountMatch (query, bb.accounts[0], QOF_QUERY_AND);
+    run_query ("query_account", query, bb.book);
+}
+
+static void
+bench_balances (const BenchBook& bb)
+{
+    auto dates = bench_dates (bb);
+    auto start = Clock::now ();
+    for (auto account : bb.accounts)
+        for (auto date : dates)
+            xaccAccountGetBalanceAsOfDate (account, date);
+    add_result ("balance_as_of_date", start, bb.accounts.size () * dates.size ());
+}
+
+static void
+bench_price_conversion (const BenchBook& bb)
+{
+    auto pdb = gnc_pricedb_get_db (bb.book);
+    auto dates = bench_dates (bb);
+    std::size_t count = 0;
+    auto start = Clock::now ();
+    for (auto account : bb.accounts)
+    {
+        auto commodity = xaccAccountGetCommodity (account);
+        if (commodity == bb.currency)
+            continue;
+        for (auto date : dates)
+        {
+            gnc_pricedb_convert_balance_nearest_price_t64 (pdb,
+                xaccAccountGetBalanceAsOfDate (account, date), commodity,
+                bb.currency, date);
+            ++count;
+        }
+    }
+    add_result ("price_conversion", start, count);
+}
+
+static void
+bench_scrub (const BenchBook& bb)
+{
+    auto root = gnc_book_get_root_account (bb.book);
+    auto start = Clock::now ();
+    xaccAccountTreeScrubOrphans (root, nullptr);
+    xaccAccountTreeScrubImbalance (root, nullptr);
+    add_result ("scrub", start, bb.accounts.size ());
+}
+
+static bool
+have_backend (const char* access_method)
+{
+    auto methods = qof_backend_get_registered_access_method_list ();
+    auto found = g_list_find_custom (methods, access_method,
+                                     (GCompareFunc)g_strcmp0) != nullptr;
+    g_list_free (methods);
+    return found;
+}
+
+/* Save the book of session to uri and load it back, timing both. */
+static void
+bench_backend (const char* prefix, QofSession* session, const char* uri,
+               std::size_t n_items)
+{
+    auto save_session = qof_session_new (qof_book_new ());
+    qof_session_begin (save_session, uri, SESSION_NEW_OVERWRITE);
+    if (qof_session_get_error (save_session) != ERR_BACKEND_NO_ERR)
+    {
+        g_warning ("Can't create %s: %s", uri,
+                   qof_session_get_error_message (save_session));
+        qof_session_destroy (save_session);
+        return;
+    }
+    qof_session_swap_data (session, save_session);
+    qof_book_mark_session_dirty (qof_session_get_book (save_session));
+    auto start = Clock::now ();
+    qof_session_save (save_session, nullptr);
+    add_result ((std::string (prefix) + "_save").c_str (), start, n_items);
+    if (qof_session_get_error (save_session) != ERR_BACKEND_NO_ERR)
+        g_warning ("Saving %s failed: %s", uri,
+                   qof_session_get_error_message (save_session));
+    qof_session_swap_data (save_session, session);
+    qof_session_end (save_session);
+    qof_session_destroy (save_session);
+
+    auto load_session = qof_session_new (qof_book_new ());
+    qof_session_begin (load_session, uri, SESSION_READ_ONLY);
+    start = Clock::now ();
+    qof_session_load (load_session, nullptr);
+    add_result ((std::string (prefix) + "_load").c_str (), start, n_items);
+    if (qof_session_get_error (load_session) != ERR_BACKEND_NO_ERR)
+        g_warning ("Loading %s failed: %s", uri,
+                   qof_session_get_error_message (load_session));
+    qof_session_end (load_session);
+    qof_session_destroy (load_session);
+}
+
+static void
+print_results (void)
+{
+    printf ("{\n  \"seed\": %d,\n  \"accounts\": %d,\n"
+            "  \"transactions_per_account\": %d,\n  \"commodities\": %d,\n"
+            "  \"prices_per_commodity\": %d,\n  \"kvp_slots\": %d,\n"
+            "  \"results\": [", opt_seed, opt_accounts, opt_transactions,
+            opt_commodities, opt_prices, opt_kvp);
+    for (std::size_t i = 0; i < results.size (); ++i)
+        printf ("%s\n    {\"name\": \"%s\", \"ms\": %.3f, \"count\": %zu}",
+                i ? "," : "", results[i].name.c_str (), results[i].ms,
+                results[i].count);
+    printf ("\n  ]\n}\n");
+}
+
+int
+main (int argc, char** argv)
+{
+    GError* error = nullptr;
+    auto context = g_option_context_new ("- benchmark the engine over a generated book");
+    g_option_context_add_main_entries (context, options, nullptr);
+    if (!g_option_context_parse (context, &argc, &argv, &error))
+    {
+        fprintf (stderr, "%s\n", error->message);
+        g_error_free (error);
+        g_option_context_free (context);
+        return 1;
+    }
+    g_option_context_free (context);
+    if (opt_accounts < 1 || opt_transactions < 0 || opt_commodities < 0 ||
+        opt_prices < 0 || opt_kvp < 0)
+    {
+        fprintf (stderr, "The sizes can't be negative and there must be an account.\n");
+        return 1;
+    }
+
+    gnc_engine_init (0, nullptr);
+
+    srand (opt_seed);
+    auto session = qof_session_new (qof_book_new ());
+    BenchBook bb {};
+    bb.book = qof_session_get_book (session);
+    bb.start = gnc_dmy2time64_neutral (1, 1, 2010);
+    auto start = Clock::now ();
+    make_commodities (bb);
+    make_prices (bb);
+    make_accounts (bb);
+    make_transactions (bb);
+    auto n_transactions = bb.accounts.size () * opt_transactions;
+    add_result ("generate", start, n_transactions);
+
+    bench_queries (bb);
+    bench_balances (bb);
+    bench_price_conversion (bb);
+    bench_scrub (bb);
+
+    auto dir = opt_dir ? opt_dir : g_get_tmp_dir ();
+    if (have_backend ("xml"))
+    {
+        auto path = g_build_filename (dir, "gnc-bench.gnucash", nullptr);
+        auto uri = g_strconcat ("xml://", path, nullptr);
+        bench_backend ("xml", session, uri, n_transactions);
+        g_free (uri);
+        g_free (path);
+    }
+    else
+        g_warning ("The XML backend isn't loaded, skipping it.");
+
+    if (have_backend ("sqlite3"))
+    {
+        auto path = g_build_filename (dir, "gnc-bench.sqlite.gnucash", nullptr);
+        auto uri = g_strconcat ("sqlite3://", path, nullptr);
+        bench_backend ("sqlite", session, uri, n_transactions);
+        g_free (uri);
+        g_free (path);
+    }
+    else
+        g_warning ("The SQLite backend isn't loaded, skipping it.");
+
+    print_results ();
+
+    qof_session_destroy (session);
+    gnc_engine_shutdown ();
+    g_free (opt_dir);
+    return 0;
+}
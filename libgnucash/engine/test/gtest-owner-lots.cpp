@@ -0,0 +1,150 @@
+/********************************************************************
+ * gtest-owner-lots.cpp: Test the owner to open lots index.         *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+\********************************************************************/
+
+extern "C"
+{
+#include <config.h>
+#include "../Account.h"
+#include "../Split.h"
+#include "../Transaction.h"
+#include "../gnc-commodity.h"
+#include "../gnc-lot.h"
+#include "../gncCustomer.h"
+#include "../gncInvoice.h"
+#include "../gncOwner.h"
+#include <qof.h>
+}
+
+#include <gtest/gtest.h>
+
+class OwnerLotsTest : public testing::Test
+{
+protected:
+    void SetUp() {
+        m_book = qof_book_new();
+        m_currency = gnc_commodity_new (m_book, "US Dollar", "CURRENCY",
+                                        "USD", "0", 100);
+        auto root = gnc_account_create_root (m_book);
+        m_receivable = make_account (root, "A/R", ACCT_TYPE_RECEIVABLE);
+        m_income = make_account (root, "Income", ACCT_TYPE_INCOME);
+
+        m_customer = gncCustomerCreate (m_book);
+        gncCustomerBeginEdit (m_customer);
+        gncCustomerSetCurrency (m_customer, m_currency);
+        gncCustomerCommitEdit (m_customer);
+        gncOwnerInitCustomer (&m_owner, m_customer);
+    }
+    void TearDown() {
+        auto root = gnc_book_get_root_account (m_book);
+        xaccAccountBeginEdit (root);
+        xaccAccountDestroy (root);
+        qof_book_destroy (m_book);
+    }
+    Account* make_account (Account* parent, const char* name,
+                           GNCAccountType type) {
+        auto account = xaccMallocAccount (m_book);
+        xaccAccountBeginEdit (account);
+        xaccAccountSetName (account, name);
+        xaccAccountSetType (account, type);
+        xaccAccountSetCommodity (account, m_currency);
+        xaccAccountCommitEdit (account);
+        gnc_account_append_child (parent, account);
+        return account;
+    }
+    /* A transaction moving amount from income to the receivable account;
+     * returns its receivable split. */
+    Split* add_transaction (int64_t amount) {
+        auto trans = xaccMallocTransaction (m_book);
+        xaccTransBeginEdit (trans);
+        xaccTransSetCurrency (trans, m_currency);
+        xaccTransSetDatePostedSecs (trans, 1577880000);
+        auto value = gnc_numeric_create (amount, 1);
+        auto income = xaccMallocSplit (m_book);
+        xaccSplitSetParent (income, trans);
+        xaccSplitSetAccount (income, m_income);
+        xaccSplitSetValue (income, gnc_numeric_neg (value));
+        xaccSplitSetAmount (income, gnc_numeric_neg (value));
+        auto receivable = xaccMallocSplit (m_book);
+        xaccSplitSetParent (receivable, trans);
+        xaccSplitSetAccount (receivable, m_receivable);
+        xaccSplitSetValue (receivable, value);
+        xaccSplitSetAmount (receivable, value);
+        xaccTransCommitEdit (trans);
+        return receivable;
+    }
+    GNCLot* add_invoice_lot (int64_t amount) {
+        auto invoice = gncInvoiceCreate (m_book);
+        gncInvoiceBeginEdit (invoice);
+        gncInvoiceSetOwner (invoice, &m_owner);
+        gncInvoiceSetCurrency (invoice, m_currency);
+        gncInvoiceCommitEdit (invoice);
+        auto lot = gnc_lot_new (m_book);
+        gncInvoiceAttachToLot (invoice, lot);
+        gncOwnerAttachToLot (&m_owner, lot);
+        gnc_lot_add_split (lot, add_transaction (amount));
+        return lot;
+    }
+
+    QofBook* m_book {};
+    gnc_commodity* m_currency {};
+    Account* m_receivable {};
+    Account* m_income {};
+    GncCustomer* m_customer {};
+    GncOwner m_owner {};
+};
+
+TEST_F(OwnerLotsTest, balance_follows_lots)
+{
+    EXPECT_TRUE (gnc_numeric_zero_p (gncOwnerGetBalanceInCurrency (&m_owner, nullptr)));
+    EXPECT_EQ (nullptr, gncOwnerGetOpenLots (&m_owner));
+
+    /* The index now exists and must follow the new lots. */
+    auto first = add_invoice_lot (100);
+    add_invoice_lot (30);
+    EXPECT_TRUE (gnc_numeric_equal (gnc_numeric_create (130, 1),
+                                    gncOwnerGetBalanceInCurrency (&m_owner, nullptr)));
+    auto lots = gncOwnerGetOpenLots (&m_owner);
+    EXPECT_EQ (2u, g_list_length (lots));
+    g_list_free (lots);
+
+    /* Paying the first invoice closes its lot. */
+    gnc_lot_add_split (first, add_transaction (-100));
+    EXPECT_TRUE (gnc_numeric_equal (gnc_numeric_create (30, 1),
+                                    gncOwnerGetBalanceInCurrency (&m_owner, nullptr)));
+    lots = gncOwnerGetOpenLots (&m_owner);
+    EXPECT_EQ (1u, g_list_length (lots));
+    EXPECT_EQ (nullptr, g_list_find (lots, first));
+    g_list_free (lots);
+}
+
+TEST_F(OwnerLotsTest, prepayments_are_listed_but_not_counted)
+{
+    /* Build the index first. */
+    gncOwnerGetBalanceInCurrency (&m_owner, nullptr);
+    auto lot = gnc_lot_new (m_book);
+    gncOwnerAttachToLot (&m_owner, lot);
+    gnc_lot_add_split (lot, add_transaction (-50));
+    EXPECT_TRUE (gnc_numeric_zero_p (gncOwnerGetBalanceInCurrency (&m_owner, nullptr)));
+    auto lots = gncOwnerGetOpenLots (&m_owner);
+    EXPECT_EQ (1u, g_list_length (lots));
+    EXPECT_EQ (lot, lots->data);
+    g_list_free (lots);
+}
@@ -0,0 +1,133 @@
+/********************************************************************
+ * gtest-qof-arena.cpp -- unit tests for the QofArena allocator.    *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ *******************************************************************/
+
+#include "../qof-arena.hpp"
+#include <gtest/gtest.h>
+#include <cstdint>
+
+struct Arenaed
+{
+    static void* operator new(std::size_t size) { return qof_arena_operator_new(size); }
+    static void operator delete(void* ptr) noexcept { qof_arena_operator_delete(ptr); }
+    int64_t payload[3];
+};
+
+TEST(QofArena, allocate)
+{
+    QofArena arena{1024};
+    auto a = arena.allocate(10);
+    auto b = arena.allocate(10);
+    EXPECT_NE(a, b);
+    EXPECT_EQ(0U, reinterpret_cast<uintptr_t>(a) % alignof(std::max_align_t));
+    EXPECT_EQ(0U, reinterpret_cast<uintptr_t>(b) % alignof(std::max_align_t));
+    EXPECT_EQ(2U, arena.allocations());
+    EXPECT_EQ(1024U, arena.bytes_reserved());
+}
+
+TEST(QofArena, big_allocations)
+{
+    QofArena arena{1024};
+    arena.allocate(4096);
+    EXPECT_EQ(4096U, arena.bytes_reserved());
+    for (int i = 0; i < 200; ++i)
+        arena.allocate(24);
+    EXPECT_EQ(201U, arena.allocations());
+    EXPECT_GT(arena.bytes_reserved(), 4096U + 1024U);
+}
+
+TEST(QofArena, scope)
+{
+    EXPECT_EQ(nullptr, QofArena::current());
+    auto heap = new Arenaed;
+    EXPECT_FALSE(qof_arena_allocated(heap));
+    EXPECT_EQ(0U, reinterpret_cast<uintptr_t>(heap) % alignof(std::max_align_t));
+    {
+        QofArena arena;
+        QofArena::Scope scope{&arena};
+        EXPECT_EQ(&arena, QofArena::current());
+        auto obj = new Arenaed;
+        EXPECT_TRUE(qof_arena_allocated(obj));
+        EXPECT_EQ(0U, reinterpret_cast<uintptr_t>(obj) % alignof(std::max_align_t));
+        EXPECT_EQ(1U, arena.allocations());
+        delete obj;
+        {
+            QofArena::Scope none{nullptr};
+            EXPECT_EQ(nullptr, QofArena::current());
+            auto other = new Arenaed;
+            EXPECT_FALSE(qof_arena_allocated(other));
+            delete other;
+        }
+        EXPECT_EQ(&arena, QofArena::current());
+    }
+    EXPECT_EQ(nullptr, QofArena::current());
+    delete heap;
+}
+
+TEST(QofArena, delete_across_scopes)
+{
+    /* Where an object is deleted doesn't matter, only where it came
+     * from. */
+    QofArena arena;
+    Arenaed* heap = new Arenaed;
+    Arenaed* obj;
+    {
+        QofArena::Scope scope{&arena};
+        obj = new Arenaed;
+        delete heap;
+    }
+    EXPECT_TRUE(qof_arena_allocated(obj));
+    delete obj;
+    EXPECT_EQ(1U, arena.allocations());
+}
+
+TEST(QofArena, no_per_object_overhead)
+{
+    /* Objects take only their own, aligned, size from an arena. */
+    QofArena arena;
+    QofArena::Scope scope{&arena};
+    constexpr auto align = alignof(std::max_align_t);
+    constexpr auto size = (sizeof(Arenaed) + align - 1) / align * align;
+    auto obj = new Arenaed;
+    auto next = new Arenaed;
+    EXPECT_TRUE(qof_arena_allocated(obj));
+    EXPECT_EQ(2 * size, arena.bytes_used());
+    EXPECT_EQ(size, static_cast<std::size_t>(reinterpret_cast<char*>(next) -
+                                             reinterpret_cast<char*>(obj)));
+    delete next;
+    delete obj;
+}
+
+TEST(QofArena, outlives_arena)
+{
+    /* A free store object deleted after every arena is gone, and one
+     * that isn't in the chunks of a live arena. */
+    auto heap = new Arenaed;
+    {
+        QofArena arena{1024};
+        QofArena::Scope scope{&arena};
+        auto big = arena.allocate(4096);
+        EXPECT_TRUE(qof_arena_allocated(big));
+        EXPECT_TRUE(qof_arena_allocated(static_cast<char*>(big) + 4095));
+        EXPECT_FALSE(qof_arena_allocated(heap));
+    }
+    EXPECT_FALSE(qof_arena_allocated(heap));
+    delete heap;
+}
@@ -45,6 +45,27 @@ TEST(qof_query_construct_predicate, string)
     EXPECT_EQ (FALSE,                   pdata->is_regex);
 }
 
+TEST(qof_query_construct_predicate, string_caseinsensitive)
+{
+    query_string_def *pdata;
+    pdata = (query_string_def*)qof_query_string_predicate(
+        QOF_COMPARE_CONTAINS,
+        "TeSt",
+        QOF_STRING_MATCH_CASEINSENSITIVE,
+        FALSE
+    );
+    EXPECT_STREQ ("TeSt", pdata->matchstring);
+    EXPECT_STREQ ("test", pdata->folded);
+
+    pdata = (query_string_def*)qof_query_string_predicate(
+        QOF_COMPARE_CONTAINS,
+        "TeSt",
+        QOF_STRING_MATCH_CASEINSENSITIVE,
+        TRUE
+    );
+    EXPECT_EQ (NULL, pdata->folded);
+}
+
 TEST(qof_query_construct_predicate, date)
 {
     query_date_def *pdata;
@@ -88,6 +109,154 @@ TEST(qof_query_construct_predicate, guid)
     EXPECT_EQ (NULL,               pdata->guids->next);
 }
 
+TEST(qof_query_construct_predicate, guid_compile)
+{
+    qof_query_core_init();
+    GList *guidlist = g_list_prepend (NULL, guid_new());
+    query_guid_def *pdata;
+    pdata = (query_guid_def*)qof_query_guid_predicate(
+        QOF_GUID_MATCH_ANY,
+        guidlist
+    );
+    qof_query_core_predicate_compile ((QofQueryPredData*)pdata);
+    EXPECT_EQ (NULL, pdata->guid_set);
+    qof_query_core_predicate_free ((QofQueryPredData*)pdata);
+
+    for (int i = 0; i < 50; ++i)
+        guidlist = g_list_prepend (guidlist, guid_new());
+    pdata = (query_guid_def*)qof_query_guid_predicate(
+        QOF_GUID_MATCH_ANY,
+        guidlist
+    );
+    EXPECT_EQ (NULL, pdata->guid_set);
+    qof_query_core_predicate_compile ((QofQueryPredData*)pdata);
+    EXPECT_NE (nullptr, pdata->guid_set);
+    qof_query_core_predicate_free ((QofQueryPredData*)pdata);
+    g_list_free_full (guidlist, (GDestroyNotify)guid_free);
+}
+
+/* The objects of the guid match tests are GncGUIDs, or GLists of them for
+ * QOF_GUID_MATCH_ALL and QOF_GUID_MATCH_LIST_ANY. */
+static gpointer
+get_guid (gpointer object, const QofParam*)
+{
+    return object;
+}
+
+static gpointer
+get_guid_list (gpointer object, const QofParam*)
+{
+    return g_list_copy (static_cast<GList*>(object));
+}
+
+/* Indexes into the guids the predicate matches, with OUT for one it
+ * doesn't match, NUL for a NULL GncGUID* and NULL_GUID for guid_null(). */
+enum { OUT = -1, NUL = -2, NULL_GUID = -3, END = -4 };
+
+struct GuidMatchCase
+{
+    QofGuidMatch options;
+    int n_guids;          // the number of guids in the predicate
+    int object[12];       // the object's guid or guids, up to END
+    gboolean expected;
+};
+
+static const GuidMatchCase guid_match_cases[] =
+{
+    { QOF_GUID_MATCH_ANY, 10, { 3, END }, TRUE },
+    { QOF_GUID_MATCH_ANY, 10, { OUT, END }, FALSE },
+    { QOF_GUID_MATCH_ANY, 10, { NUL, END }, FALSE },
+    { QOF_GUID_MATCH_ANY, 10, { NULL_GUID, END }, FALSE },
+    { QOF_GUID_MATCH_ANY, 1, { 0, END }, TRUE },
+    { QOF_GUID_MATCH_ANY, 1, { OUT, END }, FALSE },
+    { QOF_GUID_MATCH_NONE, 10, { 3, END }, FALSE },
+    { QOF_GUID_MATCH_NONE, 10, { OUT, END }, TRUE },
+    { QOF_GUID_MATCH_NONE, 10, { NUL, END }, TRUE },
+    { QOF_GUID_MATCH_NONE, 10, { NULL_GUID, END }, TRUE },
+    { QOF_GUID_MATCH_NULL, 10, { 3, END }, FALSE },
+    { QOF_GUID_MATCH_NULL, 10, { OUT, END }, FALSE },
+    { QOF_GUID_MATCH_NULL, 10, { NUL, END }, TRUE },
+    { QOF_GUID_MATCH_NULL, 10, { NULL_GUID, END }, TRUE },
+    { QOF_GUID_MATCH_NULL, 0, { 3, END }, FALSE },
+    { QOF_GUID_MATCH_NULL, 0, { NUL, END }, TRUE },
+    { QOF_GUID_MATCH_NULL, 0, { NULL_GUID, END }, TRUE },
+    { QOF_GUID_MATCH_ALL, 10, { END }, FALSE },
+    { QOF_GUID_MATCH_ALL, 10, { 0, END }, FALSE },
+    { QOF_GUID_MATCH_ALL, 10, { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, END }, TRUE },
+    { QOF_GUID_MATCH_ALL, 10, { 9, 8, 7, 6, 5, OUT, 4, 3, 2, 1, 0, END }, TRUE },
+    { QOF_GUID_MATCH_ALL, 10, { 0, 1, 2, 3, 4, 5, 6, 7, 8, 8, 8, END }, FALSE },
+    { QOF_GUID_MATCH_ALL, 10, { OUT, NUL, END }, FALSE },
+    { QOF_GUID_MATCH_ALL, 1, { OUT, 0, END }, TRUE },
+    { QOF_GUID_MATCH_LIST_ANY, 10, { END }, FALSE },
+    { QOF_GUID_MATCH_LIST_ANY, 10, { OUT, END }, FALSE },
+    { QOF_GUID_MATCH_LIST_ANY, 10, { OUT, NUL, NULL_GUID, END }, FALSE },
+    { QOF_GUID_MATCH_LIST_ANY, 10, { OUT, 7, END }, TRUE },
+    { QOF_GUID_MATCH_LIST_ANY, 10, { 9, 9, END }, TRUE },
+    { QOF_GUID_MATCH_LIST_ANY, 1, { OUT, 0, END }, TRUE },
+};
+
+static GncGUID*
+case_guid (int index, GncGUID* guids, GncGUID* out)
+{
+    switch (index)
+    {
+    case OUT: return out;
+    case NUL: return nullptr;
+    case NULL_GUID: return const_cast<GncGUID*>(guid_null());
+    default: return &guids[index];
+    }
+}
+
+TEST(qof_query_core_predicate, guid_compiled_match)
+{
+    qof_query_core_init();
+    auto predicate = qof_query_core_get_predicate (QOF_TYPE_GUID);
+    ASSERT_NE (nullptr, predicate);
+    GncGUID guids[10], out;
+    for (auto& guid : guids)
+        guid_replace (&guid);
+    guid_replace (&out);
+
+    for (const auto& c : guid_match_cases)
+    {
+        GList *guidlist = nullptr;
+        for (int i = c.n_guids - 1; i >= 0; --i)
+            guidlist = g_list_prepend (guidlist, &guids[i]);
+        auto plain = qof_query_guid_predicate (c.options, guidlist);
+        auto compiled = qof_query_guid_predicate (c.options, guidlist);
+        g_list_free (guidlist);
+        ASSERT_NE (nullptr, plain);
+        qof_query_core_predicate_compile (compiled);
+        EXPECT_EQ (c.n_guids >= 8,
+                   ((query_guid_def*)compiled)->guid_set != nullptr);
+
+        gpointer object;
+        GList *objects = nullptr;
+        QofParam getter {};
+        if (c.options == QOF_GUID_MATCH_ALL || c.options == QOF_GUID_MATCH_LIST_ANY)
+        {
+            for (auto index = c.object; *index != END; ++index)
+                objects = g_list_append (objects, case_guid (*index, guids, &out));
+            object = objects;
+            getter.param_getfcn = c.options == QOF_GUID_MATCH_ALL ?
+                get_guid : get_guid_list;
+        }
+        else
+        {
+            object = case_guid (c.object[0], guids, &out);
+            getter.param_getfcn = get_guid;
+        }
+
+        SCOPED_TRACE (&c - guid_match_cases);
+        EXPECT_EQ (c.expected, predicate (object, &getter, plain));
+        EXPECT_EQ (c.expected, predicate (object, &getter, compiled));
+
+        g_list_free (objects);
+        qof_query_core_predicate_free (plain);
+        qof_query_core_predicate_free (compiled);
+    }
+}
+
 TEST(qof_query_construct_predicate, int32)
 {
     query_int32_def *pdata;
@@ -0,0 +1,190 @@
+/********************************************************************
+ * gtest-split-table.cpp: Test GncSplitTable.                       *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+\********************************************************************/
+
+extern "C"
+{
+#include <config.h>
+#include "../Account.h"
+#include "../Split.h"
+#include "../Transaction.h"
+#include "../gnc-commodity.h"
+#include <qof.h>
+}
+
+#include "../gnc-split-table.h"
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+class SplitTableTest : public testing::Test
+{
+protected:
+    void SetUp() {
+        m_book = qof_book_new();
+        m_currency = gnc_commodity_new (m_book, "US Dollar", "CURRENCY",
+                                        "USD", "0", 100);
+        auto root = gnc_account_create_root (m_book);
+        m_bank = make_account (root, "Bank");
+        m_food = make_account (root, "Food");
+        m_fuel = make_account (root, "Fuel");
+
+        /* 1 Jan, 2 Jan and 1 Feb 2020, noon UTC. */
+        add_transaction (1577880000, "Grocer", "weekly shop", m_food, 30);
+        add_transaction (1577966400, "garage", "", m_fuel, 40);
+        add_transaction (1580558400, "Baker", "Bread", m_food, 5);
+    }
+    void TearDown() {
+        auto root = gnc_book_get_root_account (m_book);
+        xaccAccountBeginEdit (root);
+        xaccAccountDestroy (root);
+        qof_book_destroy (m_book);
+    }
+    Account* make_account (Account* parent, const char* name) {
+        auto account = xaccMallocAccount (m_book);
+        xaccAccountBeginEdit (account);
+        xaccAccountSetName (account, name);
+        xaccAccountSetCommodity (account, m_currency);
+        xaccAccountCommitEdit (account);
+        gnc_account_append_child (parent, account);
+        return account;
+    }
+    void add_transaction (time64 date, const char* description,
+                          const char* memo, Account* expense, int64_t amount) {
+        auto trans = xaccMallocTransaction (m_book);
+        xaccTransBeginEdit (trans);
+        xaccTransSetCurrency (trans, m_currency);
+        xaccTransSetDatePostedSecs (trans, date);
+        xaccTransSetDescription (trans, description);
+        auto value = gnc_numeric_create (amount, 1);
+        auto from = xaccMallocSplit (m_book);
+        xaccSplitSetParent (from, trans);
+        xaccSplitSetAccount (from, m_bank);
+        xaccSplitSetValue (from, gnc_numeric_neg (value));
+        xaccSplitSetAmount (from, gnc_numeric_neg (value));
+        auto to = xaccMallocSplit (m_book);
+        xaccSplitSetParent (to, trans);
+        xaccSplitSetAccount (to, expense);
+        xaccSplitSetMemo (to, memo);
+        xaccSplitSetValue (to, value);
+        xaccSplitSetAmount (to, value);
+        xaccTransCommitEdit (trans);
+        m_bank_splits.push_back (from);
+    }
+    /* The bank splits in the order they were created. */
+    GList* bank_splits () {
+        GList* list = nullptr;
+        for (auto it = m_bank_splits.rbegin (); it != m_bank_splits.rend (); ++it)
+            list = g_list_prepend (list, *it);
+        return list;
+    }
+    std::vector<std::string> descriptions (GncSplitTable* table) {
+        std::vector<std::string> result;
+        for (guint row = 0; row < gnc_split_table_get_n_rows (table); ++row)
+            result.push_back (xaccTransGetDescription (xaccSplitGetParent (gnc_split_table_get_split (table, row))));
+        return result;
+    }
+
+    QofBook* m_book {};
+    gnc_commodity* m_currency {};
+    Account* m_bank {};
+    Account* m_food {};
+    Account* m_fuel {};
+    std::vector<Split*> m_bank_splits;
+};
+
+TEST_F(SplitTableTest, unsorted_keeps_order)
+{
+    auto table = gnc_split_table_new ();
+    auto splits = bank_splits ();
+    gnc_split_table_build (table, splits, FALSE);
+    EXPECT_EQ (descriptions (table),
+               (std::vector<std::string> {"Grocer", "garage", "Baker"}));
+    EXPECT_EQ (GNC_SPLIT_TABLE_NO_END, gnc_split_table_get_group_end (table, 2));
+    auto result = gnc_split_table_get_splits (table);
+    EXPECT_EQ (3u, g_list_length (result));
+    EXPECT_EQ (m_bank_splits[0], result->data);
+    g_list_free (result);
+    g_list_free (splits);
+    gnc_split_table_free (table);
+}
+
+TEST_F(SplitTableTest, account_filter)
+{
+    auto table = gnc_split_table_new ();
+    auto splits = bank_splits ();
+    auto accounts = g_list_prepend (nullptr, m_food);
+    gnc_split_table_set_account_filter (table, accounts, FALSE);
+    gnc_split_table_build (table, splits, FALSE);
+    EXPECT_EQ (descriptions (table),
+               (std::vector<std::string> {"Grocer", "Baker"}));
+    gnc_split_table_set_account_filter (table, accounts, TRUE);
+    gnc_split_table_build (table, splits, FALSE);
+    EXPECT_EQ (descriptions (table), (std::vector<std::string> {"garage"}));
+    g_list_free (accounts);
+    g_list_free (splits);
+    gnc_split_table_free (table);
+}
+
+TEST_F(SplitTableTest, matcher)
+{
+    auto table = gnc_split_table_new ();
+    auto splits = bank_splits ();
+    /* Memos of the other splits in the transaction don't count. */
+    EXPECT_TRUE (gnc_split_table_set_matcher (table, "BREAD", FALSE, TRUE, FALSE));
+    gnc_split_table_build (table, splits, FALSE);
+    EXPECT_EQ (0u, gnc_split_table_get_n_rows (table));
+    EXPECT_TRUE (gnc_split_table_set_matcher (table, "GR", FALSE, TRUE, FALSE));
+    gnc_split_table_build (table, splits, FALSE);
+    EXPECT_EQ (descriptions (table), (std::vector<std::string> {"Grocer"}));
+    EXPECT_TRUE (gnc_split_table_set_matcher (table, "^[gG]", TRUE, FALSE, TRUE));
+    gnc_split_table_build (table, splits, FALSE);
+    EXPECT_EQ (descriptions (table), (std::vector<std::string> {"Baker"}));
+    EXPECT_FALSE (gnc_split_table_set_matcher (table, "(", TRUE, FALSE, FALSE));
+    gnc_split_table_build (table, splits, FALSE);
+    EXPECT_EQ (3u, gnc_split_table_get_n_rows (table));
+    g_list_free (splits);
+    gnc_split_table_free (table);
+}
+
+TEST_F(SplitTableTest, sort_and_group)
+{
+    auto table = gnc_split_table_new ();
+    auto splits = bank_splits ();
+    EXPECT_FALSE (gnc_split_table_set_sort_key (table, 0, "colour", "none", TRUE, TRUE));
+    EXPECT_FALSE (gnc_split_table_set_sort_key (table, 0, "date", "hourly", TRUE, TRUE));
+    EXPECT_TRUE (gnc_split_table_set_sort_key (table, 0, "date", "monthly", FALSE, TRUE));
+    EXPECT_TRUE (gnc_split_table_set_sort_key (table, 1, "amount", "none", FALSE, FALSE));
+    gnc_split_table_build (table, splits, TRUE);
+    /* Amounts are negative in the bank account. */
+    EXPECT_EQ (descriptions (table),
+               (std::vector<std::string> {"Baker", "Grocer", "garage"}));
+    EXPECT_EQ (GNC_SPLIT_TABLE_PRIMARY_END, gnc_split_table_get_group_end (table, 0));
+    EXPECT_EQ (GNC_SPLIT_TABLE_NO_END, gnc_split_table_get_group_end (table, 1));
+    EXPECT_EQ (GNC_SPLIT_TABLE_PRIMARY_END, gnc_split_table_get_group_end (table, 2));
+
+    EXPECT_TRUE (gnc_split_table_set_sort_key (table, 0, "none", "none", TRUE, FALSE));
+    EXPECT_TRUE (gnc_split_table_set_sort_key (table, 1, "description", "none", TRUE, TRUE));
+    gnc_split_table_build (table, splits, TRUE);
+    EXPECT_EQ (GNC_SPLIT_TABLE_SECONDARY_END, gnc_split_table_get_group_end (table, 0));
+    EXPECT_EQ (GNC_SPLIT_TABLE_SECONDARY_END, gnc_split_table_get_group_end (table, 2));
+    g_list_free (splits);
+    gnc_split_table_free (table);
+}
@@ -31,6 +31,7 @@
 
 #include "cashobjects.h"
 #include "gncCustomerP.h"
+#include "gncIDSearch.h"
 #include "gncInvoiceP.h"
 #include "gncJobP.h"
 #include "test-stuff.h"
@@ -132,6 +133,32 @@ test_customer (void)
         do_test (gncCustomerLookup (book, guid) == customer, "Entity Table");
     }
 
+    /* Test the ID search, before and after the index is built */
+    {
+        GncCustomer *found = gncCustomerCreate (book);
+
+        gncCustomerBeginEdit (found);
+        gncCustomerSetID (found, "search-1");
+        gncCustomerCommitEdit (found);
+        do_test (gnc_search_customer_on_id (book, "search-1") == found,
+                 "search on id");
+        do_test (gnc_search_customer_on_id (book, "search-2") == NULL,
+                 "search on unknown id");
+
+        gncCustomerBeginEdit (found);
+        gncCustomerSetID (found, "search-2");
+        gncCustomerCommitEdit (found);
+        do_test (gnc_search_customer_on_id (book, "search-1") == NULL,
+                 "search on changed id");
+        do_test (gnc_search_customer_on_id (book, "search-2") == found,
+                 "search on new id");
+
+        gncCustomerBeginEdit (found);
+        gncCustomerDestroy (found);
+        do_test (gnc_search_customer_on_id (book, "search-2") == NULL,
+                 "search on destroyed customer");
+    }
+
     /* Note: JobList is tested from the Job tests */
     qof_book_destroy (book);
 }
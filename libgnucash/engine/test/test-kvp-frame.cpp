@@ -181,6 +181,62 @@ TEST_F (KvpFrameTest, GetSlotPath)
     EXPECT_EQ (v1, t_root.get_slot(path3a));
 }
 
+TEST_F (KvpFrameTest, StringPath)
+{
+    auto v1 = new KvpValueImpl {15.0};
+    auto v2 = new KvpValueImpl { (int64_t)52};
+    std::string path1 {"top/second/twenty/twenty-first"};
+
+    EXPECT_EQ (t_int_val, t_root.get_slot("top/first"));
+    EXPECT_EQ (t_str_val, t_root.get_slot(std::string_view {"/top//third"}));
+    EXPECT_EQ (nullptr, t_root.get_slot("top/first/nothing"));
+    EXPECT_EQ (nullptr, t_root.get_slot(""));
+    EXPECT_EQ (nullptr, t_root.set_path(path1, v1));
+    EXPECT_EQ (v1, t_root.get_slot({"top", "second", "twenty", "twenty-first"}));
+    EXPECT_EQ (v1, t_root.set_path(path1, v2));
+    EXPECT_EQ (v2, t_root.get_slot(path1));
+    delete v1;
+}
+
+TEST_F (KvpFrameTest, ManySlots)
+{
+    KvpFrameImpl fr;
+    std::vector<std::string> keys;
+    for (auto i = 0; i < 40; ++i)
+        keys.push_back (std::to_string ((i * 17) % 40));
+    for (auto const & key : keys)
+        EXPECT_EQ (nullptr, fr.set({key}, new KvpValue {INT64_C(1)}));
+    auto stored = fr.get_keys ();
+    EXPECT_EQ (keys.size (), stored.size ());
+    EXPECT_TRUE (std::is_sorted (stored.begin (), stored.end ()));
+    for (auto const & key : keys)
+        EXPECT_NE (nullptr, fr.get_slot(key));
+    delete fr.set({"17"}, nullptr);
+    EXPECT_EQ (nullptr, fr.get_slot("17"));
+    EXPECT_EQ (keys.size () - 1, fr.get_keys ().size ());
+    KvpFrameImpl copy {fr};
+    EXPECT_EQ (0, compare (fr, copy));
+}
+
+TEST_F (KvpFrameTest, PointersSurviveInserts)
+{
+    KvpFrameImpl fr;
+    auto value = new KvpValue {INT64_C(1)};
+    fr.set({"m"}, value);
+    fr.set_path({"n", "leaf"}, new KvpValue {INT64_C(2)});
+    auto child = fr.get_slot({"n"})->get<KvpFrame*>();
+    /* Grow past the inline slots and insert on both sides of the held
+     * keys so the slots move. */
+    for (auto key : {"a", "z", "b", "y", "c", "x"})
+        fr.set_path({key, "leaf"}, new KvpValue {INT64_C(3)});
+    EXPECT_EQ (value, fr.get_slot({"m"}));
+    EXPECT_EQ (child, fr.get_slot({"n"})->get<KvpFrame*>());
+    EXPECT_EQ (2, child->get_slot({"leaf"})->get<int64_t>());
+    delete fr.set({"a"}, nullptr);
+    EXPECT_EQ (value, fr.get_slot({"m"}));
+    EXPECT_EQ (child, fr.get_slot({"n"})->get<KvpFrame*>());
+}
+
 TEST_F (KvpFrameTest, Empty)
 {
     KvpFrameImpl f1, f2;
@@ -77,8 +77,64 @@ test_qof_string_cache( void )
     g_assert(str1_1 != str1_4);
 }
 
+static void
+test_qof_string_cache_immortal( Fixture *fixture, gconstpointer pData )
+{
+    /* Strings inserted in immortal mode survive any number of removes,
+     * strings inserted afterwards are refcounted again. */
+    QofStringCacheStats before, after;
+    gchar* imm;
+    gchar* mortal;
+
+    qof_string_cache_get_stats(&before);
+    qof_string_cache_begin_immortal();
+    imm = qof_string_cache_insert("immortal test string");
+    qof_string_cache_end_immortal();
+    qof_string_cache_remove(imm);
+    qof_string_cache_remove(imm);
+    g_assert(qof_string_cache_insert("immortal test string") == imm);
+
+    mortal = qof_string_cache_insert("mortal test string");
+    qof_string_cache_get_stats(&after);
+    g_assert_cmpuint(after.immortal_strings, ==, before.immortal_strings + 1);
+    g_assert_cmpuint(after.strings, ==, before.strings + 2);
+    g_assert_cmpuint(after.inserts, ==, before.inserts + 3);
+    g_assert_cmpuint(after.hits, ==, before.hits + 1);
+    g_assert_cmpuint(after.bytes_saved, ==,
+                     before.bytes_saved + strlen("immortal test string") + 1);
+
+    qof_string_cache_remove(mortal);
+    qof_string_cache_get_stats(&after);
+    g_assert_cmpuint(after.strings, ==, before.strings + 1);
+}
+
+static void
+test_qof_string_cache_casefold( Fixture *fixture, gconstpointer pData )
+{
+    /* Only the cached copy of a string has a folded form, and it's kept
+     * until the string leaves the cache. */
+    gchar str[100];
+    gchar* cached;
+    const gchar* folded;
+
+    strncpy(str, "Caf\xc3\xa9 MEMO", sizeof(str));
+    cached = qof_string_cache_insert(str);
+    g_assert(qof_string_cache_casefold(str) == NULL);
+    folded = qof_string_cache_casefold(cached);
+    g_assert_cmpstr(folded, ==, "cafe\xcc\x81 memo");
+    g_assert(qof_string_cache_casefold(cached) == folded);
+    g_assert_cmpstr(qof_string_cache_casefold(""), ==, "");
+    g_assert(qof_string_cache_casefold(NULL) == NULL);
+    qof_string_cache_remove(cached);
+    g_assert(qof_string_cache_casefold("never cached") == NULL);
+}
+
 void
 test_suite_qof_string_cache ( void )
 {
     GNC_TEST_ADD_FUNC( suitename, "string-cache", test_qof_string_cache);
+    GNC_TEST_ADD( suitename, "string-cache-immortal", Fixture, NULL, setup,
+                  test_qof_string_cache_immortal, teardown);
+    GNC_TEST_ADD( suitename, "string-cache-casefold", Fixture, NULL, setup,
+                  test_qof_string_cache_casefold, teardown);
 }
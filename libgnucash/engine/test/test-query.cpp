@@ -26,6 +26,7 @@ extern "C"
 #include <glib.h>
 #include "qof.h"
 #include "cashobjects.h"
+#include "Query.h"
 #include "Transaction.h"
 #include "TransLog.h"
 #include "gnc-engine.h"
@@ -67,6 +68,180 @@ test_trans_query (Transaction *trans, gpointer data)
     return 0;
 }
 
+static gboolean
+same_results (GList *incr, GList *all)
+{
+    for (; incr && all; incr = incr->next, all = all->next)
+        if (incr->data != all->data)
+            return FALSE;
+    return !incr && !all;
+}
+
+static void
+test_incremental_query (QofBook *book)
+{
+    QofQuery *q, *full;
+    GList *changed = NULL, *removed = NULL, *results, *incr, *node;
+    Transaction *added, *modified, *deleted;
+    Split *moved;
+    guint n_before, n_added, n_deleted;
+    gboolean ok = TRUE;
+
+    q = qof_query_create_for (GNC_ID_SPLIT);
+    qof_query_set_book (q, book);
+    results = qof_query_run (q);
+    n_before = g_list_length (results);
+    if (n_before < 2)
+    {
+        qof_query_destroy (q);
+        return;
+    }
+
+    /* Modify the transaction of the first split, moving it to a new
+     * date so that its splits sort elsewhere. Voided transactions are
+     * read-only and are left alone. */
+    for (node = results; node; node = node->next)
+        if (!xaccTransGetReadOnly (xaccSplitGetParent (GNC_SPLIT (node->data))))
+            break;
+    if (!node)
+    {
+        qof_query_destroy (q);
+        return;
+    }
+    moved = GNC_SPLIT (node->data);
+    modified = xaccSplitGetParent (moved);
+    xaccTransBeginEdit (modified);
+    xaccTransSetDatePostedSecsNormalized (modified, get_random_time ());
+    xaccTransCommitEdit (modified);
+    changed = g_list_copy (xaccTransGetSplitList (modified));
+
+    /* Delete the transaction of the last split, keeping only the
+     * addresses of its splits. */
+    deleted = NULL;
+    for (node = g_list_last (results); node; node = node->prev)
+    {
+        Transaction *trans = xaccSplitGetParent (GNC_SPLIT (node->data));
+        if (trans != modified && !xaccTransGetReadOnly (trans))
+        {
+            deleted = trans;
+            break;
+        }
+    }
+    n_deleted = 0;
+    if (deleted)
+    {
+        removed = g_list_copy (xaccTransGetSplitList (deleted));
+        n_deleted = g_list_length (removed);
+        xaccTransBeginEdit (deleted);
+        xaccTransDestroy (deleted);
+        xaccTransCommitEdit (deleted);
+    }
+
+    /* Add a new transaction. */
+    added = get_random_transaction (book);
+    n_added = added ? xaccTransCountSplits (added) : 0;
+    if (added)
+        changed = g_list_concat (changed,
+                                 g_list_copy (xaccTransGetSplitList (added)));
+
+    incr = qof_query_run_incremental (q, changed, removed);
+
+    if (g_list_length (incr) != n_before + n_added - n_deleted)
+    {
+        failure_args ("incremental query", __FILE__, __LINE__,
+                      "incremental results %d, expected %d",
+                      g_list_length (incr), n_before + n_added - n_deleted);
+        ok = FALSE;
+    }
+    for (node = removed; node; node = node->next)
+        if (g_list_find (incr, node->data))
+        {
+            failure ("incremental query kept a deleted split");
+            ok = FALSE;
+        }
+    if (added)
+        for (node = xaccTransGetSplitList (added); node; node = node->next)
+            if (!g_list_find (incr, node->data))
+            {
+                failure ("incremental query missed an added split");
+                ok = FALSE;
+            }
+    if (!g_list_find (incr, moved))
+    {
+        failure ("incremental query lost a modified split");
+        ok = FALSE;
+    }
+
+    full = qof_query_copy (q);
+    if (!same_results (incr, qof_query_run (full)))
+    {
+        failure ("incremental query differs from the full query");
+        ok = FALSE;
+    }
+    if (ok)
+        success ("incremental query follows added, modified and deleted splits");
+
+    g_list_free (changed);
+    g_list_free (removed);
+    qof_query_destroy (full);
+    qof_query_destroy (q);
+}
+
+static void
+count_split_in_range (QofInstance *inst, gpointer data)
+{
+    time64 *range = static_cast<time64*>(data);
+    Transaction *trans = xaccSplitGetParent (GNC_SPLIT (inst));
+
+    if (trans && xaccTransGetDate (trans) >= range[0] &&
+        xaccTransGetDate (trans) <= range[1])
+        range[2]++;
+}
+
+static void
+test_date_range_query (QofBook *book)
+{
+    QofQuery *q;
+    GList *list, *node;
+    time64 range[3];
+    guint count;
+
+    range[0] = get_random_time ();
+    range[1] = get_random_time ();
+    if (range[0] > range[1])
+    {
+        time64 tmp = range[0];
+        range[0] = range[1];
+        range[1] = tmp;
+    }
+
+    q = qof_query_create_for (GNC_ID_SPLIT);
+    qof_query_set_book (q, book);
+    xaccQueryAddDateMatchTT (q, TRUE, range[0], TRUE, range[1], QOF_QUERY_AND);
+
+    /* Run twice: once building the date index, once using it after
+     * more transactions were committed. */
+    qof_query_run (q);
+    add_random_transactions_to_book (book, 10);
+    range[2] = 0;
+    qof_collection_foreach (qof_book_get_collection (book, GNC_ID_SPLIT),
+                            count_split_in_range, range);
+
+    list = qof_query_run (q);
+    count = 0;
+    for (node = list; node; node = node->next)
+        count++;
+
+    if (count != range[2])
+        failure_args ("date range query", __FILE__, __LINE__,
+                      "date index found %d splits, expected %d",
+                      count, (int)range[2]);
+    else
+        success ("date range query matches full scan");
+
+    qof_query_destroy (q);
+}
+
 static void
 run_test (void)
 {
@@ -82,6 +257,9 @@ run_test (void)
 
     xaccAccountTreeForEachTransaction (root, test_trans_query, book);
 
+    test_incremental_query (book);
+    test_date_range_query (book);
+
     qof_session_end (session);
 }
 
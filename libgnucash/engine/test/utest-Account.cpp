@@ -1933,6 +1933,143 @@ test_xaccAccountGetBalanceAsOfDate (Fixture *fixture, gconstpointer pData)
                                          (gnc_time (NULL) - offset));
     dval = gnc_numeric_to_double (val);
     g_assert_cmpfloat (dval, == , dbal);
+
+    /* Dates after and before the last one asked for give the sum of
+     * the splits posted before them. */
+    time64 dates[] = {gnc_time (NULL) + offset, gnc_time (NULL) - 4 * offset,
+                      gnc_time (NULL), gnc_time (NULL) - offset};
+    for (auto date : dates)
+    {
+        bal = gnc_numeric_zero ();
+        for (GList *node = xaccAccountGetSplitList (fixture->acct); node;
+             node = node->next)
+        {
+            Split *split = (Split*)node->data;
+            if (xaccTransGetDate (xaccSplitGetParent (split)) < date)
+                bal = gnc_numeric_add_fixed (bal, xaccSplitGetAmount (split));
+        }
+        val = xaccAccountGetBalanceAsOfDate (fixture->acct, date);
+        g_assert (gnc_numeric_eq (val, bal));
+    }
+}
+/* gnc_account_set_balance_checkpoints
+void
+gnc_account_set_balance_checkpoints (Account *acc,
+                                     const GncBalanceCheckpoint *checkpoints,
+                                     guint n_checkpoints)
+gboolean
+gnc_account_get_balance_checkpoint (const Account *acc, time64 date,
+                                    GncBalanceCheckpoint *checkpoint)
+*/
+static void
+test_gnc_account_balance_checkpoints (Fixture *fixture, gconstpointer pData)
+{
+    GncBalanceCheckpoint cps[2], found;
+    time64 date = gnc_time (NULL) - 24 * 3600 * 3;
+    gnc_numeric bal, prev, bump = gnc_numeric_create (100, 1);
+
+    xaccAccountRecomputeBalance (fixture->acct);
+    bal = xaccAccountGetBalanceAsOfDate (fixture->acct, date);
+    prev = xaccAccountGetBalanceAsOfDate (fixture->acct, date - 1);
+    g_assert (!gnc_account_get_balance_checkpoint (fixture->acct, date, NULL));
+
+    /* An early empty checkpoint: the splits since are added to it. */
+    cps[0].date = 1;
+    cps[0].balance = cps[0].cleared_balance = cps[0].reconciled_balance =
+        gnc_numeric_zero ();
+    /* A checkpoint on the date is used as it is. */
+    cps[1].date = date;
+    cps[1].balance = cps[1].cleared_balance = cps[1].reconciled_balance =
+        gnc_numeric_add_fixed (bal, bump);
+    gnc_account_set_balance_checkpoints (fixture->acct, cps, 2);
+
+    g_assert (!gnc_account_get_balance_checkpoint (fixture->acct, 0, &found));
+    g_assert (gnc_account_get_balance_checkpoint (fixture->acct, date - 1,
+                                                  &found));
+    g_assert_cmpint (found.date, ==, 1);
+    g_assert (gnc_numeric_eq (xaccAccountGetBalanceAsOfDate (fixture->acct,
+                                                             date - 1),
+                              prev));
+    g_assert (gnc_numeric_eq (xaccAccountGetBalanceAsOfDate (fixture->acct,
+                                                             date),
+                              cps[1].balance));
+
+    /* One from before the splits which are sure to be loaded isn't used. */
+    gnc_account_set_splits_loaded_since (fixture->acct, date + 1);
+    g_assert (gnc_numeric_eq (xaccAccountGetBalanceAsOfDate (fixture->acct,
+                                                             date), bal));
+    gnc_account_set_splits_loaded_since (fixture->acct, INT64_MIN);
+
+    gnc_account_set_balance_checkpoints (fixture->acct, cps, 1);
+    g_assert (gnc_numeric_eq (xaccAccountGetBalanceAsOfDate (fixture->acct,
+                                                             date), bal));
+
+    gnc_account_set_balance_checkpoints (fixture->acct, NULL, 0);
+    g_assert (!gnc_account_get_balance_checkpoint (fixture->acct, date, NULL));
+    g_assert (gnc_numeric_eq (xaccAccountGetBalanceAsOfDate (fixture->acct,
+                                                             date), bal));
+}
+/* gnc_balance_matrix_new
+GncBalanceMatrix *
+gnc_balance_matrix_new (GncBalanceFlags flags)
+*/
+static void
+test_gnc_balance_matrix (Fixture *fixture, gconstpointer pData)
+{
+    time64 now = gnc_time (NULL), day = 24 * 3600;
+    time64 dates[] = {now - 3 * day, now - 10 * day, now, now - 4 * day};
+    GncBalanceMatrix *matrix = gnc_balance_matrix_new (GncBalanceFlags (0));
+    guint row, col;
+
+    xaccAccountRecomputeBalance (fixture->acct);
+    row = gnc_balance_matrix_add_account (matrix, fixture->acct);
+    g_assert_cmpint (row, ==, 0);
+    for (col = 0; col < G_N_ELEMENTS (dates); ++col)
+        g_assert_cmpint (gnc_balance_matrix_add_date (matrix, dates[col]), ==,
+                         col);
+
+    g_assert_cmpint (gnc_balance_matrix_get_n_commodities (matrix, row), ==, 1);
+    g_assert (gnc_balance_matrix_get_commodity (matrix, row, 0) ==
+              xaccAccountGetCommodity (fixture->acct));
+    /* Balances include the splits posted on the date itself. */
+    for (col = 0; col < G_N_ELEMENTS (dates); ++col)
+        g_assert (gnc_numeric_eq (gnc_balance_matrix_get_balance (matrix, row,
+                                                                  0, col),
+                                  xaccAccountGetBalanceAsOfDate (fixture->acct,
+                                                                 dates[col] + 1)));
+    gnc_balance_matrix_free (matrix);
+
+    matrix = gnc_balance_matrix_new (GNC_BALANCE_CLEARED_ONLY);
+    row = gnc_balance_matrix_add_account (matrix, fixture->acct);
+    gnc_balance_matrix_add_date (matrix, now + 1000 * day);
+    g_assert (gnc_numeric_eq (gnc_balance_matrix_get_balance (matrix, row, 0, 0),
+                              xaccAccountGetClearedBalance (fixture->acct)));
+    gnc_balance_matrix_free (matrix);
+
+    /* Both filters apply together: clear every split and make the
+     * first transaction a closing one. */
+    auto splits = xaccAccountGetSplitList (fixture->acct);
+    g_assert (splits && splits->next);
+    auto closing = xaccSplitGetParent (static_cast<Split*> (splits->data));
+    gnc_numeric expected = gnc_numeric_zero ();
+    for (auto node = splits; node; node = node->next)
+    {
+        auto split = static_cast<Split*> (node->data);
+        xaccSplitSetReconcile (split, CREC);
+        if (xaccSplitGetParent (split) != closing)
+            expected = gnc_numeric_add_fixed (expected,
+                                              xaccSplitGetAmount (split));
+    }
+    xaccTransBeginEdit (closing);
+    xaccTransSetIsClosingTxn (closing, TRUE);
+    xaccTransCommitEdit (closing);
+    matrix = gnc_balance_matrix_new (GncBalanceFlags (GNC_BALANCE_CLEARED_ONLY |
+                                                      GNC_BALANCE_EXCLUDE_CLOSING));
+    row = gnc_balance_matrix_add_account (matrix, fixture->acct);
+    gnc_balance_matrix_add_date (matrix, now + 1000 * day);
+    g_assert (gnc_numeric_eq (gnc_balance_matrix_get_balance (matrix, row, 0, 0),
+                              expected));
+    gnc_balance_matrix_free (matrix);
 }
 /* xaccAccountGetPresentBalance
 gnc_numeric
@@ -2580,6 +2717,8 @@ test_suite_account (void)
     GNC_TEST_ADD (suitename, "gnc account get full name", Fixture, &good_data, setup, test_gnc_account_get_full_name,  teardown );
     GNC_TEST_ADD (suitename, "xaccAccountGetProjectedMinimumBalance", Fixture, &some_data, setup, test_xaccAccountGetProjectedMinimumBalance,  teardown );
     GNC_TEST_ADD (suitename, "xaccAccountGetBalanceAsOfDate", Fixture, &some_data, setup, test_xaccAccountGetBalanceAsOfDate,  teardown );
+    GNC_TEST_ADD (suitename, "gnc_account_balance_checkpoints", Fixture, &some_data, setup, test_gnc_account_balance_checkpoints,  teardown );
+    GNC_TEST_ADD (suitename, "gnc_balance_matrix", Fixture, &some_data, setup, test_gnc_balance_matrix,  teardown );
     GNC_TEST_ADD (suitename, "xaccAccountGetPresentBalance", Fixture, &some_data, setup, test_xaccAccountGetPresentBalance,  teardown );
     GNC_TEST_ADD (suitename, "xaccAccountFindOpenLots", Fixture, &complex_data, setup, test_xaccAccountFindOpenLots,  teardown );
     GNC_TEST_ADD (suitename, "xaccAccountForEachLot", Fixture, &complex_data, setup, test_xaccAccountForEachLot,  teardown );
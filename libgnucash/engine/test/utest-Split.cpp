@@ -1890,6 +1890,59 @@ test_xaccSplitVoid (Fixture *fixture, gconstpointer pData)
  * qofSplitSetParentTrans // Not Used
  * qofSplitSetAccount // Not Used
  */
+/* xaccBookForeachSplitInDateRange
+void
+xaccBookForeachSplitInDateRange (QofBook *book, time64 start, time64 end,
+                                 QofInstanceForeachCB cb, gpointer user_data)
+*/
+static void
+count_split_cb (QofInstance *inst, gpointer data)
+{
+    ++*static_cast<int*>(data);
+}
+
+static int
+count_splits_in_range (QofBook *book, time64 start, time64 end)
+{
+    int count = 0;
+    xaccBookForeachSplitInDateRange (book, start, end, count_split_cb, &count);
+    return count;
+}
+
+static void
+test_xaccBookForeachSplitInDateRange ()
+{
+    QofBook *book = qof_book_new ();
+    gnc_commodity *gnaira = gnc_commodity_new (book, "Gnaira", "CURRENCY",
+                            "GNA", "", 240);
+    Account *acc = xaccMallocAccount (book);
+    const time64 dates[] = { 100, 200, 200, 300, 400 };
+
+    xaccAccountSetCommodity (acc, gnaira);
+    for (auto date : dates)
+    {
+        Transaction *txn = xaccMallocTransaction (book);
+        Split *split = xaccMallocSplit (book);
+
+        xaccTransBeginEdit (txn);
+        xaccTransSetCurrency (txn, gnaira);
+        xaccTransSetDatePostedSecs (txn, date);
+        xaccSplitSetAccount (split, acc);
+        xaccSplitSetParent (split, txn);
+        xaccTransCommitEdit (txn);
+    }
+
+    g_assert_cmpint (count_splits_in_range (book, 0, 99), ==, 0);
+    g_assert_cmpint (count_splits_in_range (book, 0, 100), ==, 1);
+    g_assert_cmpint (count_splits_in_range (book, 200, 200), ==, 2);
+    g_assert_cmpint (count_splits_in_range (book, 200, 300), ==, 3);
+    g_assert_cmpint (count_splits_in_range (book, 201, 299), ==, 0);
+    g_assert_cmpint (count_splits_in_range (book, 300, 1000), ==, 2);
+    g_assert_cmpint (count_splits_in_range (book, 401, 1000), ==, 0);
+    g_assert_cmpint (count_splits_in_range (book, 0, 1000), ==, 5);
+
+    qof_book_destroy (book);
+}
 /* This is the QofObject initialization function:
  * xaccSplitRegister // C: 1  Local: 1:0:0
  */
@@ -1935,5 +1988,6 @@ test_suite_split (void)
     GNC_TEST_ADD (suitename, "xaccSplitMakeStockSplit", Fixture, NULL, setup, test_xaccSplitMakeStockSplit, teardown);
     GNC_TEST_ADD (suitename, "xaccSplitGetOtherSplit", Fixture, NULL, setup, test_xaccSplitGetOtherSplit, teardown);
     GNC_TEST_ADD (suitename, "xaccSplitVoid", Fixture, NULL, setup, test_xaccSplitVoid, teardown);
+    GNC_TEST_ADD_FUNC (suitename, "xaccBookForeachSplitInDateRange", test_xaccBookForeachSplitInDateRange);
 
 }